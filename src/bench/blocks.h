@@ -0,0 +1,32 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+/**
+ * Builders for synthetic Fleet Credits blocks, shared by benchmarks
+ */
+#ifndef FLEETCREDITS_BENCH_BLOCKS_H
+#define FLEETCREDITS_BENCH_BLOCKS_H
+
+#include "primitives/block.h"
+#include "primitives/contribution.h"
+#include "primitives/mweb.h"
+
+#include <vector>
+
+/**
+ * Contributions of the types that count on the main chain, each from its own
+ * contributor and with its own proof
+ */
+std::vector<CContributionTransaction> CreateBenchContributions(size_t nContributions);
+
+/** A block with a transaction carrying each contribution, as consensus reads it */
+CBlock CreateBenchContributionBlock(const std::vector<CContributionTransaction>& contributions);
+
+/**
+ * An extension block of nTxs transactions with well-formed commitments, range
+ * proofs and kernels
+ */
+CMWEBExtensionBlock CreateBenchExtensionBlock(size_t nTxs);
+
+#endif // FLEETCREDITS_BENCH_BLOCKS_H
@@ -0,0 +1,162 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "bench/blocks.h"
+#include "amount.h"
+#include "blockmarkers.h"
+#include "chainparams.h"
+#include "fleetcredits.h"
+#include "key.h"
+#include "miner.h"
+#include "oracles.h"
+#include "primitives/block.h"
+#include "primitives/contribution.h"
+#include "random.h"
+#include "script/script.h"
+#include "streams.h"
+#include "version.h"
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+static const size_t BENCH_CONTRIBUTIONS = 500;
+static const size_t BENCH_BLOCK_CONTRIBUTIONS = 100;
+static const size_t BENCH_BLOCK_MWEB_TXS = 100;
+
+std::vector<CContributionTransaction> CreateBenchContributions(size_t nContributions)
+{
+    static const ContributionType types[] = {CODE_CONTRIBUTION, CHARITABLE_ACT, CREATIVE_WORK, DATA_LABELING, AI_VALIDATION};
+    static const uint32_t levels[] = {BONUS_LOW, BONUS_MEDIUM, BONUS_HIGH, BONUS_CRITICAL};
+
+    std::vector<CContributionTransaction> contributions(nContributions);
+    for (size_t i = 0; i < contributions.size(); i++) {
+        CContributionTransaction& contrib = contributions[i];
+        CKey key;
+        key.MakeNewKey(true);
+        contrib.contributor = key.GetPubKey();
+        contrib.contrib_type = types[i % (sizeof(types) / sizeof(types[0]))];
+        contrib.bonus_level = levels[i % (sizeof(levels) / sizeof(levels[0]))];
+        contrib.timestamp = 1776643200;
+        contrib.signature.assign(64, 0x01);
+        contrib.proof_data.contrib_type = contrib.contrib_type;
+        contrib.proof_data.timestamp = contrib.timestamp;
+        contrib.proof_data.evidence.resize(32);
+        GetRandBytes(contrib.proof_data.evidence.data(), contrib.proof_data.evidence.size());
+        contrib.proof_data.hash = CalculateProofDataHash(contrib.proof_data);
+    }
+    return contributions;
+}
+
+CBlock CreateBenchContributionBlock(const std::vector<CContributionTransaction>& contributions)
+{
+    CBlock block;
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vout.resize(1);
+    block.vtx.push_back(MakeTransactionRef(std::move(coinbase)));
+    for (const auto& contrib : contributions) {
+        CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+        ss << contrib;
+        std::vector<unsigned char> script;
+        script.push_back(OP_RETURN);
+        script.push_back(FC_MARKER);
+        script.push_back(FC_MARKER_CONTRIBUTION);
+        script.insert(script.end(), ss.begin(), ss.end());
+
+        CMutableTransaction mtx;
+        mtx.vin.resize(1);
+        mtx.vin[0].prevout.hash = GetRandHash();
+        mtx.vout.resize(1);
+        mtx.vout[0].scriptPubKey = CScript(script.begin(), script.end());
+        block.vtx.push_back(MakeTransactionRef(std::move(mtx)));
+    }
+    return block;
+}
+
+// Parsing and validating the contribution markers of a block, without the
+// cache that spares ConnectBlock a second pass
+static void ContributionExtract(benchmark::State& state)
+{
+    const CBlock block = CreateBenchContributionBlock(CreateBenchContributions(BENCH_CONTRIBUTIONS));
+    while (state.KeepRunning()) {
+        block.markers.reset();
+        bool ok = ExtractContributionsFromBlock(block).size() == BENCH_CONTRIBUTIONS;
+        assert(ok);
+    }
+}
+
+// Block reward of a block full of contributions none of which has a
+// verification record yet
+static void ContributionSubsidy(benchmark::State& state)
+{
+    SelectParams(CBaseChainParams::MAIN);
+    const Consensus::Params& consensus = Params().GetConsensus(1);
+    const std::vector<CContributionTransaction> contributions = CreateBenchContributions(BENCH_CONTRIBUTIONS);
+    while (state.KeepRunning()) {
+        bool ok = GetFleetCreditsBlockSubsidyWithContributions(1, consensus, uint256(), contributions) > FC_BASE_BLOCK_REWARD;
+        assert(ok);
+    }
+}
+
+// Same with every proof claimed by its contribution, looked up in the oracle
+// state as from the height at which claims count
+static void ContributionSubsidyOracleRecords(benchmark::State& state)
+{
+    SelectParams(CBaseChainParams::MAIN);
+    const int nHeight = Params().GetConsensus(0).ContributionClaimHeight;
+    const Consensus::Params& consensus = Params().GetConsensus(nHeight);
+    const std::vector<CContributionTransaction> contributions = CreateBenchContributions(BENCH_CONTRIBUTIONS);
+    COracleView base;
+    COracleViewCache view(&base);
+    for (const auto& contrib : contributions) {
+        CVerificationEntry entry;
+        entry.record = CContributionVerifier::CreateVerificationRecord(contrib);
+        view.SetVerification(entry.record.record_id, entry);
+    }
+    while (state.KeepRunning()) {
+        bool ok = GetFleetCreditsBlockSubsidyWithContributions(nHeight, consensus, uint256(), contributions, &view) > FC_BASE_BLOCK_REWARD;
+        assert(ok);
+    }
+}
+
+// The contributors' share of the bonus, as CreateNewBlock pays it
+static void ContributionRewardSplit(benchmark::State& state)
+{
+    SelectParams(CBaseChainParams::MAIN);
+    const Consensus::Params& consensus = Params().GetConsensus(1);
+    const std::vector<CContributionTransaction> contributions = CreateBenchContributions(BENCH_CONTRIBUTIONS);
+    const CAmount bonusAmount = GetFleetCreditsBlockSubsidyWithContributions(1, consensus, uint256(), contributions) - FC_BASE_BLOCK_REWARD;
+    const CAmount contributorBonusPool = bonusAmount - bonusAmount / 2;
+    while (state.KeepRunning()) {
+        bool ok = SplitContributorBonus(contributions, FC_BASE_BLOCK_REWARD, contributorBonusPool).size() == BENCH_CONTRIBUTIONS;
+        assert(ok);
+    }
+}
+
+// The Fleet Credits part of checking one block that carries both
+// contributions and an extension block: the contribution markers, the reward
+// they earn and full verification of the MWEB transactions
+static void ContributionMWEBBlock(benchmark::State& state)
+{
+    SelectParams(CBaseChainParams::MAIN);
+    const Consensus::Params& consensus = Params().GetConsensus(1);
+    CBlock block = CreateBenchContributionBlock(CreateBenchContributions(BENCH_BLOCK_CONTRIBUTIONS));
+    block.mweb_extension = std::make_shared<CMWEBExtensionBlock>(CreateBenchExtensionBlock(BENCH_BLOCK_MWEB_TXS));
+    while (state.KeepRunning()) {
+        block.markers.reset();
+        const std::vector<CContributionTransaction> contributions = ExtractContributionsFromBlock(block);
+        bool ok = contributions.size() == BENCH_BLOCK_CONTRIBUTIONS;
+        ok &= GetFleetCreditsBlockSubsidyWithContributions(1, consensus, uint256(), contributions) > FC_BASE_BLOCK_REWARD;
+        ok &= block.mweb_extension->VerifyAll();
+        assert(ok);
+    }
+}
+
+BENCHMARK(ContributionExtract);
+BENCHMARK(ContributionSubsidy);
+BENCHMARK(ContributionSubsidyOracleRecords);
+BENCHMARK(ContributionRewardSplit);
+BENCHMARK(ContributionMWEBBlock);
@@ -0,0 +1,104 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "bench/blocks.h"
+#include "amount.h"
+#include "key.h"
+#include "primitives/mweb.h"
+#include "random.h"
+
+#include <cassert>
+#include <vector>
+
+static const size_t MWEB_BLOCK_TXS = 250;
+static const size_t MWEB_TX_INPUTS = 2;
+static const size_t MWEB_TX_OUTPUTS = 2;
+
+CMWEBExtensionBlock CreateBenchExtensionBlock(size_t nTxs)
+{
+    CMWEBExtensionBlock block;
+    block.mweb_txs.resize(nTxs);
+    for (auto& tx : block.mweb_txs) {
+        for (size_t i = 0; i < MWEB_TX_INPUTS; i++) {
+            CMWEBInput input;
+            input.output_commitment = MWEB::CreateCommitment((i + 1) * COIN, GetRandHash());
+            tx.inputs.push_back(input);
+        }
+        for (size_t i = 0; i < MWEB_TX_OUTPUTS; i++) {
+            CMWEBOutput output;
+            output.commitment = MWEB::CreateCommitment((i + 1) * COIN, GetRandHash());
+            output.range_proof = MWEB::GenerateRangeProof(output.commitment, (i + 1) * COIN);
+            tx.outputs.push_back(output);
+        }
+        CKey excess_key;
+        excess_key.MakeNewKey(true);
+        CMWEBKernel kernel;
+        kernel.excess_value = excess_key.GetPubKey();
+        kernel.signature.assign(64, 0x01);
+        kernel.kernel_id = GetRandHash();
+        tx.kernels.push_back(kernel);
+        tx.tx_hash = tx.GetHash();
+    }
+    return block;
+}
+
+// One balance check per transaction, as VerifyAll does
+static void MWEBVerifyBalancePerTx(benchmark::State& state)
+{
+    const CMWEBExtensionBlock block = CreateBenchExtensionBlock(MWEB_BLOCK_TXS);
+    while (state.KeepRunning()) {
+        for (const auto& tx : block.mweb_txs) {
+            bool ok = tx.VerifyBalance();
+            assert(ok);
+        }
+    }
+}
+
+// Full verification of an extension block (balance and range proofs),
+// inline and without the verification cache
+static void MWEBVerifyAll(benchmark::State& state)
+{
+    const CMWEBExtensionBlock block = CreateBenchExtensionBlock(MWEB_BLOCK_TXS);
+    while (state.KeepRunning()) {
+        bool ok = block.VerifyAll();
+        assert(ok);
+    }
+}
+
+// Cut-through of a synthetic 50k-output extension block in which every
+// transaction spends two outputs of its predecessor. Commitments are random
+// 33-byte strings: cut-through only compares them.
+static void MWEBCutThrough50k(benchmark::State& state)
+{
+    static const size_t CUT_THROUGH_TXS = 10000;
+    static const size_t CUT_THROUGH_TX_OUTPUTS = 5;
+
+    CMWEBExtensionBlock block;
+    block.mweb_txs.resize(CUT_THROUGH_TXS);
+    std::vector<unsigned char> vch(CPubKey::COMPRESSED_SIZE);
+    for (size_t i = 0; i < CUT_THROUGH_TXS; i++) {
+        CMWEBTransaction& tx = block.mweb_txs[i];
+        tx.outputs.resize(CUT_THROUGH_TX_OUTPUTS);
+        for (auto& output : tx.outputs) {
+            GetRandBytes(vch.data(), vch.size());
+            vch[0] = 0x02;
+            output.commitment.commitment = CPubKey(vch);
+        }
+        if (i > 0) {
+            tx.inputs.resize(2);
+            tx.inputs[0].output_commitment = block.mweb_txs[i - 1].outputs[0].commitment;
+            tx.inputs[1].output_commitment = block.mweb_txs[i - 1].outputs[1].commitment;
+        }
+    }
+
+    while (state.KeepRunning()) {
+        CMWEBExtensionBlock cut_block = MWEB::CutThrough(block);
+        assert(cut_block.mweb_txs[1].inputs.empty());
+    }
+}
+
+BENCHMARK(MWEBVerifyBalancePerTx);
+BENCHMARK(MWEBVerifyAll);
+BENCHMARK(MWEBCutThrough50k);
@@ -25,4 +25,21 @@ static void Scrypt(benchmark::State& state)
     }
 }
 
+// A batch of as many headers as the widest kernel hashes at once
+static void ScryptMulti(benchmark::State& state)
+{
+    std::vector<char> in(BUFFER_SIZE * SCRYPT_MAX_LANES, 0);
+    std::vector<char> output(32 * SCRYPT_MAX_LANES);
+    for (int i = 0; i < SCRYPT_MAX_LANES; i++)
+        in[BUFFER_SIZE * i] = i;
+
+    scrypt_detect_multi();
+
+    while (state.KeepRunning())
+    {
+        scrypt_1024_1_1_256_multi(in.data(), output.data(), SCRYPT_MAX_LANES);
+    }
+}
+
 BENCHMARK(Scrypt);
+BENCHMARK(ScryptMulti);
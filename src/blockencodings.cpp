@@ -12,6 +12,7 @@
 #include "consensus/validation.h"
 #include "chainparams.h"
 #include "hash.h"
+#include "mweb_mempool.h"
 #include "random.h"
 #include "streams.h"
 #include "txmempool.h"
@@ -21,6 +22,7 @@
 #include <unordered_map>
 
 #define MIN_TRANSACTION_BASE_SIZE (::GetSerializeSize(CTransaction(), SER_NETWORK, PROTOCOL_VERSION | SERIALIZE_TRANSACTION_NO_WITNESS))
+#define MIN_MWEB_TRANSACTION_SIZE (::GetSerializeSize(CMWEBTransaction(), SER_NETWORK, PROTOCOL_VERSION))
 
 CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock& block, bool fUseWTXID) :
         nonce(GetRand(std::numeric_limits<uint64_t>::max())),
@@ -32,6 +34,18 @@ CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock& block, bool f
         const CTransaction& tx = *block.vtx[i];
         shorttxids[i - 1] = GetShortID(fUseWTXID ? tx.GetWitnessHash() : tx.GetHash());
     }
+    if (block.mweb_extension) {
+        const CMWEBExtensionBlock& mweb = *block.mweb_extension;
+        mweb_header.reset(new CMWEBExtensionBlock());
+        mweb_header->prev_mweb_hash = mweb.prev_mweb_hash;
+        mweb_header->peg_ins = mweb.peg_ins;
+        mweb_header->peg_outs = mweb.peg_outs;
+        mweb_header->mweb_root = mweb.mweb_root;
+        mweb_header->extension_block_hash = mweb.extension_block_hash;
+        mweb_shorttxids.resize(mweb.mweb_txs.size());
+        for (size_t i = 0; i < mweb.mweb_txs.size(); i++)
+            mweb_shorttxids[i] = GetShortID(mweb.mweb_txs[i].tx_hash);
+    }
 }
 
 void CBlockHeaderAndShortTxIDs::FillShortTxIDSelector() const {
@@ -57,13 +71,19 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
         return READ_STATUS_INVALID;
     if (cmpctblock.shorttxids.size() + cmpctblock.prefilledtxn.size() > MAX_BLOCK_BASE_SIZE / MIN_TRANSACTION_BASE_SIZE)
         return READ_STATUS_INVALID;
+    if (cmpctblock.mweb_header && !cmpctblock.mweb_header->mweb_txs.empty())
+        return READ_STATUS_INVALID;
+    if (cmpctblock.mweb_shorttxids.size() > MAX_BLOCK_BASE_SIZE / MIN_MWEB_TRANSACTION_SIZE)
+        return READ_STATUS_INVALID;
 
-    if (!header.IsNull() || !txn_available.empty()) {
+    if (!header.IsNull() || !txn_available.empty() || mweb_header) {
         return READ_STATUS_FAILED;
     }
 
     header = cmpctblock.header;
     txn_available.resize(cmpctblock.BlockTxCount());
+    mweb_header = cmpctblock.mweb_header;
+    mweb_available.resize(cmpctblock.MWEBTxCount());
 
     int32_t lastprefilledindex = -1;
     for (size_t i = 0; i < cmpctblock.prefilledtxn.size(); i++) {
@@ -172,6 +192,39 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
             break;
     }
 
+    if (!mweb_available.empty()) {
+        // MWEB transactions are matched against the MWEB mempool the same way,
+        // except that their short ids are computed from tx_hash.
+        std::unordered_map<uint64_t, uint16_t> mweb_shorttxids(cmpctblock.mweb_shorttxids.size());
+        for (size_t i = 0; i < cmpctblock.mweb_shorttxids.size(); i++) {
+            mweb_shorttxids[cmpctblock.mweb_shorttxids[i]] = i;
+            if (mweb_shorttxids.bucket_size(mweb_shorttxids.bucket(cmpctblock.mweb_shorttxids[i])) > 12)
+                return READ_STATUS_FAILED;
+        }
+        if (mweb_shorttxids.size() != cmpctblock.mweb_shorttxids.size())
+            return READ_STATUS_FAILED; // Short ID collision
+
+        if (mweb_pool) {
+            std::vector<bool> have_mweb_txn(mweb_available.size());
+            for (const CMWEBTransactionRef& ptx : mweb_pool->GetMWEBTransactions()) {
+                std::unordered_map<uint64_t, uint16_t>::iterator idit = mweb_shorttxids.find(cmpctblock.GetShortID(ptx->tx_hash));
+                if (idit != mweb_shorttxids.end()) {
+                    if (!have_mweb_txn[idit->second]) {
+                        mweb_available[idit->second] = ptx;
+                        have_mweb_txn[idit->second] = true;
+                        mweb_mempool_count++;
+                    } else if (mweb_available[idit->second]) {
+                        // Two pool transactions match the short id, request it
+                        mweb_available[idit->second].reset();
+                        mweb_mempool_count--;
+                    }
+                }
+                if (mweb_mempool_count == mweb_shorttxids.size())
+                    break;
+            }
+        }
+    }
+
     LogPrint("cmpctblock", "Initialized PartiallyDownloadedBlock for block %s using a cmpctblock of size %lu\n", cmpctblock.header.GetHash().ToString(), GetSerializeSize(cmpctblock, SER_NETWORK, PROTOCOL_VERSION));
 
     return READ_STATUS_OK;
@@ -186,7 +239,16 @@ bool PartiallyDownloadedBlock::IsTxAvailable(size_t index) const {
     return txn_available[index] ? true : false;
 }
 
-ReadStatus PartiallyDownloadedBlock::FillBlock(CBlock& block, const std::vector<CTransactionRef>& vtx_missing) {
+bool PartiallyDownloadedBlock::IsMWEBTxAvailable(size_t index) const {
+    if (header.IsNull()) {
+        return false;
+    }
+
+    assert(index < mweb_available.size());
+    return mweb_available[index] ? true : false;
+}
+
+ReadStatus PartiallyDownloadedBlock::FillBlock(CBlock& block, const std::vector<CTransactionRef>& vtx_missing, const std::vector<CMWEBTransaction>& mweb_missing) {
     if (header.IsNull()) {
         return READ_STATUS_INVALID;
     }
@@ -205,11 +267,28 @@ ReadStatus PartiallyDownloadedBlock::FillBlock(CBlock& block, const std::vector<
             block.vtx[i] = std::move(txn_available[i]);
     }
 
+    size_t mweb_missing_offset = 0;
+    if (mweb_header) {
+        std::shared_ptr<CMWEBExtensionBlock> mweb = std::make_shared<CMWEBExtensionBlock>(*mweb_header);
+        mweb->mweb_txs.reserve(mweb_available.size());
+        for (size_t i = 0; i < mweb_available.size(); i++) {
+            if (!mweb_available[i]) {
+                if (mweb_missing.size() <= mweb_missing_offset)
+                    return READ_STATUS_INVALID;
+                mweb->mweb_txs.push_back(mweb_missing[mweb_missing_offset++]);
+            } else
+                mweb->mweb_txs.push_back(*mweb_available[i]);
+        }
+        block.mweb_extension = mweb;
+    }
+
     // Make sure we can't call FillBlock again.
     header.SetNull();
     txn_available.clear();
+    mweb_header.reset();
+    mweb_available.clear();
 
-    if (vtx_missing.size() != tx_missing_offset)
+    if (vtx_missing.size() != tx_missing_offset || mweb_missing.size() != mweb_missing_offset)
         return READ_STATUS_INVALID;
 
     CValidationState state;
@@ -225,6 +304,8 @@ ReadStatus PartiallyDownloadedBlock::FillBlock(CBlock& block, const std::vector<
     }
 
     LogPrint("cmpctblock", "Successfully reconstructed block %s with %lu txn prefilled, %lu txn from mempool (incl at least %lu from extra pool) and %lu txn requested\n", hash.ToString(), prefilled_count, mempool_count, extra_count, vtx_missing.size());
+    if (block.mweb_extension)
+        LogPrint("cmpctblock", "Reconstructed block %s with %lu MWEB txn from the MWEB mempool and %lu MWEB txn requested\n", hash.ToString(), mweb_mempool_count, mweb_missing.size());
     if (vtx_missing.size() < 5) {
         for (const auto& tx : vtx_missing)
             LogPrint("cmpctblock", "Reconstructed block %s required tx %s\n", hash.ToString(), tx->GetHash().ToString());
@@ -6,11 +6,20 @@
 #define FLEETCREDITS_BLOCK_ENCODINGS_H
 
 #include "primitives/block.h"
+#include "version.h"
 
 #include <memory>
 
+class CMWEBMempool;
 class CTxMemPool;
 
+// Whether compact block messages serialized at nVersion carry MWEB data; older
+// peers get the encoding without it
+static inline bool CompactBlocksHaveMWEB(int nVersion)
+{
+    return (nVersion & ~SERIALIZE_TRANSACTION_NO_WITNESS) >= MWEB_CMPCT_VERSION;
+}
+
 // Dumb helper to handle CTransaction compression at serialize-time
 struct TransactionCompressor {
 private:
@@ -26,17 +35,17 @@ public:
     }
 };
 
-class BlockTransactionsRequest {
+// Dumb helper to handle the differential encoding of transaction indexes
+struct DifferentialIndexesCompressor {
+private:
+    std::vector<uint16_t>& indexes;
 public:
-    // A BlockTransactionsRequest message
-    uint256 blockhash;
-    std::vector<uint16_t> indexes;
+    DifferentialIndexesCompressor(std::vector<uint16_t>& indexesIn) : indexes(indexesIn) {}
 
     ADD_SERIALIZE_METHODS;
 
     template <typename Stream, typename Operation>
     inline void SerializationOp(Stream& s, Operation ser_action) {
-        READWRITE(blockhash);
         uint64_t indexes_size = (uint64_t)indexes.size();
         READWRITE(COMPACTSIZE(indexes_size));
         if (ser_action.ForRead()) {
@@ -68,15 +77,35 @@ public:
     }
 };
 
+class BlockTransactionsRequest {
+public:
+    // A BlockTransactionsRequest message
+    uint256 blockhash;
+    std::vector<uint16_t> indexes;
+    // Positions of the requested transactions in the MWEB extension block
+    std::vector<uint16_t> mweb_indexes;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(blockhash);
+        READWRITE(REF(DifferentialIndexesCompressor(indexes)));
+        if (CompactBlocksHaveMWEB(s.GetVersion()))
+            READWRITE(REF(DifferentialIndexesCompressor(mweb_indexes)));
+    }
+};
+
 class BlockTransactions {
 public:
     // A BlockTransactions message
     uint256 blockhash;
     std::vector<CTransactionRef> txn;
+    std::vector<CMWEBTransaction> mweb_txn;
 
     BlockTransactions() {}
     BlockTransactions(const BlockTransactionsRequest& req) :
-        blockhash(req.blockhash), txn(req.indexes.size()) {}
+        blockhash(req.blockhash), txn(req.indexes.size()), mweb_txn(req.mweb_indexes.size()) {}
 
     ADD_SERIALIZE_METHODS;
 
@@ -96,6 +125,43 @@ public:
             for (size_t i = 0; i < txn.size(); i++)
                 READWRITE(REF(TransactionCompressor(txn[i])));
         }
+        if (CompactBlocksHaveMWEB(s.GetVersion()))
+            READWRITE(mweb_txn);
+    }
+};
+
+// Dumb helper to handle the 6-byte encoding of short transaction ids
+struct ShortTxIDsCompressor {
+private:
+    std::vector<uint64_t>& shorttxids;
+public:
+    ShortTxIDsCompressor(std::vector<uint64_t>& shorttxidsIn) : shorttxids(shorttxidsIn) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        uint64_t shorttxids_size = (uint64_t)shorttxids.size();
+        READWRITE(COMPACTSIZE(shorttxids_size));
+        if (ser_action.ForRead()) {
+            size_t i = 0;
+            while (shorttxids.size() < shorttxids_size) {
+                shorttxids.resize(std::min((uint64_t)(1000 + shorttxids.size()), shorttxids_size));
+                for (; i < shorttxids.size(); i++) {
+                    uint32_t lsb = 0; uint16_t msb = 0;
+                    READWRITE(lsb);
+                    READWRITE(msb);
+                    shorttxids[i] = (uint64_t(msb) << 32) | uint64_t(lsb);
+                }
+            }
+        } else {
+            for (size_t i = 0; i < shorttxids.size(); i++) {
+                uint32_t lsb = shorttxids[i] & 0xffffffff;
+                uint16_t msb = (shorttxids[i] >> 32) & 0xffff;
+                READWRITE(lsb);
+                READWRITE(msb);
+            }
+        }
     }
 };
 
@@ -142,6 +208,11 @@ protected:
     std::vector<uint64_t> shorttxids;
     std::vector<PrefilledTransaction> prefilledtxn;
 
+    // The MWEB extension block without its transactions, if the block has one
+    std::shared_ptr<CMWEBExtensionBlock> mweb_header;
+    // Short ids of the MWEB transactions, derived from their tx_hash
+    std::vector<uint64_t> mweb_shorttxids;
+
 public:
     CBlockHeader header;
 
@@ -154,6 +225,10 @@ public:
 
     size_t BlockTxCount() const { return shorttxids.size() + prefilledtxn.size(); }
 
+    size_t MWEBTxCount() const { return mweb_shorttxids.size(); }
+
+    bool HasMWEB() const { return mweb_header != nullptr; }
+
     ADD_SERIALIZE_METHODS;
 
     template <typename Stream, typename Operation>
@@ -161,31 +236,28 @@ public:
         READWRITE(header);
         READWRITE(nonce);
 
-        uint64_t shorttxids_size = (uint64_t)shorttxids.size();
-        READWRITE(COMPACTSIZE(shorttxids_size));
-        if (ser_action.ForRead()) {
-            size_t i = 0;
-            while (shorttxids.size() < shorttxids_size) {
-                shorttxids.resize(std::min((uint64_t)(1000 + shorttxids.size()), shorttxids_size));
-                for (; i < shorttxids.size(); i++) {
-                    uint32_t lsb = 0; uint16_t msb = 0;
-                    READWRITE(lsb);
-                    READWRITE(msb);
-                    shorttxids[i] = (uint64_t(msb) << 32) | uint64_t(lsb);
-                    static_assert(SHORTTXIDS_LENGTH == 6, "shorttxids serialization assumes 6-byte shorttxids");
-                }
-            }
-        } else {
-            for (size_t i = 0; i < shorttxids.size(); i++) {
-                uint32_t lsb = shorttxids[i] & 0xffffffff;
-                uint16_t msb = (shorttxids[i] >> 32) & 0xffff;
-                READWRITE(lsb);
-                READWRITE(msb);
-            }
-        }
+        static_assert(SHORTTXIDS_LENGTH == 6, "shorttxids serialization assumes 6-byte shorttxids");
+        READWRITE(REF(ShortTxIDsCompressor(shorttxids)));
 
         READWRITE(prefilledtxn);
 
+        // MWEB extension block, with its transactions replaced by short ids.
+        // Peers below MWEB_CMPCT_VERSION are not sent compact blocks that
+        // have one.
+        const bool fMWEB = CompactBlocksHaveMWEB(s.GetVersion());
+        bool has_mweb = fMWEB && mweb_header != nullptr;
+        if (fMWEB)
+            READWRITE(has_mweb);
+        if (has_mweb) {
+            if (ser_action.ForRead())
+                mweb_header.reset(new CMWEBExtensionBlock());
+            READWRITE(*mweb_header);
+            READWRITE(REF(ShortTxIDsCompressor(mweb_shorttxids)));
+        } else if (ser_action.ForRead()) {
+            mweb_header.reset();
+            mweb_shorttxids.clear();
+        }
+
         if (ser_action.ForRead())
             FillShortTxIDSelector();
     }
@@ -194,16 +266,22 @@ public:
 class PartiallyDownloadedBlock {
 protected:
     std::vector<CTransactionRef> txn_available;
-    size_t prefilled_count = 0, mempool_count = 0, extra_count = 0;
+    std::shared_ptr<const CMWEBExtensionBlock> mweb_header;
+    std::vector<CMWEBTransactionRef> mweb_available;
+    size_t prefilled_count = 0, mempool_count = 0, extra_count = 0, mweb_mempool_count = 0;
     CTxMemPool* pool;
+    CMWEBMempool* mweb_pool;
 public:
     CBlockHeader header;
-    PartiallyDownloadedBlock(CTxMemPool* poolIn) : pool(poolIn) {}
+    // Without an MWEB mempool every MWEB transaction has to be requested
+    PartiallyDownloadedBlock(CTxMemPool* poolIn, CMWEBMempool* mwebPoolIn = NULL) : pool(poolIn), mweb_pool(mwebPoolIn) {}
 
     // extra_txn is a list of extra transactions to look at, in <witness hash, reference> form
     ReadStatus InitData(const CBlockHeaderAndShortTxIDs& cmpctblock, const std::vector<std::pair<uint256, CTransactionRef>>& extra_txn);
     bool IsTxAvailable(size_t index) const;
-    ReadStatus FillBlock(CBlock& block, const std::vector<CTransactionRef>& vtx_missing);
+    bool IsMWEBTxAvailable(size_t index) const;
+    ReadStatus FillBlock(CBlock& block, const std::vector<CTransactionRef>& vtx_missing,
+                         const std::vector<CMWEBTransaction>& mweb_missing = std::vector<CMWEBTransaction>());
 };
 
 #endif
@@ -0,0 +1,366 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "blockmarkers.h"
+
+#include "memusage.h"
+#include "primitives/block.h"
+#include "script/script.h"
+#include "streams.h"
+#include "version.h"
+
+#include <algorithm>
+#include <atomic>
+
+bool GetFCMarker(const CScript& script, unsigned char& type, const unsigned char*& pbegin, const unsigned char*& pend, bool& fPushed)
+{
+    if (script.size() < 3 || script[0] != OP_RETURN)
+        return false;
+
+    // Skip the opcode and length of a push, if the marker is pushed
+    size_t nStart = 1;
+    unsigned char opcode = script[1];
+    if (opcode < OP_PUSHDATA1) {
+        nStart = 2;
+    } else if (opcode == OP_PUSHDATA1 && script.size() > 2) {
+        nStart = 3;
+    } else if (opcode == OP_PUSHDATA2 && script.size() > 3) {
+        nStart = 4;
+    } else if (opcode == OP_PUSHDATA4 && script.size() > 5) {
+        nStart = 6;
+    }
+
+    if (script.size() < nStart + 2 || script[nStart] != FC_MARKER)
+        return false;
+    type = script[nStart + 1];
+    pbegin = script.data() + nStart + 2;
+    pend = script.data() + script.size();
+    fPushed = nStart > 1;
+    return true;
+}
+
+namespace {
+
+/** Parse a contribution in the encoding of submitcontribution */
+bool ParseSubmittedContribution(const CTransaction& tx, const unsigned char* pbegin, const unsigned char* pend, CContributionTransaction& contrib_tx)
+{
+    try {
+        CSpanReader ss(SER_NETWORK, PROTOCOL_VERSION, pbegin, pend);
+        uint8_t contrib_type_byte;
+        ss >> contrib_type_byte;
+        contrib_tx.contrib_type = static_cast<ContributionType>(contrib_type_byte);
+        ss >> contrib_tx.proof_data.hash;
+        ss >> contrib_tx.proof_data.evidence;
+        ss >> contrib_tx.timestamp;
+        ss >> contrib_tx.bonus_level;
+        uint8_t requires_mweb_byte;
+        ss >> requires_mweb_byte;
+        contrib_tx.requires_mweb = (requires_mweb_byte != 0);
+    } catch (const std::exception& e) {
+        // Invalid contribution data
+        return false;
+    }
+
+    // Set transaction ID from the actual transaction
+    contrib_tx.tx_id = tx.GetHash();
+    return true;
+}
+
+/**
+ * Parse a contribution that counts towards the block reward: a complete,
+ * valid CContributionTransaction that does not belong in the MWEB
+ * extension block.
+ */
+bool ParseBlockContribution(const CTransaction& tx, const unsigned char* pbegin, const unsigned char* pend, CContributionTransaction& contrib_tx)
+{
+    try {
+        CSpanReader ss(SER_NETWORK, PROTOCOL_VERSION, pbegin, pend);
+        ss >> contrib_tx;
+    } catch (const std::exception& e) {
+        // Invalid contribution data
+        return false;
+    }
+    if (!ValidateContributionTransaction(contrib_tx))
+        return false;
+    contrib_tx.tx_id = tx.GetHash();
+
+    // MWEB-required contributions are extracted from MWEB extension blocks
+    // via ExtractContributionsFromMWEB() during block validation.
+    // Skip extraction from main chain to avoid duplicates.
+    return !contrib_tx.RequiresMWEB();
+}
+
+template <typename T>
+bool ParsePayload(const unsigned char* pbegin, const unsigned char* pend, T& obj)
+{
+    try {
+        CSpanReader ss(SER_NETWORK, PROTOCOL_VERSION, pbegin, pend);
+        ss >> obj;
+    } catch (const std::exception& e) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Parse a payload in the encoding of submitproposal and vote, where the
+ * marker is pushed on its own and the payload is the push that follows:
+ * OP_RETURN <0xFC type> <payload>
+ */
+template <typename T>
+bool ParsePushedPayload(const CScript& script, const unsigned char* pbegin, T& obj)
+{
+    if (script[1] != 2)
+        return false;
+    CScript::const_iterator pc = script.begin() + (pbegin - script.data());
+    opcodetype opcode;
+    std::vector<unsigned char> vch;
+    if (!script.GetOp(pc, opcode, vch) || pc != script.end())
+        return false;
+    return ParsePayload(vch.data(), vch.data() + vch.size(), obj);
+}
+
+/** Parse a governance payload in either encoding */
+template <typename T>
+bool ParseGovernancePayload(const CScript& script, const unsigned char* pbegin, const unsigned char* pend, bool fPushed, T& obj)
+{
+    if (fPushed)
+        return ParsePushedPayload(script, pbegin, obj);
+    return ParsePayload(pbegin, pend, obj);
+}
+
+/** Parse an oracle registration or vote, which must be signed by the oracle */
+template <typename T>
+bool ParseOracleMessage(const unsigned char* pbegin, const unsigned char* pend, T& obj)
+{
+    return ParsePayload(pbegin, pend, obj) && obj.CheckSignature();
+}
+
+bool ParsePegIn(const CTransaction& tx, const unsigned char* pbegin, const unsigned char* pend, CPegInMarker& peg_in)
+{
+    try {
+        CSpanReader ss(SER_NETWORK, PROTOCOL_VERSION, pbegin, pend);
+        ss >> peg_in.peg_tx_id;
+        ss >> peg_in.amount;
+    } catch (const std::exception& e) {
+        // Invalid peg-in data
+        return false;
+    }
+    peg_in.txid = tx.GetHash();
+    return true;
+}
+
+void ScanTransaction(const CTransaction& tx, bool fCoinbase, CBlockMarkers& markers)
+{
+    // Per transaction only the first contribution (in either encoding),
+    // proposal and vote marker counts, as in the Extract*FromTransaction
+    bool fSeenContribution = false;
+    bool fSeenProposal = false;
+    bool fSeenVote = false;
+
+    for (const auto& txout : tx.vout) {
+        unsigned char type;
+        const unsigned char* pbegin;
+        const unsigned char* pend;
+        bool fPushed;
+        if (!GetFCMarker(txout.scriptPubKey, type, pbegin, pend, fPushed))
+            continue;
+
+        switch (type) {
+        case FC_MARKER_CONTRIBUTION:
+            if (fCoinbase)
+                break;
+            if (!fPushed) {
+                CContributionTransaction contrib_tx;
+                if (ParseBlockContribution(tx, pbegin, pend, contrib_tx))
+                    markers.contributions.push_back(contrib_tx);
+            }
+            if (!fSeenContribution) {
+                fSeenContribution = true;
+                CContributionTransaction contrib_tx;
+                if (ParseSubmittedContribution(tx, pbegin, pend, contrib_tx))
+                    markers.tx_contributions.push_back(contrib_tx);
+            }
+            break;
+        case FC_MARKER_PEG_IN:
+            if (!fPushed) {
+                CPegInMarker peg_in;
+                if (ParsePegIn(tx, pbegin, pend, peg_in))
+                    markers.peg_ins.push_back(peg_in);
+            }
+            break;
+        case FC_MARKER_GOVERNANCE_PROPOSAL:
+            if (!fCoinbase && !fSeenProposal) {
+                fSeenProposal = true;
+                CGovernanceProposal proposal;
+                if (ParseGovernancePayload(txout.scriptPubKey, pbegin, pend, fPushed, proposal)) {
+                    proposal.proposal_id = proposal.CalculateProposalId();
+                    markers.proposals.emplace_back(tx.GetHash(), proposal);
+                }
+            }
+            break;
+        case FC_MARKER_GOVERNANCE_VOTE:
+            if (!fCoinbase && !fSeenVote) {
+                fSeenVote = true;
+                CGovernanceVote vote;
+                if (ParseGovernancePayload(txout.scriptPubKey, pbegin, pend, fPushed, vote)) {
+                    vote.vote_id = vote.CalculateVoteId();
+                    markers.votes.emplace_back(tx.GetHash(), vote);
+                }
+            }
+            break;
+        case FC_MARKER_ORACLE_REGISTRATION:
+            if (!fCoinbase && !fPushed) {
+                COracleRegistration registration;
+                if (ParseOracleMessage(pbegin, pend, registration))
+                    markers.oracle_registrations.push_back(registration);
+            }
+            break;
+        case FC_MARKER_ORACLE_VOTE:
+            if (!fCoinbase && !fPushed) {
+                COracleVote vote;
+                if (ParseOracleMessage(pbegin, pend, vote))
+                    markers.oracle_votes.push_back(vote);
+            }
+            break;
+        }
+    }
+}
+
+} // anon namespace
+
+bool CBlockMarkers::HasPegIn(const uint256& txid, const uint256& peg_tx_id, CAmount amount) const
+{
+    for (const auto& peg_in : peg_ins) {
+        if (peg_in.txid == txid && peg_in.peg_tx_id == peg_tx_id && peg_in.amount == amount)
+            return true;
+    }
+    return false;
+}
+
+bool CBlockMarkers::IsEmpty() const
+{
+    return contributions.empty() && tx_contributions.empty() && peg_ins.empty() && proposals.empty() && votes.empty() &&
+           oracle_registrations.empty() && oracle_votes.empty();
+}
+
+void CBlockMarkers::Append(const CBlockMarkers& other)
+{
+    contributions.insert(contributions.end(), other.contributions.begin(), other.contributions.end());
+    tx_contributions.insert(tx_contributions.end(), other.tx_contributions.begin(), other.tx_contributions.end());
+    peg_ins.insert(peg_ins.end(), other.peg_ins.begin(), other.peg_ins.end());
+    proposals.insert(proposals.end(), other.proposals.begin(), other.proposals.end());
+    votes.insert(votes.end(), other.votes.begin(), other.votes.end());
+    oracle_registrations.insert(oracle_registrations.end(), other.oracle_registrations.begin(), other.oracle_registrations.end());
+    oracle_votes.insert(oracle_votes.end(), other.oracle_votes.begin(), other.oracle_votes.end());
+}
+
+size_t CBlockMarkers::DynamicMemoryUsage() const
+{
+    // Approximate: the variable-size payloads inside the contributions,
+    // proposals and votes are small next to the objects themselves
+    return memusage::DynamicUsage(contributions) + memusage::DynamicUsage(tx_contributions) +
+           memusage::DynamicUsage(peg_ins) + memusage::DynamicUsage(proposals) +
+           memusage::DynamicUsage(votes) + memusage::DynamicUsage(oracle_registrations) +
+           memusage::DynamicUsage(oracle_votes) + memusage::DynamicUsage(vtx);
+}
+
+std::shared_ptr<const CBlockMarkers> GetTransactionMarkers(const CTransaction& tx)
+{
+    static const std::shared_ptr<const CBlockMarkers> empty = std::make_shared<CBlockMarkers>();
+
+    std::shared_ptr<CBlockMarkers> scanned = std::make_shared<CBlockMarkers>();
+    ScanTransaction(tx, false, *scanned);
+    if (scanned->IsEmpty())
+        return empty;
+    return scanned;
+}
+
+std::shared_ptr<const CBlockMarkers> GetBlockMarkers(const CBlock& block, const TxMarkersLookup& lookupTx)
+{
+    std::shared_ptr<const CBlockMarkers> markers = std::atomic_load(&block.markers);
+    if (markers && markers->vtx == block.vtx)
+        return markers;
+
+    std::shared_ptr<CBlockMarkers> scanned;
+    if (markers && !block.vtx.empty() && markers->vtx.size() == block.vtx.size() &&
+        std::equal(block.vtx.begin() + 1, block.vtx.end(), markers->vtx.begin() + 1)) {
+        // Only the coinbase changed, which carries nothing but peg-ins
+        scanned = std::make_shared<CBlockMarkers>(*markers);
+        if (markers->vtx[0]) {
+            const uint256 hashOld = markers->vtx[0]->GetHash();
+            scanned->peg_ins.erase(std::remove_if(scanned->peg_ins.begin(), scanned->peg_ins.end(),
+                                                  [&hashOld](const CPegInMarker& peg_in) { return peg_in.txid == hashOld; }),
+                                   scanned->peg_ins.end());
+        }
+        scanned->vtx[0] = block.vtx[0];
+        if (block.vtx[0])
+            ScanTransaction(*block.vtx[0], true, *scanned);
+    } else {
+        scanned = std::make_shared<CBlockMarkers>();
+        scanned->vtx = block.vtx;
+        for (size_t i = 0; i < block.vtx.size(); i++) {
+            // Block templates hold a null placeholder until the coinbase is made
+            if (!block.vtx[i])
+                continue;
+            std::shared_ptr<const CBlockMarkers> txMarkers;
+            if (i > 0 && lookupTx)
+                txMarkers = lookupTx(*block.vtx[i]);
+            if (txMarkers)
+                scanned->Append(*txMarkers);
+            else
+                ScanTransaction(*block.vtx[i], i == 0, *scanned);
+        }
+    }
+    markers = scanned;
+    std::atomic_store(&block.markers, markers);
+    return markers;
+}
+
+bool ExtractContributionFromTransaction(const CTransaction& tx, CContributionTransaction& contrib_tx)
+{
+    for (const auto& txout : tx.vout) {
+        unsigned char type;
+        const unsigned char* pbegin;
+        const unsigned char* pend;
+        bool fPushed;
+        if (GetFCMarker(txout.scriptPubKey, type, pbegin, pend, fPushed) && type == FC_MARKER_CONTRIBUTION)
+            return ParseSubmittedContribution(tx, pbegin, pend, contrib_tx);
+    }
+    return false;
+}
+
+bool ExtractGovernanceProposalFromTransaction(const CTransaction& tx, CGovernanceProposal& proposal)
+{
+    for (const auto& txout : tx.vout) {
+        unsigned char type;
+        const unsigned char* pbegin;
+        const unsigned char* pend;
+        bool fPushed;
+        if (GetFCMarker(txout.scriptPubKey, type, pbegin, pend, fPushed) && type == FC_MARKER_GOVERNANCE_PROPOSAL) {
+            if (!ParseGovernancePayload(txout.scriptPubKey, pbegin, pend, fPushed, proposal))
+                return false;
+            proposal.proposal_id = proposal.CalculateProposalId();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ExtractGovernanceVoteFromTransaction(const CTransaction& tx, CGovernanceVote& vote)
+{
+    for (const auto& txout : tx.vout) {
+        unsigned char type;
+        const unsigned char* pbegin;
+        const unsigned char* pend;
+        bool fPushed;
+        if (GetFCMarker(txout.scriptPubKey, type, pbegin, pend, fPushed) && type == FC_MARKER_GOVERNANCE_VOTE) {
+            if (!ParseGovernancePayload(txout.scriptPubKey, pbegin, pend, fPushed, vote))
+                return false;
+            vote.vote_id = vote.CalculateVoteId();
+            return true;
+        }
+    }
+    return false;
+}
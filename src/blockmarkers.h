@@ -0,0 +1,124 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef FLEETCREDITS_BLOCKMARKERS_H
+#define FLEETCREDITS_BLOCKMARKERS_H
+
+#include "amount.h"
+#include "primitives/contribution.h"
+#include "primitives/governance.h"
+#include "primitives/transaction.h"
+#include "primitives/verification.h"
+#include "uint256.h"
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class CBlock;
+class CScript;
+
+/**
+ * Fleet Credits data is carried in OP_RETURN outputs, after the marker byte
+ * 0xFC and a byte telling what follows.
+ */
+static const unsigned char FC_MARKER = 0xFC;
+
+enum FCMarkerType : unsigned char {
+    FC_MARKER_CONTRIBUTION = 0x01,
+    FC_MARKER_PEG_IN = 0x02,
+    FC_MARKER_GOVERNANCE_PROPOSAL = 0x03,
+    FC_MARKER_GOVERNANCE_VOTE = 0x04,
+    FC_MARKER_ORACLE_REGISTRATION = 0x05,
+    FC_MARKER_ORACLE_VOTE = 0x06,
+};
+
+/**
+ * Locate the Fleet Credits marker of an output script. The marker either
+ * directly follows OP_RETURN or starts the data of its first push
+ * (fPushed). On success [pbegin, pend) is the payload after the marker,
+ * pointing into script.
+ */
+bool GetFCMarker(const CScript& script, unsigned char& type, const unsigned char*& pbegin, const unsigned char*& pend, bool& fPushed);
+
+/** A peg-in marker (0xFC 0x02) of a main chain transaction */
+struct CPegInMarker
+{
+    uint256 txid;           //!< Transaction carrying the marker
+    uint256 peg_tx_id;
+    CAmount amount;
+};
+
+/**
+ * Everything the Fleet Credits markers of a block carry, parsed in a single
+ * pass over its outputs. Only markers directly following OP_RETURN are
+ * consensus relevant (contributions, peg-ins and oracle registrations and
+ * votes, of which only the correctly signed are kept); the contribution of each
+ * transaction as encoded by submitcontribution is kept for the RPCs and the
+ * contribution index. Governance proposals and votes are accepted in both
+ * encodings, see ExtractGovernanceProposalFromTransaction.
+ */
+class CBlockMarkers
+{
+public:
+    //! Valid contributions counting towards the block reward, see ExtractContributionsFromBlock
+    std::vector<CContributionTransaction> contributions;
+    //! The contribution of each transaction, see ExtractContributionFromTransaction
+    std::vector<CContributionTransaction> tx_contributions;
+    std::vector<CPegInMarker> peg_ins;
+    //! Governance proposals and votes, with the transaction carrying them
+    std::vector<std::pair<uint256, CGovernanceProposal> > proposals;
+    std::vector<std::pair<uint256, CGovernanceVote> > votes;
+    std::vector<COracleRegistration> oracle_registrations;
+    std::vector<COracleVote> oracle_votes;
+
+    //! The transactions scanned, to tell whether this is still up to date
+    std::vector<CTransactionRef> vtx;
+
+    /** Whether transaction txid of the block carries a matching peg-in marker */
+    bool HasPegIn(const uint256& txid, const uint256& peg_tx_id, CAmount amount) const;
+
+    bool IsEmpty() const;
+
+    /** Append the markers of another (set of) transaction(s), vtx excluded */
+    void Append(const CBlockMarkers& other);
+
+    size_t DynamicMemoryUsage() const;
+};
+
+/**
+ * Get the markers of a single non-coinbase transaction, as they are part of
+ * the markers of any block including it. Transactions without markers all
+ * share one empty instance.
+ */
+std::shared_ptr<const CBlockMarkers> GetTransactionMarkers(const CTransaction& tx);
+
+/** Looks up the markers of a transaction parsed earlier, or returns nullptr */
+typedef std::function<std::shared_ptr<const CBlockMarkers>(const CTransaction&)> TxMarkersLookup;
+
+/**
+ * Get the markers of a block. The result is cached on the block and reused
+ * until its transactions change; if only the coinbase changed (a new extra
+ * nonce) just the coinbase is scanned again. Markers of non-coinbase
+ * transactions that lookupTx knows, e.g. from the mempool, are not parsed
+ * again.
+ */
+std::shared_ptr<const CBlockMarkers> GetBlockMarkers(const CBlock& block, const TxMarkersLookup& lookupTx = TxMarkersLookup());
+
+/** Extract contribution transaction from a single transaction
+ * Returns true if a contribution was found and extracted, false otherwise
+ */
+bool ExtractContributionFromTransaction(const CTransaction& tx, CContributionTransaction& contrib_tx);
+
+/** Extract governance proposal from transaction, either directly after
+ * OP_RETURN 0xFC 0x03 or, as submitproposal writes it, in the push following
+ * a pushed 0xFC 0x03 (likewise for votes, with 0xFC 0x04)
+ */
+bool ExtractGovernanceProposalFromTransaction(const CTransaction& tx, CGovernanceProposal& proposal);
+
+/** Extract governance vote from transaction */
+bool ExtractGovernanceVoteFromTransaction(const CTransaction& tx, CGovernanceVote& vote);
+
+#endif // FLEETCREDITS_BLOCKMARKERS_H
@@ -148,6 +148,7 @@ enum BlockStatus: uint32_t {
     BLOCK_FAILED_MASK        =   BLOCK_FAILED_VALID | BLOCK_FAILED_CHILD,
 
     BLOCK_OPT_WITNESS       =   128, //!< block data in blk*.data was received with a witness-enforcing client
+    BLOCK_OPT_MWEB          =   256, //!< MWEB extension summary (hashMWEBExtension, nMWEBTx, ...) is recorded
 };
 
 /** The block chain is a tree shaped structure starting with the
@@ -207,6 +208,15 @@ public:
     //! (memory only) Maximum nTime in the chain upto and including this block.
     unsigned int nTimeMax;
 
+    //! Hash of this block's MWEB extension block, null if it has none.
+    //! Only meaningful if nStatus has BLOCK_OPT_MWEB.
+    uint256 hashMWEBExtension;
+
+    //! Number of MWEB transactions, peg-ins and peg-outs in the extension block
+    unsigned int nMWEBTx;
+    unsigned int nPegIn;
+    unsigned int nPegOut;
+
     void SetNull()
     {
         phashBlock = NULL;
@@ -222,6 +232,10 @@ public:
         nStatus = 0;
         nSequenceId = 0;
         nTimeMax = 0;
+        hashMWEBExtension = uint256();
+        nMWEBTx = 0;
+        nPegIn = 0;
+        nPegOut = 0;
 
         nVersion = 0;
         hashMerkleRoot = uint256();
@@ -403,6 +417,14 @@ public:
         READWRITE(nTime);
         READWRITE(nBits);
         READWRITE(nNonce);
+
+        // MWEB extension summary, absent from entries written before it was recorded
+        if (nStatus & BLOCK_OPT_MWEB) {
+            READWRITE(hashMWEBExtension);
+            READWRITE(VARINT(nMWEBTx));
+            READWRITE(VARINT(nPegIn));
+            READWRITE(VARINT(nPegOut));
+        }
     }
 
     uint256 GetBlockHash() const
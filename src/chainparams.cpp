@@ -93,6 +93,8 @@ public:
         consensus.BIP34Hash = uint256(); // Will be set when block 1 is mined
         consensus.BIP65Height = 1;
         consensus.BIP66Height = 1;
+        // Contributions mined before this height may share a proof
+        consensus.ContributionClaimHeight = 400000;
         consensus.powLimit = uint256S("0x00000fffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"); // ~uint256(0) >> 20;
         consensus.nPowTargetTimespan = 4 * 60 * 60; // pre-digishield: 4 hours
         consensus.nPowTargetSpacing = 60; // 1 minute
@@ -238,6 +240,7 @@ public:
         consensus.BIP34Hash = uint256(); // Will be set when block 1 is mined
         consensus.BIP65Height = 1;
         consensus.BIP66Height = 1;
+        consensus.ContributionClaimHeight = 400000;
         consensus.powLimit = uint256S("0x00000fffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"); // ~uint256(0) >> 20;
         consensus.nPowTargetTimespan = 4 * 60 * 60; // pre-digishield: 4 hours
         consensus.nPowTargetSpacing = 60; // 1 minute
@@ -370,6 +373,7 @@ public:
         consensus.BIP34Hash = uint256();
         consensus.BIP65Height = 1351; // BIP65 activated on regtest (Used in rpc activation tests)
         consensus.BIP66Height = 1251; // BIP66 activated on regtest (Used in rpc activation tests)
+        consensus.ContributionClaimHeight = 1;
         consensus.powLimit = uint256S("0x7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"); // ~uint256(0) >> 1;
         consensus.nPowTargetTimespan = 4 * 60 * 60; // pre-digishield: 4 hours
         consensus.nPowTargetSpacing = 1; // regtest: 1 second blocks
@@ -0,0 +1,261 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "contributionindex.h"
+
+#include "blockmarkers.h"
+#include "chain.h"
+#include "chainparams.h"
+#include "fleetcredits.h"
+#include "init.h"
+#include "primitives/block.h"
+#include "util.h"
+#include "validation.h"
+
+#include <ios>
+
+static const char DB_CONTRIBUTION = 'c';
+static const char DB_CONTRIBUTION_TYPE = 't';
+static const char DB_CONTRIBUTION_KEYID = 'k';
+static const char DB_BEST_BLOCK = 'B';
+
+CContributionIndex* pcontributionindex = NULL;
+
+namespace {
+
+/** Size of the fixed-length part that follows the prefix of a range key */
+size_t RangePrefixSize(char chPrefix)
+{
+    switch (chPrefix) {
+    case DB_CONTRIBUTION_TYPE: return 1;
+    case DB_CONTRIBUTION_KEYID: return sizeof(uint160);
+    }
+    throw std::ios_base::failure("Unknown contribution index range key");
+}
+
+/**
+ * Key of the (type, height, txid) and (key id, height, txid) ranges. The
+ * height is big endian so that LevelDB's byte order is height order.
+ */
+struct RangeKey
+{
+    char chPrefix;
+    std::vector<unsigned char> vchPrefix;
+    int nHeight;
+    uint256 txid;
+
+    RangeKey() : chPrefix(0), nHeight(0) {}
+    RangeKey(char chPrefixIn, const std::vector<unsigned char>& vchPrefixIn, int nHeightIn, const uint256& txidIn) :
+        chPrefix(chPrefixIn), vchPrefix(vchPrefixIn), nHeight(nHeightIn), txid(txidIn) {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        ser_writedata8(s, chPrefix);
+        s.write((const char*)vchPrefix.data(), vchPrefix.size());
+        ser_writedata32be(s, nHeight);
+        s << txid;
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        chPrefix = ser_readdata8(s);
+        vchPrefix.resize(RangePrefixSize(chPrefix));
+        s.read((char*)vchPrefix.data(), vchPrefix.size());
+        nHeight = ser_readdata32be(s);
+        s >> txid;
+    }
+};
+
+std::vector<unsigned char> TypePrefix(ContributionType type)
+{
+    return std::vector<unsigned char>(1, (unsigned char)type);
+}
+
+std::vector<unsigned char> KeyIDPrefix(const CKeyID& keyid)
+{
+    return std::vector<unsigned char>(keyid.begin(), keyid.end());
+}
+
+/** All contributions of a block, transparent ones first */
+std::vector<CContributionIndexEntry> GetBlockContributions(const CBlock& block, const CBlockIndex* pindex)
+{
+    std::vector<CContributionIndexEntry> vEntries;
+    CContributionIndexEntry entry;
+    entry.hashBlock = pindex->GetBlockHash();
+    entry.nHeight = pindex->nHeight;
+
+    for (const auto& contrib : GetBlockMarkers(block)->tx_contributions) {
+        entry.contrib = contrib;
+        vEntries.push_back(entry);
+    }
+    if (block.mweb_extension) {
+        entry.fMWEB = true;
+        for (const auto& contrib : ExtractContributionsFromMWEB(*block.mweb_extension)) {
+            entry.contrib = contrib;
+            vEntries.push_back(entry);
+        }
+    }
+    return vEntries;
+}
+
+} // anon namespace
+
+CContributionIndex::CContributionIndex(size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / "contributions", nCacheSize, fMemory, fWipe), fSynced(false)
+{
+    if (!db.Read(DB_BEST_BLOCK, hashBestBlock))
+        hashBestBlock.SetNull();
+}
+
+bool CContributionIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    CDBBatch batch(db);
+    for (const auto& entry : GetBlockContributions(block, pindex)) {
+        const uint256& txid = entry.contrib.tx_id;
+        batch.Write(std::make_pair(DB_CONTRIBUTION, txid), entry);
+        batch.Write(RangeKey(DB_CONTRIBUTION_TYPE, TypePrefix(entry.contrib.contrib_type), entry.nHeight, txid), '\0');
+        if (entry.contrib.contributor.IsValid())
+            batch.Write(RangeKey(DB_CONTRIBUTION_KEYID, KeyIDPrefix(entry.contrib.contributor.GetID()), entry.nHeight, txid), '\0');
+    }
+    batch.Write(DB_BEST_BLOCK, pindex->GetBlockHash());
+    if (!db.WriteBatch(batch))
+        return false;
+    hashBestBlock = pindex->GetBlockHash();
+    return true;
+}
+
+bool CContributionIndex::EraseBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    CDBBatch batch(db);
+    for (const auto& entry : GetBlockContributions(block, pindex)) {
+        const uint256& txid = entry.contrib.tx_id;
+        batch.Erase(std::make_pair(DB_CONTRIBUTION, txid));
+        batch.Erase(RangeKey(DB_CONTRIBUTION_TYPE, TypePrefix(entry.contrib.contrib_type), entry.nHeight, txid));
+        if (entry.contrib.contributor.IsValid())
+            batch.Erase(RangeKey(DB_CONTRIBUTION_KEYID, KeyIDPrefix(entry.contrib.contributor.GetID()), entry.nHeight, txid));
+    }
+    uint256 hashPrev = pindex->pprev ? pindex->pprev->GetBlockHash() : uint256();
+    batch.Write(DB_BEST_BLOCK, hashPrev);
+    if (!db.WriteBatch(batch))
+        return false;
+    hashBestBlock = hashPrev;
+    return true;
+}
+
+bool CContributionIndex::Sync(const CChainParams& chainparams)
+{
+    const CBlockIndex* pindex = NULL;
+    if (!hashBestBlock.IsNull()) {
+        LOCK(cs_main);
+        BlockMap::iterator mi = mapBlockIndex.find(hashBestBlock);
+        if (mi == mapBlockIndex.end())
+            return error("%s: best block %s of the contribution index is unknown", __func__, hashBestBlock.ToString());
+        pindex = mi->second;
+    }
+
+    bool fLogged = false;
+    while (true) {
+        if (ShutdownRequested())
+            return true;
+
+        // Pick the next block to undo or add; block index entries stay valid
+        // once cs_main is released
+        bool fErase;
+        const CBlockIndex* pindexNext;
+        {
+            LOCK(cs_main);
+            fErase = pindex && !chainActive.Contains(pindex);
+            if (fErase) {
+                pindexNext = pindex;
+            } else {
+                pindexNext = pindex ? chainActive.Next(pindex) : chainActive.Genesis();
+                if (!pindexNext) {
+                    // Caught up; from here on the notifications, which are
+                    // sent with cs_main held, keep the index current
+                    fSynced = true;
+                    return true;
+                }
+                if (!fLogged) {
+                    LogPrintf("Adding blocks %d to %d to the contribution index\n", pindexNext->nHeight, chainActive.Height());
+                    fLogged = true;
+                }
+            }
+        }
+
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindexNext, chainparams.GetConsensus(pindexNext->nHeight)))
+            return error("%s: failed to read block %s", __func__, pindexNext->GetBlockHash().ToString());
+        if (fErase) {
+            // Undo blocks that were disconnected while the index was not following the chain
+            if (!EraseBlock(block, pindexNext))
+                return error("%s: failed to write to the contribution index", __func__);
+            pindex = pindexNext->pprev;
+        } else {
+            if (!WriteBlock(block, pindexNext))
+                return error("%s: failed to write to the contribution index", __func__);
+            pindex = pindexNext;
+        }
+    }
+}
+
+bool CContributionIndex::ReadContribution(const uint256& txid, CContributionIndexEntry& entry)
+{
+    return db.Read(std::make_pair(DB_CONTRIBUTION, txid), entry);
+}
+
+bool CContributionIndex::FindByPrefix(char chPrefix, const std::vector<unsigned char>& vchPrefix, int nMinHeight, std::vector<CContributionIndexEntry>& vEntries)
+{
+    std::unique_ptr<CDBIterator> pcursor(db.NewIterator());
+    pcursor->Seek(RangeKey(chPrefix, vchPrefix, std::max(nMinHeight, 0), uint256()));
+    for (; pcursor->Valid(); pcursor->Next()) {
+        RangeKey key;
+        if (!pcursor->GetKey(key) || key.chPrefix != chPrefix || key.vchPrefix != vchPrefix)
+            break;
+        CContributionIndexEntry entry;
+        if (!ReadContribution(key.txid, entry))
+            return error("%s: contribution %s missing from the index", __func__, key.txid.ToString());
+        vEntries.push_back(entry);
+    }
+    return true;
+}
+
+bool CContributionIndex::FindByType(ContributionType type, int nMinHeight, std::vector<CContributionIndexEntry>& vEntries)
+{
+    return FindByPrefix(DB_CONTRIBUTION_TYPE, TypePrefix(type), nMinHeight, vEntries);
+}
+
+bool CContributionIndex::FindByContributor(const CKeyID& contributor, int nMinHeight, std::vector<CContributionIndexEntry>& vEntries)
+{
+    return FindByPrefix(DB_CONTRIBUTION_KEYID, KeyIDPrefix(contributor), nMinHeight, vEntries);
+}
+
+void CContributionIndex::BlockConnected(const CBlock& block, const CBlockIndex* pindex)
+{
+    if (!fSynced)
+        return;
+    uint256 hashPrev = pindex->pprev ? pindex->pprev->GetBlockHash() : uint256();
+    if (hashPrev != hashBestBlock) {
+        LogPrintf("%s: contribution index is not at the parent of block %s, no longer updating it\n", __func__, pindex->GetBlockHash().ToString());
+        fSynced = false;
+        return;
+    }
+    if (!WriteBlock(block, pindex)) {
+        LogPrintf("%s: failed to add block %s to the contribution index, no longer updating it\n", __func__, pindex->GetBlockHash().ToString());
+        fSynced = false;
+    }
+}
+
+void CContributionIndex::BlockDisconnected(const CBlock& block, const CBlockIndex* pindex)
+{
+    if (!fSynced)
+        return;
+    if (pindex->GetBlockHash() != hashBestBlock) {
+        LogPrintf("%s: contribution index is not at block %s, no longer updating it\n", __func__, pindex->GetBlockHash().ToString());
+        fSynced = false;
+        return;
+    }
+    if (!EraseBlock(block, pindex)) {
+        LogPrintf("%s: failed to remove block %s from the contribution index, no longer updating it\n", __func__, pindex->GetBlockHash().ToString());
+        fSynced = false;
+    }
+}
@@ -0,0 +1,112 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef FLEETCREDITS_CONTRIBUTIONINDEX_H
+#define FLEETCREDITS_CONTRIBUTIONINDEX_H
+
+#include "dbwrapper.h"
+#include "primitives/contribution.h"
+#include "pubkey.h"
+#include "serialize.h"
+#include "uint256.h"
+#include "validationinterface.h"
+
+#include <atomic>
+#include <vector>
+
+class CBlock;
+class CBlockIndex;
+class CChainParams;
+
+/** Default for -contributionindex */
+static const bool DEFAULT_CONTRIBUTIONINDEX = false;
+//! max. -dbcache (MiB) to use for the contribution index database
+static const int64_t nMaxContributionIndexCache = 64;
+
+/** A mined contribution, as stored in the contribution index */
+class CContributionIndexEntry
+{
+public:
+    CContributionTransaction contrib;
+    uint256 hashBlock;
+    int nHeight;
+    bool fMWEB;             //!< Found in the MWEB extension block
+
+    CContributionIndexEntry() : nHeight(0), fMWEB(false) {}
+
+    ADD_SERIALIZE_METHODS;
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(contrib);
+        READWRITE(hashBlock);
+        READWRITE(VARINT(nHeight));
+        READWRITE(fMWEB);
+    }
+};
+
+/**
+ * Index of the contributions mined in the active chain (contributions/).
+ *
+ * Besides the entries themselves (by txid) it keeps two sorted key ranges,
+ * (type, height, txid) and (contributor key id, height, txid), so that
+ * listing the contributions of a type or of a contributor above some height
+ * is a single range scan. It follows the chain through the BlockConnected
+ * and BlockDisconnected notifications.
+ */
+class CContributionIndex : public CValidationInterface
+{
+private:
+    CDBWrapper db;
+    uint256 hashBestBlock;  //!< Cached best block, see GetBestBlock
+    std::atomic<bool> fSynced; //!< Following chainActive, see IsSynced
+
+    bool FindByPrefix(char chPrefix, const std::vector<unsigned char>& vchPrefix, int nMinHeight, std::vector<CContributionIndexEntry>& vEntries);
+
+public:
+    CContributionIndex(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
+    virtual ~CContributionIndex() {}
+
+    /** Hash of the last block whose contributions are in the index */
+    uint256 GetBestBlock() const { return hashBestBlock; }
+
+    /**
+     * Whether the index has caught up with chainActive and follows it. This
+     * turns false for good when a block cannot be written, so that callers
+     * report an error rather than serve a stale index.
+     */
+    bool IsSynced() const { return fSynced; }
+
+    /** Add the contributions of a block, which becomes the best block */
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex);
+
+    /** Remove the contributions of a block, its parent becomes the best block */
+    bool EraseBlock(const CBlock& block, const CBlockIndex* pindex);
+
+    /**
+     * Bring the index in line with chainActive, undoing blocks that were
+     * disconnected and adding the ones connected while it was not running.
+     * cs_main is only taken to step through the chain, blocks are read and
+     * written without it. Once the index has caught up, it follows the block
+     * notifications, so it must be registered before this is called.
+     */
+    bool Sync(const CChainParams& chainparams);
+
+    /** Look up a contribution by transaction id */
+    bool ReadContribution(const uint256& txid, CContributionIndexEntry& entry);
+
+    /** Append the contributions of a type mined at nMinHeight or above, lowest height first */
+    bool FindByType(ContributionType type, int nMinHeight, std::vector<CContributionIndexEntry>& vEntries);
+
+    /** Append the contributions of a contributor mined at nMinHeight or above, lowest height first */
+    bool FindByContributor(const CKeyID& contributor, int nMinHeight, std::vector<CContributionIndexEntry>& vEntries);
+
+protected:
+    void BlockConnected(const CBlock& block, const CBlockIndex* pindex);
+    void BlockDisconnected(const CBlock& block, const CBlockIndex* pindex);
+};
+
+/** The contribution index, if -contributionindex is set */
+extern CContributionIndex* pcontributionindex;
+
+#endif // FLEETCREDITS_CONTRIBUTIONINDEX_H
@@ -51,6 +51,32 @@ static inline size_t RecursiveDynamicUsage(const CMutableTransaction& tx) {
     return mem;
 }
 
+static inline size_t RecursiveDynamicUsage(const CMWEBInput& input) {
+    return memusage::DynamicUsage(input.witness);
+}
+
+static inline size_t RecursiveDynamicUsage(const CMWEBOutput& output) {
+    return memusage::DynamicUsage(output.range_proof.proof_data) + memusage::DynamicUsage(output.view_key);
+}
+
+static inline size_t RecursiveDynamicUsage(const CMWEBKernel& kernel) {
+    return memusage::DynamicUsage(kernel.signature);
+}
+
+static inline size_t RecursiveDynamicUsage(const CMWEBTransaction& tx) {
+    size_t mem = memusage::DynamicUsage(tx.inputs) + memusage::DynamicUsage(tx.outputs) + memusage::DynamicUsage(tx.kernels);
+    for (const auto& input : tx.inputs) {
+        mem += RecursiveDynamicUsage(input);
+    }
+    for (const auto& output : tx.outputs) {
+        mem += RecursiveDynamicUsage(output);
+    }
+    for (const auto& kernel : tx.kernels) {
+        mem += RecursiveDynamicUsage(kernel);
+    }
+    return mem;
+}
+
 static inline size_t RecursiveDynamicUsage(const CBlock& block) {
     size_t mem = memusage::DynamicUsage(block.vtx);
     for (const auto& tx : block.vtx) {
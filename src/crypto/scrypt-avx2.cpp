@@ -0,0 +1,38 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// This file is compiled with AVX2 enabled; only call it after checking
+// that the CPU supports it (see scrypt_detect_multi).
+
+#include "crypto/scrypt.h"
+#include "crypto/scrypt-lanes.h"
+
+#include <immintrin.h>
+
+namespace {
+
+struct Avx2Lanes
+{
+    typedef __m256i Vec;
+    static const int WIDTH = 8;
+
+    static inline Vec Add(Vec a, Vec b) { return _mm256_add_epi32(a, b); }
+    static inline Vec Xor(Vec a, Vec b) { return _mm256_xor_si256(a, b); }
+    template <int n> static inline Vec Rotl(Vec a) { return _mm256_or_si256(_mm256_slli_epi32(a, n), _mm256_srli_epi32(a, 32 - n)); }
+    static inline Vec Load(const uint32_t *p) { return _mm256_loadu_si256((const __m256i *)p); }
+    static inline void Store(uint32_t *p, Vec a) { _mm256_storeu_si256((__m256i *)p, a); }
+    static inline Vec Index(Vec x)
+    {
+        const Vec lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        return _mm256_add_epi32(_mm256_slli_epi32(_mm256_and_si256(x, _mm256_set1_epi32(1023)), 8), lane);
+    }
+    static inline Vec Gather(const uint32_t *base, Vec index) { return _mm256_i32gather_epi32((const int *)base, index, 4); }
+};
+
+} // namespace
+
+void scrypt_1024_1_1_256_sp_avx2_8way(const char *input, char *output, char *scratchpad)
+{
+    scrypt_1024_1_1_256_sp_lanes<Avx2Lanes>(input, output, scratchpad);
+}
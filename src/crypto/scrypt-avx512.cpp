@@ -0,0 +1,51 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+// This file is compiled with AVX-512F enabled; only call it after checking
+// that the CPU supports it (see scrypt_detect_multi).
+
+#include "crypto/scrypt.h"
+#include "crypto/scrypt-lanes.h"
+
+// GCC's AVX-512 intrinsics pass a deliberately uninitialized merge operand
+// (_mm512_undefined_epi32) to the unmasked builtins, which sets off
+// -Wuninitialized wherever they are inlined.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include <immintrin.h>
+
+namespace {
+
+struct Avx512Lanes
+{
+    typedef __m512i Vec;
+    static const int WIDTH = 16;
+
+    static inline Vec Add(Vec a, Vec b) { return _mm512_add_epi32(a, b); }
+    static inline Vec Xor(Vec a, Vec b) { return _mm512_xor_si512(a, b); }
+    template <int n> static inline Vec Rotl(Vec a) { return _mm512_rol_epi32(a, n); }
+    static inline Vec Load(const uint32_t *p) { return _mm512_loadu_si512((const void *)p); }
+    static inline void Store(uint32_t *p, Vec a) { _mm512_storeu_si512((void *)p, a); }
+    static inline Vec Index(Vec x)
+    {
+        const Vec lane = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        return _mm512_add_epi32(_mm512_slli_epi32(_mm512_and_si512(x, _mm512_set1_epi32(1023)), 9), lane);
+    }
+    static inline Vec Gather(const uint32_t *base, Vec index) { return _mm512_i32gather_epi32(index, (const void *)base, 4); }
+};
+
+} // namespace
+
+void scrypt_1024_1_1_256_sp_avx512_16way(const char *input, char *output, char *scratchpad)
+{
+    scrypt_1024_1_1_256_sp_lanes<Avx512Lanes>(input, output, scratchpad);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
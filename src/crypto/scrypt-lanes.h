@@ -0,0 +1,154 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef FLEETCREDITS_CRYPTO_SCRYPT_LANES_H
+#define FLEETCREDITS_CRYPTO_SCRYPT_LANES_H
+
+/**
+ * scrypt(1024, 1, 1) over as many independent inputs at once as a vector
+ * register has 32 bit lanes: word k of lane l holds word k of the state of
+ * input l, so every salsa20/8 step runs for all inputs in one instruction.
+ *
+ * Only to be included by the file of a kernel, compiled with the flags of
+ * its instruction set. Lanes is a struct in that file's anonymous namespace
+ * that provides:
+ *   Vec                       the vector type
+ *   WIDTH                     its number of 32 bit lanes
+ *   Add, Xor, Rotl<n>         lane-wise operations
+ *   Load, Store               from and to WIDTH words in memory
+ *   Index(x)                  lane l of x is ((x & 1023) * 32 * WIDTH + l)
+ *   Gather(base, index)       lane l of the result is base[lane l of index]
+ */
+
+#include "crypto/scrypt.h"
+
+#include <stdint.h>
+#include <string.h>
+
+template <typename Lanes>
+static inline void xor_salsa8_lanes(typename Lanes::Vec B[16], const typename Lanes::Vec Bx[16])
+{
+	typedef typename Lanes::Vec Vec;
+	Vec x00,x01,x02,x03,x04,x05,x06,x07,x08,x09,x10,x11,x12,x13,x14,x15;
+	int i;
+
+	x00 = (B[ 0] = Lanes::Xor(B[ 0], Bx[ 0]));
+	x01 = (B[ 1] = Lanes::Xor(B[ 1], Bx[ 1]));
+	x02 = (B[ 2] = Lanes::Xor(B[ 2], Bx[ 2]));
+	x03 = (B[ 3] = Lanes::Xor(B[ 3], Bx[ 3]));
+	x04 = (B[ 4] = Lanes::Xor(B[ 4], Bx[ 4]));
+	x05 = (B[ 5] = Lanes::Xor(B[ 5], Bx[ 5]));
+	x06 = (B[ 6] = Lanes::Xor(B[ 6], Bx[ 6]));
+	x07 = (B[ 7] = Lanes::Xor(B[ 7], Bx[ 7]));
+	x08 = (B[ 8] = Lanes::Xor(B[ 8], Bx[ 8]));
+	x09 = (B[ 9] = Lanes::Xor(B[ 9], Bx[ 9]));
+	x10 = (B[10] = Lanes::Xor(B[10], Bx[10]));
+	x11 = (B[11] = Lanes::Xor(B[11], Bx[11]));
+	x12 = (B[12] = Lanes::Xor(B[12], Bx[12]));
+	x13 = (B[13] = Lanes::Xor(B[13], Bx[13]));
+	x14 = (B[14] = Lanes::Xor(B[14], Bx[14]));
+	x15 = (B[15] = Lanes::Xor(B[15], Bx[15]));
+
+#define SALSA_STEP(a, b, c, n) a = Lanes::Xor(a, Lanes::template Rotl<n>(Lanes::Add(b, c)))
+	for (i = 0; i < 8; i += 2) {
+		/* Operate on columns. */
+		SALSA_STEP(x04, x00, x12,  7);  SALSA_STEP(x09, x05, x01,  7);
+		SALSA_STEP(x14, x10, x06,  7);  SALSA_STEP(x03, x15, x11,  7);
+
+		SALSA_STEP(x08, x04, x00,  9);  SALSA_STEP(x13, x09, x05,  9);
+		SALSA_STEP(x02, x14, x10,  9);  SALSA_STEP(x07, x03, x15,  9);
+
+		SALSA_STEP(x12, x08, x04, 13);  SALSA_STEP(x01, x13, x09, 13);
+		SALSA_STEP(x06, x02, x14, 13);  SALSA_STEP(x11, x07, x03, 13);
+
+		SALSA_STEP(x00, x12, x08, 18);  SALSA_STEP(x05, x01, x13, 18);
+		SALSA_STEP(x10, x06, x02, 18);  SALSA_STEP(x15, x11, x07, 18);
+
+		/* Operate on rows. */
+		SALSA_STEP(x01, x00, x03,  7);  SALSA_STEP(x06, x05, x04,  7);
+		SALSA_STEP(x11, x10, x09,  7);  SALSA_STEP(x12, x15, x14,  7);
+
+		SALSA_STEP(x02, x01, x00,  9);  SALSA_STEP(x07, x06, x05,  9);
+		SALSA_STEP(x08, x11, x10,  9);  SALSA_STEP(x13, x12, x15,  9);
+
+		SALSA_STEP(x03, x02, x01, 13);  SALSA_STEP(x04, x07, x06, 13);
+		SALSA_STEP(x09, x08, x11, 13);  SALSA_STEP(x14, x13, x12, 13);
+
+		SALSA_STEP(x00, x03, x02, 18);  SALSA_STEP(x05, x04, x07, 18);
+		SALSA_STEP(x10, x09, x08, 18);  SALSA_STEP(x15, x14, x13, 18);
+	}
+#undef SALSA_STEP
+
+	B[ 0] = Lanes::Add(B[ 0], x00);
+	B[ 1] = Lanes::Add(B[ 1], x01);
+	B[ 2] = Lanes::Add(B[ 2], x02);
+	B[ 3] = Lanes::Add(B[ 3], x03);
+	B[ 4] = Lanes::Add(B[ 4], x04);
+	B[ 5] = Lanes::Add(B[ 5], x05);
+	B[ 6] = Lanes::Add(B[ 6], x06);
+	B[ 7] = Lanes::Add(B[ 7], x07);
+	B[ 8] = Lanes::Add(B[ 8], x08);
+	B[ 9] = Lanes::Add(B[ 9], x09);
+	B[10] = Lanes::Add(B[10], x10);
+	B[11] = Lanes::Add(B[11], x11);
+	B[12] = Lanes::Add(B[12], x12);
+	B[13] = Lanes::Add(B[13], x13);
+	B[14] = Lanes::Add(B[14], x14);
+	B[15] = Lanes::Add(B[15], x15);
+}
+
+/**
+ * Hash the Lanes::WIDTH 80 byte inputs that follow each other in input to
+ * as many 32 byte hashes in output. scratchpad must hold
+ * Lanes::WIDTH * 131072 + 63 bytes.
+ */
+template <typename Lanes>
+static void scrypt_1024_1_1_256_sp_lanes(const char *input, char *output, char *scratchpad)
+{
+	typedef typename Lanes::Vec Vec;
+	static const int N = Lanes::WIDTH;
+	uint8_t B[N][128];
+	uint32_t W[N];
+	Vec X[32];
+	Vec *V;
+	uint32_t i, k;
+	int l;
+
+	V = (Vec *)(((uintptr_t)(scratchpad) + 63) & ~ (uintptr_t)(63));
+
+	for (l = 0; l < N; l++)
+		PBKDF2_SHA256((const uint8_t *)input + 80 * l, 80, (const uint8_t *)input + 80 * l, 80, 1, B[l], 128);
+
+	for (k = 0; k < 32; k++) {
+		for (l = 0; l < N; l++)
+			W[l] = le32dec(&B[l][4 * k]);
+		X[k] = Lanes::Load(W);
+	}
+
+	for (i = 0; i < 1024; i++) {
+		for (k = 0; k < 32; k++)
+			V[i * 32 + k] = X[k];
+		xor_salsa8_lanes<Lanes>(&X[0], &X[16]);
+		xor_salsa8_lanes<Lanes>(&X[16], &X[0]);
+	}
+	for (i = 0; i < 1024; i++) {
+		/* Each lane reads its own row of V, given by its own X[16]. */
+		const Vec j = Lanes::Index(X[16]);
+		for (k = 0; k < 32; k++)
+			X[k] = Lanes::Xor(X[k], Lanes::Gather((const uint32_t *)&V[k], j));
+		xor_salsa8_lanes<Lanes>(&X[0], &X[16]);
+		xor_salsa8_lanes<Lanes>(&X[16], &X[0]);
+	}
+
+	for (k = 0; k < 32; k++) {
+		Lanes::Store(W, X[k]);
+		for (l = 0; l < N; l++)
+			le32enc(&B[l][4 * k], W[l]);
+	}
+
+	for (l = 0; l < N; l++)
+		PBKDF2_SHA256((const uint8_t *)input + 80 * l, 80, B[l], 128, 1, (uint8_t *)output + 32 * l, 32);
+}
+
+#endif // FLEETCREDITS_CRYPTO_SCRYPT_LANES_H
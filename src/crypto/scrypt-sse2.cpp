@@ -28,6 +28,7 @@
  */
 
 #include "crypto/scrypt.h"
+#include "crypto/scrypt-lanes.h"
 #include "support/experimental.h"
 #include <stdlib.h>
 #include <stdint.h>
@@ -137,3 +138,36 @@ void scrypt_1024_1_1_256_sp_sse2(const char *input, char *output, char *scratchp
 
 	PBKDF2_SHA256((const uint8_t *)input, 80, B, 128, 1, (uint8_t *)output, 32);
 }
+
+namespace {
+
+struct Sse2Lanes
+{
+	typedef __m128i Vec;
+	static const int WIDTH = 4;
+
+	static inline Vec Add(Vec a, Vec b) { return _mm_add_epi32(a, b); }
+	static inline Vec Xor(Vec a, Vec b) { return _mm_xor_si128(a, b); }
+	template <int n> static inline Vec Rotl(Vec a) { return _mm_or_si128(_mm_slli_epi32(a, n), _mm_srli_epi32(a, 32 - n)); }
+	static inline Vec Load(const uint32_t *p) { return _mm_loadu_si128((const __m128i *)p); }
+	static inline void Store(uint32_t *p, Vec a) { _mm_storeu_si128((__m128i *)p, a); }
+	static inline Vec Index(Vec x)
+	{
+		const Vec lane = _mm_setr_epi32(0, 1, 2, 3);
+		return _mm_add_epi32(_mm_slli_epi32(_mm_and_si128(x, _mm_set1_epi32(1023)), 7), lane);
+	}
+	static inline Vec Gather(const uint32_t *base, Vec index)
+	{
+		/* SSE2 has no gather, load the lanes one by one. */
+		uint32_t i[4];
+		_mm_storeu_si128((__m128i *)i, index);
+		return _mm_setr_epi32(base[i[0]], base[i[1]], base[i[2]], base[i[3]]);
+	}
+};
+
+} // namespace
+
+void scrypt_1024_1_1_256_sp_sse2_4way(const char *input, char *output, char *scratchpad)
+{
+	scrypt_1024_1_1_256_sp_lanes<Sse2Lanes>(input, output, scratchpad);
+}
@@ -33,7 +33,7 @@
 #include <stdint.h>
 #include <string.h>
 
-#if defined(USE_SSE2) && !defined(USE_SSE2_ALWAYS)
+#if (defined(USE_SSE2) && !defined(USE_SSE2_ALWAYS)) || defined(ENABLE_AVX2) || defined(ENABLE_AVX512F)
 #ifdef _MSC_VER
 // MSVC 64bit is unable to use inline asm
 #include <intrin.h>
@@ -262,3 +262,113 @@ void scrypt_1024_1_1_256(const char *input, char *output)
     memset(scratchpad, 0, sizeof(scratchpad));
     scrypt_1024_1_1_256_sp(input, output, scratchpad);
 }
+
+// By default, hash one input at a time. This will prevent crash in case when scrypt_detect_multi() wasn't called
+static void (*scrypt_1024_1_1_256_sp_multi_detected)(const char *input, char *output, char *scratchpad) = NULL;
+static int scrypt_multi_lanes = 1;
+
+#if defined(ENABLE_AVX2) || defined(ENABLE_AVX512F)
+// Whether the OS saves the register state in mask (bits of XCR0) on context switches
+static bool scrypt_os_saves_state(uint32_t mask)
+{
+#if defined(_MSC_VER)
+    uint32_t a = (uint32_t)_xgetbv(0);
+#else
+    uint32_t a, d;
+    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+#endif
+    return (a & mask) == mask;
+}
+#endif
+
+int scrypt_detect_multi(int max_lanes)
+{
+    void (*detected)(const char *input, char *output, char *scratchpad) = NULL;
+    int lanes = 1;
+
+#if defined(ENABLE_AVX2) || defined(ENABLE_AVX512F)
+    bool fAVX = false;
+    unsigned int cpuid7_ebx = 0;
+#if defined(_MSC_VER)
+    int x86cpuid[4];
+    __cpuid(x86cpuid, 0);
+    const unsigned int max_leaf = (unsigned int)x86cpuid[0];
+    __cpuid(x86cpuid, 1);
+    const unsigned int cpuid1_ecx = (unsigned int)x86cpuid[2];
+#else
+    unsigned int eax, ebx, ecx, edx;
+    const unsigned int max_leaf = __get_cpuid_max(0, NULL);
+    const unsigned int cpuid1_ecx = __get_cpuid(1, &eax, &ebx, &ecx, &edx) ? ecx : 0;
+#endif
+    // AVX needs the OS to enable XSAVE and save the XMM and YMM registers
+    if ((cpuid1_ecx & 1<<27) && (cpuid1_ecx & 1<<28))
+        fAVX = scrypt_os_saves_state(0x06);
+    if (fAVX && max_leaf >= 7) {
+#if defined(_MSC_VER)
+        __cpuidex(x86cpuid, 7, 0);
+        cpuid7_ebx = (unsigned int)x86cpuid[1];
+#else
+        __cpuid_count(7, 0, eax, cpuid7_ebx, ecx, edx);
+#endif
+    }
+#endif
+
+#if defined(ENABLE_AVX512F)
+    // AVX-512F, and the opmask and ZMM registers saved
+    if (detected == NULL && max_lanes >= 16 && fAVX && (cpuid7_ebx & 1<<16) && scrypt_os_saves_state(0xe6))
+    {
+        detected = &scrypt_1024_1_1_256_sp_avx512_16way;
+        lanes = 16;
+    }
+#endif
+#if defined(ENABLE_AVX2)
+    if (detected == NULL && max_lanes >= 8 && fAVX && (cpuid7_ebx & 1<<5))
+    {
+        detected = &scrypt_1024_1_1_256_sp_avx2_8way;
+        lanes = 8;
+    }
+#endif
+#if defined(USE_SSE2)
+    if (detected == NULL && max_lanes >= 4 && scrypt_detect_sse2())
+    {
+        detected = &scrypt_1024_1_1_256_sp_sse2_4way;
+        lanes = 4;
+    }
+#endif
+
+    scrypt_1024_1_1_256_sp_multi_detected = detected;
+    scrypt_multi_lanes = lanes;
+    return lanes;
+}
+
+void scrypt_1024_1_1_256_multi(const char *input, char *output, size_t count)
+{
+    void (*kernel)(const char *input, char *output, char *scratchpad) = scrypt_1024_1_1_256_sp_multi_detected;
+    const size_t lanes = scrypt_multi_lanes;
+    size_t i = 0;
+
+    if (kernel != NULL && count > 1) {
+        char *scratchpad = (char *)malloc(lanes * 131072 + 63);
+        if (scratchpad != NULL) {
+            for (; i + lanes <= count; i += lanes)
+                kernel(input + 80 * i, output + 32 * i, scratchpad);
+
+            // Run a last partial group through the kernel too when it fills
+            // at least half of the lanes, the others hashing copies of its
+            // last input; a smaller one is quicker one at a time
+            if ((count - i) * 2 >= lanes) {
+                char in[SCRYPT_MAX_LANES * 80];
+                char out[SCRYPT_MAX_LANES * 32];
+                for (size_t l = 0; l < lanes; l++)
+                    memcpy(&in[80 * l], input + 80 * (i + l < count ? i + l : count - 1), 80);
+                kernel(in, out, scratchpad);
+                memcpy(output + 32 * i, out, 32 * (count - i));
+                i = count;
+            }
+            free(scratchpad);
+        }
+    }
+
+    for (; i < count; i++)
+        scrypt_1024_1_1_256(input + 80 * i, output + 32 * i);
+}
@@ -14,9 +14,35 @@
 
 static const int SCRYPT_SCRATCHPAD_SIZE = 131072 + 63;
 
+/** Most inputs hashed at once by a lane-parallel kernel, and its scratchpad size */
+static const int SCRYPT_MAX_LANES = 16;
+static const int SCRYPT_MULTI_SCRATCHPAD_SIZE = SCRYPT_MAX_LANES * 131072 + 63;
+
 void scrypt_1024_1_1_256(const char *input, char *output);
 void scrypt_1024_1_1_256_sp_generic(const char *input, char *output, char *scratchpad);
 
+/**
+ * Hash count 80 byte inputs that follow each other in input to count 32 byte
+ * hashes in output, as many calls to scrypt_1024_1_1_256 would. The inputs
+ * go through the lane-parallel kernel chosen by scrypt_detect_multi, as
+ * many at once as it has lanes.
+ */
+void scrypt_1024_1_1_256_multi(const char *input, char *output, size_t count);
+
+/**
+ * Choose the widest lane-parallel kernel the CPU supports with at most
+ * max_lanes lanes: AVX-512F (16), AVX2 (8) or SSE2 (4), when built with
+ * them. Returns its number of lanes, 1 if inputs are hashed one at a time.
+ */
+int scrypt_detect_multi(int max_lanes = SCRYPT_MAX_LANES);
+
+#if defined(ENABLE_AVX2)
+void scrypt_1024_1_1_256_sp_avx2_8way(const char *input, char *output, char *scratchpad);
+#endif
+#if defined(ENABLE_AVX512F)
+void scrypt_1024_1_1_256_sp_avx512_16way(const char *input, char *output, char *scratchpad);
+#endif
+
 #if defined(USE_SSE2)
 #if defined(_M_X64) || defined(__x86_64__) || defined(_M_AMD64) || (defined(MAC_OSX) && defined(__i386__))
 #define USE_SSE2_ALWAYS 1
@@ -27,6 +53,7 @@ void scrypt_1024_1_1_256_sp_generic(const char *input, char *output, char *scrat
 
 bool scrypt_detect_sse2();
 void scrypt_1024_1_1_256_sp_sse2(const char *input, char *output, char *scratchpad);
+void scrypt_1024_1_1_256_sp_sse2_4way(const char *input, char *output, char *scratchpad);
 extern void (*scrypt_1024_1_1_256_sp_detected)(const char *input, char *output, char *scratchpad);
 #else
 #define scrypt_1024_1_1_256_sp(input, output, scratchpad) scrypt_1024_1_1_256_sp_generic((input), (output), (scratchpad))
@@ -61,6 +61,11 @@ public:
      */
     CDBBatch(const CDBWrapper &_parent) : parent(_parent), ssKey(SER_DISK, CLIENT_VERSION), ssValue(SER_DISK, CLIENT_VERSION) { };
 
+    void Clear()
+    {
+        batch.Clear();
+    }
+
     template <typename K, typename V>
     void Write(const K& key, const V& value)
     {
@@ -88,6 +93,9 @@ public:
         batch.Delete(slKey);
         ssKey.clear();
     }
+
+    //! The approximate size in bytes of the changes queued so far
+    size_t SizeEstimate() const { return batch.ApproximateSize(); }
 };
 
 class CDBIterator
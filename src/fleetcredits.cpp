@@ -12,10 +12,12 @@
 
 #include "policy/policy.h"
 #include "arith_uint256.h"
+#include "blockmarkers.h"
 #include "fleetcredits.h"
 #include "txmempool.h"
 #include "util.h"
 #include "fleetcredits-fees.h"
+#include "oracles.h"
 #include "primitives/contribution.h"
 #include "primitives/block.h"
 #include "primitives/mweb.h"
@@ -98,6 +100,11 @@ unsigned int CalculateFleetCreditsNextWorkRequired(const CBlockIndex* pindexLast
 }
 
 bool CheckAuxPowProofOfWork(const CBlockHeader& block, const Consensus::Params& params)
+{
+    return CheckAuxPowProofOfWork(block, block.auxpow ? block.auxpow->getParentBlockPoWHash() : block.GetPoWHash(), params);
+}
+
+bool CheckAuxPowProofOfWork(const CBlockHeader& block, const uint256& hashPoW, const Consensus::Params& params)
 {
     /* Except for legacy blocks with full version 1, ensure that
        the chain ID is correct.  Legacy blocks are not allowed since
@@ -115,7 +122,7 @@ bool CheckAuxPowProofOfWork(const CBlockHeader& block, const Consensus::Params&
             return error("%s : no auxpow on block with auxpow version",
                          __func__);
 
-        if (!CheckProofOfWork(block.GetPoWHash(), block.nBits, params))
+        if (!CheckProofOfWork(hashPoW, block.nBits, params))
             return error("%s : non-AUX proof of work failed", __func__);
 
         return true;
@@ -126,7 +133,7 @@ bool CheckAuxPowProofOfWork(const CBlockHeader& block, const Consensus::Params&
     if (!block.IsAuxpow())
         return error("%s : auxpow on block with non-auxpow version", __func__);
 
-    if (!CheckProofOfWork(block.auxpow->getParentBlockPoWHash(), block.nBits, params))
+    if (!CheckProofOfWork(hashPoW, block.nBits, params))
         return error("%s : AUX proof of work failed", __func__);
 
     // CAuxPow::check is only available when auxpow.cpp is linked (server builds)
@@ -147,7 +154,7 @@ CAmount GetFleetCreditsBlockSubsidy(int nHeight, const Consensus::Params& consen
 }
 
 /** Get block subsidy with contribution bonuses applied */
-CAmount GetFleetCreditsBlockSubsidyWithContributions(int nHeight, const Consensus::Params& consensusParams, uint256 prevHash, const std::vector<CContributionTransaction>& contrib_txs)
+CAmount GetFleetCreditsBlockSubsidyWithContributions(int nHeight, const Consensus::Params& consensusParams, uint256 prevHash, const std::vector<CContributionTransaction>& contrib_txs, const COracleView* oracles)
 {
     // Get base reward
     CAmount baseReward = GetFleetCreditsBlockSubsidy(nHeight, consensusParams, prevHash);
@@ -157,9 +164,27 @@ CAmount GetFleetCreditsBlockSubsidyWithContributions(int nHeight, const Consensu
         return baseReward;
     }
     
+    // Apply tier payout mapping
+    const CContributionTransaction* best = GetBestBonusContribution(contrib_txs, nHeight, consensusParams, oracles);
+    if (best != NULL) {
+        CAmount tierReward = GetContributionTierPayout(best->bonus_level, best->contrib_type);
+        if (tierReward > baseReward) {
+            return tierReward;
+        }
+    }
+    
+    return baseReward;
+}
+
+const CContributionTransaction* GetBestBonusContribution(const std::vector<CContributionTransaction>& contrib_txs, int nHeight, const Consensus::Params& consensusParams, const COracleView* oracles)
+{
+    // Before this height a contribution earned its bonus whether or not its
+    // proof had been claimed already
+    if (nHeight < consensusParams.ContributionClaimHeight)
+        oracles = NULL;
+
     // Find highest bonus level from verified contributions
-    uint32_t maxBonusLevel = BONUS_NONE;
-    ContributionType maxContribType = CODE_CONTRIBUTION;
+    const CContributionTransaction* best = NULL;
     
     for (const auto& contrib : contrib_txs) {
         // Verify contribution before considering it for bonus
@@ -170,8 +195,12 @@ CAmount GetFleetCreditsBlockSubsidyWithContributions(int nHeight, const Consensu
             continue;  // Skip invalid contributions
         }
         
-        // Create verification record to check status
-        CVerificationRecord record = CContributionVerifier::CreateVerificationRecord(contrib);
+        // Look up the verification record of its proof, which another
+        // contribution may have claimed already
+        VerificationStatus verification_status = GetContributionVerificationStatus(oracles, contrib);
+        if (verification_status == VERIFICATION_REJECTED) {
+            continue;
+        }
         
         // Verify based on contribution type
         // Note: The verification functions use placeholders for now (GitHub API, etc.)
@@ -205,18 +234,17 @@ CAmount GetFleetCreditsBlockSubsidyWithContributions(int nHeight, const Consensu
                 static_cast<CContributionTransaction&>(review_tx) = contrib;
                 is_verified = CContributionVerifier::VerifyEthicalReview(review_tx);
                 // Ethical reviews require oracle consensus - check if we have it
-                if (is_verified && record.verification_status == VERIFICATION_PENDING) {
+                if (is_verified && verification_status == VERIFICATION_PENDING) {
                     // Still pending oracle votes - don't count for bonus yet
                     is_verified = false;
                 }
                 break;
             }
             case CHARITABLE_ACT: {
-                // Charitable acts require oracle consensus
-                // For now, if it passed basic validation, we'll accept it
-                // In full implementation, oracle votes would be processed here
+                // Charitable acts require oracle consensus, which stays
+                // pending until oracle stake is bonded
                 is_verified = true;  // Basic validation already passed
-                if (record.verification_status == VERIFICATION_PENDING) {
+                if (verification_status == VERIFICATION_PENDING) {
                     // Still pending oracle votes - don't count for bonus yet
                     is_verified = false;
                 }
@@ -230,21 +258,12 @@ CAmount GetFleetCreditsBlockSubsidyWithContributions(int nHeight, const Consensu
         }
         
         // Only count verified contributions for bonus calculation
-        if (is_verified && contrib.bonus_level > maxBonusLevel) {
-            maxBonusLevel = contrib.bonus_level;
-            maxContribType = contrib.contrib_type;
+        if (is_verified && contrib.bonus_level > (best ? best->bonus_level : (uint32_t)BONUS_NONE)) {
+            best = &contrib;
         }
     }
     
-    // Apply tier payout mapping
-    if (maxBonusLevel > BONUS_NONE) {
-        CAmount tierReward = GetContributionTierPayout(maxBonusLevel, maxContribType);
-        if (tierReward > baseReward) {
-            return tierReward;
-        }
-    }
-    
-    return baseReward;
+    return best;
 }
 
 /** Extract contribution transactions from a block
@@ -254,74 +273,7 @@ CAmount GetFleetCreditsBlockSubsidyWithContributions(int nHeight, const Consensu
  */
 std::vector<CContributionTransaction> ExtractContributionsFromBlock(const CBlock& block)
 {
-    std::vector<CContributionTransaction> contributions;
-    
-    // Contribution marker: 0xFC 0x01 (Fleet Credits Contribution)
-    const unsigned char CONTRIB_MARKER[] = {0xFC, 0x01};
-    const size_t MARKER_SIZE = 2;
-    
-    // Scan all transactions in the block (skip coinbase)
-    for (size_t i = 1; i < block.vtx.size(); i++) {
-        const CTransaction& tx = *block.vtx[i];
-        
-        // Check each output for OP_RETURN with contribution marker
-        for (const auto& txout : tx.vout) {
-            const CScript& script = txout.scriptPubKey;
-            
-            // Check if this is an OP_RETURN output
-            if (script.size() > 0 && script[0] == OP_RETURN) {
-                // OP_RETURN outputs have format: OP_RETURN <data>
-                // Check if it starts with our contribution marker
-                if (script.size() >= MARKER_SIZE + 1) {
-                    // Skip OP_RETURN byte (index 0), check marker
-                    bool matches_marker = true;
-                    for (size_t j = 0; j < MARKER_SIZE; j++) {
-                        if (script[j + 1] != CONTRIB_MARKER[j]) {
-                            matches_marker = false;
-                            break;
-                        }
-                    }
-                    
-                    if (matches_marker) {
-                        // Extract contribution data (everything after marker)
-                        std::vector<unsigned char> contrib_data(
-                            script.begin() + 1 + MARKER_SIZE,
-                            script.end()
-                        );
-                        
-                        // Try to deserialize contribution transaction
-                        try {
-                            CContributionTransaction contrib_tx;
-                            CDataStream ss(contrib_data, SER_NETWORK, PROTOCOL_VERSION);
-                            ss >> contrib_tx;
-                            
-                            // Validate basic structure
-                            if (ValidateContributionTransaction(contrib_tx)) {
-                                // Set transaction ID from the actual transaction
-                                contrib_tx.tx_id = tx.GetHash();
-                                
-                                // Check if this contribution requires MWEB
-                                // If so, it should be in the MWEB extension block, not main chain
-                                if (contrib_tx.RequiresMWEB()) {
-                                    // MWEB-required contributions are extracted from MWEB extension blocks
-                                    // via ExtractContributionsFromMWEB() during block validation.
-                                    // Skip extraction from main chain to avoid duplicates.
-                                    continue;
-                                }
-                                
-                                contributions.push_back(contrib_tx);
-                            }
-                        } catch (const std::exception& e) {
-                            // Invalid contribution data, skip
-                            // Log error in production: LogPrintf("Failed to parse contribution: %s\n", e.what());
-                        }
-                    }
-                }
-            }
-        }
-    }
-    
-    return contributions;
+    return GetBlockMarkers(block)->contributions;
 }
 
 
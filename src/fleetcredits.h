@@ -2,6 +2,9 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#ifndef FLEETCREDITS_FLEETCREDITS_H
+#define FLEETCREDITS_FLEETCREDITS_H
+
 #include "amount.h"
 #include "chain.h"
 #include "chainparams.h"
@@ -10,6 +13,7 @@
 
 // Forward declarations
 class CMWEBExtensionBlock;
+class COracleView;
 
 /** Extract contributions from MWEB extension block */
 std::vector<CContributionTransaction> ExtractContributionsFromMWEB(const CMWEBExtensionBlock& mweb_block);
@@ -21,7 +25,13 @@ bool RouteToMWEB(const CContributionTransaction& contrib_tx, CMWEBTransaction& m
 
 bool AllowDigishieldMinDifficultyForBlock(const CBlockIndex* pindexLast, const CBlockHeader *pblock, const Consensus::Params& params);
 CAmount GetFleetCreditsBlockSubsidy(int nHeight, const Consensus::Params& consensusParams, uint256 prevHash);
-CAmount GetFleetCreditsBlockSubsidyWithContributions(int nHeight, const Consensus::Params& consensusParams, uint256 prevHash, const std::vector<CContributionTransaction>& contrib_txs);
+/** Block subsidy with contribution bonuses, for contributions verified in the oracle state
+ *  of oracles (NULL: as new verification records would be, see CreateVerificationRecord).
+ *  The proofs claimed in oracles only count from consensusParams.ContributionClaimHeight. */
+CAmount GetFleetCreditsBlockSubsidyWithContributions(int nHeight, const Consensus::Params& consensusParams, uint256 prevHash, const std::vector<CContributionTransaction>& contrib_txs, const COracleView* oracles = NULL);
+/** The verified contribution of contrib_txs with the highest bonus level, the first of them
+ *  on a tie, which alone decides the bonus; NULL if none is verified */
+const CContributionTransaction* GetBestBonusContribution(const std::vector<CContributionTransaction>& contrib_txs, int nHeight, const Consensus::Params& consensusParams, const COracleView* oracles = NULL);
 std::vector<CContributionTransaction> ExtractContributionsFromBlock(const CBlock& block);
 unsigned int CalculateFleetCreditsNextWorkRequired(const CBlockIndex* pindexLast, int64_t nLastRetargetTime, const Consensus::Params& params);
 
@@ -33,4 +43,10 @@ unsigned int CalculateFleetCreditsNextWorkRequired(const CBlockIndex* pindexLast
  */
 bool CheckAuxPowProofOfWork(const CBlockHeader& block, const Consensus::Params& params);
 
+/**
+ * Same, with the scrypt hash of the block, or of its auxpow parent block if
+ * it has one, already computed as hashPoW (e.g. for a batch of headers).
+ */
+bool CheckAuxPowProofOfWork(const CBlockHeader& block, const uint256& hashPoW, const Consensus::Params& params);
 
+#endif // FLEETCREDITS_FLEETCREDITS_H
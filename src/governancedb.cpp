@@ -0,0 +1,342 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "governancedb.h"
+
+#include "blockmarkers.h"
+#include "chain.h"
+#include "chainparams.h"
+#include "init.h"
+#include "primitives/block.h"
+#include "util.h"
+#include "validation.h"
+
+#include <set>
+
+static const char DB_PROPOSAL = 'p';
+static const char DB_TALLY = 't';
+static const char DB_VOTE = 'v';
+static const char DB_UNDO = 'u';
+static const char DB_BEST_BLOCK = 'B';
+
+CGovernanceDB* pgovernancedb = NULL;
+
+namespace {
+
+typedef std::pair<char, std::pair<uint256, uint256> > VoteKey;
+
+VoteKey MakeVoteKey(const uint256& proposal_id, const uint256& vote_id)
+{
+    return std::make_pair(DB_VOTE, std::make_pair(proposal_id, vote_id));
+}
+
+} // anon namespace
+
+void CGovernanceTally::AddVote(const CGovernanceVote& vote)
+{
+    if (vote.choice == VOTE_YES) {
+        yes_power += vote.voting_power;
+        yes_votes++;
+    } else if (vote.choice == VOTE_NO) {
+        no_power += vote.voting_power;
+        no_votes++;
+    } else {
+        abstain_power += vote.voting_power;
+        abstain_votes++;
+    }
+}
+
+void CGovernanceTally::RemoveVote(const CGovernanceVote& vote)
+{
+    if (vote.choice == VOTE_YES) {
+        yes_power -= vote.voting_power;
+        yes_votes--;
+    } else if (vote.choice == VOTE_NO) {
+        no_power -= vote.voting_power;
+        no_votes--;
+    } else {
+        abstain_power -= vote.voting_power;
+        abstain_votes--;
+    }
+}
+
+ProposalStatus CGovernanceProposalEntry::GetStatus(int64_t nTime, CAmount nNetworkStake) const
+{
+    if (proposal.status != PROPOSAL_APPROVED)
+        return proposal.status;
+    if (proposal.execution_time > 0 && nTime < (int64_t)proposal.execution_time)
+        return proposal.status;
+    if (nTime < (int64_t)proposal.voting_end_time)
+        return proposal.status;
+
+    CAmount total_power = tally.GetTotalPower();
+    double participation = (double)total_power / (double)nNetworkStake * 100.0;
+    if (total_power <= 0 || participation < proposal.quorum_percentage)
+        return PROPOSAL_EXPIRED;
+    double approval = (double)tally.yes_power / (double)total_power * 100.0;
+    if (approval < proposal.approval_percentage)
+        return PROPOSAL_REJECTED;
+    return PROPOSAL_EXECUTED;
+}
+
+CGovernanceDB::CGovernanceDB(size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / "governance", nCacheSize, fMemory, fWipe), fSynced(false)
+{
+    if (!db.Read(DB_BEST_BLOCK, hashBestBlock))
+        hashBestBlock.SetNull();
+    if (!LoadProposals())
+        throw std::runtime_error("Error loading the governance database");
+}
+
+bool CGovernanceDB::LoadProposals()
+{
+    LOCK(cs);
+    std::unique_ptr<CDBIterator> pcursor(db.NewIterator());
+    pcursor->Seek(std::make_pair(DB_PROPOSAL, uint256()));
+    for (; pcursor->Valid(); pcursor->Next()) {
+        std::pair<char, uint256> key;
+        if (!pcursor->GetKey(key) || key.first != DB_PROPOSAL)
+            break;
+        CGovernanceProposalEntry entry;
+        if (!pcursor->GetValue(entry))
+            return error("%s: failed to read proposal %s", __func__, key.second.ToString());
+        if (!db.Read(std::make_pair(DB_TALLY, key.second), entry.tally))
+            return error("%s: tally of proposal %s missing", __func__, key.second.ToString());
+        mapProposals[key.second] = entry;
+    }
+    LogPrintf("Loaded %u governance proposals\n", mapProposals.size());
+    return true;
+}
+
+uint256 CGovernanceDB::GetBestBlock() const
+{
+    LOCK(cs);
+    return hashBestBlock;
+}
+
+bool CGovernanceDB::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    LOCK(cs);
+    std::shared_ptr<const CBlockMarkers> markers = GetBlockMarkers(block);
+    CDBBatch batch(db);
+    CGovernanceBlockUndo undo;
+    std::map<uint256, CGovernanceProposalEntry> mapAdded;
+    std::map<uint256, CGovernanceTally> mapTallies;
+
+    for (const auto& item : markers->proposals) {
+        const CGovernanceProposal& proposal = item.second;
+        if (!ValidateGovernanceProposal(proposal) || mapProposals.count(proposal.proposal_id) || mapAdded.count(proposal.proposal_id))
+            continue;
+        CGovernanceProposalEntry& entry = mapAdded[proposal.proposal_id];
+        entry.proposal = proposal;
+        entry.txid = item.first;
+        entry.nHeight = pindex->nHeight;
+        batch.Write(std::make_pair(DB_PROPOSAL, proposal.proposal_id), entry);
+        mapTallies[proposal.proposal_id] = CGovernanceTally();
+        undo.vProposals.push_back(proposal.proposal_id);
+    }
+
+    std::set<uint256> setVotes;
+    for (const auto& item : markers->votes) {
+        const CGovernanceVote& vote = item.second;
+        if (!ValidateGovernanceVote(vote))
+            continue;
+        std::map<uint256, CGovernanceTally>::iterator it = mapTallies.find(vote.proposal_id);
+        if (it == mapTallies.end()) {
+            std::map<uint256, CGovernanceProposalEntry>::const_iterator mi = mapProposals.find(vote.proposal_id);
+            if (mi == mapProposals.end())
+                continue;
+            it = mapTallies.insert(std::make_pair(vote.proposal_id, mi->second.tally)).first;
+        }
+        VoteKey key = MakeVoteKey(vote.proposal_id, vote.vote_id);
+        if (setVotes.count(vote.vote_id) || db.Exists(key))
+            continue;
+        setVotes.insert(vote.vote_id);
+        batch.Write(key, vote);
+        it->second.AddVote(vote);
+        undo.vVotes.push_back(std::make_pair(vote.proposal_id, vote.vote_id));
+    }
+
+    for (const auto& item : mapTallies)
+        batch.Write(std::make_pair(DB_TALLY, item.first), item.second);
+    if (!undo.IsEmpty())
+        batch.Write(std::make_pair(DB_UNDO, pindex->GetBlockHash()), undo);
+    batch.Write(DB_BEST_BLOCK, pindex->GetBlockHash());
+    if (!db.WriteBatch(batch))
+        return false;
+
+    mapProposals.insert(mapAdded.begin(), mapAdded.end());
+    for (const auto& item : mapTallies)
+        mapProposals[item.first].tally = item.second;
+    hashBestBlock = pindex->GetBlockHash();
+    return true;
+}
+
+bool CGovernanceDB::EraseBlock(const CBlockIndex* pindex)
+{
+    LOCK(cs);
+    CDBBatch batch(db);
+    std::map<uint256, CGovernanceTally> mapTallies;
+
+    // Blocks without an undo record added nothing
+    CGovernanceBlockUndo undo;
+    if (db.Read(std::make_pair(DB_UNDO, pindex->GetBlockHash()), undo)) {
+        for (std::vector<std::pair<uint256, uint256> >::reverse_iterator it = undo.vVotes.rbegin(); it != undo.vVotes.rend(); ++it) {
+            VoteKey key = MakeVoteKey(it->first, it->second);
+            CGovernanceVote vote;
+            if (!db.Read(key, vote))
+                return error("%s: vote %s missing from the governance database", __func__, it->second.ToString());
+            std::map<uint256, CGovernanceTally>::iterator mi = mapTallies.find(it->first);
+            if (mi == mapTallies.end()) {
+                std::map<uint256, CGovernanceProposalEntry>::const_iterator pi = mapProposals.find(it->first);
+                if (pi == mapProposals.end())
+                    return error("%s: proposal %s missing from the governance database", __func__, it->first.ToString());
+                mi = mapTallies.insert(std::make_pair(it->first, pi->second.tally)).first;
+            }
+            mi->second.RemoveVote(vote);
+            batch.Erase(key);
+        }
+        for (const uint256& proposal_id : undo.vProposals) {
+            batch.Erase(std::make_pair(DB_PROPOSAL, proposal_id));
+            batch.Erase(std::make_pair(DB_TALLY, proposal_id));
+            mapTallies.erase(proposal_id);
+        }
+        batch.Erase(std::make_pair(DB_UNDO, pindex->GetBlockHash()));
+    }
+
+    for (const auto& item : mapTallies)
+        batch.Write(std::make_pair(DB_TALLY, item.first), item.second);
+    uint256 hashPrev = pindex->pprev ? pindex->pprev->GetBlockHash() : uint256();
+    batch.Write(DB_BEST_BLOCK, hashPrev);
+    if (!db.WriteBatch(batch))
+        return false;
+
+    for (const uint256& proposal_id : undo.vProposals)
+        mapProposals.erase(proposal_id);
+    for (const auto& item : mapTallies)
+        mapProposals[item.first].tally = item.second;
+    hashBestBlock = hashPrev;
+    return true;
+}
+
+bool CGovernanceDB::Sync(const CChainParams& chainparams)
+{
+    const CBlockIndex* pindex = NULL;
+    uint256 hashBest = GetBestBlock();
+    if (!hashBest.IsNull()) {
+        LOCK(cs_main);
+        BlockMap::iterator mi = mapBlockIndex.find(hashBest);
+        if (mi == mapBlockIndex.end())
+            return error("%s: best block %s of the governance database is unknown", __func__, hashBest.ToString());
+        pindex = mi->second;
+    }
+
+    bool fLogged = false;
+    while (true) {
+        if (ShutdownRequested())
+            return true;
+
+        // Pick the next block to undo or apply; block index entries stay
+        // valid once cs_main is released
+        const CBlockIndex* pindexNext;
+        {
+            LOCK(cs_main);
+            if (pindex && !chainActive.Contains(pindex)) {
+                pindexNext = NULL;
+            } else {
+                pindexNext = pindex ? chainActive.Next(pindex) : chainActive.Genesis();
+                if (!pindexNext) {
+                    // Caught up; from here on the notifications, which are
+                    // sent with cs_main held, keep the store current
+                    fSynced = true;
+                    return true;
+                }
+                if (!fLogged) {
+                    LogPrintf("Adding blocks %d to %d to the governance database\n", pindexNext->nHeight, chainActive.Height());
+                    fLogged = true;
+                }
+            }
+        }
+
+        if (!pindexNext) {
+            // Undo blocks that were disconnected while the store was not following the chain
+            if (!EraseBlock(pindex))
+                return error("%s: failed to write to the governance database", __func__);
+            pindex = pindex->pprev;
+            continue;
+        }
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindexNext, chainparams.GetConsensus(pindexNext->nHeight)))
+            return error("%s: failed to read block %s", __func__, pindexNext->GetBlockHash().ToString());
+        if (!WriteBlock(block, pindexNext))
+            return error("%s: failed to write to the governance database", __func__);
+        pindex = pindexNext;
+    }
+}
+
+bool CGovernanceDB::GetProposal(const uint256& proposal_id, CGovernanceProposalEntry& entry) const
+{
+    LOCK(cs);
+    std::map<uint256, CGovernanceProposalEntry>::const_iterator it = mapProposals.find(proposal_id);
+    if (it == mapProposals.end())
+        return false;
+    entry = it->second;
+    return true;
+}
+
+std::vector<CGovernanceProposalEntry> CGovernanceDB::GetProposals() const
+{
+    LOCK(cs);
+    std::vector<CGovernanceProposalEntry> vEntries;
+    vEntries.reserve(mapProposals.size());
+    for (const auto& item : mapProposals)
+        vEntries.push_back(item.second);
+    return vEntries;
+}
+
+bool CGovernanceDB::GetVotes(const uint256& proposal_id, std::vector<CGovernanceVote>& vVotes)
+{
+    std::unique_ptr<CDBIterator> pcursor(db.NewIterator());
+    pcursor->Seek(MakeVoteKey(proposal_id, uint256()));
+    for (; pcursor->Valid(); pcursor->Next()) {
+        VoteKey key;
+        if (!pcursor->GetKey(key) || key.first != DB_VOTE || key.second.first != proposal_id)
+            break;
+        CGovernanceVote vote;
+        if (!pcursor->GetValue(vote))
+            return error("%s: failed to read vote %s", __func__, key.second.second.ToString());
+        vVotes.push_back(vote);
+    }
+    return true;
+}
+
+void CGovernanceDB::BlockConnected(const CBlock& block, const CBlockIndex* pindex)
+{
+    if (!fSynced)
+        return;
+    uint256 hashPrev = pindex->pprev ? pindex->pprev->GetBlockHash() : uint256();
+    if (hashPrev != GetBestBlock()) {
+        LogPrintf("%s: governance database is not at the parent of block %s, no longer updating it\n", __func__, pindex->GetBlockHash().ToString());
+        fSynced = false;
+        return;
+    }
+    if (!WriteBlock(block, pindex)) {
+        LogPrintf("%s: failed to add block %s to the governance database, no longer updating it\n", __func__, pindex->GetBlockHash().ToString());
+        fSynced = false;
+    }
+}
+
+void CGovernanceDB::BlockDisconnected(const CBlock& block, const CBlockIndex* pindex)
+{
+    if (!fSynced)
+        return;
+    if (pindex->GetBlockHash() != GetBestBlock()) {
+        LogPrintf("%s: governance database is not at block %s, no longer updating it\n", __func__, pindex->GetBlockHash().ToString());
+        fSynced = false;
+        return;
+    }
+    if (!EraseBlock(pindex)) {
+        LogPrintf("%s: failed to remove block %s from the governance database, no longer updating it\n", __func__, pindex->GetBlockHash().ToString());
+        fSynced = false;
+    }
+}
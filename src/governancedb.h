@@ -0,0 +1,172 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef FLEETCREDITS_GOVERNANCEDB_H
+#define FLEETCREDITS_GOVERNANCEDB_H
+
+#include "amount.h"
+#include "dbwrapper.h"
+#include "primitives/governance.h"
+#include "serialize.h"
+#include "sync.h"
+#include "uint256.h"
+#include "validationinterface.h"
+
+#include <atomic>
+#include <map>
+#include <utility>
+#include <vector>
+
+class CBlock;
+class CBlockIndex;
+class CChainParams;
+
+//! max. -dbcache (MiB) to use for the governance database
+static const int64_t nMaxGovernanceCache = 16;
+
+/** Running totals of the votes cast on a proposal */
+class CGovernanceTally
+{
+public:
+    CAmount yes_power;
+    CAmount no_power;
+    CAmount abstain_power;
+    int yes_votes;
+    int no_votes;
+    int abstain_votes;
+
+    CGovernanceTally() : yes_power(0), no_power(0), abstain_power(0), yes_votes(0), no_votes(0), abstain_votes(0) {}
+
+    ADD_SERIALIZE_METHODS;
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(yes_power);
+        READWRITE(no_power);
+        READWRITE(abstain_power);
+        READWRITE(VARINT(yes_votes));
+        READWRITE(VARINT(no_votes));
+        READWRITE(VARINT(abstain_votes));
+    }
+
+    void AddVote(const CGovernanceVote& vote);
+    void RemoveVote(const CGovernanceVote& vote);
+    CAmount GetTotalPower() const { return yes_power + no_power + abstain_power; }
+};
+
+/** A proposal mined in the active chain, as kept by the governance store */
+class CGovernanceProposalEntry
+{
+public:
+    CGovernanceProposal proposal;
+    uint256 txid;
+    int nHeight;
+    CGovernanceTally tally;  //!< Stored separately, under its own key
+
+    CGovernanceProposalEntry() : nHeight(0) {}
+
+    /**
+     * Status of the proposal at nTime. An approved proposal whose voting
+     * and execution times have passed is decided by its tally: expired below
+     * quorum of nNetworkStake, rejected below the approval threshold and
+     * executed otherwise. The outcome is derived rather than stored, so it
+     * follows the tally as blocks connect and disconnect.
+     */
+    ProposalStatus GetStatus(int64_t nTime, CAmount nNetworkStake) const;
+
+    ADD_SERIALIZE_METHODS;
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(proposal);
+        READWRITE(txid);
+        READWRITE(VARINT(nHeight));
+    }
+};
+
+/** What a block added to the governance store, to take it out again on disconnect */
+class CGovernanceBlockUndo
+{
+public:
+    std::vector<uint256> vProposals;
+    //! (proposal id, vote id) of the votes counted, in block order
+    std::vector<std::pair<uint256, uint256> > vVotes;
+
+    ADD_SERIALIZE_METHODS;
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(vProposals);
+        READWRITE(vVotes);
+    }
+
+    bool IsEmpty() const { return vProposals.empty() && vVotes.empty(); }
+};
+
+/**
+ * Governance proposals and votes of the active chain (governance/).
+ *
+ * On disk it keeps each proposal, its running tally, every vote counted
+ * (keyed by proposal so the votes on a proposal are one range scan) and,
+ * per block, an undo record of what the block added. Votes update the
+ * tally of their proposal as blocks connect and are taken out again from
+ * the undo record when blocks disconnect, so tallies are never recounted.
+ * Proposals and tallies are loaded into memory at startup.
+ *
+ * It follows the chain through the BlockConnected and BlockDisconnected
+ * notifications. Only the first proposal and vote marker of a transaction
+ * count; a vote counts once, on a proposal already known.
+ */
+class CGovernanceDB : public CValidationInterface
+{
+private:
+    CDBWrapper db;
+    mutable CCriticalSection cs;
+    uint256 hashBestBlock;
+    std::map<uint256, CGovernanceProposalEntry> mapProposals;
+    std::atomic<bool> fSynced; //!< Following chainActive, see IsSynced
+
+    bool LoadProposals();
+
+public:
+    CGovernanceDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
+    virtual ~CGovernanceDB() {}
+
+    /** Hash of the last block applied to the store */
+    uint256 GetBestBlock() const;
+
+    /** Apply the proposals and votes of a block, which becomes the best block */
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex);
+
+    /** Undo what the best block added, its parent becomes the best block */
+    bool EraseBlock(const CBlockIndex* pindex);
+
+    /**
+     * Whether the store has caught up with chainActive and follows it. This
+     * turns false for good when a block cannot be applied, so that callers
+     * report an error rather than serve stale proposals.
+     */
+    bool IsSynced() const { return fSynced; }
+
+    /**
+     * Bring the store in line with chainActive, undoing blocks that were
+     * disconnected and applying the ones connected while it was not
+     * running. As CContributionIndex::Sync, cs_main is only taken to step
+     * through the chain, so the store must be registered for the block
+     * notifications before this is called.
+     */
+    bool Sync(const CChainParams& chainparams);
+
+    bool GetProposal(const uint256& proposal_id, CGovernanceProposalEntry& entry) const;
+    std::vector<CGovernanceProposalEntry> GetProposals() const;
+
+    /** The votes counted on a proposal, in vote id order */
+    bool GetVotes(const uint256& proposal_id, std::vector<CGovernanceVote>& vVotes);
+
+protected:
+    void BlockConnected(const CBlock& block, const CBlockIndex* pindex);
+    void BlockDisconnected(const CBlock& block, const CBlockIndex* pindex);
+};
+
+/** The governance store */
+extern CGovernanceDB* pgovernancedb;
+
+#endif // FLEETCREDITS_GOVERNANCEDB_H
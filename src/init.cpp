@@ -21,13 +21,17 @@
 #include "checkpoints.h"
 #include "compat/sanity.h"
 #include "consensus/validation.h"
-#include "crypto/scrypt.h" // for scrypt_detect_sse2
+#include "contributionindex.h"
+#include "crypto/scrypt.h" // for scrypt_detect_sse2 and scrypt_detect_multi
 #include "fs.h"
+#include "governancedb.h"
 #include "httpserver.h"
 #include "httprpc.h"
 #include "key.h"
 #include "validation.h"
 #include "miner.h"
+#include "mweb_mempool.h"
+#include "mweb_verifycache.h"
 #include "netbase.h"
 #include "net.h"
 #include "net_processing.h"
@@ -156,9 +160,9 @@ class CCoinsViewErrorCatcher : public CCoinsViewBacked
 {
 public:
     CCoinsViewErrorCatcher(CCoinsView* view) : CCoinsViewBacked(view) {}
-    bool GetCoins(const uint256 &txid, CCoins &coins) const {
+    bool GetCoin(const COutPoint &outpoint, Coin &coin) const {
         try {
-            return CCoinsViewBacked::GetCoins(txid, coins);
+            return CCoinsViewBacked::GetCoin(outpoint, coin);
         } catch(const std::runtime_error& e) {
             uiInterface.SafeThreadSafeMessageBox(_("Error reading from database, shutting down."), "", CClientUIInterface::MSG_ERROR);
             LogPrintf("Error reading from database: %s\n", e.what());
@@ -215,6 +219,12 @@ void Shutdown()
     MapPort(false);
     UnregisterValidationInterface(peerLogic.get());
     peerLogic.reset();
+    if (pcontributionindex) {
+        UnregisterValidationInterface(pcontributionindex);
+    }
+    if (pgovernancedb) {
+        UnregisterValidationInterface(pgovernancedb);
+    }
     g_connman.reset();
 
     StopTorControl();
@@ -238,6 +248,14 @@ void Shutdown()
         if (pcoinsTip != NULL) {
             FlushStateToDisk();
         }
+        delete poraclesTip;
+        poraclesTip = NULL;
+        delete poraclesdbview;
+        poraclesdbview = NULL;
+        delete pmwebcoinsTip;
+        pmwebcoinsTip = NULL;
+        delete pmwebcoinsdbview;
+        pmwebcoinsdbview = NULL;
         delete pcoinsTip;
         pcoinsTip = NULL;
         delete pcoinscatcher;
@@ -246,6 +264,10 @@ void Shutdown()
         pcoinsdbview = NULL;
         delete pblocktree;
         pblocktree = NULL;
+        delete pcontributionindex;
+        pcontributionindex = NULL;
+        delete pgovernancedb;
+        pgovernancedb = NULL;
     }
 #ifdef ENABLE_WALLET
     if (pwalletMain)
@@ -339,6 +361,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage +=HelpMessageOpt("-assumevalid=<hex>", strprintf(_("If this block is in the chain assume that it and its ancestors are valid and potentially skip their script verification (0 to verify all, default: %s, testnet: %s)"), Params(CBaseChainParams::MAIN).GetConsensus(0).defaultAssumeValid.GetHex(), Params(CBaseChainParams::TESTNET).GetConsensus(0).defaultAssumeValid.GetHex()));
     strUsage += HelpMessageOpt("-backupdir=<dir>", _("Specify directory where to write backups and data dumps (default datadir/backups)"));
     strUsage += HelpMessageOpt("-conf=<file>", strprintf(_("Specify configuration file (default: %s)"), FLEETCREDITS_CONF_FILENAME));
+    strUsage += HelpMessageOpt("-contributionindex", strprintf(_("Maintain an index of mined contributions, used by the listcontributions and getcontributionstatus rpc calls (default: %u)"), DEFAULT_CONTRIBUTIONINDEX));
     if (mode == HMM_FLEETCREDITSD)
     {
 #if HAVE_DECL_DAEMON
@@ -353,8 +376,10 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-maxorphantx=<n>", strprintf(_("Keep at most <n> unconnectable transactions in memory (default: %u)"), DEFAULT_MAX_ORPHAN_TRANSACTIONS));
     strUsage += HelpMessageOpt("-maxmempool=<n>", strprintf(_("Keep the transaction memory pool below <n> megabytes (default: %u)"), DEFAULT_MAX_MEMPOOL_SIZE));
     strUsage += HelpMessageOpt("-mempoolexpiry=<n>", strprintf(_("Do not keep transactions in the mempool longer than <n> hours (default: %u)"), DEFAULT_MEMPOOL_EXPIRY));
+    strUsage += HelpMessageOpt("-maxmwebmempool=<n>", strprintf(_("Keep the MWEB transaction memory pool below <n> megabytes (default: %u)"), DEFAULT_MAX_MWEB_MEMPOOL_SIZE));
     strUsage += HelpMessageOpt("-blockreconstructionextratxn=<n>", strprintf(_("Extra transactions to keep in memory for compact block reconstructions (default: %u)"), DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN));
-    strUsage += HelpMessageOpt("-par=<n>", strprintf(_("Set the number of script verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)"),
+    strUsage += HelpMessageOpt("-par=<n>", strprintf(_("Set the number of script verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d). "
+        "n-1 worker threads each are started for script, header proof of work and input prefetch checks, and half as many (at least one) for MWEB checks"),
         -GetNumCores(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS));
 #ifndef WIN32
     strUsage += HelpMessageOpt("-pid=<file>", strprintf(_("Specify pid file (default: %s)"), FLEETCREDITS_PID_FILENAME));
@@ -461,6 +486,7 @@ std::string HelpMessage(HelpMessageMode mode)
         strUsage += HelpMessageOpt("-limitfreerelay=<n>", strprintf("Continuously rate-limit free transactions to <n>*1000 bytes per minute (default: %u)", DEFAULT_LIMITFREERELAY));
         strUsage += HelpMessageOpt("-relaypriority", strprintf("Require high priority for relaying free or low-fee transactions (default: %u)", DEFAULT_RELAYPRIORITY));
         strUsage += HelpMessageOpt("-maxsigcachesize=<n>", strprintf("Limit size of signature cache to <n> MiB (default: %u)", DEFAULT_MAX_SIG_CACHE_SIZE));
+        strUsage += HelpMessageOpt("-maxmwebcachesize=<n>", strprintf("Limit size of the MWEB transaction verification cache to <n> MiB (default: %u)", DEFAULT_MAX_MWEB_CACHE_SIZE));
         strUsage += HelpMessageOpt("-maxtipage=<n>", strprintf("Maximum tip age in seconds to consider node in initial block download (default: %u)", DEFAULT_MAX_TIP_AGE));
     }
     strUsage += HelpMessageOpt("-minrelaytxfee=<amt>", strprintf(_("Fees (in %s/kB) smaller than this are considered zero fee for relaying, mining and transaction creation (default: %s)"),
@@ -495,6 +521,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-blockmintxfee=<amt>", strprintf(_("Set lowest fee rate (in %s/kB) for transactions to be included in block creation. (default: %s)"), CURRENCY_UNIT, FormatMoney(DEFAULT_BLOCK_MIN_TX_FEE)));
     if (showDebug)
         strUsage += HelpMessageOpt("-blockversion=<n>", "Override block version to test forking scenarios");
+    strUsage += HelpMessageOpt("-genproclimit=<n>", strprintf(_("Set the number of threads generate and generatetoaddress search nonces with (-1 = all cores, default: %d)"), DEFAULT_GENERATE_THREADS));
 
     strUsage += HelpMessageGroup(_("RPC server options:"));
     strUsage += HelpMessageOpt("-server", _("Accept command line and JSON-RPC commands"));
@@ -903,6 +930,8 @@ bool AppInitParameterInteraction()
     if (GetArg("-prune", 0)) {
         if (GetBoolArg("-txindex", DEFAULT_TXINDEX))
             return InitError(_("Prune mode is incompatible with -txindex."));
+        if (GetBoolArg("-contributionindex", DEFAULT_CONTRIBUTIONINDEX))
+            return InitError(_("Prune mode is incompatible with -contributionindex."));
     }
 
     // Make sure enough file descriptors are available
@@ -971,6 +1000,10 @@ bool AppInitParameterInteraction()
     int64_t nMempoolSizeMin = GetArg("-limitdescendantsize", DEFAULT_DESCENDANT_SIZE_LIMIT) * 1000 * 40;
     if (nMempoolSizeMax < 0 || nMempoolSizeMax < nMempoolSizeMin)
         return InitError(strprintf(_("-maxmempool must be at least %d MB"), std::ceil(nMempoolSizeMin / 1000000.0)));
+    int64_t nMWEBMempoolSizeMax = GetArg("-maxmwebmempool", DEFAULT_MAX_MWEB_MEMPOOL_SIZE) * 1000000;
+    if (nMWEBMempoolSizeMax < 0)
+        return InitError(_("-maxmwebmempool must not be negative"));
+    mwebMempool.SetLimits(nMWEBMempoolSizeMax, GetArg("-mempoolexpiry", DEFAULT_MEMPOOL_EXPIRY) * 60 * 60);
     // incremental relay fee sets the minimimum feerate increase necessary for BIP 125 replacement in the mempool
     // and the amount the mempool min fee increases above the feerate of txs evicted due to mempool limiting.
     if (IsArgSet("-incrementalrelayfee"))
@@ -1245,11 +1278,26 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
     LogPrintf("Using at most %i automatic connections (%i file descriptors available)\n", nMaxConnections, nFD);
 
     InitSignatureCache();
-
+    InitMWEBVerifyCache();
+
+    // Each kind of check has its own queue and worker threads, and the thread
+    // calling into the queue also works on it. Header proof of work checks run
+    // while headers are processed and input prefetching before a block is
+    // connected, so those get the full -par workers. Script and MWEB checks
+    // run together while a block is connected; the MWEB queue gets half of
+    // them, so that blocks without an extension block still check their
+    // scripts on all cores.
+    int nWorkers = nScriptCheckThreads ? nScriptCheckThreads - 1 : 0;
+    int nMWEBWorkers = nWorkers ? std::max(1, nWorkers / 2) : 0;
     LogPrintf("Using %u threads for script verification\n", nScriptCheckThreads);
-    if (nScriptCheckThreads) {
-        for (int i=0; i<nScriptCheckThreads-1; i++)
-            threadGroup.create_thread(&ThreadScriptCheck);
+    LogPrintf("Using %d worker threads each for script, header and prefetch queues, %d for MWEB checks\n", nWorkers, nMWEBWorkers);
+    for (int i=0; i<nWorkers; i++) {
+        threadGroup.create_thread(&ThreadScriptCheck);
+        threadGroup.create_thread(&ThreadHeaderCheck);
+        threadGroup.create_thread(&ThreadCoinsPrefetch);
+    }
+    for (int i=0; i<nMWEBWorkers; i++) {
+        threadGroup.create_thread(&ThreadMWEBCheck);
     }
 
     // Start the lightweight task scheduler thread
@@ -1278,6 +1326,11 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
     }
 #endif
 
+    int nScryptLanes = scrypt_detect_multi();
+    if (nScryptLanes > 1) {
+        LogPrintf("scrypt: hashing header batches %d at a time\n", nScryptLanes);
+    }
+
     // ********************************************************* Step 5: verify wallet database integrity
 #ifdef ENABLE_WALLET
     if (!CWallet::Verify())
@@ -1477,6 +1530,13 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
     int64_t nBlockTreeDBCache = nTotalCache / 8;
     nBlockTreeDBCache = std::min(nBlockTreeDBCache, (GetBoolArg("-txindex", DEFAULT_TXINDEX) ? nMaxBlockDBAndTxIndexCache : nMaxBlockDBCache) << 20);
     nTotalCache -= nBlockTreeDBCache;
+    int64_t nContributionIndexCache = 0;
+    if (GetBoolArg("-contributionindex", DEFAULT_CONTRIBUTIONINDEX)) {
+        nContributionIndexCache = std::min(nTotalCache / 8, nMaxContributionIndexCache << 20);
+        nTotalCache -= nContributionIndexCache;
+    }
+    int64_t nGovernanceCache = std::min(nTotalCache / 8, nMaxGovernanceCache << 20);
+    nTotalCache -= nGovernanceCache;
     int64_t nCoinDBCache = std::min(nTotalCache / 2, (nTotalCache / 4) + (1 << 23)); // use 25%-50% of the remainder for disk cache
     nCoinDBCache = std::min(nCoinDBCache, nMaxCoinsDBCache << 20); // cap total coins db cache
     nTotalCache -= nCoinDBCache;
@@ -1484,6 +1544,9 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
     int64_t nMempoolSizeMax = GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000;
     LogPrintf("Cache configuration:\n");
     LogPrintf("* Using %.1fMiB for block index database\n", nBlockTreeDBCache * (1.0 / 1024 / 1024));
+    if (nContributionIndexCache)
+        LogPrintf("* Using %.1fMiB for contribution index database\n", nContributionIndexCache * (1.0 / 1024 / 1024));
+    LogPrintf("* Using %.1fMiB for governance database\n", nGovernanceCache * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1fMiB for chain state database\n", nCoinDBCache * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1fMiB for in-memory UTXO set (plus up to %.1fMiB of unused mempool space)\n", nCoinCacheUsage * (1.0 / 1024 / 1024), nMempoolSizeMax * (1.0 / 1024 / 1024));
 
@@ -1498,15 +1561,47 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
         do {
             try {
                 UnloadBlockIndex();
+                delete poraclesTip;
+                delete poraclesdbview;
+                delete pmwebcoinsTip;
+                delete pmwebcoinsdbview;
                 delete pcoinsTip;
                 delete pcoinsdbview;
                 delete pcoinscatcher;
                 delete pblocktree;
+                // The caches are only created once the chainstate checks passed
+                poraclesTip = NULL;
+                pmwebcoinsTip = NULL;
+                pcoinsTip = NULL;
+                pcoinscatcher = NULL;
 
                 pblocktree = new CBlockTreeDB(nBlockTreeDBCache, false, fReindex);
                 pcoinsdbview = new CCoinsViewDB(nCoinDBCache, false, fReindex || fReindexChainState);
+                pmwebcoinsdbview = new CMWEBCoinsViewDB(*pcoinsdbview);
+                poraclesdbview = new COracleViewDB(*pcoinsdbview);
+
+                // The MWEB output set and oracle state are written in the same
+                // batch as the coins; a different best block means they were
+                // never built. Check before upgrading the coins, which the
+                // reindex would throw away.
+                if (pmwebcoinsdbview->GetBestBlock() != pcoinsdbview->GetBestBlock()) {
+                    strLoadError = _("The MWEB output set does not match the chainstate. You need to rebuild the database using -reindex-chainstate");
+                    break;
+                }
+                if (poraclesdbview->GetBestBlock() != pcoinsdbview->GetBestBlock()) {
+                    strLoadError = _("The oracle state does not match the chainstate. You need to rebuild the database using -reindex-chainstate");
+                    break;
+                }
+
+                // If necessary, upgrade the chainstate from the per-transaction coins format.
+                if (!pcoinsdbview->Upgrade()) {
+                    strLoadError = _("Error upgrading chainstate database");
+                    break;
+                }
                 pcoinscatcher = new CCoinsViewErrorCatcher(pcoinsdbview);
                 pcoinsTip = new CCoinsViewCache(pcoinscatcher);
+                pmwebcoinsTip = new CMWEBCoinsViewCache(pmwebcoinsdbview);
+                poraclesTip = new COracleViewCache(poraclesdbview);
 
                 if (fReindex) {
                     pblocktree->WriteReindexing(true);
@@ -1529,10 +1624,18 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                         LogPrintf("Regtest: Genesis block mismatch detected. Clearing old data and reindexing...\n");
                         // Clear old chain data for regtest
                         UnloadBlockIndex();
+                        delete poraclesTip;
+                        delete poraclesdbview;
+                        delete pmwebcoinsTip;
+                        delete pmwebcoinsdbview;
                         delete pcoinsTip;
                         delete pcoinsdbview;
                         delete pcoinscatcher;
                         delete pblocktree;
+                        poraclesTip = nullptr;
+                        poraclesdbview = nullptr;
+                        pmwebcoinsTip = nullptr;
+                        pmwebcoinsdbview = nullptr;
                         pcoinsTip = nullptr;
                         pcoinsdbview = nullptr;
                         pcoinscatcher = nullptr;
@@ -1642,6 +1745,25 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
     }
     LogPrintf(" block index %15dms\n", GetTimeMillis() - nStart);
 
+    if (GetBoolArg("-contributionindex", DEFAULT_CONTRIBUTIONINDEX)) {
+        uiInterface.SafeInitMessage(_("Loading contribution index..."));
+        pcontributionindex = new CContributionIndex(nContributionIndexCache, false, fReindex || fReindexChainState);
+        RegisterValidationInterface(pcontributionindex);
+        if (!pcontributionindex->Sync(chainparams))
+            return InitError(_("Error loading the contribution index. You need to remove the contributions directory or restart with -reindex."));
+    }
+
+    uiInterface.SafeInitMessage(_("Loading governance database..."));
+    try {
+        pgovernancedb = new CGovernanceDB(nGovernanceCache, false, fReindex || fReindexChainState);
+    } catch (const std::exception& e) {
+        LogPrintf("%s\n", e.what());
+        return InitError(_("Error loading the governance database. You need to remove the governance directory or restart with -reindex."));
+    }
+    RegisterValidationInterface(pgovernancedb);
+    if (!pgovernancedb->Sync(chainparams))
+        return InitError(_("Error loading the governance database. You need to remove the governance directory or restart with -reindex."));
+
     // Update CConnman's best height immediately after loading block index
     // This ensures GetBestHeight() returns correct value when nodes are created
     // This is critical to prevent clients from advertising incorrect block heights to peers
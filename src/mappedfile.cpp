@@ -0,0 +1,60 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "mappedfile.h"
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool CMappedFile::IsSupported()
+{
+#ifndef WIN32
+    // As in LevelDB's env_posix, only map files with a 64-bit address space:
+    // 32-bit processes would run out of it with a few block files mapped
+    return sizeof(void*) >= 8;
+#else
+    return false;
+#endif
+}
+
+std::shared_ptr<const CMappedFile> CMappedFile::Open(const fs::path& path)
+{
+#ifndef WIN32
+    if (!IsSupported())
+        return nullptr;
+
+    int fd = open(path.string().c_str(), O_RDONLY);
+    if (fd == -1)
+        return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    // The mapping holds its own reference to the file, the descriptor is not
+    // needed once it exists.
+    size_t nSize = st.st_size;
+    void* p = mmap(nullptr, nSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return nullptr;
+
+    return std::shared_ptr<const CMappedFile>(new CMappedFile(path, static_cast<const unsigned char*>(p), nSize));
+#else
+    return nullptr;
+#endif
+}
+
+CMappedFile::~CMappedFile()
+{
+#ifndef WIN32
+    munmap(const_cast<unsigned char*>(pdata), nSize);
+#endif
+}
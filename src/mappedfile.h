@@ -0,0 +1,52 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef FLEETCREDITS_MAPPEDFILE_H
+#define FLEETCREDITS_MAPPEDFILE_H
+
+#include "fs.h"
+
+#include <memory>
+#include <stddef.h>
+
+/**
+ * A read-only memory mapping of a whole file.
+ *
+ * The mapping covers the file as it was when it was opened. Data appended
+ * later by a writer becomes visible through it as long as it lies within the
+ * mapped size, but a file that is truncated below the mapped size must not be
+ * read past its new end: on POSIX systems touching such pages raises SIGBUS.
+ * Callers should therefore only read ranges they know to be written.
+ */
+class CMappedFile
+{
+public:
+    /**
+     * Map the file at path. Returns nullptr if the file cannot be opened or
+     * mapped, is empty, or memory mapping is not supported on this platform,
+     * in which case callers should fall back to regular file reads.
+     */
+    static std::shared_ptr<const CMappedFile> Open(const fs::path& path);
+
+    /** Whether Open maps files at all: not on Windows, nor on 32-bit builds */
+    static bool IsSupported();
+
+    ~CMappedFile();
+
+    CMappedFile(const CMappedFile&) = delete;
+    CMappedFile& operator=(const CMappedFile&) = delete;
+
+    const unsigned char* data() const { return pdata; }
+    size_t size() const { return nSize; }
+    const fs::path& GetPath() const { return path; }
+
+private:
+    CMappedFile(const fs::path& pathIn, const unsigned char* pdataIn, size_t nSizeIn) : path(pathIn), pdata(pdataIn), nSize(nSizeIn) {}
+
+    const fs::path path;
+    const unsigned char* const pdata;
+    const size_t nSize;
+};
+
+#endif // FLEETCREDITS_MAPPEDFILE_H
@@ -6,6 +6,7 @@
 #define FLEETCREDITS_MEMUSAGE_H
 
 #include "indirectmap.h"
+#include "support/allocators/pool.h"
 
 #include <stdlib.h>
 
@@ -167,6 +168,17 @@ static inline size_t DynamicUsage(const boost::unordered_map<X, Y, Z>& m)
     return MallocUsage(sizeof(boost_unordered_node<std::pair<const X, Y> >)) * m.size() + MallocUsage(sizeof(void*) * m.bucket_count());
 }
 
+/** A map backed by a PoolResource uses whole chunks, whether or not their
+ *  blocks are currently in use, plus whatever went past the pool. */
+template<typename X, typename Y, typename Z, typename P, size_t MAX_BLOCK_SIZE_BYTES, size_t ALIGN_BYTES>
+static inline size_t DynamicUsage(const boost::unordered_map<X, Y, Z, P, PoolAllocator<std::pair<const X, Y>, MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES> >& m)
+{
+    const PoolResource<MAX_BLOCK_SIZE_BYTES, ALIGN_BYTES>* resource = m.get_allocator().resource();
+    // The chunks are kept in a std::list, whose nodes hold two links and the chunk pointer.
+    const size_t chunk_usage = MallocUsage(sizeof(void*) * 3) + MallocUsage(resource->ChunkSizeBytes());
+    return chunk_usage * resource->NumAllocatedChunks() + MallocUsage(resource->OversizeBytes());
+}
+
 }
 
 #endif // FLEETCREDITS_MEMUSAGE_H
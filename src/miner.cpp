@@ -13,6 +13,8 @@
 #include "consensus/consensus.h"
 #include "consensus/merkle.h"
 #include "consensus/validation.h"
+#include "crypto/scrypt.h"
+#include "blockmarkers.h"
 #include "fleetcredits.h"
 #include "hash.h"
 #include "validation.h"
@@ -22,18 +24,24 @@
 #include "primitives/transaction.h"
 #include "primitives/contribution.h"
 #include "primitives/mweb.h"
+#include "mweb_coins.h"
 #include "mweb_mempool.h"
+#include "oracles.h"
 #include "script/standard.h"
 #include "streams.h"
 #include "timedata.h"
 #include "txmempool.h"
 #include "util.h"
 #include "utilmoneystr.h"
+#include "utilstrencodings.h"
 #include "validationinterface.h"
 #include "versionbits.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <string.h>
+#include <thread>
 #include <boost/thread.hpp>
 #include <boost/tuple/tuple.hpp>
 #include <map>
@@ -132,6 +140,7 @@ void BlockAssembler::resetBlock()
     // These counters do not include coinbase tx
     nBlockTx = 0;
     nFees = 0;
+    vBlockBestContribution.clear();
 
     lastFewTxs = 0;
     blockFinished = false;
@@ -157,8 +166,10 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
     LOCK2(cs_main, mempool.cs);
     CBlockIndex* pindexPrev = chainActive.Tip();
     nHeight = pindexPrev->nHeight + 1;
+    hashPrevBlock = pindexPrev->GetBlockHash();
 
     const Consensus::Params& consensus = chainparams.GetConsensus(nHeight);
+    nBaseSubsidy = nBlockSubsidy = GetFleetCreditsBlockSubsidy(nHeight, consensus, hashPrevBlock);
     const int32_t nChainId = consensus.nAuxpowChainId;
     const int32_t nVersion = VERSIONBITS_LAST_OLD_BLOCK_VERSION;
     pblock->SetBaseVersion(nVersion, nChainId);
@@ -193,8 +204,11 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
     nLastBlockSize = nBlockSize;
     nLastBlockWeight = nBlockWeight;
 
-    // Extract contributions from block being created
-    std::vector<CContributionTransaction> contributions = ExtractContributionsFromBlock(*pblock);
+    // Contributions of the block being created, as parsed and validated when
+    // their transactions entered the mempool. The markers stay cached on the
+    // block for TestBlockValidity and ConnectBlock.
+    std::shared_ptr<const CBlockMarkers> markers = GetBlockMarkers(*pblock, [](const CTransaction& tx) { return mempool.GetMarkers(tx); });
+    const std::vector<CContributionTransaction>& contributions = markers->contributions;
     
     // Get base reward
     CAmount baseReward = GetFleetCreditsBlockSubsidy(nHeight, consensus, pindexPrev->GetBlockHash());
@@ -206,7 +220,8 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
             nHeight, 
             consensus, 
             pindexPrev->GetBlockHash(), 
-            contributions
+            contributions,
+            poraclesTip
         );
     }
     
@@ -230,60 +245,8 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
         // Calculate total contributor bonus pool (50% of bonus)
         CAmount contributorBonusPool = bonusAmount - minerBonusShare;
         
-        // Aggregate weights per contributor based on the bonus they introduce
-        std::map<CPubKey, CAmount> contributorWeights;
-        for (const auto& contrib : contributions) {
-            if (contrib.bonus_level == BONUS_NONE) {
-                continue;
-            }
-
-            // Basic validation ensures we don't reward malformed payloads
-            if (!ValidateContributionTransaction(contrib)) {
-                continue;
-            }
-
-            CAmount tierReward = GetContributionTierPayout(contrib.bonus_level, contrib.contrib_type);
-            CAmount bonusWeight = tierReward - baseReward;
-            if (bonusWeight <= 0) {
-                continue;
-            }
-
-            contributorWeights[contrib.contributor] += bonusWeight;
-        }
-
-        CAmount totalBonusWeight = 0;
-        for (const auto& entry : contributorWeights) {
-            totalBonusWeight += entry.second;
-        }
-
-        // Distribute contributor rewards proportionally
-        std::map<CPubKey, CAmount> contributorRewards;
-        if (totalBonusWeight > 0) {
-            CAmount remainingPool = contributorBonusPool;
-            size_t processed = 0;
-            const size_t totalRecipients = contributorWeights.size();
-
-            for (const auto& entry : contributorWeights) {
-                ++processed;
-                CAmount rewardAmount;
-                if (processed == totalRecipients) {
-                    // Give any rounding remainder to the final recipient
-                    rewardAmount = remainingPool;
-                } else {
-                    rewardAmount = (contributorBonusPool * entry.second) / totalBonusWeight;
-                    if (rewardAmount > remainingPool) {
-                        rewardAmount = remainingPool;
-                    }
-                }
-
-                if (rewardAmount > 0) {
-                    contributorRewards[entry.first] += rewardAmount;
-                    remainingPool -= rewardAmount;
-                }
-            }
-        }
-
         // Add coinbase outputs for each contributor
+        std::map<CPubKey, CAmount> contributorRewards = SplitContributorBonus(contributions, baseReward, contributorBonusPool);
         for (const auto& rewardPair : contributorRewards) {
             const CPubKey& contributorPubKey = rewardPair.first;
             const CAmount& rewardAmount = rewardPair.second;
@@ -324,18 +287,33 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
     CMWEBExtensionBlock mweb_block;
     bool has_mweb_data = false;
     
-    // Collect pending MWEB transactions from mempool
+    // Collect pending MWEB transactions from mempool, highest fee rate first.
+    // The extension block is serialized with the block and counts towards
+    // its weight in full, so bound the selection by the weight left.
     extern CMWEBMempool mwebMempool;
-    std::vector<CMWEBTransaction> pending_mweb_txs = mwebMempool.GetMWEBTransactions();
+    const uint64_t nMWEBOverhead = (1 + ::GetSerializeSize(mweb_block, SER_NETWORK, PROTOCOL_VERSION)) * WITNESS_SCALE_FACTOR;
+    std::vector<CMWEBTransactionRef> pending_mweb_txs;
+    if (nBlockWeight + nMWEBOverhead < nBlockMaxWeight)
+        mwebMempool.SelectMWEBTransactions((nBlockMaxWeight - nBlockWeight - nMWEBOverhead) / WITNESS_SCALE_FACTOR, pending_mweb_txs);
     std::vector<CPegInTransaction> pending_peg_ins = mwebMempool.GetPegIns();
     std::vector<CPegOutTransaction> pending_peg_outs = mwebMempool.GetPegOuts();
     
-    // Add pending MWEB transactions
+    // Add pending MWEB transactions whose inputs are unspent. Outputs created
+    // by transactions selected earlier may be spent by later ones.
     if (!pending_mweb_txs.empty()) {
-        mweb_block.mweb_txs.insert(mweb_block.mweb_txs.end(), 
-                                   pending_mweb_txs.begin(), 
-                                   pending_mweb_txs.end());
-        has_mweb_data = true;
+        CMWEBCoinsViewCache mweb_view(pmwebcoinsTip);
+        for (const auto& mweb_tx_ref : pending_mweb_txs) {
+            const CMWEBTransaction& mweb_tx = *mweb_tx_ref;
+            CMWEBCoinsViewCache mweb_tx_view(&mweb_view);
+            CMWEBBlockUndo mweb_undo;
+            if (!ApplyMWEBTransaction(mweb_tx, mweb_tx_view, mweb_undo, nHeight)) {
+                LogPrint("mweb", "CreateNewBlock(): skipping MWEB transaction %s with missing inputs\n", mweb_tx.GetHash().ToString());
+                continue;
+            }
+            mweb_tx_view.Flush();
+            mweb_block.mweb_txs.push_back(mweb_tx);
+            has_mweb_data = true;
+        }
     }
     
     // Add pending peg-ins from mempool (these already have recipient_address set)
@@ -378,17 +356,16 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
     if (has_mweb_data && (!mweb_block.mweb_txs.empty() || !mweb_block.peg_ins.empty() || !mweb_block.peg_outs.empty())) {
         // Set previous MWEB hash
         if (pindexPrev) {
-            // Get previous MWEB hash from previous block
-            CBlock prev_block;
-            if (ReadBlockFromDisk(prev_block, pindexPrev, Params().GetConsensus(0))) {
-                if (prev_block.mweb_extension) {
+            if (pindexPrev->nStatus & BLOCK_OPT_MWEB) {
+                mweb_block.prev_mweb_hash = pindexPrev->hashMWEBExtension;
+            } else {
+                // Index entry written before the MWEB summary was recorded
+                CBlock prev_block;
+                if (ReadBlockFromDisk(prev_block, pindexPrev, Params().GetConsensus(0)) && prev_block.mweb_extension) {
                     mweb_block.prev_mweb_hash = prev_block.mweb_extension->GetHash();
                 } else {
                     mweb_block.prev_mweb_hash.SetNull();
                 }
-            } else {
-                // If we can't read previous block, set to null
-                mweb_block.prev_mweb_hash.SetNull();
             }
         } else {
             // Genesis block - no previous MWEB hash
@@ -396,7 +373,7 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
         }
         
         // Apply cut-through optimization
-        mweb_block = MWEB::CutThrough(mweb_block);
+        MWEB::ApplyCutThrough(mweb_block);
         
         // Re-check after cut-through (shouldn't be empty, but be safe)
         if (mweb_block.mweb_txs.empty() && mweb_block.peg_ins.empty() && mweb_block.peg_outs.empty()) {
@@ -555,6 +532,18 @@ void BlockAssembler::AddToBlock(CTxMemPool::txiter iter)
     nFees += iter->GetFee();
     inBlock.insert(iter);
 
+    // Only the best contribution decides the bonus, so the others need not be kept
+    const std::vector<CContributionTransaction>& contributions = iter->GetMarkers()->contributions;
+    if (!contributions.empty()) {
+        std::vector<CContributionTransaction> vContributions(vBlockBestContribution);
+        vContributions.insert(vContributions.end(), contributions.begin(), contributions.end());
+        const CContributionTransaction* best = GetBestBonusContribution(vContributions, nHeight, chainparams.GetConsensus(nHeight), poraclesTip);
+        if (best != NULL) {
+            vBlockBestContribution.assign(1, *best);
+            nBlockSubsidy = GetFleetCreditsBlockSubsidyWithContributions(nHeight, chainparams.GetConsensus(nHeight), hashPrevBlock, vBlockBestContribution, poraclesTip);
+        }
+    }
+
     bool fPrintPriority = GetBoolArg("-printpriority", DEFAULT_PRINTPRIORITY);
     if (fPrintPriority) {
         double dPriority = iter->GetPriority(nHeight);
@@ -594,6 +583,56 @@ int BlockAssembler::UpdatePackagesForAdded(const CTxMemPool::setEntries& already
     return nDescendantsUpdated;
 }
 
+void BlockAssembler::UpdateContributionBonuses(CTxMemPool::setEntries& contributionTxs, CTxMemPool::setEntries& bonusTxs, indexed_modified_transaction_set &mapModifiedTx, const CTxMemPool::setEntries& failedTx)
+{
+    // Only the best contribution of a block counts, so a package is worth
+    // what its best contribution adds to the best one already in
+    const Consensus::Params& consensus = chainparams.GetConsensus(nHeight);
+    const CAmount nMinerShare = (nBlockSubsidy - nBaseSubsidy) / 2;
+    std::map<CTxMemPool::txiter, CAmount, CTxMemPool::CompareIteratorByHash> mapBonus;
+    for (CTxMemPool::setEntries::iterator it = contributionTxs.begin(); it != contributionTxs.end(); ) {
+        if (inBlock.count(*it)) {
+            contributionTxs.erase(it++);
+            continue;
+        }
+        std::vector<CContributionTransaction> vContributions(vBlockBestContribution);
+        const std::vector<CContributionTransaction>& contributions = (*it)->GetMarkers()->contributions;
+        vContributions.insert(vContributions.end(), contributions.begin(), contributions.end());
+        CAmount nSubsidy = GetFleetCreditsBlockSubsidyWithContributions(nHeight, consensus, hashPrevBlock, vContributions, poraclesTip);
+        CAmount nBonus = (nSubsidy - nBaseSubsidy) / 2 - nMinerShare;
+        if (nBonus > 0) {
+            // Every package containing this transaction earns the bonus
+            CTxMemPool::setEntries descendants;
+            mempool.CalculateDescendants(*it, descendants);
+            BOOST_FOREACH(CTxMemPool::txiter desc, descendants) {
+                CAmount& nPackageBonus = mapBonus[desc];
+                nPackageBonus = std::max(nPackageBonus, nBonus);
+            }
+        }
+        ++it;
+    }
+
+    for (CTxMemPool::txiter it : bonusTxs) {
+        modtxiter mit = mapModifiedTx.find(it);
+        if (mit != mapModifiedTx.end() && !mapBonus.count(it))
+            mapModifiedTx.modify(mit, update_contribution_bonus(0));
+    }
+    bonusTxs.clear();
+    for (const auto& bonus : mapBonus) {
+        if (inBlock.count(bonus.first) || failedTx.count(bonus.first))
+            continue;
+        bonusTxs.insert(bonus.first);
+        modtxiter mit = mapModifiedTx.find(bonus.first);
+        if (mit == mapModifiedTx.end()) {
+            CTxMemPoolModifiedEntry modEntry(bonus.first);
+            modEntry.nContributionBonus = bonus.second;
+            mapModifiedTx.insert(modEntry);
+        } else {
+            mapModifiedTx.modify(mit, update_contribution_bonus(bonus.second));
+        }
+    }
+}
+
 // Skip entries in mapTx that are already in a block or are present
 // in mapModifiedTx (which implies that the mapTx ancestor state is
 // stale due to ancestor inclusion in the block)
@@ -632,6 +671,11 @@ void BlockAssembler::SortForBlock(const CTxMemPool::setEntries& package, CTxMemP
 // Each time through the loop, we compare the best transaction in
 // mapModifiedTxs with the next transaction in the mempool to decide what
 // transaction package to work on next.
+//
+// Packages with contributions also score the miner's share of the subsidy
+// bonus they would add (see UpdateContributionBonuses). They are kept in
+// mapModifiedTx with that bonus, which is updated whenever the contribution
+// deciding the bonus of the block changes.
 void BlockAssembler::addPackageTxs(int &nPackagesSelected, int &nDescendantsUpdated)
 {
     // mapModifiedTx will store sorted packages after they are modified
@@ -644,6 +688,11 @@ void BlockAssembler::addPackageTxs(int &nPackagesSelected, int &nDescendantsUpda
     // and modifying them for their already included ancestors
     UpdatePackagesForAdded(inBlock, mapModifiedTx);
 
+    CTxMemPool::setEntries contributionTxs = mempool.GetContributionTxs();
+    CTxMemPool::setEntries bonusTxs;
+    if (!contributionTxs.empty())
+        UpdateContributionBonuses(contributionTxs, bonusTxs, mapModifiedTx, failedTx);
+
     CTxMemPool::indexed_transaction_set::index<ancestor_score>::type::iterator mi = mempool.mapTx.get<ancestor_score>().begin();
     CTxMemPool::txiter iter;
 
@@ -695,13 +744,15 @@ void BlockAssembler::addPackageTxs(int &nPackagesSelected, int &nDescendantsUpda
         uint64_t packageSize = iter->GetSizeWithAncestors();
         CAmount packageFees = iter->GetModFeesWithAncestors();
         int64_t packageSigOpsCost = iter->GetSigOpCostWithAncestors();
+        CAmount packageBonus = 0;
         if (fUsingModified) {
             packageSize = modit->nSizeWithAncestors;
             packageFees = modit->nModFeesWithAncestors;
             packageSigOpsCost = modit->nSigOpCostWithAncestors;
+            packageBonus = modit->nContributionBonus;
         }
 
-        if (packageFees < blockMinFeeRate.GetFee(packageSize)) {
+        if (packageFees + packageBonus < blockMinFeeRate.GetFee(packageSize)) {
             // Everything else we might consider has a lower fee rate
             return;
         }
@@ -749,6 +800,7 @@ void BlockAssembler::addPackageTxs(int &nPackagesSelected, int &nDescendantsUpda
         std::vector<CTxMemPool::txiter> sortedEntries;
         SortForBlock(ancestors, iter, sortedEntries);
 
+        const uint32_t nBonusLevel = GetBlockBonusLevel();
         for (size_t i=0; i<sortedEntries.size(); ++i) {
             AddToBlock(sortedEntries[i]);
             // Erase from the modified set, if present
@@ -759,6 +811,11 @@ void BlockAssembler::addPackageTxs(int &nPackagesSelected, int &nDescendantsUpda
 
         // Update transactions that depend on each of these
         nDescendantsUpdated += UpdatePackagesForAdded(ancestors, mapModifiedTx);
+
+        // A better contribution decides the bonus now, so the bonus of the
+        // other contributions changed
+        if (GetBlockBonusLevel() != nBonusLevel)
+            UpdateContributionBonuses(contributionTxs, bonusTxs, mapModifiedTx, failedTx);
     }
 }
 
@@ -844,6 +901,59 @@ void BlockAssembler::addPriorityTxs()
     fNeedSizeAccounting = fSizeAccounting;
 }
 
+std::map<CPubKey, CAmount> SplitContributorBonus(const std::vector<CContributionTransaction>& contributions, CAmount baseReward, CAmount contributorBonusPool)
+{
+    // Aggregate weights per contributor based on the bonus they introduce
+    std::map<CPubKey, CAmount> contributorWeights;
+    for (const auto& contrib : contributions) {
+        // Malformed payloads were already dropped by GetBlockMarkers
+        if (contrib.bonus_level == BONUS_NONE) {
+            continue;
+        }
+
+        CAmount tierReward = GetContributionTierPayout(contrib.bonus_level, contrib.contrib_type);
+        CAmount bonusWeight = tierReward - baseReward;
+        if (bonusWeight <= 0) {
+            continue;
+        }
+
+        contributorWeights[contrib.contributor] += bonusWeight;
+    }
+
+    CAmount totalBonusWeight = 0;
+    for (const auto& entry : contributorWeights) {
+        totalBonusWeight += entry.second;
+    }
+
+    // Distribute contributor rewards proportionally
+    std::map<CPubKey, CAmount> contributorRewards;
+    if (totalBonusWeight > 0) {
+        CAmount remainingPool = contributorBonusPool;
+        size_t processed = 0;
+        const size_t totalRecipients = contributorWeights.size();
+
+        for (const auto& entry : contributorWeights) {
+            ++processed;
+            CAmount rewardAmount;
+            if (processed == totalRecipients) {
+                // Give any rounding remainder to the final recipient
+                rewardAmount = remainingPool;
+            } else {
+                rewardAmount = (contributorBonusPool * entry.second) / totalBonusWeight;
+                if (rewardAmount > remainingPool) {
+                    rewardAmount = remainingPool;
+                }
+            }
+
+            if (rewardAmount > 0) {
+                contributorRewards[entry.first] += rewardAmount;
+                remainingPool -= rewardAmount;
+            }
+        }
+    }
+    return contributorRewards;
+}
+
 void IncrementExtraNonce(CBlock* pblock, const CBlockIndex* pindexPrev, unsigned int& nExtraNonce)
 {
     // Update nExtraNonce
@@ -862,3 +972,57 @@ void IncrementExtraNonce(CBlock* pblock, const CBlockIndex* pindexPrev, unsigned
     pblock->vtx[0] = MakeTransactionRef(std::move(txCoinbase));
     pblock->hashMerkleRoot = BlockMerkleRoot(*pblock);
 }
+
+bool SearchNonce(CPureBlockHeader& header, unsigned int nBits, const Consensus::Params& params, uint32_t nNonceEnd, uint64_t& nMaxTries, int nThreads)
+{
+    const uint64_t nNonceBegin = header.nNonce;
+    if (nNonceBegin >= nNonceEnd)
+        return false;
+    const uint64_t nLimit = nNonceBegin + std::min<uint64_t>(nMaxTries, nNonceEnd - nNonceBegin);
+
+    // Batches are taken in increasing nonce order and none is taken past a
+    // nonce found, so every nonce below the lowest one found gets tried.
+    // The first few nonces go one at a time, as easy targets (regtest) are
+    // met long before a whole batch is hashed.
+    std::atomic<uint64_t> nNext(nNonceBegin);
+    std::atomic<uint64_t> nFound(nLimit);
+    auto search = [&]() {
+        CPureBlockHeader candidate = header;
+        char input[SCRYPT_MAX_LANES * 80];
+        uint256 hashes[SCRYPT_MAX_LANES];
+        while (true) {
+            uint64_t nBatch = nNext.load();
+            uint64_t nCount;
+            do {
+                if (nBatch >= nLimit || nBatch >= nFound.load())
+                    return;
+                nCount = nBatch - nNonceBegin < (uint64_t)SCRYPT_MAX_LANES ? 1 : std::min<uint64_t>(SCRYPT_MAX_LANES, nLimit - nBatch);
+            } while (!nNext.compare_exchange_weak(nBatch, nBatch + nCount));
+
+            for (uint64_t i = 0; i < nCount; i++) {
+                candidate.nNonce = nBatch + i;
+                memcpy(&input[80 * i], BEGIN(candidate.nVersion), 80);
+            }
+            scrypt_1024_1_1_256_multi(input, (char*)hashes, nCount);
+            for (uint64_t i = 0; i < nCount; i++) {
+                if (CheckProofOfWork(hashes[i], nBits, params)) {
+                    uint64_t nPrev = nFound.load();
+                    while (nBatch + i < nPrev && !nFound.compare_exchange_weak(nPrev, nBatch + i)) {}
+                    break;
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < nThreads; i++)
+        threads.emplace_back(search);
+    search();
+    for (std::thread& thread : threads)
+        thread.join();
+
+    const uint64_t nEnd = nFound.load();
+    header.nNonce = nEnd;
+    nMaxTries -= nEnd - nNonceBegin;
+    return nEnd < nLimit;
+}
@@ -8,9 +8,11 @@
 #define FLEETCREDITS_MINER_H
 
 #include "primitives/block.h"
+#include "primitives/contribution.h"
 #include "txmempool.h"
 
 #include <stdint.h>
+#include <map>
 #include <memory>
 #include "boost/multi_index_container.hpp"
 #include "boost/multi_index/ordered_index.hpp"
@@ -24,6 +26,8 @@ class CWallet;
 namespace Consensus { struct Params; };
 
 static const bool DEFAULT_PRINTPRIORITY = false;
+/** Default for -genproclimit, the number of threads generate searches nonces with */
+static const int DEFAULT_GENERATE_THREADS = 1;
 
 struct CBlockTemplate
 {
@@ -42,12 +46,16 @@ struct CTxMemPoolModifiedEntry {
         nSizeWithAncestors = entry->GetSizeWithAncestors();
         nModFeesWithAncestors = entry->GetModFeesWithAncestors();
         nSigOpCostWithAncestors = entry->GetSigOpCostWithAncestors();
+        nContributionBonus = 0;
     }
 
     CTxMemPool::txiter iter;
     uint64_t nSizeWithAncestors;
     CAmount nModFeesWithAncestors;
     int64_t nSigOpCostWithAncestors;
+    //! Miner's share of the subsidy bonus the best contribution in the
+    //! package would add to the block, scored like fees
+    CAmount nContributionBonus;
 };
 
 /** Comparator for CTxMemPool::txiter objects.
@@ -71,13 +79,14 @@ struct modifiedentry_iter {
 };
 
 // This matches the calculation in CompareTxMemPoolEntryByAncestorFee,
-// except operating on CTxMemPoolModifiedEntry.
+// except operating on CTxMemPoolModifiedEntry and counting the contribution
+// bonus as fees.
 // TODO: refactor to avoid duplication of this logic.
 struct CompareModifiedEntry {
     bool operator()(const CTxMemPoolModifiedEntry &a, const CTxMemPoolModifiedEntry &b) const
     {
-        double f1 = (double)a.nModFeesWithAncestors * b.nSizeWithAncestors;
-        double f2 = (double)b.nModFeesWithAncestors * a.nSizeWithAncestors;
+        double f1 = (double)(a.nModFeesWithAncestors + a.nContributionBonus) * b.nSizeWithAncestors;
+        double f2 = (double)(b.nModFeesWithAncestors + b.nContributionBonus) * a.nSizeWithAncestors;
         if (f1 == f2) {
             return CTxMemPool::CompareIteratorByHash()(a.iter, b.iter);
         }
@@ -131,6 +140,18 @@ struct update_for_parent_inclusion
     CTxMemPool::txiter iter;
 };
 
+struct update_contribution_bonus
+{
+    update_contribution_bonus(CAmount bonus) : nBonus(bonus) {}
+
+    void operator() (CTxMemPoolModifiedEntry &e)
+    {
+        e.nContributionBonus = nBonus;
+    }
+
+    CAmount nBonus;
+};
+
 /** Generate a new block, without valid proof-of-work */
 class BlockAssembler
 {
@@ -153,9 +174,15 @@ private:
     uint64_t nBlockSigOpsCost;
     CAmount nFees;
     CTxMemPool::setEntries inBlock;
+    // The contribution deciding the bonus of the block so far (if any) and
+    // the subsidy it earns
+    std::vector<CContributionTransaction> vBlockBestContribution;
+    CAmount nBaseSubsidy;
+    CAmount nBlockSubsidy;
 
     // Chain context for the block
     int nHeight;
+    uint256 hashPrevBlock;
     int64_t nLockTimeCutoff;
     const CChainParams& chainparams;
 
@@ -208,10 +235,37 @@ private:
       * state updated assuming given transactions are inBlock. Returns number
       * of updated descendants. */
     int UpdatePackagesForAdded(const CTxMemPool::setEntries& alreadyAdded, indexed_modified_transaction_set &mapModifiedTx);
+    /** Recompute the contribution bonus of the packages of the given
+      * transactions carrying contributions (and their descendants) for the
+      * block as it is now, adding them to mapModifiedTx as needed. Drops
+      * entries of contributionTxs that made it into the block. bonusTxs
+      * holds the entries of mapModifiedTx with a bonus. */
+    void UpdateContributionBonuses(CTxMemPool::setEntries& contributionTxs, CTxMemPool::setEntries& bonusTxs, indexed_modified_transaction_set &mapModifiedTx, const CTxMemPool::setEntries& failedTx);
+    /** Bonus level of the contribution deciding the bonus of the block so far */
+    uint32_t GetBlockBonusLevel() const { return vBlockBestContribution.empty() ? (uint32_t)BONUS_NONE : vBlockBestContribution[0].bonus_level; }
 };
 
+/**
+ * Split the contributors' half of a block's bonus (contributorBonusPool)
+ * among the contributors of the block, in proportion to the bonus each of
+ * their contributions adds over baseReward. The last recipient gets the
+ * rounding remainder.
+ */
+std::map<CPubKey, CAmount> SplitContributorBonus(const std::vector<CContributionTransaction>& contributions, CAmount baseReward, CAmount contributorBonusPool);
+
 /** Modify the extranonce in a block */
 void IncrementExtraNonce(CBlock* pblock, const CBlockIndex* pindexPrev, unsigned int& nExtraNonce);
+
+/**
+ * Search the nonces of header from its nNonce up to nNonceEnd, at most
+ * nMaxTries of them, for one that meets nBits. The nonces are hashed in
+ * batches for the batched scrypt kernel, shared out over nThreads threads
+ * that stop taking batches as soon as one is found. Returns whether one was
+ * found. As a serial search would, leaves header.nNonce at the lowest nonce
+ * found or else the first one not tried, and takes the nonces tried before
+ * it off nMaxTries.
+ */
+bool SearchNonce(CPureBlockHeader& header, unsigned int nBits, const Consensus::Params& params, uint32_t nNonceEnd, uint64_t& nMaxTries, int nThreads);
 int64_t UpdateTime(CBlockHeader* pblock, const Consensus::Params& consensusParams, const CBlockIndex* pindexPrev);
 
 #endif // FLEETCREDITS_MINER_H
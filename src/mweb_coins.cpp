@@ -0,0 +1,222 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "mweb_coins.h"
+
+#include "hash.h"
+#include "random.h"
+#include "util.h"
+#include "utilstrencodings.h"
+
+#include <assert.h>
+
+bool CMWEBCoinsView::GetCoin(const CPubKey& commitment, CMWEBCoin& coin) const { return false; }
+bool CMWEBCoinsView::HaveCoin(const CPubKey& commitment) const { return false; }
+uint256 CMWEBCoinsView::GetBestBlock() const { return uint256(); }
+bool CMWEBCoinsView::BatchWrite(CMWEBCoinsMap& mapCoins, const uint256& hashBlock) { return false; }
+
+SaltedCommitmentHasher::SaltedCommitmentHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
+
+size_t SaltedCommitmentHasher::operator()(const CPubKey& commitment) const
+{
+    return CSipHasher(k0, k1).Write(commitment.begin(), commitment.size()).Finalize();
+}
+
+CMWEBCoinsViewCache::CMWEBCoinsViewCache(CMWEBCoinsView* baseIn) : base(baseIn), cachedCoinsUsage(0) { }
+
+size_t CMWEBCoinsViewCache::DynamicMemoryUsage() const {
+    return memusage::DynamicUsage(cacheCoins) + cachedCoinsUsage;
+}
+
+CMWEBCoinsMap::iterator CMWEBCoinsViewCache::FetchCoin(const CPubKey& commitment) const {
+    CMWEBCoinsMap::iterator it = cacheCoins.find(commitment);
+    if (it != cacheCoins.end())
+        return it;
+    CMWEBCoin tmp;
+    if (!base->GetCoin(commitment, tmp))
+        return cacheCoins.end();
+    CMWEBCoinsMap::iterator ret = cacheCoins.insert(std::make_pair(commitment, CMWEBCoinsCacheEntry())).first;
+    ret->second.coin = std::move(tmp);
+    if (ret->second.coin.IsSpent()) {
+        // The parent only has an empty entry for this commitment; we can
+        // consider our version as fresh.
+        ret->second.flags = CMWEBCoinsCacheEntry::FRESH;
+    }
+    cachedCoinsUsage += ret->second.coin.DynamicMemoryUsage();
+    return ret;
+}
+
+bool CMWEBCoinsViewCache::GetCoin(const CPubKey& commitment, CMWEBCoin& coin) const {
+    CMWEBCoinsMap::const_iterator it = FetchCoin(commitment);
+    if (it != cacheCoins.end() && !it->second.coin.IsSpent()) {
+        coin = it->second.coin;
+        return true;
+    }
+    return false;
+}
+
+const CMWEBCoin* CMWEBCoinsViewCache::AccessCoin(const CPubKey& commitment) const {
+    CMWEBCoinsMap::const_iterator it = FetchCoin(commitment);
+    if (it == cacheCoins.end() || it->second.coin.IsSpent()) {
+        return NULL;
+    }
+    return &it->second.coin;
+}
+
+bool CMWEBCoinsViewCache::HaveCoin(const CPubKey& commitment) const {
+    return AccessCoin(commitment) != NULL;
+}
+
+bool CMWEBCoinsViewCache::AddCoin(const CPubKey& commitment, const CMWEBCoin& coin) {
+    assert(!coin.IsSpent());
+    CMWEBCoinsMap::iterator it = FetchCoin(commitment);
+    if (it == cacheCoins.end()) {
+        // Neither we nor the parent know this output; it can be dropped
+        // again without telling the parent if it is spent before a flush.
+        it = cacheCoins.insert(std::make_pair(commitment, CMWEBCoinsCacheEntry())).first;
+        it->second.flags = CMWEBCoinsCacheEntry::FRESH;
+    } else if (!it->second.coin.IsSpent()) {
+        return false;
+    }
+    cachedCoinsUsage -= it->second.coin.DynamicMemoryUsage();
+    it->second.coin = coin;
+    it->second.flags |= CMWEBCoinsCacheEntry::DIRTY;
+    cachedCoinsUsage += it->second.coin.DynamicMemoryUsage();
+    return true;
+}
+
+bool CMWEBCoinsViewCache::SpendCoin(const CPubKey& commitment, CMWEBCoin* moveto) {
+    CMWEBCoinsMap::iterator it = FetchCoin(commitment);
+    if (it == cacheCoins.end() || it->second.coin.IsSpent()) {
+        return false;
+    }
+    cachedCoinsUsage -= it->second.coin.DynamicMemoryUsage();
+    if (moveto) {
+        *moveto = std::move(it->second.coin);
+    }
+    if (it->second.flags & CMWEBCoinsCacheEntry::FRESH) {
+        cacheCoins.erase(it);
+    } else {
+        it->second.flags |= CMWEBCoinsCacheEntry::DIRTY;
+        it->second.coin.Clear();
+    }
+    return true;
+}
+
+uint256 CMWEBCoinsViewCache::GetBestBlock() const {
+    if (hashBlock.IsNull())
+        hashBlock = base->GetBestBlock();
+    return hashBlock;
+}
+
+void CMWEBCoinsViewCache::SetBestBlock(const uint256& hashBlockIn) {
+    hashBlock = hashBlockIn;
+}
+
+bool CMWEBCoinsViewCache::BatchWrite(CMWEBCoinsMap& mapCoins, const uint256& hashBlockIn) {
+    for (CMWEBCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end();) {
+        if (it->second.flags & CMWEBCoinsCacheEntry::DIRTY) { // Ignore non-dirty entries (optimization).
+            CMWEBCoinsMap::iterator itUs = cacheCoins.find(it->first);
+            if (itUs == cacheCoins.end()) {
+                // The parent cache does not have an entry, while the child does.
+                // We can ignore it if it's both FRESH and spent in the child.
+                if (!(it->second.flags & CMWEBCoinsCacheEntry::FRESH && it->second.coin.IsSpent())) {
+                    CMWEBCoinsCacheEntry& entry = cacheCoins[it->first];
+                    entry.coin = std::move(it->second.coin);
+                    cachedCoinsUsage += entry.coin.DynamicMemoryUsage();
+                    entry.flags = CMWEBCoinsCacheEntry::DIRTY;
+                    // We can mark it FRESH in the parent if it was FRESH in the child
+                    if (it->second.flags & CMWEBCoinsCacheEntry::FRESH)
+                        entry.flags |= CMWEBCoinsCacheEntry::FRESH;
+                }
+            } else {
+                if ((it->second.flags & CMWEBCoinsCacheEntry::FRESH) && !itUs->second.coin.IsSpent())
+                    throw std::logic_error("FRESH flag misapplied to MWEB cache entry for an unspent output");
+
+                if ((itUs->second.flags & CMWEBCoinsCacheEntry::FRESH) && it->second.coin.IsSpent()) {
+                    // The grandparent does not have an entry, and the child is
+                    // spending it. This means we can just delete it from the parent.
+                    cachedCoinsUsage -= itUs->second.coin.DynamicMemoryUsage();
+                    cacheCoins.erase(itUs);
+                } else {
+                    // A normal modification.
+                    cachedCoinsUsage -= itUs->second.coin.DynamicMemoryUsage();
+                    itUs->second.coin = std::move(it->second.coin);
+                    cachedCoinsUsage += itUs->second.coin.DynamicMemoryUsage();
+                    itUs->second.flags |= CMWEBCoinsCacheEntry::DIRTY;
+                }
+            }
+        }
+        CMWEBCoinsMap::iterator itOld = it++;
+        mapCoins.erase(itOld);
+    }
+    hashBlock = hashBlockIn;
+    return true;
+}
+
+bool CMWEBCoinsViewCache::Flush() {
+    bool fOk = base->BatchWrite(cacheCoins, hashBlock);
+    cacheCoins.clear();
+    cachedCoinsUsage = 0;
+    return fOk;
+}
+
+unsigned int CMWEBCoinsViewCache::GetCacheSize() const {
+    return cacheCoins.size();
+}
+
+bool ApplyMWEBTransaction(const CMWEBTransaction& tx, CMWEBCoinsViewCache& view, CMWEBBlockUndo& undo, int nHeight)
+{
+    for (const auto& input : tx.inputs) {
+        undo.vspent.push_back(CMWEBCoin());
+        if (!view.SpendCoin(input.output_commitment.commitment, &undo.vspent.back()))
+            return false;
+    }
+    for (const auto& output : tx.outputs) {
+        if (!view.AddCoin(output.commitment.commitment, CMWEBCoin(output, nHeight)))
+            return false;
+    }
+    return true;
+}
+
+bool UpdateMWEBCoins(const CMWEBExtensionBlock& block, CMWEBCoinsViewCache& view, CMWEBBlockUndo& undo, int nHeight)
+{
+    for (const auto& tx : block.mweb_txs) {
+        if (!ApplyMWEBTransaction(tx, view, undo, nHeight))
+            return false;
+    }
+    return true;
+}
+
+bool DisconnectMWEBCoins(const CMWEBExtensionBlock& block, CMWEBCoinsViewCache& view, const CMWEBBlockUndo& undo)
+{
+    bool fClean = true;
+
+    size_t nInputs = 0;
+    for (const auto& tx : block.mweb_txs) {
+        nInputs += tx.inputs.size();
+    }
+    if (undo.vspent.size() != nInputs)
+        return error("%s: MWEB block and undo data inconsistent", __func__);
+
+    // undo transactions in reverse order
+    size_t nUndo = undo.vspent.size();
+    for (auto tx = block.mweb_txs.rbegin(); tx != block.mweb_txs.rend(); ++tx) {
+        for (auto output = tx->outputs.rbegin(); output != tx->outputs.rend(); ++output) {
+            if (!view.SpendCoin(output->commitment.commitment))
+                fClean = fClean && error("%s: MWEB output %s missing", __func__, HexStr(output->commitment.commitment));
+        }
+        for (auto input = tx->inputs.rbegin(); input != tx->inputs.rend(); ++input) {
+            const CMWEBCoin& coin = undo.vspent[--nUndo];
+            if (coin.output.commitment.commitment != input->output_commitment.commitment) {
+                fClean = fClean && error("%s: MWEB undo data does not match input", __func__);
+                continue;
+            }
+            if (!view.AddCoin(coin.output.commitment.commitment, coin))
+                fClean = fClean && error("%s: MWEB undo data overwriting existing output", __func__);
+        }
+    }
+
+    return fClean;
+}
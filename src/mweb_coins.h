@@ -0,0 +1,198 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef FLEETCREDITS_MWEB_COINS_H
+#define FLEETCREDITS_MWEB_COINS_H
+
+#include "core_memusage.h"
+#include "memusage.h"
+#include "primitives/mweb.h"
+#include "pubkey.h"
+#include "serialize.h"
+#include "uint256.h"
+
+#include <stdint.h>
+
+#include <utility>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+/** An unspent MWEB output, keyed by its commitment in the MWEB output set */
+class CMWEBCoin
+{
+public:
+    //! The output as it appeared in the extension block
+    CMWEBOutput output;
+
+    //! Height of the block that created the output
+    uint32_t nHeight;
+
+    CMWEBCoin() : nHeight(0) {}
+    CMWEBCoin(const CMWEBOutput& outputIn, uint32_t nHeightIn) : output(outputIn), nHeight(nHeightIn) {}
+
+    ADD_SERIALIZE_METHODS;
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(VARINT(nHeight));
+        READWRITE(output);
+    }
+
+    void Clear() {
+        output = CMWEBOutput();
+        nHeight = 0;
+    }
+
+    //! A spent (or never created) output has a null commitment
+    bool IsSpent() const {
+        return output.commitment.IsNull();
+    }
+
+    size_t DynamicMemoryUsage() const {
+        return memusage::DynamicUsage(output.range_proof.proof_data) + memusage::DynamicUsage(output.view_key);
+    }
+};
+
+/** Undo information for the MWEB part of a block: the outputs it spent */
+class CMWEBBlockUndo
+{
+public:
+    std::vector<CMWEBCoin> vspent;
+
+    ADD_SERIALIZE_METHODS;
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(vspent);
+    }
+};
+
+class SaltedCommitmentHasher
+{
+private:
+    /** Salt */
+    const uint64_t k0, k1;
+
+public:
+    SaltedCommitmentHasher();
+
+    size_t operator()(const CPubKey& commitment) const;
+};
+
+struct CMWEBCoinsCacheEntry
+{
+    CMWEBCoin coin; // The actual cached data.
+    unsigned char flags;
+
+    enum Flags {
+        DIRTY = (1 << 0), // This cache entry is potentially different from the version in the parent view.
+        FRESH = (1 << 1), // The parent view does not have this entry (or it is spent).
+    };
+
+    CMWEBCoinsCacheEntry() : coin(), flags(0) {}
+};
+
+typedef boost::unordered_map<CPubKey, CMWEBCoinsCacheEntry, SaltedCommitmentHasher> CMWEBCoinsMap;
+
+/** Abstract view on the unspent MWEB output set, see CCoinsView. */
+class CMWEBCoinsView
+{
+public:
+    //! Retrieve the unspent output with the given commitment
+    virtual bool GetCoin(const CPubKey& commitment, CMWEBCoin& coin) const;
+
+    //! Just check whether an unspent output with the given commitment exists
+    virtual bool HaveCoin(const CPubKey& commitment) const;
+
+    //! Retrieve the block hash whose state this view currently represents
+    virtual uint256 GetBestBlock() const;
+
+    //! Do a bulk modification (multiple output changes + BestBlock change).
+    //! The passed mapCoins can be modified.
+    virtual bool BatchWrite(CMWEBCoinsMap& mapCoins, const uint256& hashBlock);
+
+    //! As we use CMWEBCoinsViews polymorphically, have a virtual destructor
+    virtual ~CMWEBCoinsView() {}
+};
+
+/** CMWEBCoinsView that adds a write-back memory cache to another CMWEBCoinsView */
+class CMWEBCoinsViewCache : public CMWEBCoinsView
+{
+protected:
+    CMWEBCoinsView* base;
+
+    /**
+     * Make mutable so that we can "fill the cache" even from Get-methods
+     * declared as "const".
+     */
+    mutable uint256 hashBlock;
+    mutable CMWEBCoinsMap cacheCoins;
+
+    /* Cached dynamic memory usage for the inner CMWEBCoin objects. */
+    mutable size_t cachedCoinsUsage;
+
+public:
+    CMWEBCoinsViewCache(CMWEBCoinsView* baseIn);
+
+    // Standard CMWEBCoinsView methods
+    bool GetCoin(const CPubKey& commitment, CMWEBCoin& coin) const;
+    bool HaveCoin(const CPubKey& commitment) const;
+    uint256 GetBestBlock() const;
+    void SetBestBlock(const uint256& hashBlock);
+    bool BatchWrite(CMWEBCoinsMap& mapCoins, const uint256& hashBlock);
+
+    /**
+     * Return a pointer to the unspent output in the cache, or NULL if not
+     * found or spent.
+     */
+    const CMWEBCoin* AccessCoin(const CPubKey& commitment) const;
+
+    /** Add an output to the set. Returns false if it already exists unspent. */
+    bool AddCoin(const CPubKey& commitment, const CMWEBCoin& coin);
+
+    /**
+     * Spend an output. If moveto is not NULL, the spent output is moved
+     * there (for undo data). Returns false if it does not exist unspent.
+     */
+    bool SpendCoin(const CPubKey& commitment, CMWEBCoin* moveto = NULL);
+
+    /**
+     * Push the modifications applied to this cache to its base.
+     * Failure to call this method before destruction will cause the changes to be forgotten.
+     * If false is returned, the state of this cache (and its backing view) will be undefined.
+     */
+    bool Flush();
+
+    //! Calculate the size of the cache (in number of outputs)
+    unsigned int GetCacheSize() const;
+
+    //! Calculate the size of the cache (in bytes)
+    size_t DynamicMemoryUsage() const;
+
+private:
+    CMWEBCoinsMap::iterator FetchCoin(const CPubKey& commitment) const;
+
+    /**
+     * By making the copy constructor private, we prevent accidentally using it when one intends to create a cache on top of a base cache.
+     */
+    CMWEBCoinsViewCache(const CMWEBCoinsViewCache&);
+};
+
+/**
+ * Apply an MWEB transaction to the output set: spend every input (recording
+ * it in undo) and add every output. Returns false if an input is missing or
+ * spent, or an output already exists; view is then partially updated.
+ */
+bool ApplyMWEBTransaction(const CMWEBTransaction& tx, CMWEBCoinsViewCache& view, CMWEBBlockUndo& undo, int nHeight);
+
+/** Apply all MWEB transactions of an extension block, see ApplyMWEBTransaction. */
+bool UpdateMWEBCoins(const CMWEBExtensionBlock& block, CMWEBCoinsViewCache& view, CMWEBBlockUndo& undo, int nHeight);
+
+/**
+ * Revert UpdateMWEBCoins using the undo data of the block.
+ * Returns false if the view was not in the expected state (the changes
+ * are applied nonetheless).
+ */
+bool DisconnectMWEBCoins(const CMWEBExtensionBlock& block, CMWEBCoinsViewCache& view, const CMWEBBlockUndo& undo);
+
+#endif // FLEETCREDITS_MWEB_COINS_H
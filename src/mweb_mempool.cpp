@@ -4,51 +4,178 @@
 
 #include "mweb_mempool.h"
 
+#include "core_memusage.h"
+#include "memusage.h"
+#include "mweb_verifycache.h"
 #include "primitives/mweb.h"
 #include "sync.h"
+#include "util.h"
+#include "utiltime.h"
+#include "version.h"
 
 CMWEBMempool mwebMempool;
 
-bool CMWEBMempool::AddMWEBTransaction(const CMWEBTransaction& tx)
+CMWEBMempoolEntry::CMWEBMempoolEntry(const CMWEBTransactionRef& _tx, int64_t _nTime):
+    tx(_tx), nFee(0), nTime(_nTime)
+{
+    for (const auto& kernel : tx->kernels) {
+        nFee += kernel.fee;
+    }
+    nTxSize = ::GetSerializeSize(*tx, SER_NETWORK, PROTOCOL_VERSION);
+    nUsageSize = RecursiveDynamicUsage(*tx) + memusage::DynamicUsage(tx);
+}
+
+CMWEBMempool::CMWEBMempool() :
+    cachedInnerUsage(0),
+    nSizeLimit(DEFAULT_MAX_MWEB_MEMPOOL_SIZE * 1000000),
+    nExpiry(0)
+{
+}
+
+void CMWEBMempool::SetLimits(size_t nSizeLimitIn, int64_t nExpiryIn)
 {
     LOCK(cs_mweb_mempool);
-    
-    // Verify transaction before adding
-    if (!tx.VerifyBalance()) {
+    nSizeLimit = nSizeLimitIn;
+    nExpiry = nExpiryIn;
+}
+
+bool CMWEBMempool::AddMWEBTransaction(const CMWEBTransaction& tx)
+{
+    // Verify transaction before adding, unless it was already found valid
+    // (e.g. by the network code, or before it expired from the pool). The
+    // cache entry lets ConnectBlock skip verifying it again.
+    if (!VerifyMWEBTransaction(tx)) {
         return false;
     }
-    if (!tx.VerifyRangeProofs()) {
-        return false;
+
+    CMWEBMempoolEntry entry(MakeMWEBTransactionRef(tx), GetTime());
+
+    LOCK(cs_mweb_mempool);
+
+    indexed_mweb_transaction_set::iterator it = mapTx.find(tx.tx_hash);
+    if (it != mapTx.end()) {
+        cachedInnerUsage -= it->DynamicMemoryUsage();
+        mapTx.erase(it);
     }
-    
-    mweb_txs[tx.tx_hash] = tx;
-    return true;
+    mapTx.insert(entry);
+    cachedInnerUsage += entry.DynamicMemoryUsage();
+
+    if (nExpiry > 0) {
+        int expired = Expire(GetTime() - nExpiry);
+        if (expired != 0)
+            LogPrint("mweb", "Expired %i MWEB transactions from the memory pool\n", expired);
+    }
+    TrimToSize(nSizeLimit);
+
+    return mapTx.count(tx.tx_hash) != 0;
 }
 
 bool CMWEBMempool::RemoveMWEBTransaction(const uint256& txid)
 {
     LOCK(cs_mweb_mempool);
-    
-    auto it = mweb_txs.find(txid);
-    if (it != mweb_txs.end()) {
-        mweb_txs.erase(it);
+
+    indexed_mweb_transaction_set::iterator it = mapTx.find(txid);
+    if (it != mapTx.end()) {
+        cachedInnerUsage -= it->DynamicMemoryUsage();
+        mapTx.erase(it);
         return true;
     }
     return false;
 }
 
-std::vector<CMWEBTransaction> CMWEBMempool::GetMWEBTransactions() const
+bool CMWEBMempool::CompareFeeRate(const uint256& hasha, const uint256& hashb) const
 {
     LOCK(cs_mweb_mempool);
-    
-    std::vector<CMWEBTransaction> result;
-    result.reserve(mweb_txs.size());
-    for (const auto& pair : mweb_txs) {
-        result.push_back(pair.second);
+    indexed_mweb_transaction_set::const_iterator i = mapTx.find(hasha);
+    if (i == mapTx.end())
+        return false;
+    indexed_mweb_transaction_set::const_iterator j = mapTx.find(hashb);
+    if (j == mapTx.end())
+        return true;
+    return CompareMWEBEntryByFeeRate()(*i, *j);
+}
+
+bool CMWEBMempool::Exists(const uint256& txid) const
+{
+    LOCK(cs_mweb_mempool);
+    return mapTx.count(txid) != 0;
+}
+
+CMWEBTransactionRef CMWEBMempool::Get(const uint256& txid) const
+{
+    LOCK(cs_mweb_mempool);
+    indexed_mweb_transaction_set::const_iterator it = mapTx.find(txid);
+    if (it == mapTx.end())
+        return nullptr;
+    return it->GetSharedTx();
+}
+
+std::vector<CMWEBTransactionRef> CMWEBMempool::GetMWEBTransactions() const
+{
+    LOCK(cs_mweb_mempool);
+
+    std::vector<CMWEBTransactionRef> result;
+    result.reserve(mapTx.size());
+    for (const auto& entry : mapTx.get<mweb_fee_rate>()) {
+        result.push_back(entry.GetSharedTx());
     }
     return result;
 }
 
+void CMWEBMempool::SelectMWEBTransactions(size_t nMaxSize, std::vector<CMWEBTransactionRef>& vSelected) const
+{
+    LOCK(cs_mweb_mempool);
+
+    size_t nSize = 0;
+    for (const auto& entry : mapTx.get<mweb_fee_rate>()) {
+        if (nSize + entry.GetTxSize() > nMaxSize)
+            continue;
+        nSize += entry.GetTxSize();
+        vSelected.push_back(entry.GetSharedTx());
+    }
+}
+
+int CMWEBMempool::Expire(int64_t time)
+{
+    AssertLockHeld(cs_mweb_mempool);
+    int nExpired = 0;
+    indexed_mweb_transaction_set::index<mweb_entry_time>::type::iterator it = mapTx.get<mweb_entry_time>().begin();
+    while (it != mapTx.get<mweb_entry_time>().end() && it->GetTime() < time) {
+        cachedInnerUsage -= it->DynamicMemoryUsage();
+        it = mapTx.get<mweb_entry_time>().erase(it);
+        nExpired++;
+    }
+    return nExpired;
+}
+
+void CMWEBMempool::TrimToSize(size_t sizelimit)
+{
+    AssertLockHeld(cs_mweb_mempool);
+    unsigned int nEvicted = 0;
+    while (!mapTx.empty() && DynamicMemoryUsageInternal() > sizelimit) {
+        // The fee rate index is best first; evict from the back
+        indexed_mweb_transaction_set::index<mweb_fee_rate>::type::iterator it = std::prev(mapTx.get<mweb_fee_rate>().end());
+        cachedInnerUsage -= it->DynamicMemoryUsage();
+        mapTx.get<mweb_fee_rate>().erase(it);
+        nEvicted++;
+    }
+    if (nEvicted > 0)
+        LogPrint("mweb", "Evicted %u MWEB transactions to keep the memory pool under %u bytes\n", nEvicted, (unsigned int)sizelimit);
+}
+
+size_t CMWEBMempool::DynamicMemoryUsageInternal() const
+{
+    AssertLockHeld(cs_mweb_mempool);
+    // Estimate the overhead of mapTx to be 12 pointers + an allocation, as no exact formula for boost::multi_index_contained is implemented.
+    return memusage::MallocUsage(sizeof(CMWEBMempoolEntry) + 12 * sizeof(void*)) * mapTx.size() + cachedInnerUsage;
+}
+
+size_t CMWEBMempool::DynamicMemoryUsage() const
+{
+    LOCK(cs_mweb_mempool);
+    return DynamicMemoryUsageInternal();
+}
+
 bool CMWEBMempool::AddPegIn(const CPegInTransaction& peg_in)
 {
     LOCK(cs_mweb_mempool);
@@ -129,7 +256,8 @@ void CMWEBMempool::Clear()
 {
     LOCK(cs_mweb_mempool);
     
-    mweb_txs.clear();
+    mapTx.clear();
+    cachedInnerUsage = 0;
     peg_ins.clear();
     peg_outs.clear();
 }
@@ -138,6 +266,6 @@ size_t CMWEBMempool::Size() const
 {
     LOCK(cs_mweb_mempool);
     
-    return mweb_txs.size() + peg_ins.size() + peg_outs.size();
+    return mapTx.size() + peg_ins.size() + peg_outs.size();
 }
 
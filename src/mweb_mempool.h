@@ -5,71 +5,199 @@
 #ifndef FLEETCREDITS_MWEB_MEMPOOL_H
 #define FLEETCREDITS_MWEB_MEMPOOL_H
 
+#include "amount.h"
+#include "coins.h"
 #include "primitives/mweb.h"
 #include "sync.h"
 #include "uint256.h"
 
 #include <map>
-#include <set>
 #include <vector>
 
+#include "boost/multi_index_container.hpp"
+#include "boost/multi_index/hashed_index.hpp"
+#include "boost/multi_index/ordered_index.hpp"
+
+/** Default for -maxmwebmempool, maximum megabytes of the MWEB mempool */
+static const unsigned int DEFAULT_MAX_MWEB_MEMPOOL_SIZE = 50;
+
+/** A pending MWEB transaction with the data needed to order and evict it */
+class CMWEBMempoolEntry
+{
+private:
+    CMWEBTransactionRef tx;
+    CAmount nFee;              //!< Sum of the kernel fees
+    size_t nTxSize;            //!< ... and serialized size
+    size_t nUsageSize;         //!< ... and total memory usage
+    int64_t nTime;             //!< Local time when entering the mempool
+
+public:
+    CMWEBMempoolEntry(const CMWEBTransactionRef& _tx, int64_t _nTime);
+
+    const CMWEBTransaction& GetTx() const { return *this->tx; }
+    CMWEBTransactionRef GetSharedTx() const { return this->tx; }
+    const CAmount& GetFee() const { return nFee; }
+    size_t GetTxSize() const { return nTxSize; }
+    int64_t GetTime() const { return nTime; }
+    size_t DynamicMemoryUsage() const { return nUsageSize; }
+};
+
+struct mwebentry_txid
+{
+    typedef uint256 result_type;
+    result_type operator() (const CMWEBMempoolEntry& entry) const
+    {
+        return entry.GetTx().tx_hash;
+    }
+};
+
+/** Sort by kernel fee rate in descending order */
+class CompareMWEBEntryByFeeRate
+{
+public:
+    bool operator()(const CMWEBMempoolEntry& a, const CMWEBMempoolEntry& b) const
+    {
+        double f1 = (double)a.GetFee() * b.GetTxSize();
+        double f2 = (double)b.GetFee() * a.GetTxSize();
+        if (f1 == f2) {
+            return b.GetTx().tx_hash < a.GetTx().tx_hash;
+        }
+        return f1 > f2;
+    }
+};
+
+class CompareMWEBEntryByEntryTime
+{
+public:
+    bool operator()(const CMWEBMempoolEntry& a, const CMWEBMempoolEntry& b) const
+    {
+        return a.GetTime() < b.GetTime();
+    }
+};
+
+// Multi_index tag names
+struct mweb_fee_rate {};
+struct mweb_entry_time {};
+
 /** MWEB Mempool
  * Stores pending MWEB transactions, peg-ins, and peg-outs
- * for inclusion in the next MWEB extension block
+ * for inclusion in the next MWEB extension block.
+ *
+ * Transactions are indexed by hash, by kernel fee rate and by entry time,
+ * like CTxMemPool, so that block templates take the best paying ones first
+ * and the pool can be kept under a memory limit by evicting the worst.
  */
 class CMWEBMempool
 {
+public:
+    typedef boost::multi_index_container<
+        CMWEBMempoolEntry,
+        boost::multi_index::indexed_by<
+            // sorted by hash
+            boost::multi_index::hashed_unique<mwebentry_txid, SaltedTxidHasher>,
+            // sorted by fee rate
+            boost::multi_index::ordered_non_unique<
+                boost::multi_index::tag<mweb_fee_rate>,
+                boost::multi_index::identity<CMWEBMempoolEntry>,
+                CompareMWEBEntryByFeeRate
+            >,
+            // sorted by entry time
+            boost::multi_index::ordered_non_unique<
+                boost::multi_index::tag<mweb_entry_time>,
+                boost::multi_index::identity<CMWEBMempoolEntry>,
+                CompareMWEBEntryByEntryTime
+            >
+        >
+    > indexed_mweb_transaction_set;
+
 private:
     mutable CCriticalSection cs_mweb_mempool;
-    
+
     // Pending MWEB transactions
-    std::map<uint256, CMWEBTransaction> mweb_txs;
-    
+    indexed_mweb_transaction_set mapTx;
+    uint64_t cachedInnerUsage; //!< sum of dynamic memory usage of all the entries
+
     // Pending peg-in transactions
     std::map<uint256, CPegInTransaction> peg_ins;
-    
+
     // Pending peg-out transactions
     std::map<uint256, CPegOutTransaction> peg_outs;
 
+    size_t nSizeLimit;         //!< Bytes of memory the transactions may use
+    int64_t nExpiry;           //!< Seconds after which transactions are dropped
+
+    /** Evict the lowest fee rate transactions until within nSizeLimit */
+    void TrimToSize(size_t sizelimit);
+
+    /** Remove transactions that entered the pool before time */
+    int Expire(int64_t time);
+
+    size_t DynamicMemoryUsageInternal() const;
+
 public:
-    CMWEBMempool() {}
-    
-    /** Add MWEB transaction to mempool */
+    CMWEBMempool();
+
+    /** Set the memory limit (in bytes) and the expiry age (in seconds) */
+    void SetLimits(size_t nSizeLimitIn, int64_t nExpiryIn);
+
+    /** Add MWEB transaction to mempool. Returns false if it is invalid or
+     * was immediately evicted because the pool is full of better paying ones. */
     bool AddMWEBTransaction(const CMWEBTransaction& tx);
-    
+
     /** Remove MWEB transaction from mempool */
     bool RemoveMWEBTransaction(const uint256& txid);
-    
-    /** Get all pending MWEB transactions */
-    std::vector<CMWEBTransaction> GetMWEBTransactions() const;
-    
+
+    /** Whether a transaction with this hash is pending */
+    bool Exists(const uint256& txid) const;
+
+    /**
+     * Whether hasha pays a higher fee rate than hashb, in the order of the
+     * fee rate index. Transactions no longer pending sort last.
+     */
+    bool CompareFeeRate(const uint256& hasha, const uint256& hashb) const;
+
+    /** Get a pending transaction by hash, or nullptr if there is none */
+    CMWEBTransactionRef Get(const uint256& txid) const;
+
+    /** Get all pending MWEB transactions, highest fee rate first */
+    std::vector<CMWEBTransactionRef> GetMWEBTransactions() const;
+
+    /**
+     * Append pending MWEB transactions to vSelected, highest fee rate first,
+     * skipping those that would take the total serialized size beyond
+     * nMaxSize. Only the shared transactions are copied.
+     */
+    void SelectMWEBTransactions(size_t nMaxSize, std::vector<CMWEBTransactionRef>& vSelected) const;
+
     /** Add peg-in transaction */
     bool AddPegIn(const CPegInTransaction& peg_in);
-    
+
     /** Remove peg-in transaction */
     bool RemovePegIn(const uint256& peg_tx_id);
-    
+
     /** Get all pending peg-ins */
     std::vector<CPegInTransaction> GetPegIns() const;
-    
+
     /** Add peg-out transaction */
     bool AddPegOut(const CPegOutTransaction& peg_out);
-    
+
     /** Remove peg-out transaction */
     bool RemovePegOut(const uint256& peg_tx_id);
-    
+
     /** Get all pending peg-outs */
     std::vector<CPegOutTransaction> GetPegOuts() const;
-    
+
     /** Clear all pending transactions (called when block is mined) */
     void Clear();
-    
+
     /** Get total number of pending transactions */
     size_t Size() const;
+
+    /** Get the memory used by pending MWEB transactions */
+    size_t DynamicMemoryUsage() const;
 };
 
 // Global MWEB mempool instance
 extern CMWEBMempool mwebMempool;
 
 #endif // FLEETCREDITS_MWEB_MEMPOOL_H
-
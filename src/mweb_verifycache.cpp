@@ -0,0 +1,119 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "mweb_verifycache.h"
+
+#include "crypto/sha256.h"
+#include "primitives/mweb.h"
+#include "random.h"
+#include "uint256.h"
+#include "util.h"
+
+#include "cuckoocache.h"
+#include <boost/thread.hpp>
+
+namespace {
+
+/**
+ * Entries are nonced hashes, so no extra blinding is needed in the set hash
+ * computation; see SignatureCacheHasher.
+ */
+class MWEBVerifyCacheHasher
+{
+public:
+    template <uint8_t hash_select>
+    uint32_t operator()(const uint256& key) const
+    {
+        static_assert(hash_select <8, "MWEBVerifyCacheHasher only has 8 hashes available.");
+        uint32_t u;
+        std::memcpy(&u, key.begin()+4*hash_select, 4);
+        return u;
+    }
+};
+
+/**
+ * Cache of MWEB transactions whose balance and range proofs were verified,
+ * so that transactions seen in the MWEB mempool are not verified again when
+ * the block including them is connected.
+ */
+class CMWEBVerifyCache
+{
+private:
+    //! Entries are SHA256(nonce || transaction hash), where the transaction
+    //! hash is computed from the contents rather than taken from tx_hash.
+    uint256 nonce;
+    typedef CuckooCache::cache<uint256, MWEBVerifyCacheHasher> map_type;
+    map_type setValid;
+    boost::shared_mutex cs_mwebcache;
+
+public:
+    CMWEBVerifyCache()
+    {
+        GetRandBytes(nonce.begin(), 32);
+        // Minimal cache so that it is usable before InitMWEBVerifyCache
+        // sizes it; nothing is stored by then, so no entries are lost.
+        setValid.setup_bytes(0);
+    }
+
+    void
+    ComputeEntry(uint256& entry, const CMWEBTransaction& tx)
+    {
+        uint256 hash = tx.GetHash();
+        CSHA256().Write(nonce.begin(), 32).Write(hash.begin(), 32).Finalize(entry.begin());
+    }
+
+    bool
+    Get(const uint256& entry, const bool erase)
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs_mwebcache);
+        return setValid.contains(entry, erase);
+    }
+
+    void Set(uint256& entry)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_mwebcache);
+        setValid.insert(entry);
+    }
+    uint32_t setup_bytes(size_t n)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_mwebcache);
+        return setValid.setup_bytes(n);
+    }
+};
+
+static CMWEBVerifyCache mwebVerifyCache;
+}
+
+// To be called once in AppInit2/TestingSetup to size the mwebVerifyCache
+void InitMWEBVerifyCache()
+{
+    size_t nMaxCacheSize = std::min(std::max((int64_t)0, GetArg("-maxmwebcachesize", DEFAULT_MAX_MWEB_CACHE_SIZE)), MAX_MAX_MWEB_CACHE_SIZE) * ((size_t) 1 << 20);
+    size_t nElems = mwebVerifyCache.setup_bytes(nMaxCacheSize);
+    LogPrintf("Using %zu MiB out of %zu requested for MWEB verification cache, able to store %zu elements\n",
+            (nElems*sizeof(uint256)) >>20, nMaxCacheSize>>20, nElems);
+}
+
+bool IsMWEBTransactionVerified(const CMWEBTransaction& tx, bool erase)
+{
+    uint256 entry;
+    mwebVerifyCache.ComputeEntry(entry, tx);
+    return mwebVerifyCache.Get(entry, erase);
+}
+
+void SetMWEBTransactionVerified(const CMWEBTransaction& tx)
+{
+    uint256 entry;
+    mwebVerifyCache.ComputeEntry(entry, tx);
+    mwebVerifyCache.Set(entry);
+}
+
+bool VerifyMWEBTransaction(const CMWEBTransaction& tx)
+{
+    if (IsMWEBTransactionVerified(tx, false))
+        return true;
+    if (!tx.VerifyBalance() || !tx.VerifyRangeProofs())
+        return false;
+    SetMWEBTransactionVerified(tx);
+    return true;
+}
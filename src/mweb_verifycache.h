@@ -0,0 +1,37 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef FLEETCREDITS_MWEB_VERIFYCACHE_H
+#define FLEETCREDITS_MWEB_VERIFYCACHE_H
+
+#include <stdint.h>
+
+class CMWEBTransaction;
+
+// Each entry is a 32 byte hash, so the default is enough for over 130000
+// transactions, many times what the MWEB mempool holds by default.
+static const unsigned int DEFAULT_MAX_MWEB_CACHE_SIZE = 4;
+// Maximum MWEB verification cache size allowed
+static const int64_t MAX_MAX_MWEB_CACHE_SIZE = 16384;
+
+/**
+ * Whether the balance and range proofs of tx were already found valid.
+ * Pass erase when the transaction is not expected to be checked again
+ * (i.e. it is being connected in a block); the entry is then only marked
+ * for eviction.
+ */
+bool IsMWEBTransactionVerified(const CMWEBTransaction& tx, bool erase);
+
+/** Remember that the balance and range proofs of tx are valid. */
+void SetMWEBTransactionVerified(const CMWEBTransaction& tx);
+
+/**
+ * Check the balance and range proofs of tx, unless the cache already has
+ * them as valid, and remember a valid result.
+ */
+bool VerifyMWEBTransaction(const CMWEBTransaction& tx);
+
+void InitMWEBVerifyCache();
+
+#endif // FLEETCREDITS_MWEB_VERIFYCACHE_H
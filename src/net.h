@@ -656,6 +656,8 @@ public:
     // Set of transaction ids we still have to announce.
     // They are sorted by the mempool before relay, so the order is not important.
     std::set<uint256> setInventoryTxToSend;
+    // Set of MWEB transaction hashes we still have to announce.
+    std::set<uint256> setInventoryMWEBTxToSend;
     // List of block ids we still have announce.
     // There is no final sorting before sending, as they are always sent immediately
     // and in the order requested.
@@ -800,6 +802,10 @@ public:
             if (!filterInventoryKnown.contains(inv.hash)) {
                 setInventoryTxToSend.insert(inv.hash);
             }
+        } else if (inv.type == MSG_MWEB_TX) {
+            if (!filterInventoryKnown.contains(inv.hash)) {
+                setInventoryMWEBTxToSend.insert(inv.hash);
+            }
         } else if (inv.type == MSG_BLOCK) {
             vInventoryBlockToSend.push_back(inv.hash);
         }
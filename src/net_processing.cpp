@@ -15,6 +15,9 @@
 #include "init.h"
 #include "validation.h"
 #include "merkleblock.h"
+#include "mweb_coins.h"
+#include "mweb_mempool.h"
+#include "mweb_verifycache.h"
 #include "net.h"
 #include "netmessagemaker.h"
 #include "netbase.h"
@@ -84,6 +87,8 @@ static size_t vExtraTxnForCompactIt = 0;
 static std::vector<std::pair<uint256, CTransactionRef>> vExtraTxnForCompact GUARDED_BY(cs_main);
 
 static TxRequestTracker g_txrequest GUARDED_BY(cs_main);
+/** Announcements of MWEB transactions, kept apart from g_txrequest as they are fetched with MSG_MWEB_TX */
+static TxRequestTracker g_mwebtxrequest GUARDED_BY(cs_main);
 
 static const uint64_t RANDOMIZER_ID_ADDRESS_RELAY = 0x3cac0035b5866b90ULL; // SHA256("main address relay")[0:8]
 
@@ -314,6 +319,7 @@ void InitializeNode(CNode *pnode, CConnman& connman) {
         LOCK(cs_main);
         mapNodeState.emplace_hint(mapNodeState.end(), std::piecewise_construct, std::forward_as_tuple(nodeid), std::forward_as_tuple(addr, std::move(addrName)));
         assert(g_txrequest.Count(nodeid) == 0);
+        assert(g_mwebtxrequest.Count(nodeid) == 0);
     }
     if(!pnode->fInbound)
         PushNodeVersion(pnode, connman, GetTime());
@@ -336,6 +342,7 @@ void FinalizeNode(NodeId nodeid, bool& fUpdateConnectionTime) {
     }
     EraseOrphansFor(nodeid);
     g_txrequest.DisconnectedPeer(nodeid);
+    g_mwebtxrequest.DisconnectedPeer(nodeid);
 
     nPreferredDownload -= state->fPreferredDownload;
     nPeersWithValidatedDownloads -= (state->nBlocksInFlightValidHeaders != 0);
@@ -349,6 +356,7 @@ void FinalizeNode(NodeId nodeid, bool& fUpdateConnectionTime) {
         assert(nPreferredDownload == 0);
         assert(nPeersWithValidatedDownloads == 0);
         assert(g_txrequest.Size() == 0);
+        assert(g_mwebtxrequest.Size() == 0);
     }
 }
 
@@ -395,7 +403,7 @@ bool MarkBlockAsInFlight(NodeId nodeid, const uint256& hash, const Consensus::Pa
     MarkBlockAsReceived(hash);
 
     std::list<QueuedBlock>::iterator it = state->vBlocksInFlight.insert(state->vBlocksInFlight.end(),
-            {hash, pindex, pindex != NULL, std::unique_ptr<PartiallyDownloadedBlock>(pit ? new PartiallyDownloadedBlock(&mempool) : NULL)});
+            {hash, pindex, pindex != NULL, std::unique_ptr<PartiallyDownloadedBlock>(pit ? new PartiallyDownloadedBlock(&mempool, &mwebMempool) : NULL)});
     state->nBlocksInFlight++;
     state->nBlocksInFlightValidHeaders += it->fValidatedHeaders;
     if (state->nBlocksInFlight == 1) {
@@ -444,6 +452,12 @@ void UpdateBlockAvailability(NodeId nodeid, const uint256 &hash) {
     }
 }
 
+// Compact blocks sent to peers below MWEB_CMPCT_VERSION cannot carry an MWEB
+// extension block
+bool CanSendCompactBlock(const CNode* pnode, bool fHasMWEB) {
+    return pnode->nVersion >= MWEB_CMPCT_VERSION || !fHasMWEB;
+}
+
 void MaybeSetPeerAsAnnouncingHeaderAndIDs(NodeId nodeid, CConnman& connman) {
     AssertLockHeld(cs_main);
     CNodeState* nodestate = State(nodeid);
@@ -604,12 +618,12 @@ void FindNextBlocksToDownload(NodeId nodeid, unsigned int count, std::vector<con
 
 } // anon namespace
 
-void AddTxAnnouncement(CNode* node, const uint256& txhash, int64_t current_time)
+void AddTxAnnouncement(TxRequestTracker& txrequest, CNode* node, const uint256& txhash, int64_t current_time)
 {
-    AssertLockHeld(cs_main); // For g_txrequest
+    AssertLockHeld(cs_main); // For g_txrequest and g_mwebtxrequest
     NodeId nodeid = node->GetId();
 
-    if (!node->fWhitelisted && g_txrequest.Count(nodeid) >= MAX_PEER_TX_ANNOUNCEMENTS) {
+    if (!node->fWhitelisted && txrequest.Count(nodeid) >= MAX_PEER_TX_ANNOUNCEMENTS) {
         // Too many queued announcements from this peer
         return;
     }
@@ -622,13 +636,13 @@ void AddTxAnnouncement(CNode* node, const uint256& txhash, int64_t current_time)
     //       MAX_PEER_TX_IN_FLIGHT requests in flight and aren't whitelisted.
     const CNodeState* state = State(nodeid);
     const bool preferred = state->fPreferredDownload;
-    const bool overloaded = (!node->fWhitelisted && g_txrequest.CountInFlight(nodeid) >= MAX_PEER_TX_IN_FLIGHT);
+    const bool overloaded = (!node->fWhitelisted && txrequest.CountInFlight(nodeid) >= MAX_PEER_TX_IN_FLIGHT);
 
     int64_t delay = 0;
     if (!preferred) delay += NONPREF_PEER_TX_DELAY;
     if (overloaded) delay += OVERLOADED_PEER_TX_DELAY;
 
-    g_txrequest.ReceivedInv(nodeid, txhash, preferred, current_time + delay);
+    txrequest.ReceivedInv(nodeid, txhash, preferred, current_time + delay);
 }
 
 bool GetNodeStateStats(NodeId nodeid, CNodeStateStats &stats) {
@@ -886,6 +900,7 @@ void PeerLogicValidation::NewPoWValidBlock(const CBlockIndex *pindex, const std:
     nHighestFastAnnounce = pindex->nHeight;
 
     bool fWitnessEnabled = IsWitnessEnabled(pindex->pprev, Params().GetConsensus(pindex->nHeight));
+    bool fHasMWEB = pblock->mweb_extension != nullptr;
     uint256 hashBlock(pblock->GetHash());
 
     {
@@ -895,7 +910,7 @@ void PeerLogicValidation::NewPoWValidBlock(const CBlockIndex *pindex, const std:
         most_recent_compact_block = pcmpctblock;
     }
 
-    connman->ForEachNode([this, &pcmpctblock, pindex, &msgMaker, fWitnessEnabled, &hashBlock](CNode* pnode) {
+    connman->ForEachNode([this, &pcmpctblock, pindex, &msgMaker, fWitnessEnabled, fHasMWEB, &hashBlock](CNode* pnode) {
         // TODO: Avoid the repeated-serialization here
         if (pnode->nVersion < INVALID_CB_NO_BAN_VERSION || pnode->fDisconnect)
             return;
@@ -904,6 +919,7 @@ void PeerLogicValidation::NewPoWValidBlock(const CBlockIndex *pindex, const std:
         // If the peer has, or we announced to them the previous block already,
         // but we don't think they have this one, go ahead and announce it
         if (state.fPreferHeaderAndIDs && (!fWitnessEnabled || state.fWantsCmpctWitness) &&
+                CanSendCompactBlock(pnode, fHasMWEB) &&
                 !PeerHasHeader(&state, pindex) && PeerHasHeader(&state, pindex->pprev)) {
 
             LogPrint("net", "%s sending header-and-ids %s to peer=%d\n", "PeerLogicValidation::NewPoWValidBlock",
@@ -986,29 +1002,35 @@ void PeerLogicValidation::BlockChecked(const CBlock& block, const CValidationSta
 
 bool static AlreadyHave(const CInv& inv) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
 {
+    assert(recentRejects);
+    if (chainActive.Tip()->GetBlockHash() != hashRecentRejectsChainTip)
+    {
+        // If the chain tip has changed previously rejected transactions
+        // might be now valid, e.g. due to a nLockTime'd tx becoming valid,
+        // or a double-spend. Reset the rejects filter and give those
+        // txs a second chance. MWEB transactions share the filter, so
+        // this is done whatever the inventory type.
+        hashRecentRejectsChainTip = chainActive.Tip()->GetBlockHash();
+        recentRejects->reset();
+    }
+
     switch (inv.type)
     {
     case MSG_TX:
     case MSG_WITNESS_TX:
         {
-            assert(recentRejects);
-            if (chainActive.Tip()->GetBlockHash() != hashRecentRejectsChainTip)
-            {
-                // If the chain tip has changed previously rejected transactions
-                // might be now valid, e.g. due to a nLockTime'd tx becoming valid,
-                // or a double-spend. Reset the rejects filter and give those
-                // txs a second chance.
-                hashRecentRejectsChainTip = chainActive.Tip()->GetBlockHash();
-                recentRejects->reset();
-            }
-
-            // Use pcoinsTip->HaveCoinsInCache as a quick approximation to exclude
-            // requesting or processing some txs which have already been included in a block
+            // Use pcoinsTip->HaveCoinInCache as a quick approximation to exclude
+            // requesting or processing some txs which have already been included in a block.
+            // Checking the first two outputs catches almost every transaction that
+            // has not been fully spent yet.
             return recentRejects->contains(inv.hash) ||
                    mempool.exists(inv.hash) ||
                    mapOrphanTransactions.count(inv.hash) ||
-                   pcoinsTip->HaveCoinsInCache(inv.hash);
+                   pcoinsTip->HaveCoinInCache(COutPoint(inv.hash, 0)) ||
+                   pcoinsTip->HaveCoinInCache(COutPoint(inv.hash, 1));
         }
+    case MSG_MWEB_TX:
+        return recentRejects->contains(inv.hash) || mwebMempool.Exists(inv.hash);
     case MSG_BLOCK:
     case MSG_WITNESS_BLOCK:
         return mapBlockIndex.count(inv.hash);
@@ -1026,6 +1048,16 @@ static void RelayTransaction(const CTransaction& tx, CConnman& connman)
     });
 }
 
+static void RelayMWEBTransaction(const CMWEBTransaction& tx, CConnman& connman)
+{
+    CInv inv(MSG_MWEB_TX, tx.tx_hash);
+    connman.ForEachNode([&inv](CNode* pnode)
+    {
+        if (pnode->nVersion >= MWEB_TX_VERSION)
+            pnode->PushInventory(inv);
+    });
+}
+
 static void RelayAddress(const CAddress& addr, bool fReachable, CConnman& connman)
 {
     unsigned int nRelayNodes = fReachable ? 2 : 1; // limited relaying of addresses outside our network(s)
@@ -1174,7 +1206,8 @@ void static ProcessGetData(CNode* pfrom, const Consensus::Params& consensusParam
                         // instead we respond with the full, non-compact block.
                         bool fPeerWantsWitness = State(pfrom->GetId())->fWantsCmpctWitness;
                         int nSendFlags = fPeerWantsWitness ? 0 : SERIALIZE_TRANSACTION_NO_WITNESS;
-                        if (CanDirectFetch(consensusParams) && mi->second->nHeight >= chainActive.Height() - MAX_CMPCTBLOCK_DEPTH) {
+                        if (CanDirectFetch(consensusParams) && mi->second->nHeight >= chainActive.Height() - MAX_CMPCTBLOCK_DEPTH &&
+                                CanSendCompactBlock(pfrom, block.mweb_extension != nullptr)) {
                             CBlockHeaderAndShortTxIDs cmpctblock(block, fPeerWantsWitness);
                             connman.PushMessage(pfrom, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, cmpctblock));
                         } else
@@ -1216,6 +1249,16 @@ void static ProcessGetData(CNode* pfrom, const Consensus::Params& consensusParam
                     vNotFound.push_back(inv);
                 }
             }
+            else if (inv.type == MSG_MWEB_TX)
+            {
+                // Only serve what is still pending; once mined it is part of the block
+                CMWEBTransactionRef ptx = mwebMempool.Get(inv.hash);
+                if (ptx) {
+                    connman.PushMessage(pfrom, msgMaker.Make(NetMsgType::MWEBTX, *ptx));
+                } else {
+                    vNotFound.push_back(inv);
+                }
+            }
 
             if (inv.type == MSG_BLOCK || inv.type == MSG_FILTERED_BLOCK || inv.type == MSG_CMPCT_BLOCK || inv.type == MSG_WITNESS_BLOCK)
                 break;
@@ -1262,6 +1305,15 @@ inline void static SendBlockTransactions(const CBlock& block, const BlockTransac
         }
         resp.txn[i] = block.vtx[req.indexes[i]];
     }
+    for (size_t i = 0; i < req.mweb_indexes.size(); i++) {
+        if (!block.mweb_extension || req.mweb_indexes[i] >= block.mweb_extension->mweb_txs.size()) {
+            LOCK(cs_main);
+            Misbehaving(pfrom->GetId(), 100);
+            LogPrintf("Peer %d sent us a getblocktxn with out-of-bounds MWEB tx indices", pfrom->id);
+            return;
+        }
+        resp.mweb_txn[i] = block.mweb_extension->mweb_txs[req.mweb_indexes[i]];
+    }
     LOCK(cs_main);
     const CNetMsgMaker msgMaker(pfrom->GetSendVersion());
     int nSendFlags = State(pfrom->GetId())->fWantsCmpctWitness ? 0 : SERIALIZE_TRANSACTION_NO_WITNESS;
@@ -1771,10 +1823,13 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
             else
             {
                 pfrom->AddInventoryKnown(inv);
-                if (fBlocksOnly)
+                TxRequestTracker& txrequest = (inv.type == MSG_MWEB_TX ? g_mwebtxrequest : g_txrequest);
+                if (inv.type == MSG_MWEB_TX && pfrom->nVersion < MWEB_TX_VERSION)
+                    LogPrint("net", "MWEB transaction (%s) inv sent by a peer that does not relay them peer=%d\n", inv.hash.ToString(), pfrom->id);
+                else if (fBlocksOnly)
                     LogPrint("net", "transaction (%s) inv sent in violation of protocol peer=%d\n", inv.hash.ToString(), pfrom->id);
                 else if (!fAlreadyHave && !fImporting && !fReindex && !IsInitialBlockDownload())
-                    AddTxAnnouncement(pfrom, inv.hash, current_time);
+                    AddTxAnnouncement(txrequest, pfrom, inv.hash, current_time);
             }
 
         }
@@ -2063,7 +2118,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                     CInv _inv(MSG_TX | nFetchFlags, txin.prevout.hash);
                     pfrom->AddInventoryKnown(_inv);
                     if (!AlreadyHave(_inv)) {
-                        AddTxAnnouncement(pfrom, _inv.hash, current_time);
+                        AddTxAnnouncement(g_txrequest, pfrom, _inv.hash, current_time);
                     }
                 }
                 AddOrphanTx(ptx, pfrom->GetId());
@@ -2137,6 +2192,86 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
     }
 
 
+    else if (strCommand == NetMsgType::MWEBTX)
+    {
+        // Same blocks-only rule as for ordinary transactions, and only from
+        // peers that negotiated MWEB transaction relay
+        if (pfrom->nVersion < MWEB_TX_VERSION ||
+            (!fRelayTxes && (!pfrom->fWhitelisted || !GetBoolArg("-whitelistrelay", DEFAULT_WHITELISTRELAY))))
+        {
+            LogPrint("net", "MWEB transaction sent in violation of protocol peer=%d\n", pfrom->id);
+            return true;
+        }
+
+        CMWEBTransaction tx;
+        vRecv >> tx;
+
+        CInv inv(MSG_MWEB_TX, tx.tx_hash);
+        pfrom->AddInventoryKnown(inv);
+
+        // The hash and the proofs do not depend on the chain, so check them
+        // before taking cs_main. A valid result goes into the verification
+        // cache, where AddMWEBTransaction finds it.
+        bool fBadHash = tx.tx_hash != tx.GetHash();
+        bool fVerified = !fBadHash && (mwebMempool.Exists(inv.hash) || VerifyMWEBTransaction(tx));
+
+        LOCK(cs_main);
+
+        // Mark the tx as received
+        g_mwebtxrequest.ReceivedResponse(pfrom->GetId(), inv.hash);
+
+        if (fBadHash) {
+            // The announced hash does not commit to the contents
+            LogPrint("mweb", "MWEB transaction %s from peer=%d has a bad hash\n", inv.hash.ToString(), pfrom->id);
+            Misbehaving(pfrom->GetId(), 100);
+            return true;
+        }
+
+        if (AlreadyHave(inv))
+            return true;
+
+        if (!fVerified) {
+            // Balance or range proofs do not hold, whatever the chain state
+            assert(recentRejects);
+            recentRejects->insert(inv.hash);
+            g_mwebtxrequest.ForgetTxHash(inv.hash);
+            LogPrint("mweb", "MWEB transaction %s from peer=%d has invalid proofs\n", inv.hash.ToString(), pfrom->id);
+            Misbehaving(pfrom->GetId(), 100);
+            return true;
+        }
+
+        // Only accept transactions spending confirmed outputs, so the pool
+        // cannot be filled with spends of outputs that do not exist.
+        bool fInputsAvailable = true;
+        for (const auto& input : tx.inputs) {
+            if (!pmwebcoinsTip->HaveCoin(input.output_commitment.commitment)) {
+                fInputsAvailable = false;
+                break;
+            }
+        }
+
+        if (!fInputsAvailable) {
+            // Most likely a child of an MWEB transaction that is not mined
+            // yet. Unlike a reject it may be requested again once announced
+            // after its inputs confirm.
+            g_mwebtxrequest.ForgetTxHash(inv.hash);
+            LogPrint("mweb", "MWEB transaction %s from peer=%d spends unconfirmed outputs, skipped\n", inv.hash.ToString(), pfrom->id);
+        } else if (mwebMempool.AddMWEBTransaction(tx)) {
+            g_mwebtxrequest.ForgetTxHash(inv.hash);
+            RelayMWEBTransaction(tx, connman);
+            LogPrint("mweb", "AcceptToMWEBMempool: peer=%d: accepted %s (poolsz %u txn)\n",
+                pfrom->id, inv.hash.ToString(), mwebMempool.Size());
+        } else {
+            // Conflicting or paying too little to stay in a full pool; do
+            // not request it again until the tip changes.
+            assert(recentRejects);
+            recentRejects->insert(inv.hash);
+            g_mwebtxrequest.ForgetTxHash(inv.hash);
+            LogPrint("mweb", "MWEB transaction %s from peer=%d was not accepted\n", inv.hash.ToString(), pfrom->id);
+        }
+    }
+
+
     else if (strCommand == NetMsgType::CMPCTBLOCK && !fImporting && !fReindex) // Ignore blocks received while importing
     {
         CBlockHeaderAndShortTxIDs cmpctblock;
@@ -2222,13 +2357,17 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
 
         // We want to be a bit conservative just to be extra careful about DoS
         // possibilities in compact block processing...
-        if (pindex->nHeight <= chainActive.Height() + 2) {
+        // A compact block with an MWEB extension the peer's version cannot
+        // encode is treated like a block far ahead of us, so it is fetched
+        // whole. Blocks without one reconstruct as with any BIP152 peer.
+        bool fMWEBUnencodable = !CompactBlocksHaveMWEB(pfrom->nVersion) && cmpctblock.HasMWEB();
+        if (pindex->nHeight <= chainActive.Height() + 2 && !fMWEBUnencodable) {
             if ((!fAlreadyInFlight && nodestate->nBlocksInFlight < MAX_BLOCKS_IN_TRANSIT_PER_PEER) ||
                  (fAlreadyInFlight && blockInFlightIt->second.first == pfrom->GetId())) {
                 std::list<QueuedBlock>::iterator* queuedBlockIt = NULL;
                 if (!MarkBlockAsInFlight(pfrom->GetId(), pindex->GetBlockHash(), chainparams.GetConsensus(pindex->nHeight), pindex, &queuedBlockIt)) {
                     if (!(*queuedBlockIt)->partialBlock)
-                        (*queuedBlockIt)->partialBlock.reset(new PartiallyDownloadedBlock(&mempool));
+                        (*queuedBlockIt)->partialBlock.reset(new PartiallyDownloadedBlock(&mempool, &mwebMempool));
                     else {
                         // The block was already in flight using compact blocks from the same peer
                         LogPrint("net", "Peer sent us compact block we were already syncing!\n");
@@ -2256,7 +2395,11 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                     if (!partialBlock.IsTxAvailable(i))
                         req.indexes.push_back(i);
                 }
-                if (req.indexes.empty()) {
+                for (size_t i = 0; i < cmpctblock.MWEBTxCount(); i++) {
+                    if (!partialBlock.IsMWEBTxAvailable(i))
+                        req.mweb_indexes.push_back(i);
+                }
+                if (req.indexes.empty() && req.mweb_indexes.empty()) {
                     // Dirty hack to jump to BLOCKTXN code (TODO: move message handling into their own functions)
                     BlockTransactions txn;
                     txn.blockhash = cmpctblock.header.GetHash();
@@ -2272,7 +2415,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                 // download from.
                 // Optimistically try to reconstruct anyway since we might be
                 // able to without any round trips.
-                PartiallyDownloadedBlock tempBlock(&mempool);
+                PartiallyDownloadedBlock tempBlock(&mempool, &mwebMempool);
                 ReadStatus status = tempBlock.InitData(cmpctblock, vExtraTxnForCompact);
                 if (status != READ_STATUS_OK) {
                     // TODO: don't ignore failures
@@ -2287,7 +2430,8 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
         } else {
             if (fAlreadyInFlight) {
                 // We requested this block, but its far into the future, so our
-                // mempool will probably be useless - request the block normally
+                // mempool will probably be useless (or the peer cannot encode
+                // its MWEB extension) - request the block normally
                 std::vector<CInv> vInv(1);
                 vInv[0] = CInv(MSG_BLOCK | GetFetchFlags(pfrom, pindex->pprev, chainparams.GetConsensus(pindex->pprev->nHeight)), cmpctblock.header.GetHash());
                 connman.PushMessage(pfrom, msgMaker.Make(NetMsgType::GETDATA, vInv));
@@ -2351,7 +2495,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
             }
 
             PartiallyDownloadedBlock& partialBlock = *it->second.second->partialBlock;
-            ReadStatus status = partialBlock.FillBlock(*pblock, resp.txn);
+            ReadStatus status = partialBlock.FillBlock(*pblock, resp.txn, resp.mweb_txn);
             if (status == READ_STATUS_INVALID) {
                 MarkBlockAsReceived(resp.blockhash); // Reset in-flight state in case of whitelist
                 Misbehaving(pfrom->GetId(), 100);
@@ -2795,6 +2939,8 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                     // If we receive a NOTFOUND message for a txid we requested, we
                     // mark the announcement as completed in TxRequestTracker.
                     g_txrequest.ReceivedResponse(pfrom->GetId(), inv.hash);
+                } else if (inv.type == MSG_MWEB_TX) {
+                    g_mwebtxrequest.ReceivedResponse(pfrom->GetId(), inv.hash);
                 }
             }
         }
@@ -2987,6 +3133,23 @@ public:
     }
 };
 
+class CompareInvMWEBMempoolOrder
+{
+    const CMWEBMempool *mp;
+public:
+    CompareInvMWEBMempoolOrder(const CMWEBMempool *_mempool)
+    {
+        mp = _mempool;
+    }
+
+    bool operator()(std::set<uint256>::iterator a, std::set<uint256>::iterator b)
+    {
+        /* As std::make_heap produces a max-heap, we want the entries with the
+         * highest fee rate to sort later. */
+        return mp->CompareFeeRate(*b, *a);
+    }
+};
+
 bool SendMessages(CNode* pto, CConnman& connman, const std::atomic<bool>& interruptMsgProc)
 {
     const Consensus::Params& consensusParams = Params().GetConsensus(chainActive.Height());
@@ -3177,7 +3340,7 @@ bool SendMessages(CNode* pto, CConnman& connman, const std::atomic<bool>& interr
                 }
             }
             if (!fRevertToInv && !vHeaders.empty()) {
-                if (vHeaders.size() == 1 && state.fPreferHeaderAndIDs) {
+                if (vHeaders.size() == 1 && state.fPreferHeaderAndIDs && CanSendCompactBlock(pto, !pBestIndex->hashMWEBExtension.IsNull())) {
                     // We only send up to 1 block as header-and-ids, as otherwise
                     // probably means we're doing an initial-ish-sync or they're slow
                     LogPrint("net", "%s sending header-and-ids %s to peer=%d\n", __func__,
@@ -3279,7 +3442,10 @@ bool SendMessages(CNode* pto, CConnman& connman, const std::atomic<bool>& interr
             // Time to send but the peer has requested we not relay transactions.
             if (fSendTrickle) {
                 LOCK(pto->cs_filter);
-                if (!pto->fRelayTxes) pto->setInventoryTxToSend.clear();
+                if (!pto->fRelayTxes) {
+                    pto->setInventoryTxToSend.clear();
+                    pto->setInventoryMWEBTxToSend.clear();
+                }
             }
 
             // Respond to BIP35 mempool requests
@@ -3379,6 +3545,36 @@ bool SendMessages(CNode* pto, CConnman& connman, const std::atomic<bool>& interr
                     }
                     pto->filterInventoryKnown.insert(hash);
                 }
+
+                // MWEB transactions share the broadcast budget; they carry no
+                // ancestry, so announce the best paying ones first.
+                std::vector<std::set<uint256>::iterator> vInvMWEBTx;
+                vInvMWEBTx.reserve(pto->setInventoryMWEBTxToSend.size());
+                for (std::set<uint256>::iterator it = pto->setInventoryMWEBTxToSend.begin(); it != pto->setInventoryMWEBTxToSend.end(); it++) {
+                    vInvMWEBTx.push_back(it);
+                }
+                CompareInvMWEBMempoolOrder compareInvMWEBMempoolOrder(&mwebMempool);
+                std::make_heap(vInvMWEBTx.begin(), vInvMWEBTx.end(), compareInvMWEBMempoolOrder);
+                while (!vInvMWEBTx.empty() && nRelayedTransactions < INVENTORY_BROADCAST_MAX) {
+                    std::pop_heap(vInvMWEBTx.begin(), vInvMWEBTx.end(), compareInvMWEBMempoolOrder);
+                    std::set<uint256>::iterator it = vInvMWEBTx.back();
+                    vInvMWEBTx.pop_back();
+                    uint256 hash = *it;
+                    pto->setInventoryMWEBTxToSend.erase(it);
+                    if (pto->filterInventoryKnown.contains(hash)) {
+                        continue;
+                    }
+                    if (!mwebMempool.Exists(hash)) {
+                        continue;
+                    }
+                    vInv.push_back(CInv(MSG_MWEB_TX, hash));
+                    nRelayedTransactions++;
+                    if (vInv.size() == MAX_INV_SZ) {
+                        connman.PushMessage(pto, msgMaker.Make(NetMsgType::INV, vInv));
+                        vInv.clear();
+                    }
+                    pto->filterInventoryKnown.insert(hash);
+                }
             }
         }
         if (!vInv.empty())
@@ -3492,6 +3688,25 @@ bool SendMessages(CNode* pto, CConnman& connman, const std::atomic<bool>& interr
             }
         }
 
+        requestable = g_mwebtxrequest.GetRequestable(pto->GetId(), current_time, &expired);
+        for (const auto& entry : expired) {
+            LogPrint("net", "timeout of inflight MWEB tx %s from peer=%d\n", entry.second.ToString(), entry.first);
+        }
+        for (const uint256& txhash : requestable) {
+            CInv inv(MSG_MWEB_TX, txhash);
+            if (!AlreadyHave(inv)) {
+                LogPrint("net", "Requesting %s peer=%d\n", inv.ToString(), pto->GetId());
+                vGetData.emplace_back(inv);
+                if (vGetData.size() >= MAX_GETDATA_SZ) {
+                    connman.PushMessage(pto, msgMaker.Make(NetMsgType::GETDATA, vGetData));
+                    vGetData.clear();
+                }
+                g_mwebtxrequest.RequestedTx(pto->GetId(), txhash, current_time + GETDATA_TX_INTERVAL);
+            } else {
+                g_mwebtxrequest.ForgetTxHash(txhash);
+            }
+        }
+
 
         if (!vGetData.empty())
             connman.PushMessage(pto, msgMaker.Make(NetMsgType::GETDATA, vGetData));
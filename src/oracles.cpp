@@ -0,0 +1,265 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "oracles.h"
+
+#include "blockmarkers.h"
+
+#include <assert.h>
+
+bool COracleView::GetOracle(const CPubKey& pubkey, COracleNode& oracle) const { return false; }
+bool COracleView::GetVerification(const uint256& record_id, CVerificationEntry& entry) const { return false; }
+uint256 COracleView::GetBestBlock() const { return uint256(); }
+void COracleView::LoadSampler(COracleSampler& sampler) const { }
+bool COracleView::BatchWrite(COracleMap& mapOracles, CVerificationMap& mapVerifications, const uint256& hashBlock) { return false; }
+
+namespace {
+
+size_t OracleUsage(const COracleNode& oracle)
+{
+    return memusage::MallocUsage(oracle.node_address.capacity());
+}
+
+} // anon namespace
+
+COracleViewCache::COracleViewCache(COracleView* baseIn) : base(baseIn), cachedUsage(0), fSamplerLoaded(false) { }
+
+size_t COracleViewCache::DynamicMemoryUsage() const {
+    return memusage::DynamicUsage(cacheOracles) + memusage::DynamicUsage(cacheVerifications) + cachedUsage;
+}
+
+COracleMap::iterator COracleViewCache::FetchOracle(const CPubKey& pubkey) const {
+    COracleMap::iterator it = cacheOracles.find(pubkey);
+    if (it != cacheOracles.end())
+        return it;
+    COracleNode tmp;
+    if (!base->GetOracle(pubkey, tmp))
+        return cacheOracles.end();
+    COracleMap::iterator ret = cacheOracles.insert(std::make_pair(pubkey, COracleCacheEntry())).first;
+    ret->second.oracle = std::move(tmp);
+    cachedUsage += OracleUsage(ret->second.oracle);
+    return ret;
+}
+
+CVerificationMap::iterator COracleViewCache::FetchVerification(const uint256& record_id) const {
+    CVerificationMap::iterator it = cacheVerifications.find(record_id);
+    if (it != cacheVerifications.end())
+        return it;
+    CVerificationEntry tmp;
+    if (!base->GetVerification(record_id, tmp))
+        return cacheVerifications.end();
+    CVerificationMap::iterator ret = cacheVerifications.insert(std::make_pair(record_id, CVerificationCacheEntry())).first;
+    ret->second.entry = std::move(tmp);
+    cachedUsage += ret->second.entry.DynamicMemoryUsage();
+    return ret;
+}
+
+const COracleNode* COracleViewCache::AccessOracle(const CPubKey& pubkey) const {
+    COracleMap::const_iterator it = FetchOracle(pubkey);
+    if (it == cacheOracles.end() || !it->second.oracle.pubkey.IsValid())
+        return NULL;
+    return &it->second.oracle;
+}
+
+const CVerificationEntry* COracleViewCache::AccessVerification(const uint256& record_id) const {
+    CVerificationMap::const_iterator it = FetchVerification(record_id);
+    if (it == cacheVerifications.end() || it->second.entry.IsNull())
+        return NULL;
+    return &it->second.entry;
+}
+
+bool COracleViewCache::GetOracle(const CPubKey& pubkey, COracleNode& oracle) const {
+    const COracleNode* poracle = AccessOracle(pubkey);
+    if (!poracle)
+        return false;
+    oracle = *poracle;
+    return true;
+}
+
+bool COracleViewCache::GetVerification(const uint256& record_id, CVerificationEntry& entry) const {
+    const CVerificationEntry* pentry = AccessVerification(record_id);
+    if (!pentry)
+        return false;
+    entry = *pentry;
+    return true;
+}
+
+void COracleViewCache::SetOracle(const CPubKey& pubkey, const COracleNode& oracle) {
+    COracleMap::iterator it = FetchOracle(pubkey);
+    if (it == cacheOracles.end()) {
+        it = cacheOracles.insert(std::make_pair(pubkey, COracleCacheEntry())).first;
+    }
+    cachedUsage -= OracleUsage(it->second.oracle);
+    it->second.oracle = oracle;
+    it->second.flags |= COracleCacheEntry::DIRTY;
+    cachedUsage += OracleUsage(it->second.oracle);
+    UpdateSampler(pubkey, oracle);
+}
+
+void COracleViewCache::SetVerification(const uint256& record_id, const CVerificationEntry& entry) {
+    CVerificationMap::iterator it = FetchVerification(record_id);
+    if (it == cacheVerifications.end()) {
+        it = cacheVerifications.insert(std::make_pair(record_id, CVerificationCacheEntry())).first;
+    }
+    cachedUsage -= it->second.entry.DynamicMemoryUsage();
+    it->second.entry = entry;
+    it->second.flags |= CVerificationCacheEntry::DIRTY;
+    cachedUsage += it->second.entry.DynamicMemoryUsage();
+}
+
+uint256 COracleViewCache::GetBestBlock() const {
+    if (hashBlock.IsNull())
+        hashBlock = base->GetBestBlock();
+    return hashBlock;
+}
+
+void COracleViewCache::SetBestBlock(const uint256& hashBlockIn) {
+    hashBlock = hashBlockIn;
+}
+
+bool COracleViewCache::BatchWrite(COracleMap& mapOracles, CVerificationMap& mapVerifications, const uint256& hashBlockIn) {
+    for (COracleMap::iterator it = mapOracles.begin(); it != mapOracles.end();) {
+        if (it->second.flags & COracleCacheEntry::DIRTY) { // Ignore non-dirty entries (optimization).
+            COracleCacheEntry& entry = cacheOracles[it->first];
+            cachedUsage -= OracleUsage(entry.oracle);
+            entry.oracle = std::move(it->second.oracle);
+            entry.flags |= COracleCacheEntry::DIRTY;
+            cachedUsage += OracleUsage(entry.oracle);
+            UpdateSampler(it->first, entry.oracle);
+        }
+        COracleMap::iterator itOld = it++;
+        mapOracles.erase(itOld);
+    }
+    for (CVerificationMap::iterator it = mapVerifications.begin(); it != mapVerifications.end();) {
+        if (it->second.flags & CVerificationCacheEntry::DIRTY) {
+            CVerificationCacheEntry& entry = cacheVerifications[it->first];
+            cachedUsage -= entry.entry.DynamicMemoryUsage();
+            entry.entry = std::move(it->second.entry);
+            entry.flags |= CVerificationCacheEntry::DIRTY;
+            cachedUsage += entry.entry.DynamicMemoryUsage();
+        }
+        CVerificationMap::iterator itOld = it++;
+        mapVerifications.erase(itOld);
+    }
+    hashBlock = hashBlockIn;
+    return true;
+}
+
+void COracleViewCache::UpdateSampler(const CPubKey& pubkey, const COracleNode& oracle) const {
+    // Registrations, stake changes and deactivations all go through here
+    if (!fSamplerLoaded)
+        return;
+    if (oracle.pubkey.IsValid())
+        sampler.Update(oracle);
+    else
+        sampler.SetStake(pubkey, 0);
+}
+
+COracleSampler& COracleViewCache::GetSampler() const {
+    if (!fSamplerLoaded) {
+        base->LoadSampler(sampler);
+        fSamplerLoaded = true;
+        for (const auto& entry : cacheOracles)
+            UpdateSampler(entry.first, entry.second.oracle);
+    }
+    return sampler;
+}
+
+void COracleViewCache::LoadSampler(COracleSampler& samplerOut) const {
+    samplerOut = GetSampler();
+}
+
+std::vector<COracleNode> COracleViewCache::SelectOracles(const uint256& hashBlockIn, const uint256& txid, uint32_t count) const {
+    std::vector<COracleNode> selected;
+    for (const CPubKey& pubkey : GetSampler().Select(hashBlockIn, txid, count)) {
+        const COracleNode* oracle = AccessOracle(pubkey);
+        assert(oracle);
+        selected.push_back(*oracle);
+    }
+    return selected;
+}
+
+bool COracleViewCache::Flush() {
+    bool fOk = base->BatchWrite(cacheOracles, cacheVerifications, hashBlock);
+    cacheOracles.clear();
+    cacheVerifications.clear();
+    cachedUsage = 0;
+    return fOk;
+}
+
+unsigned int COracleViewCache::GetCacheSize() const {
+    return cacheOracles.size() + cacheVerifications.size();
+}
+
+VerificationStatus GetContributionVerificationStatus(const COracleView* view, const CContributionTransaction& contrib)
+{
+    CVerificationEntry entry;
+    if (view && view->GetVerification(contrib.proof_data.hash, entry)) {
+        if (!entry.record.contrib_tx_id.IsNull() && entry.record.contrib_tx_id != contrib.tx_id)
+            return VERIFICATION_REJECTED;
+    }
+    // The stake of an oracle is only declared, so oracle votes must not
+    // decide the status yet
+    return CContributionVerifier::CreateVerificationRecord(contrib).verification_status;
+}
+
+bool HasOracleUpdates(const CBlockMarkers& markers)
+{
+    return !markers.contributions.empty() || !markers.oracle_registrations.empty();
+}
+
+namespace {
+
+void UpdateOracle(COracleViewCache& view, COracleBlockUndo& undo, const CPubKey& pubkey, const COracleNode& oracle)
+{
+    const COracleNode* pprev = view.AccessOracle(pubkey);
+    undo.vOracles.emplace_back(pubkey, pprev ? *pprev : COracleNode());
+    view.SetOracle(pubkey, oracle);
+}
+
+void UpdateVerification(COracleViewCache& view, COracleBlockUndo& undo, const uint256& record_id, const CVerificationEntry& entry)
+{
+    const CVerificationEntry* pprev = view.AccessVerification(record_id);
+    undo.vVerifications.emplace_back(record_id, pprev ? *pprev : CVerificationEntry());
+    view.SetVerification(record_id, entry);
+}
+
+} // anon namespace
+
+void UpdateOracleState(const CBlockMarkers& markers, COracleViewCache& view, COracleBlockUndo& undo, int64_t nTime)
+{
+    for (const auto& registration : markers.oracle_registrations) {
+        COracleNode oracle;
+        view.GetOracle(registration.pubkey, oracle);
+        // Registrations apply in sequence, replays of older ones are ignored
+        if (registration.sequence <= oracle.registration_sequence)
+            continue;
+        oracle.registration_sequence = registration.sequence;
+        oracle.pubkey = registration.pubkey;
+        oracle.node_address = registration.node_address;
+        oracle.stake_fc = registration.stake_fc;
+        oracle.is_active = registration.is_active;
+        UpdateOracle(view, undo, registration.pubkey, oracle);
+    }
+
+    for (const auto& contrib : markers.contributions) {
+        const uint256& record_id = contrib.proof_data.hash;
+        // The first contribution with a proof claims it
+        if (view.AccessVerification(record_id))
+            continue;
+        CVerificationEntry entry;
+        entry.record = CContributionVerifier::CreateVerificationRecord(contrib);
+        entry.record.verification_timestamp = nTime;
+        UpdateVerification(view, undo, record_id, entry);
+    }
+}
+
+void DisconnectOracleState(COracleViewCache& view, const COracleBlockUndo& undo)
+{
+    // Restore in reverse order, so the state from before the block wins
+    for (auto it = undo.vVerifications.rbegin(); it != undo.vVerifications.rend(); ++it)
+        view.SetVerification(it->first, it->second);
+    for (auto it = undo.vOracles.rbegin(); it != undo.vOracles.rend(); ++it)
+        view.SetOracle(it->first, it->second);
+}
@@ -0,0 +1,214 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef FLEETCREDITS_ORACLES_H
+#define FLEETCREDITS_ORACLES_H
+
+#include "coins.h"
+#include "memusage.h"
+#include "primitives/verification.h"
+#include "pubkey.h"
+#include "serialize.h"
+#include "uint256.h"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <boost/unordered_map.hpp>
+
+class CBlockMarkers;
+
+/** The verification record of a proof, created by the contribution claiming it */
+class CVerificationEntry
+{
+public:
+    CVerificationRecord record;
+
+    ADD_SERIALIZE_METHODS;
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(record);
+    }
+
+    //! An entry without record id stands for a record that does not exist
+    bool IsNull() const { return record.record_id.IsNull(); }
+
+    size_t DynamicMemoryUsage() const {
+        return memusage::DynamicUsage(record.view_key);
+    }
+};
+
+/** What a block changed in the oracle state, to restore it on disconnect */
+class COracleBlockUndo
+{
+public:
+    //! State before the block of the oracles and records it changed, in the
+    //! order they were changed; null where they did not exist
+    std::vector<std::pair<CPubKey, COracleNode> > vOracles;
+    std::vector<std::pair<uint256, CVerificationEntry> > vVerifications;
+
+    ADD_SERIALIZE_METHODS;
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(vOracles);
+        READWRITE(vVerifications);
+    }
+};
+
+struct COracleCacheEntry
+{
+    COracleNode oracle; // Null (invalid pubkey) once removed
+    unsigned char flags;
+
+    enum Flags {
+        DIRTY = (1 << 0), // This cache entry is potentially different from the version in the parent view.
+    };
+
+    COracleCacheEntry() : flags(0) {}
+};
+
+struct CVerificationCacheEntry
+{
+    CVerificationEntry entry; // Null once removed
+    unsigned char flags;
+
+    enum Flags {
+        DIRTY = (1 << 0), // This cache entry is potentially different from the version in the parent view.
+    };
+
+    CVerificationCacheEntry() : flags(0) {}
+};
+
+typedef std::map<CPubKey, COracleCacheEntry> COracleMap;
+typedef boost::unordered_map<uint256, CVerificationCacheEntry, SaltedTxidHasher> CVerificationMap;
+
+/**
+ * Abstract view on the oracle registry and the verification records of
+ * contributions, see CCoinsView.
+ */
+class COracleView
+{
+public:
+    //! Retrieve a registered oracle
+    virtual bool GetOracle(const CPubKey& pubkey, COracleNode& oracle) const;
+
+    //! Retrieve the verification record with the given id (a proof hash)
+    virtual bool GetVerification(const uint256& record_id, CVerificationEntry& entry) const;
+
+    //! Retrieve the block hash whose state this view currently represents
+    virtual uint256 GetBestBlock() const;
+
+    //! Add all registered oracles to sampler, see COracleSampler::Update
+    virtual void LoadSampler(COracleSampler& sampler) const;
+
+    //! Do a bulk modification (multiple oracle and record changes + BestBlock change).
+    //! The passed maps can be modified.
+    virtual bool BatchWrite(COracleMap& mapOracles, CVerificationMap& mapVerifications, const uint256& hashBlock);
+
+    //! As we use COracleViews polymorphically, have a virtual destructor
+    virtual ~COracleView() {}
+};
+
+/** COracleView that adds a write-back memory cache to another COracleView */
+class COracleViewCache : public COracleView
+{
+protected:
+    COracleView* base;
+
+    /**
+     * Make mutable so that we can "fill the cache" even from Get-methods
+     * declared as "const".
+     */
+    mutable uint256 hashBlock;
+    mutable COracleMap cacheOracles;
+    mutable CVerificationMap cacheVerifications;
+
+    /* Cached dynamic memory usage for the inner oracle and record objects. */
+    mutable size_t cachedUsage;
+
+    /* Stakes of all eligible oracles, loaded from base when first needed and kept up to date after. */
+    mutable COracleSampler sampler;
+    mutable bool fSamplerLoaded;
+
+public:
+    COracleViewCache(COracleView* baseIn);
+
+    // Standard COracleView methods
+    bool GetOracle(const CPubKey& pubkey, COracleNode& oracle) const;
+    bool GetVerification(const uint256& record_id, CVerificationEntry& entry) const;
+    uint256 GetBestBlock() const;
+    void SetBestBlock(const uint256& hashBlock);
+    bool BatchWrite(COracleMap& mapOracles, CVerificationMap& mapVerifications, const uint256& hashBlock);
+    void LoadSampler(COracleSampler& sampler) const;
+
+    /** Return a pointer to the oracle in the cache, or NULL if not registered. */
+    const COracleNode* AccessOracle(const CPubKey& pubkey) const;
+
+    /** Return a pointer to the record in the cache, or NULL if not found. */
+    const CVerificationEntry* AccessVerification(const uint256& record_id) const;
+
+    /** Register or update an oracle; a null oracle removes it. */
+    void SetOracle(const CPubKey& pubkey, const COracleNode& oracle);
+
+    /** Add or update a verification record; a null entry removes it. */
+    void SetVerification(const uint256& record_id, const CVerificationEntry& entry);
+
+    /**
+     * Select count oracles to verify a contribution, see COracleSampler::Select.
+     * Returns nothing if fewer than count oracles are eligible.
+     */
+    std::vector<COracleNode> SelectOracles(const uint256& hashBlock, const uint256& txid, uint32_t count = 5) const;
+
+    /**
+     * Push the modifications applied to this cache to its base.
+     * Failure to call this method before destruction will cause the changes to be forgotten.
+     * If false is returned, the state of this cache (and its backing view) will be undefined.
+     */
+    bool Flush();
+
+    //! Calculate the size of the cache (in number of oracles and records)
+    unsigned int GetCacheSize() const;
+
+    //! Calculate the size of the cache (in bytes)
+    size_t DynamicMemoryUsage() const;
+
+private:
+    COracleMap::iterator FetchOracle(const CPubKey& pubkey) const;
+    void UpdateSampler(const CPubKey& pubkey, const COracleNode& oracle) const;
+    COracleSampler& GetSampler() const;
+    CVerificationMap::iterator FetchVerification(const uint256& record_id) const;
+
+    /**
+     * By making the copy constructor private, we prevent accidentally using it when one intends to create a cache on top of a base cache.
+     */
+    COracleViewCache(const COracleViewCache&);
+};
+
+/**
+ * Verification status of a contribution in the state of view, as the block
+ * subsidy counts it: that of a new record (see CreateVerificationRecord), so
+ * types that need oracle consensus stay pending. A proof already claimed by
+ * another contribution counts as rejected. Oracle votes are not part of the
+ * state: they cannot decide anything until oracle stake is bonded to a
+ * locked output.
+ */
+VerificationStatus GetContributionVerificationStatus(const COracleView* view, const CContributionTransaction& contrib);
+
+/** Whether the markers of a block change the oracle state, and so have undo data */
+bool HasOracleUpdates(const CBlockMarkers& markers);
+
+/**
+ * Apply the oracle registrations and contributions of a block, in that
+ * order. A registration only applies if its sequence number is higher than
+ * that of the last one applied for the oracle. The first contribution with a
+ * proof creates the record of that proof and claims it. nTime is the block
+ * time, used as the verification timestamp.
+ */
+void UpdateOracleState(const CBlockMarkers& markers, COracleViewCache& view, COracleBlockUndo& undo, int64_t nTime);
+
+/** Revert UpdateOracleState using the undo data of the block. */
+void DisconnectOracleState(COracleViewCache& view, const COracleBlockUndo& undo);
+
+#endif // FLEETCREDITS_ORACLES_H
@@ -15,6 +15,8 @@
 
 #include "primitives/mweb.h"
 
+class CBlockMarkers;
+
 /** Nodes collect new transactions into a block, hash them into a hash tree,
  * and scan through nonce values to make the block's hash satisfy proof-of-work
  * requirements.  When they solve the proof-of-work, they broadcast the block
@@ -75,6 +77,7 @@ public:
 
     // memory only
     mutable bool fChecked;
+    mutable std::shared_ptr<const CBlockMarkers> markers; //!< see GetBlockMarkers
 
     CBlock()
     {
@@ -112,6 +115,7 @@ public:
         vtx.clear();
         mweb_extension.reset();
         fChecked = false;
+        markers.reset();
     }
 
     CBlockHeader GetBlockHeader() const
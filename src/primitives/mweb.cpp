@@ -6,6 +6,7 @@
 
 #include "amount.h"
 #include "hash.h"
+#include "mweb_verifycache.h"
 #include "pubkey.h"
 #include "random.h"
 #include "uint256.h"
@@ -20,8 +21,7 @@
 
 #include <algorithm>
 #include <cstring>
-#include <map>
-#include <set>
+#include <limits>
 #include <string>
 #include <utility>
 #include <vector>
@@ -91,18 +91,16 @@ bool CMWEBTransaction::VerifyBalance() const
     // sum(input commitments) - sum(output commitments) - fee = excess
     // This is proven cryptographically via the kernel
     
-    secp256k1_pubkey sum_inputs = {};
-    secp256k1_pubkey sum_outputs = {};
-    // excess variable removed - not used in current implementation
-    
     secp256k1_context* ctx = GetMWEBContext();
     if (!ctx) {
         // Fallback: basic structure check
         return !inputs.empty() || !outputs.empty();
     }
     
-    // Initialize sum_inputs to point at infinity (0)
-    bool first_input = true;
+    // Parse every commitment once and fold them with a single combine, so
+    // that only the sum decides and not the order the points come in
+    std::vector<secp256k1_pubkey> points;
+    points.reserve(inputs.size() + outputs.size());
     for (const auto& input : inputs) {
         secp256k1_pubkey input_pubkey;
         if (!secp256k1_ec_pubkey_parse(ctx, &input_pubkey,
@@ -110,20 +108,10 @@ bool CMWEBTransaction::VerifyBalance() const
                                       input.output_commitment.commitment.size())) {
             return false;
         }
-        
-        if (first_input) {
-            sum_inputs = input_pubkey;
-            first_input = false;
-        } else {
-            const secp256k1_pubkey* pubkeys[] = {&sum_inputs, &input_pubkey};
-            if (!secp256k1_ec_pubkey_combine(ctx, &sum_inputs, pubkeys, 2)) {
-                return false;
-            }
-        }
+        points.push_back(input_pubkey);
     }
     
-    // Sum all output commitments
-    bool first_output = true;
+    // Outputs are negated (inputs - outputs)
     for (const auto& output : outputs) {
         secp256k1_pubkey output_pubkey;
         if (!secp256k1_ec_pubkey_parse(ctx, &output_pubkey,
@@ -131,28 +119,20 @@ bool CMWEBTransaction::VerifyBalance() const
                                       output.commitment.commitment.size())) {
             return false;
         }
-        
-        if (first_output) {
-            sum_outputs = output_pubkey;
-            first_output = false;
-        } else {
-            const secp256k1_pubkey* pubkeys[] = {&sum_outputs, &output_pubkey};
-            if (!secp256k1_ec_pubkey_combine(ctx, &sum_outputs, pubkeys, 2)) {
-                return false;
-            }
+        if (secp256k1_ec_pubkey_negate(ctx, &output_pubkey) != 1) {
+            return false;
         }
+        points.push_back(output_pubkey);
     }
     
-    // Negate sum_outputs (inputs - outputs)
-    secp256k1_pubkey negated_outputs = sum_outputs;
-    if (secp256k1_ec_pubkey_negate(ctx, &negated_outputs) != 1) {
-        return false;
+    // Combine: sum_inputs - sum_outputs, which fails if they cancel out
+    std::vector<const secp256k1_pubkey*> point_ptrs;
+    point_ptrs.reserve(points.size());
+    for (const auto& point : points) {
+        point_ptrs.push_back(&point);
     }
-    
-    // Combine: sum_inputs - sum_outputs
-    const secp256k1_pubkey* pubkeys[] = {&sum_inputs, &negated_outputs};
     secp256k1_pubkey net_commitment;
-    if (!secp256k1_ec_pubkey_combine(ctx, &net_commitment, pubkeys, 2)) {
+    if (!secp256k1_ec_pubkey_combine(ctx, &net_commitment, point_ptrs.data(), point_ptrs.size())) {
         return false;
     }
     
@@ -207,26 +187,40 @@ uint256 CMWEBExtensionBlock::GetHash() const
 }
 
 /** Verify all MWEB transactions in this block */
-bool CMWEBExtensionBlock::VerifyAll() const
+bool CMWEBExtensionBlock::VerifyAll(std::vector<CMWEBCheck>* pvChecks, bool fJustCheck) const
 {
     // Allow empty MWEB extension block (no transactions yet)
     if (mweb_txs.empty() && peg_ins.empty() && peg_outs.empty()) {
         return true;  // Empty block is valid
     }
     
-    // Verify all MWEB transactions (if any)
-    for (const auto& tx : mweb_txs) {
-        // Skip empty transactions (they might be placeholders)
-        if (tx.inputs.empty() && tx.outputs.empty()) {
+    // Verify all MWEB transactions (if any) that were not verified before,
+    // either inline or by handing fixed-size ranges of them to the caller's
+    // check queue
+    std::vector<bool> vVerified(mweb_txs.size());
+    for (size_t i = 0; i < mweb_txs.size(); i++) {
+        vVerified[i] = IsMWEBTransactionVerified(mweb_txs[i], !fJustCheck);
+    }
+    if (pvChecks) {
+        pvChecks->reserve(pvChecks->size() + (mweb_txs.size() + MWEB_CHECK_TXS - 1) / MWEB_CHECK_TXS);
+    }
+    size_t nBegin = 0;
+    while (nBegin < mweb_txs.size()) {
+        if (vVerified[nBegin]) {
+            nBegin++;
             continue;
         }
-        
-        if (!tx.VerifyBalance()) {
-            return false;
+        size_t nEnd = nBegin + 1;
+        while (nEnd < mweb_txs.size() && !vVerified[nEnd] && (!pvChecks || nEnd - nBegin < MWEB_CHECK_TXS)) {
+            nEnd++;
         }
-        if (!tx.VerifyRangeProofs()) {
+        CMWEBCheck check(mweb_txs, nBegin, nEnd);
+        if (pvChecks) {
+            pvChecks->push_back(check);
+        } else if (!check()) {
             return false;
         }
+        nBegin = nEnd;
     }
     
     // Verify peg-in transactions match main chain
@@ -268,6 +262,11 @@ bool CMWEBExtensionBlock::VerifyAll() const
     return true;
 }
 
+bool CMWEBCheck::operator()()
+{
+    return MWEB::VerifyTransactions(txs->begin() + nBegin, txs->begin() + nEnd);
+}
+
 /** MWEB Namespace Implementation */
 namespace MWEB {
 
@@ -481,63 +480,122 @@ bool VerifyRangeProof(const CRangeProof& proof, const CPedersenCommitment& commi
     return true;
 }
 
+/** Verify the balance and range proofs of the transactions in [first, last) */
+bool VerifyTransactions(std::vector<CMWEBTransaction>::const_iterator first,
+                        std::vector<CMWEBTransaction>::const_iterator last)
+{
+    for (auto it = first; it != last; ++it) {
+        const CMWEBTransaction& tx = *it;
+
+        // Skip empty transactions (they might be placeholders)
+        if (tx.inputs.empty() && tx.outputs.empty()) {
+            continue;
+        }
+
+        // Each transaction is checked on its own: whether a range balances
+        // as a whole depends on how VerifyAll split the block, and
+        // transactions that do not balance may offset each other
+        if (!tx.VerifyBalance()) {
+            return false;
+        }
+        if (!tx.VerifyRangeProofs()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 /** Calculate cut-through (remove intermediate outputs spent in same block) */
-CMWEBExtensionBlock CutThrough(const CMWEBExtensionBlock& block)
+void ApplyCutThrough(CMWEBExtensionBlock& block)
 {
-    CMWEBExtensionBlock cut_block = block;
-    
-    // Build a map of output commitments
-    std::map<CPubKey, size_t> output_commitments;
-    for (size_t i = 0; i < cut_block.mweb_txs.size(); i++) {
-        for (size_t j = 0; j < cut_block.mweb_txs[i].outputs.size(); j++) {
-            const CPubKey& commitment = cut_block.mweb_txs[i].outputs[j].commitment.commitment;
-            output_commitments[commitment] = i * 10000 + j;  // Encode tx and output index
+    std::vector<CMWEBTransaction>& txs = block.mweb_txs;
+
+    // Outputs of txs[i] are numbered from offsets[i] in a flat index
+    std::vector<uint32_t> offsets(txs.size() + 1, 0);
+    size_t nInputs = 0;
+    for (size_t i = 0; i < txs.size(); i++) {
+        offsets[i + 1] = offsets[i] + txs[i].outputs.size();
+        nInputs += txs[i].inputs.size();
+    }
+    const uint32_t nOutputs = offsets.back();
+    if (nOutputs == 0 || nInputs == 0)
+        return;
+
+    // Open-addressing table of (tx index, output index), kept at most half
+    // full. Commitments are hashed with a random salt so that crafted ones
+    // cannot degrade probing.
+    static const CSipHasher hasherSalted(GetRand(std::numeric_limits<uint64_t>::max()), GetRand(std::numeric_limits<uint64_t>::max()));
+    static const uint32_t EMPTY = std::numeric_limits<uint32_t>::max();
+    size_t nSlots = 1;
+    while (nSlots < 2 * (size_t)nOutputs)
+        nSlots <<= 1;
+    const size_t mask = nSlots - 1;
+    std::vector<std::pair<uint32_t, uint32_t> > table(nSlots, std::make_pair(EMPTY, EMPTY));
+
+    for (uint32_t i = 0; i < txs.size(); i++) {
+        for (uint32_t j = 0; j < txs[i].outputs.size(); j++) {
+            const CPubKey& commitment = txs[i].outputs[j].commitment.commitment;
+            size_t slot = CSipHasher(hasherSalted).Write(commitment.begin(), commitment.size()).Finalize() & mask;
+            while (table[slot].first != EMPTY &&
+                   txs[table[slot].first].outputs[table[slot].second].commitment.commitment != commitment) {
+                slot = (slot + 1) & mask;
+            }
+            // A repeated commitment keeps its first occurrence
+            if (table[slot].first == EMPTY)
+                table[slot] = std::make_pair(i, j);
         }
     }
-    
-    // Find inputs that match outputs in the same block
-    std::set<size_t> inputs_to_remove;
-    std::set<std::pair<size_t, size_t>> outputs_to_remove;  // (tx_index, output_index)
-    
-    for (size_t i = 0; i < cut_block.mweb_txs.size(); i++) {
-        for (size_t j = 0; j < cut_block.mweb_txs[i].inputs.size(); j++) {
-            const CPubKey& input_commitment = cut_block.mweb_txs[i].inputs[j].output_commitment.commitment;
-            
-            auto it = output_commitments.find(input_commitment);
-            if (it != output_commitments.end()) {
-                // This input matches an output in the same block
-                size_t encoded = it->second;
-                size_t output_tx_idx = encoded / 10000;
-                size_t output_idx = encoded % 10000;
-                
-                // Mark for removal
-                inputs_to_remove.insert(i * 10000 + j);
-                outputs_to_remove.insert(std::make_pair(output_tx_idx, output_idx));
+
+    // Drop inputs spending an output of this block, each output at most once,
+    // compacting the input vectors in place
+    std::vector<bool> spent(nOutputs, false);
+    for (auto& tx : txs) {
+        size_t nKeep = 0;
+        for (size_t j = 0; j < tx.inputs.size(); j++) {
+            const CPubKey& commitment = tx.inputs[j].output_commitment.commitment;
+            size_t slot = CSipHasher(hasherSalted).Write(commitment.begin(), commitment.size()).Finalize() & mask;
+            bool fCut = false;
+            while (table[slot].first != EMPTY) {
+                const std::pair<uint32_t, uint32_t>& entry = table[slot];
+                if (txs[entry.first].outputs[entry.second].commitment.commitment == commitment) {
+                    const uint32_t nFlat = offsets[entry.first] + entry.second;
+                    if (!spent[nFlat]) {
+                        spent[nFlat] = true;
+                        fCut = true;
+                    }
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+            if (!fCut) {
+                if (nKeep != j)
+                    tx.inputs[nKeep] = std::move(tx.inputs[j]);
+                nKeep++;
             }
         }
+        tx.inputs.resize(nKeep);
     }
-    
-    // Remove matching inputs and outputs
-    for (size_t i = 0; i < cut_block.mweb_txs.size(); i++) {
-        // Remove inputs
-        auto& inputs = cut_block.mweb_txs[i].inputs;
-        inputs.erase(
-            std::remove_if(inputs.begin(), inputs.end(),
-                [&](const CMWEBInput& input) {
-                    return inputs_to_remove.count(i * 10000 + (&input - &inputs[0])) > 0;
-                }),
-            inputs.end());
-        
-        // Remove outputs
-        auto& outputs = cut_block.mweb_txs[i].outputs;
-        outputs.erase(
-            std::remove_if(outputs.begin(), outputs.end(),
-                [&](const CMWEBOutput& output) {
-                    return outputs_to_remove.count(std::make_pair(i, &output - &outputs[0])) > 0;
-                }),
-            outputs.end());
+
+    // Compact the outputs, now that no lookup refers to them any more
+    for (size_t i = 0; i < txs.size(); i++) {
+        std::vector<CMWEBOutput>& outputs = txs[i].outputs;
+        size_t nKeep = 0;
+        for (size_t j = 0; j < outputs.size(); j++) {
+            if (spent[offsets[i] + j])
+                continue;
+            if (nKeep != j)
+                outputs[nKeep] = std::move(outputs[j]);
+            nKeep++;
+        }
+        outputs.resize(nKeep);
     }
-    
+}
+
+CMWEBExtensionBlock CutThrough(const CMWEBExtensionBlock& block)
+{
+    CMWEBExtensionBlock cut_block = block;
+    ApplyCutThrough(cut_block);
     return cut_block;
 }
 
@@ -9,6 +9,8 @@
 #include "serialize.h"
 #include "uint256.h"
 
+#include <algorithm>
+#include <memory>
 #include <vector>
 
 // Forward declaration
@@ -182,6 +184,10 @@ public:
     bool VerifyRangeProofs() const;
 };
 
+typedef std::shared_ptr<const CMWEBTransaction> CMWEBTransactionRef;
+static inline CMWEBTransactionRef MakeMWEBTransactionRef() { return std::make_shared<const CMWEBTransaction>(); }
+template <typename Tx> static inline CMWEBTransactionRef MakeMWEBTransactionRef(Tx&& txIn) { return std::make_shared<const CMWEBTransaction>(std::forward<Tx>(txIn)); }
+
 /** Peg-in Transaction
  * Moves FC from main chain to MWEB
  */
@@ -237,6 +243,35 @@ public:
     }
 };
 
+/** Closure representing the balance and range-proof checks of a contiguous
+ * range of transactions in an extension block, so that they can be run on
+ * a CCheckQueue like CScriptCheck.
+ * The referenced transactions must outlive the check.
+ */
+class CMWEBCheck
+{
+private:
+    const std::vector<CMWEBTransaction>* txs;
+    size_t nBegin;
+    size_t nEnd;
+
+public:
+    CMWEBCheck(): txs(NULL), nBegin(0), nEnd(0) {}
+    CMWEBCheck(const std::vector<CMWEBTransaction>& txsIn, size_t nBeginIn, size_t nEndIn) :
+        txs(&txsIn), nBegin(nBeginIn), nEnd(nEndIn) {}
+
+    bool operator()();
+
+    void swap(CMWEBCheck& check) {
+        std::swap(txs, check.txs);
+        std::swap(nBegin, check.nBegin);
+        std::swap(nEnd, check.nEnd);
+    }
+};
+
+/** Number of MWEB transactions covered by a single CMWEBCheck */
+static const size_t MWEB_CHECK_TXS = 8;
+
 /** MWEB Extension Block
  * Attaches to main chain block, contains MWEB transactions
  */
@@ -269,8 +304,16 @@ public:
     /** Calculate extension block hash */
     uint256 GetHash() const;
 
-    /** Verify all MWEB transactions in this block */
-    bool VerifyAll() const;
+    /** Verify all MWEB transactions in this block
+     * If pvChecks is not NULL, the per-transaction balance and range-proof
+     * checks are appended to it as CMWEBChecks instead of being run inline;
+     * only the peg-in/peg-out checks are done before returning.
+     * Transactions found in the MWEB verification cache are skipped. Their
+     * cache entries are dropped unless fJustCheck is set. Nothing is added to
+     * the cache here: only the mempool does, for transactions it verified
+     * on their own.
+     */
+    bool VerifyAll(std::vector<CMWEBCheck>* pvChecks = NULL, bool fJustCheck = false) const;
 };
 
 /** View Key
@@ -315,9 +358,17 @@ namespace MWEB {
     /** Verify a range proof */
     bool VerifyRangeProof(const CRangeProof& proof, const CPedersenCommitment& commitment);
 
+    /** Verify the balance and range proofs of the transactions in [first, last) */
+    bool VerifyTransactions(std::vector<CMWEBTransaction>::const_iterator first,
+                            std::vector<CMWEBTransaction>::const_iterator last);
+
     /** Calculate cut-through (remove intermediate outputs spent in same block) */
     CMWEBExtensionBlock CutThrough(const CMWEBExtensionBlock& block);
 
+    /** Apply cut-through to block in place, in a single hashed pass over
+     * its outputs and inputs. Each output cancels at most one input. */
+    void ApplyCutThrough(CMWEBExtensionBlock& block);
+
 }
 
 #endif // FLEETCREDITS_PRIMITIVES_MWEB_H
@@ -10,7 +10,7 @@
 #include "util.h"
 
 #include <algorithm>
-#include <random>
+#include <limits>
 
 // TODO: GitHub API integration for code contribution verification
 // For now, we'll use placeholder logic
@@ -121,7 +121,7 @@ bool CContributionVerifier::VerifyCharitableAct(const CContributionTransaction&
         if (vote.vote_choice == VOTE_APPROVE) {
             approve_count++;
         }
-        if (vote.vote_choice != VOTE_ABSTAIN) {
+        if (vote.vote_choice != ORACLE_VOTE_ABSTAIN) {
             total_votes++;
         }
     }
@@ -140,8 +140,8 @@ CVerificationRecord CContributionVerifier::CreateVerificationRecord(const CContr
 {
     CVerificationRecord record;
     
-    // Generate record ID from contribution tx ID
-    record.record_id = contrib_tx.tx_id;
+    // Records are keyed by the proof, which only one contribution can claim
+    record.record_id = contrib_tx.proof_data.hash;
     record.contrib_tx_id = contrib_tx.tx_id;
     record.verification_timestamp = GetTime();
     record.verification_status = VERIFICATION_PENDING;
@@ -181,6 +181,40 @@ CVerificationRecord CContributionVerifier::CreateVerificationRecord(const CContr
     return record;
 }
 
+/** Hash signed by the oracle casting a vote */
+uint256 COracleVote::GetSignatureHash() const
+{
+    CHashWriter ss(SER_GETHASH, 0);
+    ss << oracle_pubkey;
+    ss << verification_record_id;
+    ss << static_cast<uint8_t>(vote_choice);
+    ss << vote_timestamp;
+    ss << vote_reason;
+    return ss.GetHash();
+}
+
+bool COracleVote::CheckSignature() const
+{
+    return oracle_pubkey.IsFullyValid() && oracle_pubkey.Verify(GetSignatureHash(), vote_signature);
+}
+
+/** Hash signed by the oracle registering */
+uint256 COracleRegistration::GetSignatureHash() const
+{
+    CHashWriter ss(SER_GETHASH, 0);
+    ss << pubkey;
+    ss << node_address;
+    ss << stake_fc;
+    ss << is_active;
+    ss << sequence;
+    return ss.GetHash();
+}
+
+bool COracleRegistration::CheckSignature() const
+{
+    return pubkey.IsFullyValid() && pubkey.Verify(GetSignatureHash(), signature);
+}
+
 /** Process oracle votes and update verification record */
 bool CContributionVerifier::ProcessOracleVotes(CVerificationRecord& record,
                                                const std::vector<COracleVote>& votes,
@@ -212,7 +246,7 @@ bool CContributionVerifier::ProcessOracleVotes(CVerificationRecord& record,
             reject_count++;
             total_votes++;
         }
-        // VOTE_ABSTAIN doesn't count toward total
+        // ORACLE_VOTE_ABSTAIN doesn't count toward total
     }
     
     // Update record
@@ -244,38 +278,144 @@ bool CContributionVerifier::ProcessOracleVotes(CVerificationRecord& record,
     return false;
 }
 
-/** Select random oracles for verification (3 of 5) */
-std::vector<COracleNode> CContributionVerifier::SelectRandomOracles(const std::vector<COracleNode>& all_oracles,
-                                                                     uint32_t count)
+CAmount COracleSampler::PrefixSum(size_t n) const
 {
-    std::vector<COracleNode> selected;
-    
-    // Filter to active oracles with sufficient stake
-    std::vector<COracleNode> eligible;
-    for (const auto& oracle : all_oracles) {
-        if (oracle.is_active && oracle.MeetsStakeRequirement()) {
-            eligible.push_back(oracle);
+    CAmount sum = 0;
+    for (; n > 0; n &= n - 1)
+        sum += vTree[n];
+    return sum;
+}
+
+void COracleSampler::AddStake(size_t slot, CAmount delta)
+{
+    for (size_t i = slot + 1; i < vTree.size(); i += i & (~i + 1))
+        vTree[i] += delta;
+}
+
+size_t COracleSampler::FindSlot(CAmount target) const
+{
+    size_t n = vTree.size() - 1;
+    size_t step = 1;
+    while (step * 2 <= n)
+        step *= 2;
+    size_t pos = 0;
+    for (; step > 0; step /= 2) {
+        if (pos + step <= n && vTree[pos + step] <= target) {
+            pos += step;
+            target -= vTree[pos];
         }
     }
-    
-    // Need at least 'count' eligible oracles
-    if (eligible.size() < count) {
-        return selected;  // Not enough oracles
+    return pos;
+}
+
+void COracleSampler::Rebuild()
+{
+    mapSlot.clear();
+    for (size_t i = 0; i < vSlots.size(); i++)
+        mapSlot[vSlots[i]] = i;
+
+    // Linear time construction
+    vTree.assign(vStake.size() + 1, 0);
+    for (size_t i = 1; i < vTree.size(); i++) {
+        vTree[i] += vStake[i - 1];
+        size_t parent = i + (i & (~i + 1));
+        if (parent < vTree.size())
+            vTree[parent] += vTree[i];
     }
-    
-    // Select random subset
-    // Use deterministic randomness based on block hash or contribution tx ID
-    // For now, use simple shuffle
-    std::vector<COracleNode> shuffled = eligible;
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::shuffle(shuffled.begin(), shuffled.end(), gen);
-    
-    // Take first 'count' oracles
-    for (size_t i = 0; i < count && i < shuffled.size(); i++) {
-        selected.push_back(shuffled[i]);
+}
+
+void COracleSampler::Compact()
+{
+    std::vector<CPubKey> vOldSlots;
+    std::vector<CAmount> vOldStake;
+    vOldSlots.swap(vSlots);
+    vOldStake.swap(vStake);
+    for (size_t i = 0; i < vOldSlots.size(); i++) {
+        if (vOldStake[i] > 0) {
+            vSlots.push_back(vOldSlots[i]);
+            vStake.push_back(vOldStake[i]);
+        }
     }
-    
-    return selected;
+    Rebuild();
+}
+
+void COracleSampler::SetStake(const CPubKey& oracle, CAmount stake)
+{
+    if (stake < 0)
+        stake = 0;
+
+    std::map<CPubKey, size_t>::iterator it = mapSlot.find(oracle);
+    if (it != mapSlot.end()) {
+        size_t slot = it->second;
+        if (vStake[slot] == 0 && stake > 0)
+            nEligible++;
+        else if (vStake[slot] > 0 && stake == 0)
+            nEligible--;
+        AddStake(slot, stake - vStake[slot]);
+        nTotalStake += stake - vStake[slot];
+        vStake[slot] = stake;
+        if (stake == 0 && vSlots.size() > 2 * nEligible + 16)
+            Compact();
+        return;
+    }
+    if (stake == 0)
+        return;
+
+    nEligible++;
+    nTotalStake += stake;
+    if (!vSlots.empty() && oracle < vSlots.back()) {
+        std::vector<CPubKey>::iterator pos = std::lower_bound(vSlots.begin(), vSlots.end(), oracle);
+        vStake.insert(vStake.begin() + (pos - vSlots.begin()), stake);
+        vSlots.insert(pos, oracle);
+        Rebuild();
+        return;
+    }
+
+    // Append: the new node covers the stakes of (n - lowbit(n), n]
+    if (vTree.empty())
+        vTree.push_back(0);
+    size_t n = vTree.size();
+    mapSlot[oracle] = vSlots.size();
+    vSlots.push_back(oracle);
+    vStake.push_back(stake);
+    vTree.push_back(stake + PrefixSum(n - 1) - PrefixSum(n - (n & (~n + 1))));
+}
+
+void COracleSampler::Update(const COracleNode& oracle)
+{
+    SetStake(oracle.pubkey, oracle.is_active && oracle.MeetsStakeRequirement() ? oracle.stake_fc : 0);
+}
+
+std::vector<CPubKey> COracleSampler::Select(const uint256& hashBlock, const uint256& txid, uint32_t count)
+{
+    std::vector<CPubKey> vSelected;
+    if (nEligible < count)
+        return vSelected;
+
+    // Draw without replacement by taking the stake of drawn oracles out of
+    // the tree, then putting it back
+    std::vector<size_t> vDrawn;
+    CAmount nRemaining = nTotalStake;
+    for (uint32_t i = 0; i < count; i++) {
+        // Draws at or above the largest multiple of nRemaining are retried,
+        // so that every target is equally likely
+        const uint64_t nRange = nRemaining;
+        const uint64_t nLimit = std::numeric_limits<uint64_t>::max() - std::numeric_limits<uint64_t>::max() % nRange;
+        uint64_t nDraw;
+        uint32_t nTry = 0;
+        do {
+            CHashWriter ss(SER_GETHASH, 0);
+            ss << hashBlock << txid << i << nTry++;
+            nDraw = ss.GetHash().GetCheapHash();
+        } while (nDraw >= nLimit);
+        size_t slot = FindSlot(nDraw % nRange);
+        vSelected.push_back(vSlots[slot]);
+        vDrawn.push_back(slot);
+        AddStake(slot, -vStake[slot]);
+        nRemaining -= vStake[slot];
+    }
+    for (size_t slot : vDrawn)
+        AddStake(slot, vStake[slot]);
+    return vSelected;
 }
 
@@ -12,6 +12,7 @@
 #include "uint256.h"
 #include "amount.h"
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -27,6 +28,7 @@ public:
     uint32_t incorrect_votes;
     bool is_active;
     uint64_t last_rotation_date;
+    uint32_t registration_sequence; // Sequence of the registration last applied
 
     COracleNode() 
         : stake_fc(0)
@@ -36,6 +38,7 @@ public:
         , incorrect_votes(0)
         , is_active(false)
         , last_rotation_date(0)
+        , registration_sequence(0)
     {}
 
     ADD_SERIALIZE_METHODS;
@@ -50,6 +53,7 @@ public:
         READWRITE(incorrect_votes);
         READWRITE(is_active);
         READWRITE(last_rotation_date);
+        READWRITE(registration_sequence);
     }
 
     /** Check if oracle meets minimum stake requirement */
@@ -64,11 +68,98 @@ public:
     }
 };
 
+/**
+ * Registration of an oracle, or an update of its address, stake or
+ * activity, signed by the oracle's key. Carried on chain after the marker
+ * 0xFC 0x05; the vote statistics of a registered oracle are kept by the
+ * registry and not part of a registration.
+ *
+ * Each registration of an oracle carries a higher sequence number than the
+ * one applied before it, starting at 1, so that an old signed registration
+ * cannot be replayed to restore an earlier stake or activity.
+ */
+class COracleRegistration {
+public:
+    CPubKey pubkey;
+    std::string node_address;
+    int64_t stake_fc;
+    bool is_active;
+    uint32_t sequence;
+    std::vector<unsigned char> signature;
+
+    COracleRegistration() : stake_fc(0), is_active(false), sequence(0) {}
+
+    ADD_SERIALIZE_METHODS;
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(pubkey);
+        READWRITE(node_address);
+        READWRITE(stake_fc);
+        READWRITE(is_active);
+        READWRITE(sequence);
+        READWRITE(signature);
+    }
+
+    /** Hash signed by the oracle: everything but the signature */
+    uint256 GetSignatureHash() const;
+
+    /** Check signature against pubkey */
+    bool CheckSignature() const;
+};
+
+/**
+ * Stake-weighted sampling of oracles, for selecting the verifiers of a
+ * contribution deterministically.
+ *
+ * The stakes of the oracles are kept in a Fenwick tree, in pubkey order, so
+ * that changing a stake and drawing an oracle are both O(log n); a new
+ * oracle is O(log n) as well when it sorts last and O(n) otherwise. An
+ * oracle whose stake drops to zero keeps its slot as a hole that weighs
+ * nothing; holes are compacted away once they make up half the tree. Draws
+ * therefore only depend on the stakes, not on the order of the updates.
+ */
+class COracleSampler {
+private:
+    std::vector<CPubKey> vSlots;     //!< Oracle of each slot, sorted
+    std::vector<CAmount> vStake;     //!< Stake of each slot, zero for holes
+    std::vector<CAmount> vTree;      //!< Fenwick tree over vStake, 1-based
+    std::map<CPubKey, size_t> mapSlot;
+    size_t nEligible;
+    CAmount nTotalStake;
+
+    CAmount PrefixSum(size_t n) const;
+    void AddStake(size_t slot, CAmount delta);
+    /** First slot whose cumulative stake exceeds target */
+    size_t FindSlot(CAmount target) const;
+    /** Rebuild the tree and slot index from vSlots and vStake */
+    void Rebuild();
+    void Compact();
+
+public:
+    COracleSampler() : nEligible(0), nTotalStake(0) {}
+
+    /** Set the stake of an oracle, adding it if new; zero removes it */
+    void SetStake(const CPubKey& oracle, CAmount stake);
+    /** Track an oracle, which counts with its stake while eligible */
+    void Update(const COracleNode& oracle);
+
+    size_t size() const { return nEligible; }
+    CAmount GetTotalStake() const { return nTotalStake; }
+
+    /**
+     * Draw count distinct oracles, each with probability proportional to
+     * its stake among those not drawn yet, seeded by the block hash and the
+     * contribution's txid. Returns nothing if there are fewer than count
+     * oracles. Leaves the sampler as it was.
+     */
+    std::vector<CPubKey> Select(const uint256& hashBlock, const uint256& txid, uint32_t count);
+};
+
 /** Oracle vote on a contribution */
 enum OracleVoteChoice {
     VOTE_APPROVE = 0x01,
     VOTE_REJECT = 0x02,
-    VOTE_ABSTAIN = 0x03
+    ORACLE_VOTE_ABSTAIN = 0x03
 };
 
 class COracleVote {
@@ -82,7 +173,7 @@ public:
     std::string vote_reason;
 
     COracleVote()
-        : vote_choice(VOTE_ABSTAIN)
+        : vote_choice(ORACLE_VOTE_ABSTAIN)
         , vote_timestamp(0)
     {
         vote_id.SetNull();
@@ -95,11 +186,21 @@ public:
         READWRITE(vote_id);
         READWRITE(oracle_pubkey);
         READWRITE(verification_record_id);
-        READWRITE(vote_choice);
+        uint8_t choice_byte = static_cast<uint8_t>(vote_choice);
+        READWRITE(choice_byte);
+        if (ser_action.ForRead()) {
+            vote_choice = static_cast<OracleVoteChoice>(choice_byte);
+        }
         READWRITE(vote_timestamp);
         READWRITE(vote_signature);
         READWRITE(vote_reason);
     }
+
+    /** Hash signed by the oracle: everything but vote_id and the signature */
+    uint256 GetSignatureHash() const;
+
+    /** Check vote_signature against oracle_pubkey */
+    bool CheckSignature() const;
 };
 
 /** Verification status for contributions */
@@ -144,7 +245,11 @@ public:
         READWRITE(required_votes);
         READWRITE(consensus_score);
         READWRITE(approved);
-        READWRITE(verification_status);
+        uint8_t status_byte = static_cast<uint8_t>(verification_status);
+        READWRITE(status_byte);
+        if (ser_action.ForRead()) {
+            verification_status = static_cast<VerificationStatus>(status_byte);
+        }
         READWRITE(verification_timestamp);
         READWRITE(view_key);
     }
@@ -246,7 +351,7 @@ public:
     static bool VerifyCharitableAct(const CContributionTransaction& contrib_tx, 
                                     const std::vector<COracleVote>& votes);
     
-    /** Create verification record for a contribution */
+    /** Create verification record for a contribution, keyed by its proof hash */
     static CVerificationRecord CreateVerificationRecord(const CContributionTransaction& contrib_tx);
     
     /** Process oracle votes and update verification record */
@@ -254,9 +359,6 @@ public:
                                    const std::vector<COracleVote>& votes,
                                    const std::vector<COracleNode>& oracles);
     
-    /** Select random oracles for verification (3 of 5) */
-    static std::vector<COracleNode> SelectRandomOracles(const std::vector<COracleNode>& all_oracles, 
-                                                         uint32_t count = 5);
 };
 
 #endif // FLEETCREDITS_PRIMITIVES_VERIFICATION_H
@@ -246,6 +246,11 @@ extern const char *GETBLOCKTXN;
  * @since protocol version 70014 as described by BIP 152
  */
 extern const char *BLOCKTXN;
+/**
+ * The mwebtx message transmits a single MWEB transaction, in response to a
+ * getdata for an MSG_MWEB_TX inventory.
+ */
+extern const char *MWEBTX;
 };
 
 /* Get a vector of all valid message types (see above) */
@@ -332,7 +337,8 @@ enum GetDataMsg
     UNDEFINED = 0,
     MSG_TX = 1,
     MSG_BLOCK = 2,
-    // The following can only occur in getdata. Invs always use TX or BLOCK.
+    MSG_MWEB_TX = 6,         //!< Fleet Credits: MWEB transaction, identified by its tx_hash
+    // The following can only occur in getdata. Invs always use TX, MWEB_TX or BLOCK.
     MSG_FILTERED_BLOCK = 3,  //!< Defined in BIP37
     MSG_CMPCT_BLOCK = 4,     //!< Defined in BIP152
     MSG_WITNESS_BLOCK = MSG_BLOCK | MSG_WITNESS_FLAG, //!< Defined in BIP144
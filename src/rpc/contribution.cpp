@@ -5,11 +5,14 @@
 #include "rpc/server.h"
 #include "rpc/client.h"
 #include "base58.h"
+#include "blockmarkers.h"
 #include "consensus/validation.h"
+#include "contributionindex.h"
 #include "primitives/contribution.h"
 #include "primitives/transaction.h"
 #include "primitives/mweb.h"
 #include "mweb_mempool.h"
+#include "oracles.h"
 #include "validation.h"
 #include "net.h"
 #include "net_processing.h"
@@ -38,108 +41,13 @@ void EnsureWalletIsUnlocked();
 // Forward declaration from validation.cpp
 bool GetTransaction(const uint256 &hash, CTransactionRef &txOut, const Consensus::Params& consensusParams, uint256 &hashBlock, bool fAllowSlow);
 
-/** Extract contribution transaction from a single transaction
- * Returns true if a contribution was found and extracted, false otherwise
- */
-bool ExtractContributionFromTransaction(const CTransaction& tx, CContributionTransaction& contrib_tx)
+/** The contribution index, or NULL if it is disabled. Throws if it stopped following the chain. */
+static CContributionIndex* GetContributionIndex()
 {
-    // Contribution marker: 0xFC 0x01 (Fleet Credits Contribution)
-    const unsigned char CONTRIB_MARKER[] = {0xFC, 0x01};
-    const size_t MARKER_SIZE = 2;
-    
-    // Check each output for OP_RETURN with contribution marker
-    for (const auto& txout : tx.vout) {
-        const CScript& script = txout.scriptPubKey;
-        
-        // Check if this is an OP_RETURN output
-        if (script.size() > 0 && script[0] == OP_RETURN) {
-            // CScript adds a length prefix when pushing a vector
-            // Format: OP_RETURN <length_byte> <0xFC> <0x01> <data...>
-            // Or if length >= 76: OP_RETURN OP_PUSHDATA1 <length_byte> <0xFC> <0x01> <data...>
-            
-            size_t dataStart = 1; // Skip OP_RETURN
-            size_t lengthBytes = 0;
-            
-            // Check for length prefix
-            if (script.size() > dataStart) {
-                unsigned char lengthByte = script[dataStart];
-                
-                // If length < 76, it's a single byte length prefix
-                if (lengthByte < OP_PUSHDATA1) {
-                    lengthBytes = 1;
-                    dataStart += 1;
-                }
-                // If length == OP_PUSHDATA1 (0x4c), next byte is the length
-                else if (lengthByte == OP_PUSHDATA1 && script.size() > dataStart + 1) {
-                    lengthBytes = 2; // OP_PUSHDATA1 + length byte
-                    dataStart += 2;
-                }
-                // If length == OP_PUSHDATA2 (0x4d), next 2 bytes are the length
-                else if (lengthByte == OP_PUSHDATA2 && script.size() > dataStart + 2) {
-                    lengthBytes = 3; // OP_PUSHDATA2 + 2 length bytes
-                    dataStart += 3;
-                }
-                // If length == OP_PUSHDATA4 (0x4e), next 4 bytes are the length
-                else if (lengthByte == OP_PUSHDATA4 && script.size() > dataStart + 4) {
-                    lengthBytes = 5; // OP_PUSHDATA4 + 4 length bytes
-                    dataStart += 5;
-                }
-            }
-            
-            // Check if we have enough bytes for the marker
-            if (script.size() >= dataStart + MARKER_SIZE) {
-                // Check marker (after length prefix)
-                bool matches_marker = true;
-                for (size_t j = 0; j < MARKER_SIZE; j++) {
-                    if (script[dataStart + j] != CONTRIB_MARKER[j]) {
-                        matches_marker = false;
-                        break;
-                    }
-                }
-                
-                if (matches_marker) {
-                    // Extract contribution data (everything after marker)
-                    std::vector<unsigned char> contrib_data(
-                        script.begin() + dataStart + MARKER_SIZE,
-                        script.end()
-                    );
-                    
-                    // Try to deserialize contribution transaction
-                    try {
-                        CDataStream ss(contrib_data, SER_NETWORK, PROTOCOL_VERSION);
-                        uint8_t contrib_type_byte;
-                        ss >> contrib_type_byte;
-                        contrib_tx.contrib_type = static_cast<ContributionType>(contrib_type_byte);
-                        ss >> contrib_tx.proof_data.hash;
-                        ss >> contrib_tx.proof_data.evidence;
-                        ss >> contrib_tx.timestamp;
-                        ss >> contrib_tx.bonus_level;
-                        uint8_t requires_mweb_byte;
-                        ss >> requires_mweb_byte;
-                        contrib_tx.requires_mweb = (requires_mweb_byte != 0);
-                        
-                        // Set transaction ID from the actual transaction
-                        contrib_tx.tx_id = tx.GetHash();
-                        
-                        // Extract contributor from first input (if available)
-                        if (!tx.vin.empty()) {
-                            // Try to extract pubkey from scriptSig or witness
-                            // For now, we'll set a placeholder - contributor address would need to be extracted differently
-                            // The contributor pubkey should be embedded in the contribution data or we derive it from inputs
-                            // For simplicity, we'll leave it as is for now
-                        }
-                        
-                        return true;
-                    } catch (const std::exception& e) {
-                        // Invalid contribution data
-                        return false;
-                    }
-                }
-            }
-        }
+    if (pcontributionindex && !pcontributionindex->IsSynced()) {
+        throw JSONRPCError(RPC_DATABASE_ERROR, "The contribution index is not in sync with the chain, restart to update it");
     }
-    
-    return false;
+    return pcontributionindex;
 }
 
 /** Submit a contribution transaction to the network */
@@ -257,7 +165,13 @@ UniValue submitcontribution(const JSONRPCRequest& request)
         if (RouteToMWEB(contrib_tx, mweb_tx)) {
             // Submit MWEB transaction to MWEB mempool
             extern CMWEBMempool mwebMempool;
-            mwebMempool.AddMWEBTransaction(mweb_tx);
+            if (mwebMempool.AddMWEBTransaction(mweb_tx) && g_connman) {
+                CInv inv(MSG_MWEB_TX, mweb_tx.tx_hash);
+                g_connman->ForEachNode([&inv](CNode* pnode)
+                {
+                    pnode->PushInventory(inv);
+                });
+            }
             // For now, return placeholder indicating MWEB routing
             UniValue result(UniValue::VOBJ);
             result.pushKV("txid", mweb_tx.tx_hash.ToString());
@@ -326,6 +240,8 @@ UniValue getcontributionstatus(const JSONRPCRequest& request)
         throw runtime_error(
             "getcontributionstatus \"txid\"\n"
             "\nGet the status of a contribution transaction.\n"
+            "Confirmed contributions are looked up in the contribution index (-contributionindex),\n"
+            "or else need -txindex.\n"
             "\nArguments:\n"
             "1. txid           (string, required) The contribution transaction ID\n"
             "\nResult:\n"
@@ -334,6 +250,9 @@ UniValue getcontributionstatus(const JSONRPCRequest& request)
             "  \"status\" : \"verified\",    (string) Verification status\n"
             "  \"bonus_level\" : \"HIGH\",   (string) Bonus level applied\n"
             "  \"reward\" : 11500,          (numeric) Reward amount in FC\n"
+            "  \"oracles\" : [            (array) For a mined contribution that waits for oracle consensus,\n"
+            "     \"pubkey\", ...          the oracles assigned to verify it; empty while too few are registered\n"
+            "  ]\n"
             "}\n"
             "\nExamples:\n"
             + HelpExampleCli("getcontributionstatus", "\"abc123...\"")
@@ -345,28 +264,37 @@ UniValue getcontributionstatus(const JSONRPCRequest& request)
 
     uint256 txid = uint256S(request.params[0].get_str());
 
-    // Look up transaction in blockchain/mempool
-    CTransactionRef tx;
+    CContributionTransaction contrib_tx;
     uint256 hashBlock;
-    if (!GetTransaction(txid, tx, Params().GetConsensus(0), hashBlock, true)) {
-        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Transaction not found in mempool or blockchain");
-    }
+    CContributionIndexEntry indexEntry;
+    CContributionIndex* pindexContributions = GetContributionIndex();
+    if (pindexContributions && pindexContributions->ReadContribution(txid, indexEntry)) {
+        contrib_tx = indexEntry.contrib;
+        hashBlock = indexEntry.hashBlock;
+    } else {
+        // Look up transaction in blockchain/mempool
+        CTransactionRef tx;
+        if (!GetTransaction(txid, tx, Params().GetConsensus(0), hashBlock, true)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Transaction not found in mempool or blockchain");
+        }
 
-    // Extract contribution data from transaction
-    CContributionTransaction contrib_tx;
-    if (!ExtractContributionFromTransaction(*tx, contrib_tx)) {
-        throw JSONRPCError(RPC_INVALID_PARAMETER, "Transaction is not a contribution transaction");
+        // Extract contribution data from transaction
+        if (!ExtractContributionFromTransaction(*tx, contrib_tx)) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Transaction is not a contribution transaction");
+        }
     }
 
     // Determine verification status
     string status = "pending";
     int confirmations = 0;
+    bool fMined = false;
     
     if (!hashBlock.IsNull()) {
         BlockMap::iterator mi = mapBlockIndex.find(hashBlock);
         if (mi != mapBlockIndex.end() && (*mi).second) {
             CBlockIndex* pindex = (*mi).second;
             if (chainActive.Contains(pindex)) {
+                fMined = true;
                 confirmations = 1 + chainActive.Height() - pindex->nHeight;
                 // Consider verified after 12 confirmations (as per whitepaper)
                 if (confirmations >= 12) {
@@ -400,17 +328,61 @@ UniValue getcontributionstatus(const JSONRPCRequest& request)
     if (!hashBlock.IsNull()) {
         result.pushKV("blockhash", hashBlock.ToString());
     }
+    if (fMined && GetContributionVerificationStatus(poraclesTip, contrib_tx) == VERIFICATION_PENDING) {
+        // The assignment is drawn from the block and the contribution, so
+        // every node names the same oracles for it
+        UniValue oracles(UniValue::VARR);
+        for (const COracleNode& oracle : poraclesTip->SelectOracles(hashBlock, txid))
+            oracles.push_back(HexStr(oracle.pubkey.begin(), oracle.pubkey.end()));
+        result.pushKV("oracles", oracles);
+    }
 
     return result;
 }
 
+/** JSON entry of listcontributions for a contribution mined at nHeight */
+static UniValue MinedContributionToJSON(const CContributionTransaction& contrib_tx, const uint256& hashBlock, int nHeight, int nTipHeight, bool fMWEB)
+{
+    // Determine status
+    string status = "verified";
+    int confirmations = nTipHeight - nHeight + 1;
+    if (confirmations < 12) {
+        status = confirmations > 0 ? "confirmed" : "pending";
+    }
+
+    // Calculate reward
+    CAmount baseReward = FC_BASE_BLOCK_REWARD;
+    double multiplier = GetBonusMultiplier(contrib_tx.bonus_level, contrib_tx.contrib_type);
+    CAmount reward = static_cast<CAmount>(baseReward * multiplier);
+
+    UniValue entry(UniValue::VOBJ);
+    entry.pushKV("txid", contrib_tx.tx_id.ToString());
+    entry.pushKV("type", GetContributionTypeName(contrib_tx.contrib_type));
+    entry.pushKV("status", status);
+    entry.pushKV("confirmations", confirmations);
+    entry.pushKV("reward", reward / COIN);
+    entry.pushKV("bonus_level", GetBonusLevelName(contrib_tx.bonus_level));
+    entry.pushKV("blockhash", hashBlock.ToString());
+    entry.pushKV("blockheight", nHeight);
+    entry.pushKV("timestamp", contrib_tx.timestamp);
+    if (fMWEB) {
+        entry.pushKV("requires_mweb", true);
+        entry.pushKV("mweb", true);  // Indicate this is from MWEB extension block
+    } else {
+        entry.pushKV("requires_mweb", contrib_tx.requires_mweb);
+    }
+    return entry;
+}
+
 /** List contributions by address or type */
 UniValue listcontributions(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() > 2) {
         throw runtime_error(
             "listcontributions [\"address\"] [\"contrib_type\"]\n"
-            "\nList contribution transactions.\n"
+            "\nList contribution transactions of the last 1000 blocks and the mempool.\n"
+            "Mined ones are read from the contribution index if -contributionindex is set,\n"
+            "which is also required to filter by address.\n"
             "\nArguments:\n"
             "1. address        (string, optional) Filter by contributor address\n"
             "2. contrib_type   (string, optional) Filter by contribution type\n"
@@ -512,106 +484,86 @@ UniValue listcontributions(const JSONRPCRequest& request)
     int startHeight = chainActive.Height();
     int endHeight = std::max(0, startHeight - maxBlocks);
     
-    for (int height = startHeight; height >= endHeight; height--) {
-        CBlockIndex* pindex = chainActive[height];
-        if (!pindex) continue;
-        
-        CBlock block;
-        if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus(0))) {
-            continue;
+    CContributionIndex* pindexContributions = GetContributionIndex();
+    if (pindexContributions) {
+        // Range scans over the (type, height) or (contributor, height) keys
+        std::vector<CContributionIndexEntry> vEntries;
+        bool fOk = true;
+        if (filter_by_address) {
+            CKeyID keyID;
+            if (!filter_address.GetKeyID(keyID)) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Address does not refer to a key");
+            }
+            fOk = pindexContributions->FindByContributor(keyID, endHeight, vEntries);
+        } else if (filter_by_type) {
+            fOk = pindexContributions->FindByType(filter_type, endHeight, vEntries);
+        } else {
+            for (int type = CODE_CONTRIBUTION; type <= ETHICAL_REVIEW && fOk; type++) {
+                fOk = pindexContributions->FindByType(static_cast<ContributionType>(type), endHeight, vEntries);
+            }
         }
+        if (!fOk) {
+            throw JSONRPCError(RPC_DATABASE_ERROR, "Unable to read the contribution index");
+        }
+
+        // Newest first, like the block scan
+        std::stable_sort(vEntries.begin(), vEntries.end(), [](const CContributionIndexEntry& a, const CContributionIndexEntry& b) {
+            return a.nHeight > b.nHeight;
+        });
+        for (const auto& entry : vEntries) {
+            if (filter_by_type && entry.contrib.contrib_type != filter_type) {
+                continue;
+            }
+            result.push_back(MinedContributionToJSON(entry.contrib, entry.hashBlock, entry.nHeight, startHeight, entry.fMWEB));
+        }
+    } else {
+        for (int height = startHeight; height >= endHeight; height--) {
+            CBlockIndex* pindex = chainActive[height];
+            if (!pindex) continue;
         
-        // Scan transactions in block
-        for (size_t i = 1; i < block.vtx.size(); i++) {
-            const CTransaction& tx = *block.vtx[i];
-            
-            CContributionTransaction contrib_tx;
-            if (ExtractContributionFromTransaction(tx, contrib_tx)) {
+            CBlock block;
+            if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus(0))) {
+                continue;
+            }
+        
+            // Contributions of the block's transactions
+            for (const auto& contrib_tx : GetBlockMarkers(block)->tx_contributions) {
                 // Apply filters
                 if (filter_by_type && contrib_tx.contrib_type != filter_type) {
                     continue;
                 }
-                
+
                 // Note: Address filtering would require extracting address from transaction inputs
                 // For now, we'll skip address filtering or implement a simplified version
                 if (filter_by_address) {
                     // TODO: Extract contributor address from transaction inputs
                     // For now, skip address filtering
                 }
-                
-                // Determine status
-                string status = "verified";
-                int confirmations = startHeight - height + 1;
-                if (confirmations < 12) {
-                    status = confirmations > 0 ? "confirmed" : "pending";
-                }
-                
-                // Calculate reward
-                CAmount baseReward = FC_BASE_BLOCK_REWARD;
-                double multiplier = GetBonusMultiplier(contrib_tx.bonus_level, contrib_tx.contrib_type);
-                CAmount reward = static_cast<CAmount>(baseReward * multiplier);
-                
-                UniValue entry(UniValue::VOBJ);
-                entry.pushKV("txid", contrib_tx.tx_id.ToString());
-                entry.pushKV("type", GetContributionTypeName(contrib_tx.contrib_type));
-                entry.pushKV("status", status);
-                entry.pushKV("confirmations", confirmations);
-                entry.pushKV("reward", reward / COIN);
-                entry.pushKV("bonus_level", GetBonusLevelName(contrib_tx.bonus_level));
-                entry.pushKV("blockhash", pindex->GetBlockHash().ToString());
-                entry.pushKV("blockheight", height);
-                entry.pushKV("timestamp", contrib_tx.timestamp);
-                entry.pushKV("requires_mweb", contrib_tx.requires_mweb);
-                
-                result.push_back(entry);
+
+                result.push_back(MinedContributionToJSON(contrib_tx, pindex->GetBlockHash(), height, startHeight, false));
             }
-        }
-        
-        // Also extract contributions from MWEB extension block if present
-        if (block.mweb_extension) {
-            std::vector<CContributionTransaction> mweb_contribs = ExtractContributionsFromMWEB(*block.mweb_extension);
-            for (const auto& contrib_tx : mweb_contribs) {
-                // Apply filters
-                if (filter_by_type && contrib_tx.contrib_type != filter_type) {
-                    continue;
-                }
+
+            // Also extract contributions from MWEB extension block if present
+            if (block.mweb_extension) {
+                std::vector<CContributionTransaction> mweb_contribs = ExtractContributionsFromMWEB(*block.mweb_extension);
+                for (const auto& contrib_tx : mweb_contribs) {
+                    // Apply filters
+                    if (filter_by_type && contrib_tx.contrib_type != filter_type) {
+                        continue;
+                    }
                 
-                // MWEB contributions are privacy-sensitive, address filtering may be limited
-                if (filter_by_address) {
-                    // TODO: Extract contributor address from MWEB transaction (requires view key)
-                    // For now, skip address filtering for MWEB contributions
-                }
+                    // MWEB contributions are privacy-sensitive, address filtering may be limited
+                    if (filter_by_address) {
+                        // TODO: Extract contributor address from MWEB transaction (requires view key)
+                        // For now, skip address filtering for MWEB contributions
+                    }
                 
-                // Determine status
-                string status = "verified";
-                int confirmations = startHeight - height + 1;
-                if (confirmations < 12) {
-                    status = confirmations > 0 ? "confirmed" : "pending";
+                    result.push_back(MinedContributionToJSON(contrib_tx, pindex->GetBlockHash(), height, startHeight, true));
                 }
-                
-                // Calculate reward
-                CAmount baseReward = FC_BASE_BLOCK_REWARD;
-                double multiplier = GetBonusMultiplier(contrib_tx.bonus_level, contrib_tx.contrib_type);
-                CAmount reward = static_cast<CAmount>(baseReward * multiplier);
-                
-                UniValue entry(UniValue::VOBJ);
-                entry.pushKV("txid", contrib_tx.tx_id.ToString());
-                entry.pushKV("type", GetContributionTypeName(contrib_tx.contrib_type));
-                entry.pushKV("status", status);
-                entry.pushKV("confirmations", confirmations);
-                entry.pushKV("reward", reward / COIN);
-                entry.pushKV("bonus_level", GetBonusLevelName(contrib_tx.bonus_level));
-                entry.pushKV("blockhash", pindex->GetBlockHash().ToString());
-                entry.pushKV("blockheight", height);
-                entry.pushKV("timestamp", contrib_tx.timestamp);
-                entry.pushKV("requires_mweb", true);
-                entry.pushKV("mweb", true);  // Indicate this is from MWEB extension block
-                
-                result.push_back(entry);
             }
         }
     }
-    
+
     // Also check mempool for pending contributions
     {
         LOCK(mempool.cs);
@@ -647,9 +599,10 @@ UniValue listcontributions(const JSONRPCRequest& request)
     // Also check MWEB mempool for pending MWEB contributions
     {
         extern CMWEBMempool mwebMempool;
-        std::vector<CMWEBTransaction> mweb_txs = mwebMempool.GetMWEBTransactions();
+        std::vector<CMWEBTransactionRef> mweb_txs = mwebMempool.GetMWEBTransactions();
         
-        for (const auto& mweb_tx : mweb_txs) {
+        for (const auto& mweb_tx_ref : mweb_txs) {
+            const CMWEBTransaction& mweb_tx = *mweb_tx_ref;
             // Extract contribution data from MWEB transaction outputs
             // MWEB contributions embed data in view_key field
             for (const auto& output : mweb_tx.outputs) {
@@ -5,16 +5,9 @@
 #ifndef FLEETCREDITS_RPC_CONTRIBUTION_H
 #define FLEETCREDITS_RPC_CONTRIBUTION_H
 
+#include "blockmarkers.h" // for ExtractContributionFromTransaction
 #include "primitives/contribution.h"
 #include "primitives/transaction.h"
 
-// Forward declarations
-class CTransaction;
-
-/** Extract contribution transaction from a single transaction
- * Returns true if a contribution was found and extracted, false otherwise
- */
-bool ExtractContributionFromTransaction(const CTransaction& tx, CContributionTransaction& contrib_tx);
-
 #endif // FLEETCREDITS_RPC_CONTRIBUTION_H
 
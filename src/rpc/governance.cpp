@@ -4,6 +4,8 @@
 
 #include "rpc/server.h"
 #include "rpc/register.h"
+#include "blockmarkers.h"
+#include "governancedb.h"
 #include "primitives/governance.h"
 #include "primitives/block.h"
 #include "primitives/transaction.h"
@@ -28,99 +30,55 @@ extern CWallet* pwalletMain;
 bool EnsureWalletIsAvailable(bool avoidException);
 void EnsureWalletIsUnlocked();
 
-// In-memory storage for governance proposals and votes (in production, this would be in chainstate)
-static map<uint256, CGovernanceProposal> mapProposals;
-static map<uint256, vector<CGovernanceVote>> mapProposalVotes;
-static CCriticalSection cs_governance;
+// Total network stake proposals need a quorum of (simplified - in production
+// would query chainstate)
+static const CAmount GOVERNANCE_NETWORK_STAKE = 100000000 * COIN;
 
-/** Extract governance proposal from transaction */
-bool ExtractGovernanceProposalFromTransaction(const CTransaction& tx, CGovernanceProposal& proposal) {
-    // Governance proposals are embedded in OP_RETURN outputs with marker 0xFC 0x03
-    const unsigned char GOV_MARKER[] = {0xFC, 0x03};
-    const size_t MARKER_SIZE = 2;
-    
-    for (const auto& txout : tx.vout) {
-        const CScript& script = txout.scriptPubKey;
-        
-        if (script.size() > 0 && script[0] == OP_RETURN) {
-            if (script.size() >= MARKER_SIZE + 1) {
-                bool matches = true;
-                for (size_t j = 0; j < MARKER_SIZE; j++) {
-                    if (script[j + 1] != GOV_MARKER[j]) {
-                        matches = false;
-                        break;
-                    }
-                }
-                
-                if (matches) {
-                    std::vector<unsigned char> proposal_data(
-                        script.begin() + 1 + MARKER_SIZE,
-                        script.end()
-                    );
-                    
-                    try {
-                        CDataStream ss(proposal_data, SER_NETWORK, PROTOCOL_VERSION);
-                        ss >> proposal;
-                        proposal.proposal_id = proposal.CalculateProposalId();
-                        return true;
-                    } catch (const std::exception& e) {
-                        return false;
-                    }
-                }
-            }
-        }
-    }
-    
-    return false;
+static CGovernanceDB& EnsureGovernanceDB()
+{
+    if (!pgovernancedb)
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Governance database not loaded");
+    if (!pgovernancedb->IsSynced())
+        throw JSONRPCError(RPC_DATABASE_ERROR, "The governance database is not in sync with the chain, restart to update it");
+    return *pgovernancedb;
 }
 
-/** Extract governance vote from transaction */
-bool ExtractGovernanceVoteFromTransaction(const CTransaction& tx, CGovernanceVote& vote) {
-    // Governance votes are embedded in OP_RETURN outputs with marker 0xFC 0x04
-    const unsigned char VOTE_MARKER[] = {0xFC, 0x04};
-    const size_t MARKER_SIZE = 2;
-    
-    for (const auto& txout : tx.vout) {
-        const CScript& script = txout.scriptPubKey;
-        
-        if (script.size() > 0 && script[0] == OP_RETURN) {
-            if (script.size() >= MARKER_SIZE + 1) {
-                bool matches = true;
-                for (size_t j = 0; j < MARKER_SIZE; j++) {
-                    if (script[j + 1] != VOTE_MARKER[j]) {
-                        matches = false;
-                        break;
-                    }
-                }
-                
-                if (matches) {
-                    std::vector<unsigned char> vote_data(
-                        script.begin() + 1 + MARKER_SIZE,
-                        script.end()
-                    );
-                    
-                    try {
-                        CDataStream ss(vote_data, SER_NETWORK, PROTOCOL_VERSION);
-                        ss >> vote;
-                        vote.vote_id = vote.CalculateVoteId();
-                        return true;
-                    } catch (const std::exception& e) {
-                        return false;
-                    }
-                }
-            }
+/** Whether a proposal is mined or waiting in the mempool */
+static bool ProposalExists(const uint256& proposal_id)
+{
+    CGovernanceProposalEntry entry;
+    if (EnsureGovernanceDB().GetProposal(proposal_id, entry))
+        return true;
+
+    LOCK(mempool.cs);
+    for (const CTxMemPoolEntry& e : mempool.mapTx) {
+        for (const auto& item : e.GetMarkers()->proposals) {
+            if (item.second.proposal_id == proposal_id)
+                return true;
         }
     }
-    
     return false;
 }
 
+static void TallyToJSON(const CGovernanceTally& tally, UniValue& entry)
+{
+    entry.pushKV("yes_votes", tally.yes_votes);
+    entry.pushKV("no_votes", tally.no_votes);
+    entry.pushKV("abstain_votes", tally.abstain_votes);
+    entry.pushKV("yes_voting_power", tally.yes_power / COIN);
+    entry.pushKV("no_voting_power", tally.no_power / COIN);
+    entry.pushKV("abstain_voting_power", tally.abstain_power / COIN);
+    entry.pushKV("total_voting_power", tally.GetTotalPower() / COIN);
+}
+
 /** Submit a governance proposal */
 UniValue submitproposal(const JSONRPCRequest& request) {
     if (request.fHelp || request.params.size() < 4) {
         throw runtime_error(
             "submitproposal \"proposal_type\" \"title\" \"description\" \"proposal_data\" [\"discussion_days\"] [\"voting_days\"]\n"
             "\nSubmit a governance proposal to the Fleet Credits network.\n"
+            "The proposal is not recorded locally: listproposals and getproposal only show it\n"
+            "once the transaction carrying it has been mined. Votes may be cast while it is in the mempool.\n"
             "\nArguments:\n"
             "1. proposal_type    (string, required) Proposal type: PARAMETER_CHANGE, RESERVE_SPENDING, ORACLE_ELECTION, FEATURE_ADD, FEATURE_REMOVE, EMERGENCY\n"
             "2. title           (string, required) Proposal title\n"
@@ -241,11 +199,7 @@ UniValue submitproposal(const JSONRPCRequest& request) {
         throw JSONRPCError(RPC_CLIENT_P2P_DISABLED, "Error: Peer-to-peer functionality missing or disabled");
     }
     
-    // Store proposal in memory (in production, this would be in chainstate)
-    {
-        LOCK(cs_governance);
-        mapProposals[proposal.proposal_id] = proposal;
-    }
+    // The proposal enters the governance database once it is mined
     
     UniValue result(UniValue::VOBJ);
     result.pushKV("proposal_id", proposal.proposal_id.ToString());
@@ -295,11 +249,8 @@ UniValue vote(const JSONRPCRequest& request) {
     }
     
     // Check proposal exists
-    {
-        LOCK(cs_governance);
-        if (mapProposals.find(proposal_id) == mapProposals.end()) {
-            throw JSONRPCError(RPC_INVALID_PARAMETER, "Proposal not found");
-        }
+    if (!ProposalExists(proposal_id)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Proposal not found");
     }
     
     // Get voting power (wallet balance by default)
@@ -360,11 +311,7 @@ UniValue vote(const JSONRPCRequest& request) {
         throw JSONRPCError(RPC_CLIENT_P2P_DISABLED, "Error: Peer-to-peer functionality missing or disabled");
     }
     
-    // Store vote in memory
-    {
-        LOCK(cs_governance);
-        mapProposalVotes[proposal_id].push_back(vote_obj);
-    }
+    // The vote is counted once it is mined
     
     UniValue result(UniValue::VOBJ);
     result.pushKV("vote_id", vote_obj.vote_id.ToString());
@@ -390,6 +337,8 @@ UniValue listproposals(const JSONRPCRequest& request) {
             "    \"status\" : \"status\",\n"
             "    \"submission_time\" : timestamp,\n"
             "    \"voting_end_time\" : timestamp,\n"
+            "    \"txid\" : \"hash\",    (string) The transaction carrying the proposal\n"
+            "    \"height\" : n,         (numeric) The height it was mined at\n"
             "    \"yes_votes\" : n,\n"
             "    \"no_votes\" : n,\n"
             "    \"abstain_votes\" : n,\n"
@@ -399,45 +348,38 @@ UniValue listproposals(const JSONRPCRequest& request) {
         );
     }
     
-    LOCK(cs_governance);
-    
     ProposalStatus filter_status = PROPOSAL_PENDING;
     bool filter = false;
     if (request.params.size() > 0) {
         string status_str = request.params[0].get_str();
         filter = true;
-        // Parse status string to enum
-        // For now, just list all if filter provided
+        if (status_str == "PENDING") {
+            filter_status = PROPOSAL_PENDING;
+        } else if (status_str == "ACTIVE") {
+            filter_status = PROPOSAL_ACTIVE;
+        } else if (status_str == "APPROVED") {
+            filter_status = PROPOSAL_APPROVED;
+        } else if (status_str == "REJECTED") {
+            filter_status = PROPOSAL_REJECTED;
+        } else if (status_str == "EXECUTED") {
+            filter_status = PROPOSAL_EXECUTED;
+        } else if (status_str == "EXPIRED") {
+            filter_status = PROPOSAL_EXPIRED;
+        } else {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid status");
+        }
     }
     
     UniValue result(UniValue::VARR);
     
-    for (const auto& pair : mapProposals) {
-        const CGovernanceProposal& proposal = pair.second;
+    for (const auto& proposal_entry : EnsureGovernanceDB().GetProposals()) {
+        const CGovernanceProposal& proposal = proposal_entry.proposal;
+        ProposalStatus status = proposal_entry.GetStatus(GetTime(), GOVERNANCE_NETWORK_STAKE);
         
-        if (filter && proposal.status != filter_status) {
+        if (filter && status != filter_status) {
             continue;
         }
         
-        // Count votes
-        CAmount yes_power = 0, no_power = 0, abstain_power = 0;
-        int yes_count = 0, no_count = 0, abstain_count = 0;
-        
-        if (mapProposalVotes.find(proposal.proposal_id) != mapProposalVotes.end()) {
-            for (const auto& vote : mapProposalVotes[proposal.proposal_id]) {
-                if (vote.choice == VOTE_YES) {
-                    yes_power += vote.voting_power;
-                    yes_count++;
-                } else if (vote.choice == VOTE_NO) {
-                    no_power += vote.voting_power;
-                    no_count++;
-                } else {
-                    abstain_power += vote.voting_power;
-                    abstain_count++;
-                }
-            }
-        }
-        
         UniValue entry(UniValue::VOBJ);
         entry.pushKV("proposal_id", proposal.proposal_id.ToString());
         entry.pushKV("title", proposal.title);
@@ -455,7 +397,7 @@ UniValue listproposals(const JSONRPCRequest& request) {
         entry.pushKV("type", type_str);
         
         string status_str;
-        switch (proposal.status) {
+        switch (status) {
             case PROPOSAL_PENDING: status_str = "PENDING"; break;
             case PROPOSAL_ACTIVE: status_str = "ACTIVE"; break;
             case PROPOSAL_APPROVED: status_str = "APPROVED"; break;
@@ -467,13 +409,9 @@ UniValue listproposals(const JSONRPCRequest& request) {
         entry.pushKV("status", status_str);
         entry.pushKV("submission_time", (int64_t)proposal.submission_time);
         entry.pushKV("voting_end_time", (int64_t)proposal.voting_end_time);
-        entry.pushKV("yes_votes", yes_count);
-        entry.pushKV("no_votes", no_count);
-        entry.pushKV("abstain_votes", abstain_count);
-        entry.pushKV("yes_voting_power", yes_power / COIN);
-        entry.pushKV("no_voting_power", no_power / COIN);
-        entry.pushKV("abstain_voting_power", abstain_power / COIN);
-        entry.pushKV("total_voting_power", (yes_power + no_power + abstain_power) / COIN);
+        entry.pushKV("txid", proposal_entry.txid.ToString());
+        entry.pushKV("height", proposal_entry.nHeight);
+        TallyToJSON(proposal_entry.tally, entry);
         
         result.push_back(entry);
     }
@@ -503,13 +441,12 @@ UniValue getproposal(const JSONRPCRequest& request) {
     
     uint256 proposal_id = uint256S(request.params[0].get_str());
     
-    LOCK(cs_governance);
-    
-    if (mapProposals.find(proposal_id) == mapProposals.end()) {
+    CGovernanceProposalEntry proposal_entry;
+    if (!EnsureGovernanceDB().GetProposal(proposal_id, proposal_entry)) {
         throw JSONRPCError(RPC_INVALID_PARAMETER, "Proposal not found");
     }
     
-    const CGovernanceProposal& proposal = mapProposals[proposal_id];
+    const CGovernanceProposal& proposal = proposal_entry.proposal;
     
     UniValue result(UniValue::VOBJ);
     result.pushKV("proposal_id", proposal.proposal_id.ToString());
@@ -529,7 +466,7 @@ UniValue getproposal(const JSONRPCRequest& request) {
     result.pushKV("type", type_str);
     
     string status_str;
-    switch (proposal.status) {
+    switch (proposal_entry.GetStatus(GetTime(), GOVERNANCE_NETWORK_STAKE)) {
         case PROPOSAL_PENDING: status_str = "PENDING"; break;
         case PROPOSAL_ACTIVE: status_str = "ACTIVE"; break;
         case PROPOSAL_APPROVED: status_str = "APPROVED"; break;
@@ -545,33 +482,9 @@ UniValue getproposal(const JSONRPCRequest& request) {
     result.pushKV("voting_end_time", (int64_t)proposal.voting_end_time);
     result.pushKV("quorum_percentage", (int64_t)proposal.quorum_percentage);
     result.pushKV("approval_percentage", (int64_t)proposal.approval_percentage);
-    
-    // Count votes
-    CAmount yes_power = 0, no_power = 0, abstain_power = 0;
-    int yes_count = 0, no_count = 0, abstain_count = 0;
-    
-    if (mapProposalVotes.find(proposal.proposal_id) != mapProposalVotes.end()) {
-        for (const auto& vote : mapProposalVotes[proposal.proposal_id]) {
-            if (vote.choice == VOTE_YES) {
-                yes_power += vote.voting_power;
-                yes_count++;
-            } else if (vote.choice == VOTE_NO) {
-                no_power += vote.voting_power;
-                no_count++;
-            } else {
-                abstain_power += vote.voting_power;
-                abstain_count++;
-            }
-        }
-    }
-    
-    result.pushKV("yes_votes", yes_count);
-    result.pushKV("no_votes", no_count);
-    result.pushKV("abstain_votes", abstain_count);
-    result.pushKV("yes_voting_power", yes_power / COIN);
-    result.pushKV("no_voting_power", no_power / COIN);
-    result.pushKV("abstain_voting_power", abstain_power / COIN);
-    result.pushKV("total_voting_power", (yes_power + no_power + abstain_power) / COIN);
+    result.pushKV("txid", proposal_entry.txid.ToString());
+    result.pushKV("height", proposal_entry.nHeight);
+    TallyToJSON(proposal_entry.tally, result);
     
     return result;
 }
@@ -581,7 +494,8 @@ UniValue checkproposals(const JSONRPCRequest& request) {
     if (request.fHelp) {
         throw runtime_error(
             "checkproposals\n"
-            "\nCheck for approved proposals and execute them if conditions are met.\n"
+            "\nCheck for approved proposals whose voting has ended and passed its quorum and approval thresholds.\n"
+            "The outcome follows from the current tally and is not stored.\n"
             "\nResult:\n"
             "{\n"
             "  \"checked\" : n,           (numeric) Number of proposals checked\n"
@@ -591,7 +505,7 @@ UniValue checkproposals(const JSONRPCRequest& request) {
         );
     }
     
-    LOCK(cs_governance);
+    CGovernanceDB& governancedb = EnsureGovernanceDB();
     
     int checked = 0;
     int executed = 0;
@@ -599,57 +513,13 @@ UniValue checkproposals(const JSONRPCRequest& request) {
     
     int64_t currentTime = GetTime();
     
-    for (auto& pair : mapProposals) {
-        CGovernanceProposal& proposal = pair.second;
+    for (const auto& proposal_entry : governancedb.GetProposals()) {
+        const CGovernanceProposal& proposal = proposal_entry.proposal;
         checked++;
         
-        // Skip if not approved or already executed
-        if (proposal.status != PROPOSAL_APPROVED) {
-            continue;
-        }
-        
-        // Check if execution time has passed
-        if (proposal.execution_time > 0 && currentTime < (int64_t)proposal.execution_time) {
-            continue;
-        }
-        
-        // Check if voting period has ended
-        if (currentTime < (int64_t)proposal.voting_end_time) {
-            continue;
-        }
-        
-        // Count votes and check quorum/approval
-        CAmount yes_power = 0, no_power = 0, abstain_power = 0;
-        CAmount total_power = 0;
-        
-        if (mapProposalVotes.find(proposal.proposal_id) != mapProposalVotes.end()) {
-            for (const auto& vote : mapProposalVotes[proposal.proposal_id]) {
-                if (vote.choice == VOTE_YES) {
-                    yes_power += vote.voting_power;
-                } else if (vote.choice == VOTE_NO) {
-                    no_power += vote.voting_power;
-                } else {
-                    abstain_power += vote.voting_power;
-                }
-                total_power += vote.voting_power;
-            }
-        }
-        
-        // Get total network stake (simplified - in production would query chainstate)
-        // For now, use a placeholder
-        CAmount network_stake = 100000000 * COIN;  // Placeholder
-        
-        // Check quorum
-        double participation = (double)total_power / (double)network_stake * 100.0;
-        if (participation < proposal.quorum_percentage) {
-            proposal.status = PROPOSAL_EXPIRED;
-            continue;
-        }
-        
-        // Check approval
-        double approval = (double)yes_power / (double)total_power * 100.0;
-        if (approval < proposal.approval_percentage) {
-            proposal.status = PROPOSAL_REJECTED;
+        // Approved proposals whose voting has ended are decided by their
+        // tally; the outcome is derived on every call, not stored
+        if (proposal_entry.GetStatus(currentTime, GOVERNANCE_NETWORK_STAKE) != PROPOSAL_EXECUTED) {
             continue;
         }
         
@@ -659,15 +529,12 @@ UniValue checkproposals(const JSONRPCRequest& request) {
         // - For PARAMETER_CHANGE: Update consensus parameters
         // - For ORACLE_ELECTION: Update oracle list
         // - For FEATURE_ADD/REMOVE: Enable/disable features
-        
-        // For now, just mark as executed
-        proposal.status = PROPOSAL_EXECUTED;
         executed++;
         
         UniValue exec(UniValue::VOBJ);
         exec.pushKV("proposal_id", proposal.proposal_id.ToString());
         exec.pushKV("type", "EXECUTED");
-        exec.pushKV("execution_time", (int64_t)currentTime);
+        exec.pushKV("execution_time", (int64_t)std::max((int64_t)proposal.voting_end_time, (int64_t)proposal.execution_time));
         executions.push_back(exec);
     }
     
@@ -17,6 +17,7 @@
 #include "txmempool.h"
 #include "rpc/contribution.h"
 #include "mweb_mempool.h"
+#include "net.h"
 #include "streams.h"
 #include "protocol.h"
 #include "chainparams.h"
@@ -145,8 +146,7 @@ UniValue createpegin(const JSONRPCRequest& request)
 
     // Sign and commit transaction
     CValidationState state;
-    extern CConnman* g_connman;
-    if (g_connman && !pwalletMain->CommitTransaction(wtxNew, reservekey, g_connman, state)) {
+    if (g_connman && !pwalletMain->CommitTransaction(wtxNew, reservekey, g_connman.get(), state)) {
         throw JSONRPCError(RPC_WALLET_ERROR, 
             strprintf("Error: Transaction was rejected! Reason: %s", state.GetRejectReason()));
     } else if (!g_connman) {
@@ -362,8 +362,15 @@ UniValue routecontributiontomweb(const JSONRPCRequest& request)
     }
 
     // Store MWEB transaction in MWEB mempool for inclusion in next block
+    // and announce it so that every miner gets to see it
     extern CMWEBMempool mwebMempool;
-    mwebMempool.AddMWEBTransaction(mweb_tx);
+    if (mwebMempool.AddMWEBTransaction(mweb_tx) && g_connman) {
+        CInv inv(MSG_MWEB_TX, mweb_tx.tx_hash);
+        g_connman->ForEachNode([&inv](CNode* pnode)
+        {
+            pnode->PushInventory(inv);
+        });
+    }
     
     UniValue result(UniValue::VOBJ);
     result.pushKV("mwebtxid", mweb_tx.tx_hash.GetHex());
@@ -420,11 +427,12 @@ UniValue listmwebtxs(const JSONRPCRequest& request)
     int found = 0;
 
     // First, check mempool for pending MWEB transactions
-    std::vector<CMWEBTransaction> mempool_txs = mwebMempool.GetMWEBTransactions();
-    for (const auto& mweb_tx : mempool_txs) {
+    std::vector<CMWEBTransactionRef> mempool_txs = mwebMempool.GetMWEBTransactions();
+    for (const auto& mweb_tx_ref : mempool_txs) {
         if (found >= count) {
             break;
         }
+        const CMWEBTransaction& mweb_tx = *mweb_tx_ref;
         
         UniValue tx_obj(UniValue::VOBJ);
         tx_obj.pushKV("txid", mweb_tx.tx_hash.GetHex());
@@ -482,6 +490,12 @@ UniValue listmwebtxs(const JSONRPCRequest& request)
     CBlockIndex* pindex = chainActive.Tip();
     
     while (pindex && found < count) {
+        // Skip blocks known from the index to have no extension block
+        if ((pindex->nStatus & BLOCK_OPT_MWEB) && pindex->hashMWEBExtension.IsNull()) {
+            pindex = pindex->pprev;
+            continue;
+        }
+
         // Read block
         CBlock block;
         if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus(0))) {
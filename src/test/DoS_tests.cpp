@@ -63,6 +63,7 @@ struct DoSTestingSetup : BasicTestingSetup {
                 dummyIndex.nChainWork = 0;
                 dummyIndex.nChainTx = 1;
                 pindexBestHeader = &dummyIndex;
+                pindexDummy = &dummyIndex;
                 if (chainActive.Tip() == nullptr) {
                     chainActive.SetTip(&dummyIndex);
                 }
@@ -73,8 +74,17 @@ struct DoSTestingSetup : BasicTestingSetup {
         UnregisterNodeSignals(GetNodeSignals());
         g_connman.reset();
         connman = nullptr;
+        // Later suites must not find the dummy as their chain tip
+        LOCK(cs_main);
+        if (pindexDummy) {
+            if (chainActive.Tip() == pindexDummy)
+                chainActive.SetTip(nullptr);
+            if (pindexBestHeader == pindexDummy)
+                pindexBestHeader = nullptr;
+        }
     }
     CConnman* connman = nullptr;
+    CBlockIndex* pindexDummy = nullptr;
 };
 
 static CService ip(uint32_t i)
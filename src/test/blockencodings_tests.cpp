@@ -5,8 +5,12 @@
 #include "blockencodings.h"
 #include "consensus/merkle.h"
 #include "chainparams.h"
+#include "consensus/validation.h"
+#include "mweb_mempool.h"
 #include "random.h"
+#include "validation.h"
 
+#include "test/mweb_test.h"
 #include "test/test_fleetcredits.h"
 
 #include <boost/test/unit_test.hpp>
@@ -151,6 +155,10 @@ public:
             shorttxids[i] = (uint64_t(msb) << 32) | uint64_t(lsb);
         }
         READWRITE(prefilledtxn);
+        // The blocks built here carry no MWEB extension block
+        bool has_mweb = false;
+        READWRITE(has_mweb);
+        assert(!has_mweb);
     }
 };
 
@@ -314,6 +322,106 @@ BOOST_AUTO_TEST_CASE(EmptyBlockRoundTripTest)
     }
 }
 
+BOOST_AUTO_TEST_CASE(MWEBRoundTripTest)
+{
+    CTxMemPool pool(CFeeRate(0));
+    CMWEBMempool mweb_pool;
+    CBlock block(BuildBlockTestCase());
+    for (size_t i = 1; i < block.vtx.size(); i++)
+        pool.addUnchecked(block.vtx[i]->GetHash(), TestMemPoolEntryHelper().FromTx(*block.vtx[i]));
+
+    std::vector<CMWEBTransaction> mweb_txs;
+    for (int i = 0; i < 3; i++) {
+        mweb_txs.push_back(MWEBTest::CreateTestMWEBTransaction(COIN, InsecureRand256()));
+        mweb_txs.back().tx_hash = mweb_txs.back().GetHash();
+    }
+    block.mweb_extension.reset(new CMWEBExtensionBlock(MWEBTest::CreateTestMWEBExtensionBlock(mweb_txs)));
+
+    // Only the middle MWEB transaction is pending locally
+    BOOST_CHECK(mweb_pool.AddMWEBTransaction(mweb_txs[1]));
+
+    CBlockHeaderAndShortTxIDs shortIDs(block, true);
+    BOOST_CHECK_EQUAL(shortIDs.MWEBTxCount(), 3);
+
+    CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+    stream << shortIDs;
+
+    // The transactions themselves are not sent
+    BOOST_CHECK(stream.size() < ::GetSerializeSize(*block.mweb_extension, SER_NETWORK, PROTOCOL_VERSION));
+
+    CBlockHeaderAndShortTxIDs shortIDs2;
+    stream >> shortIDs2;
+
+    PartiallyDownloadedBlock partialBlock(&pool, &mweb_pool);
+    BOOST_CHECK(partialBlock.InitData(shortIDs2, extra_txn) == READ_STATUS_OK);
+    BOOST_CHECK(!partialBlock.IsMWEBTxAvailable(0));
+    BOOST_CHECK( partialBlock.IsMWEBTxAvailable(1));
+    BOOST_CHECK(!partialBlock.IsMWEBTxAvailable(2));
+
+    {
+        // Missing MWEB transactions must be supplied
+        PartiallyDownloadedBlock partialBlockCopy = partialBlock;
+        CBlock block2;
+        BOOST_CHECK(partialBlockCopy.FillBlock(block2, {}, {mweb_txs[0]}) == READ_STATUS_INVALID);
+    }
+    {
+        // A wrong transaction does not hash to the extension block hash
+        PartiallyDownloadedBlock partialBlockCopy = partialBlock;
+        CBlock block2;
+        BOOST_CHECK(partialBlockCopy.FillBlock(block2, {}, {mweb_txs[2], mweb_txs[0]}) == READ_STATUS_FAILED);
+    }
+
+    CBlock block2;
+    BOOST_CHECK(partialBlock.FillBlock(block2, {}, {mweb_txs[0], mweb_txs[2]}) == READ_STATUS_OK);
+    BOOST_CHECK_EQUAL(block.GetHash().ToString(), block2.GetHash().ToString());
+    BOOST_REQUIRE(block2.mweb_extension);
+    BOOST_CHECK_EQUAL(block2.mweb_extension->mweb_txs.size(), 3);
+    BOOST_CHECK(block2.mweb_extension->GetHash() == block.mweb_extension->GetHash());
+
+    // An extension block that does not match its hash may have been rebuilt
+    // from the wrong transactions, and is not taken as invalid
+    block2.mweb_extension->mweb_txs.pop_back();
+    block2.fChecked = false;
+    CValidationState state;
+    BOOST_CHECK(!CheckBlock(block2, state));
+    BOOST_CHECK(state.CorruptionPossible());
+}
+
+BOOST_AUTO_TEST_CASE(MWEBCompactVersionTest)
+{
+    CBlock block(BuildBlockTestCase());
+    std::vector<CMWEBTransaction> mweb_txs(1, MWEBTest::CreateTestMWEBTransaction(COIN, InsecureRand256()));
+    block.mweb_extension.reset(new CMWEBExtensionBlock(MWEBTest::CreateTestMWEBExtensionBlock(mweb_txs)));
+    CBlockHeaderAndShortTxIDs shortIDs(block, false);
+
+    // Peers below MWEB_CMPCT_VERSION get the encoding without MWEB data,
+    // whatever the transaction serialization flags
+    CDataStream stream(SER_NETWORK, MWEB_CMPCT_VERSION);
+    stream << shortIDs;
+    CDataStream old_stream(SER_NETWORK, (MWEB_CMPCT_VERSION - 1) | SERIALIZE_TRANSACTION_NO_WITNESS);
+    old_stream << shortIDs;
+    BOOST_CHECK(old_stream.size() < stream.size());
+
+    CBlockHeaderAndShortTxIDs shortIDs2;
+    old_stream >> shortIDs2;
+    BOOST_CHECK(old_stream.empty());
+    BOOST_CHECK_EQUAL(shortIDs2.BlockTxCount(), shortIDs.BlockTxCount());
+    BOOST_CHECK_EQUAL(shortIDs2.MWEBTxCount(), 0);
+    BOOST_CHECK(shortIDs.HasMWEB());
+    BOOST_CHECK(!shortIDs2.HasMWEB());
+
+    BlockTransactionsRequest req;
+    req.blockhash = block.GetHash();
+    req.indexes.push_back(1);
+    req.mweb_indexes.push_back(0);
+    old_stream << req;
+    BlockTransactionsRequest req2;
+    old_stream >> req2;
+    BOOST_CHECK(old_stream.empty());
+    BOOST_CHECK_EQUAL(req2.indexes.size(), 1);
+    BOOST_CHECK(req2.mweb_indexes.empty());
+}
+
 BOOST_AUTO_TEST_CASE(TransactionsRequestSerializationTest) {
     BlockTransactionsRequest req1;
     req1.blockhash = InsecureRand256();
@@ -335,6 +443,19 @@ BOOST_AUTO_TEST_CASE(TransactionsRequestSerializationTest) {
     BOOST_CHECK_EQUAL(req1.indexes[1], req2.indexes[1]);
     BOOST_CHECK_EQUAL(req1.indexes[2], req2.indexes[2]);
     BOOST_CHECK_EQUAL(req1.indexes[3], req2.indexes[3]);
+    BOOST_CHECK(req2.mweb_indexes.empty());
+
+    BlockTransactionsRequest req3;
+    req3.mweb_indexes.push_back(2);
+    req3.mweb_indexes.push_back(7);
+    CDataStream stream2(SER_NETWORK, PROTOCOL_VERSION);
+    stream2 << req3;
+    BlockTransactionsRequest req4;
+    stream2 >> req4;
+    BOOST_CHECK(req4.indexes.empty());
+    BOOST_CHECK_EQUAL(req4.mweb_indexes.size(), 2);
+    BOOST_CHECK_EQUAL(req4.mweb_indexes[0], 2);
+    BOOST_CHECK_EQUAL(req4.mweb_indexes[1], 7);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,132 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "blockmarkers.h"
+#include "fleetcredits.h"
+#include "key.h"
+#include "primitives/block.h"
+#include "test/test_fleetcredits.h"
+#include "test/test_markers.h"
+#include "txmempool.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(blockmarkers_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(block_markers)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    CContributionTransaction contrib = MakeStubContribution(key, CODE_CONTRIBUTION, BONUS_MEDIUM);
+    CContributionTransaction ethical = MakeStubContribution(key, ETHICAL_REVIEW, BONUS_HIGH);
+
+    CMutableTransaction mtx;
+    mtx.vin.resize(1);
+    mtx.vin[0].prevout.hash = GetRandHash();
+    mtx.vout.resize(3);
+    mtx.vout[0].scriptPubKey = MakeRawMarkerScript(FC_MARKER_CONTRIBUTION, contrib);
+    mtx.vout[1].scriptPubKey = MakeRawMarkerScript(FC_MARKER_CONTRIBUTION, ethical);
+    mtx.vout[2].scriptPubKey = MakeRawMarkerScript(FC_MARKER_PEG_IN, std::make_pair(uint256S("0x01"), CAmount(5 * COIN)));
+    CTransactionRef rawTx = MakeTransactionRef(mtx);
+    CTransactionRef submittedTx = MakeContributionTx(MakeStubContribution(key, DATA_LABELING, BONUS_LOW));
+
+    CBlock block;
+    block.vtx.push_back(MakeTransactionRef(CMutableTransaction()));
+    block.vtx.push_back(rawTx);
+    block.vtx.push_back(submittedTx);
+
+    std::shared_ptr<const CBlockMarkers> markers = GetBlockMarkers(block);
+    // Only the raw, non-MWEB contribution counts towards the reward
+    BOOST_CHECK_EQUAL(markers->contributions.size(), 1U);
+    BOOST_CHECK(markers->contributions[0].tx_id == rawTx->GetHash());
+    BOOST_CHECK_EQUAL(markers->contributions[0].bonus_level, (uint32_t)BONUS_MEDIUM);
+    BOOST_CHECK_EQUAL(ExtractContributionsFromBlock(block).size(), 1U);
+    // The pushed one is only seen in the submitcontribution encoding
+    BOOST_CHECK_EQUAL(markers->tx_contributions.back().contrib_type, DATA_LABELING);
+    BOOST_CHECK(markers->tx_contributions.back().tx_id == submittedTx->GetHash());
+    CContributionTransaction extracted;
+    BOOST_CHECK(ExtractContributionFromTransaction(*submittedTx, extracted));
+    BOOST_CHECK(extracted.tx_id == submittedTx->GetHash());
+
+    BOOST_CHECK(markers->HasPegIn(rawTx->GetHash(), uint256S("0x01"), 5 * COIN));
+    BOOST_CHECK(!markers->HasPegIn(rawTx->GetHash(), uint256S("0x01"), 4 * COIN));
+    BOOST_CHECK(!markers->HasPegIn(submittedTx->GetHash(), uint256S("0x01"), 5 * COIN));
+
+    // Cached until the transactions change
+    BOOST_CHECK(GetBlockMarkers(block) == markers);
+    CBlock copy(block);
+    BOOST_CHECK(GetBlockMarkers(copy) == markers);
+    block.vtx.pop_back();
+    BOOST_CHECK(GetBlockMarkers(block) != markers);
+    BOOST_CHECK_EQUAL(GetBlockMarkers(block)->contributions.size(), 1U);
+}
+
+BOOST_AUTO_TEST_CASE(block_markers_from_mempool)
+{
+    CKey key;
+    key.MakeNewKey(true);
+
+    CMutableTransaction mtx;
+    mtx.vin.resize(1);
+    mtx.vin[0].prevout.hash = GetRandHash();
+    mtx.vout.resize(1);
+    mtx.vout[0].nValue = 0;
+    mtx.vout[0].scriptPubKey = MakeRawMarkerScript(FC_MARKER_CONTRIBUTION, MakeStubContribution(key, CODE_CONTRIBUTION, BONUS_MEDIUM));
+    CTransactionRef contribTx = MakeTransactionRef(mtx);
+    CMutableTransaction plain;
+    plain.vin.resize(1);
+    plain.vin[0].prevout.hash = GetRandHash();
+    plain.vout.resize(1);
+    plain.vout[0].nValue = COIN;
+    CTransactionRef plainTx = MakeTransactionRef(plain);
+
+    // Entries parse their markers once; those without any share an empty set
+    TestMemPoolEntryHelper entry;
+    CTxMemPool pool(CFeeRate(0));
+    pool.addUnchecked(contribTx->GetHash(), entry.FromTx(*contribTx));
+    pool.addUnchecked(plainTx->GetHash(), entry.FromTx(*plainTx));
+    std::shared_ptr<const CBlockMarkers> txMarkers = pool.GetMarkers(*contribTx);
+    BOOST_CHECK(txMarkers);
+    BOOST_CHECK_EQUAL(txMarkers->contributions.size(), 1U);
+    BOOST_CHECK(txMarkers->contributions[0].tx_id == contribTx->GetHash());
+    BOOST_CHECK(pool.GetMarkers(*plainTx)->IsEmpty());
+    BOOST_CHECK(pool.GetMarkers(*plainTx) == GetTransactionMarkers(plain));
+
+    // Blocks take the markers of known transactions from the lookup
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vout.resize(1);
+    coinbase.vout[0].scriptPubKey = MakeRawMarkerScript(FC_MARKER_PEG_IN, std::make_pair(uint256S("0x01"), CAmount(5 * COIN)));
+    CBlock block;
+    block.vtx.push_back(MakeTransactionRef(coinbase));
+    block.vtx.push_back(contribTx);
+    block.vtx.push_back(plainTx);
+    int nLookups = 0;
+    std::shared_ptr<const CBlockMarkers> markers = GetBlockMarkers(block, [&](const CTransaction& tx) {
+        nLookups++;
+        return pool.GetMarkers(tx);
+    });
+    BOOST_CHECK_EQUAL(nLookups, 2);
+    BOOST_CHECK_EQUAL(markers->contributions.size(), 1U);
+    BOOST_CHECK(markers->contributions[0].tx_id == contribTx->GetHash());
+    BOOST_CHECK(markers->HasPegIn(block.vtx[0]->GetHash(), uint256S("0x01"), 5 * COIN));
+
+    // A new coinbase (extra nonce) only rescans the coinbase
+    CTransactionRef oldCoinbase = block.vtx[0];
+    coinbase.vin[0].scriptSig = CScript() << 42;
+    block.vtx[0] = MakeTransactionRef(coinbase);
+    nLookups = 0;
+    std::shared_ptr<const CBlockMarkers> updated = GetBlockMarkers(block, [&](const CTransaction& tx) {
+        nLookups++;
+        return pool.GetMarkers(tx);
+    });
+    BOOST_CHECK_EQUAL(nLookups, 0);
+    BOOST_CHECK(updated != markers);
+    BOOST_CHECK_EQUAL(updated->contributions.size(), 1U);
+    BOOST_CHECK_EQUAL(updated->peg_ins.size(), 1U);
+    BOOST_CHECK(updated->HasPegIn(block.vtx[0]->GetHash(), uint256S("0x01"), 5 * COIN));
+    BOOST_CHECK(!updated->HasPegIn(oldCoinbase->GetHash(), uint256S("0x01"), 5 * COIN));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
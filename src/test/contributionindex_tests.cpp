@@ -0,0 +1,100 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "contributionindex.h"
+#include "chain.h"
+#include "chainparams.h"
+#include "key.h"
+#include "primitives/block.h"
+#include "script/standard.h"
+#include "test/test_fleetcredits.h"
+#include "test/test_markers.h"
+#include "validation.h"
+#include "validationinterface.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(contributionindex_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(contribution_index)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    CContributionIndex index(1 << 20, true);
+    BOOST_CHECK(index.GetBestBlock().IsNull());
+
+    // Two blocks: a code contribution at height 1, a code and a creative one at height 2
+    std::vector<CBlock> blocks(2);
+    std::vector<uint256> hashes(2);
+    std::vector<CBlockIndex> indexes(2);
+    for (int i = 0; i < 2; i++) {
+        blocks[i].vtx.push_back(MakeTransactionRef(CMutableTransaction())); // coinbase is skipped
+        blocks[i].vtx.push_back(MakeContributionTx(MakeStubContribution(key, CODE_CONTRIBUTION, BONUS_LOW)));
+        blocks[i].nNonce = i;
+        hashes[i] = blocks[i].GetHash();
+        indexes[i].phashBlock = &hashes[i];
+        indexes[i].nHeight = i + 1;
+        indexes[i].pprev = i ? &indexes[i - 1] : NULL;
+    }
+    blocks[1].vtx.push_back(MakeContributionTx(MakeStubContribution(key, CREATIVE_WORK, BONUS_HIGH)));
+
+    BOOST_CHECK(index.WriteBlock(blocks[0], &indexes[0]));
+    BOOST_CHECK(index.WriteBlock(blocks[1], &indexes[1]));
+    BOOST_CHECK(index.GetBestBlock() == hashes[1]);
+
+    CContributionIndexEntry entry;
+    BOOST_CHECK(index.ReadContribution(blocks[1].vtx[2]->GetHash(), entry));
+    BOOST_CHECK(entry.hashBlock == hashes[1]);
+    BOOST_CHECK_EQUAL(entry.nHeight, 2);
+    BOOST_CHECK_EQUAL(entry.contrib.contrib_type, CREATIVE_WORK);
+    BOOST_CHECK_EQUAL(entry.contrib.bonus_level, (uint32_t)BONUS_HIGH);
+    BOOST_CHECK(!entry.fMWEB);
+
+    // Range scans are ordered by height and start at the minimum height
+    std::vector<CContributionIndexEntry> vEntries;
+    BOOST_CHECK(index.FindByType(CODE_CONTRIBUTION, 0, vEntries));
+    BOOST_CHECK_EQUAL(vEntries.size(), 2U);
+    BOOST_CHECK_EQUAL(vEntries[0].nHeight, 1);
+    BOOST_CHECK_EQUAL(vEntries[1].nHeight, 2);
+    vEntries.clear();
+    BOOST_CHECK(index.FindByType(CODE_CONTRIBUTION, 2, vEntries));
+    BOOST_CHECK_EQUAL(vEntries.size(), 1U);
+    BOOST_CHECK(vEntries[0].contrib.tx_id == blocks[1].vtx[1]->GetHash());
+    vEntries.clear();
+    BOOST_CHECK(index.FindByType(CREATIVE_WORK, 0, vEntries));
+    BOOST_CHECK_EQUAL(vEntries.size(), 1U);
+    vEntries.clear();
+    BOOST_CHECK(index.FindByType(ETHICAL_REVIEW, 0, vEntries));
+    BOOST_CHECK(vEntries.empty());
+
+    // Disconnecting the tip removes its contributions
+    BOOST_CHECK(index.EraseBlock(blocks[1], &indexes[1]));
+    BOOST_CHECK(index.GetBestBlock() == hashes[0]);
+    BOOST_CHECK(!index.ReadContribution(blocks[1].vtx[2]->GetHash(), entry));
+    BOOST_CHECK(index.FindByType(CODE_CONTRIBUTION, 0, vEntries));
+    BOOST_CHECK_EQUAL(vEntries.size(), 1U);
+    BOOST_CHECK_EQUAL(vEntries[0].nHeight, 1);
+}
+
+BOOST_FIXTURE_TEST_CASE(contribution_index_sync, TestChain240Setup)
+{
+    CContributionIndex index(1 << 20, true);
+    BOOST_CHECK(!index.IsSynced());
+
+    // Sync catches up with the chain and then follows its notifications
+    RegisterValidationInterface(&index);
+    BOOST_CHECK(index.Sync(Params()));
+    BOOST_CHECK(index.IsSynced());
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(index.GetBestBlock() == chainActive.Tip()->GetBlockHash());
+    }
+
+    CScript scriptPubKey = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    CBlock block = CreateAndProcessBlock(std::vector<CMutableTransaction>(), scriptPubKey);
+    BOOST_CHECK(index.GetBestBlock() == block.GetHash());
+    UnregisterValidationInterface(&index);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -3,39 +3,18 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "arith_uint256.h"
+#include "chain.h"
 #include "chainparams.h"
 #include "fleetcredits.h"
 #include "key.h"
 #include "primitives/contribution.h"
 #include "test/test_fleetcredits.h"
+#include "test/test_markers.h"
 
 #include <boost/test/unit_test.hpp>
 
 BOOST_FIXTURE_TEST_SUITE(fleetcredits_tests, BasicTestingSetup)
 
-static CContributionTransaction MakeStubContribution(CKey& key, ContributionType type, uint32_t bonusLevel)
-{
-    CContributionTransaction contrib;
-    contrib.contrib_type = type;
-    contrib.bonus_level = bonusLevel;
-    contrib.contributor = key.GetPubKey();
-    contrib.timestamp = 1776643200; // deterministic test timestamp
-    contrib.signature = std::vector<unsigned char>(1, 0x01);
-
-    contrib.proof_data.contrib_type = type;
-    contrib.proof_data.timestamp = contrib.timestamp;
-    contrib.proof_data.evidence = {0x01};
-    contrib.proof_data.nonce = {0x02};
-    contrib.proof_data.metadata = {0x03};
-    contrib.proof_data.hash = CalculateProofDataHash(contrib.proof_data);
-
-    if (type == ETHICAL_REVIEW) {
-        contrib.requires_mweb = true;
-    }
-
-    return contrib;
-}
-
 BOOST_AUTO_TEST_CASE(block_subsidy_constant_reward)
 {
     const CChainParams& mainParams = Params(CBaseChainParams::MAIN);
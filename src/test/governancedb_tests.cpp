@@ -0,0 +1,149 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "governancedb.h"
+#include "chain.h"
+#include "chainparams.h"
+#include "key.h"
+#include "primitives/block.h"
+#include "script/standard.h"
+#include "test/test_fleetcredits.h"
+#include "test/test_markers.h"
+#include "validation.h"
+#include "validationinterface.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(governancedb_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(governance_db)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    CGovernanceDB governancedb(1 << 20, true);
+
+    CGovernanceProposal proposal;
+    proposal.proposer = key.GetPubKey();
+    proposal.title = "title";
+    proposal.description = "description";
+    proposal.submission_time = 1;
+    proposal.discussion_end_time = 2;
+    proposal.voting_start_time = 3;
+    proposal.voting_end_time = 4;
+    proposal.signature = std::vector<unsigned char>(1, 0x01);
+    proposal.proposal_id = proposal.CalculateProposalId();
+
+    // Votes as the vote RPC encodes them: the marker pushed, then the payload
+    CGovernanceVote yes = MakeStubVote(key, proposal.proposal_id, VOTE_YES, 10 * COIN);
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << yes;
+    CScript yesScript = CScript() << OP_RETURN << std::vector<unsigned char>{FC_MARKER, FC_MARKER_GOVERNANCE_VOTE} << std::vector<unsigned char>(ss.begin(), ss.end());
+
+    std::vector<CBlock> blocks(2);
+    std::vector<uint256> hashes(2);
+    std::vector<CBlockIndex> indexes(2);
+    blocks[0].vtx.push_back(MakeTransactionRef(CMutableTransaction()));
+    blocks[0].vtx.push_back(MakeMarkerTx(MakeRawMarkerScript(FC_MARKER_GOVERNANCE_PROPOSAL, proposal)));
+    blocks[0].vtx.push_back(MakeMarkerTx(yesScript));
+    blocks[1].vtx.push_back(MakeTransactionRef(CMutableTransaction()));
+    blocks[1].vtx.push_back(MakeMarkerTx(MakeRawMarkerScript(FC_MARKER_GOVERNANCE_VOTE, MakeStubVote(key, proposal.proposal_id, VOTE_NO, 5 * COIN))));
+    blocks[1].vtx.push_back(MakeMarkerTx(yesScript)); // counted once only
+    blocks[1].vtx.push_back(MakeMarkerTx(MakeRawMarkerScript(FC_MARKER_GOVERNANCE_VOTE, MakeStubVote(key, GetRandHash(), VOTE_NO, 5 * COIN))));
+    for (int i = 0; i < 2; i++) {
+        blocks[i].nNonce = i;
+        hashes[i] = blocks[i].GetHash();
+        indexes[i].phashBlock = &hashes[i];
+        indexes[i].nHeight = i + 1;
+        indexes[i].pprev = i ? &indexes[i - 1] : NULL;
+    }
+
+    BOOST_CHECK(governancedb.WriteBlock(blocks[0], &indexes[0]));
+    CGovernanceProposalEntry entry;
+    BOOST_CHECK(governancedb.GetProposal(proposal.proposal_id, entry));
+    BOOST_CHECK(entry.txid == blocks[0].vtx[1]->GetHash());
+    BOOST_CHECK_EQUAL(entry.nHeight, 1);
+    BOOST_CHECK_EQUAL(entry.tally.yes_votes, 1);
+    BOOST_CHECK_EQUAL(entry.tally.yes_power, 10 * COIN);
+
+    BOOST_CHECK(governancedb.WriteBlock(blocks[1], &indexes[1]));
+    BOOST_CHECK(governancedb.GetBestBlock() == hashes[1]);
+    BOOST_CHECK(governancedb.GetProposal(proposal.proposal_id, entry));
+    BOOST_CHECK_EQUAL(entry.tally.yes_votes, 1);
+    BOOST_CHECK_EQUAL(entry.tally.no_votes, 1);
+    BOOST_CHECK_EQUAL(entry.tally.GetTotalPower(), 15 * COIN);
+    std::vector<CGovernanceVote> vVotes;
+    BOOST_CHECK(governancedb.GetVotes(proposal.proposal_id, vVotes));
+    BOOST_CHECK_EQUAL(vVotes.size(), 2U);
+    BOOST_CHECK_EQUAL(governancedb.GetProposals().size(), 1U);
+
+    // Disconnecting takes out exactly what each block added
+    BOOST_CHECK(governancedb.EraseBlock(&indexes[1]));
+    BOOST_CHECK(governancedb.GetBestBlock() == hashes[0]);
+    BOOST_CHECK(governancedb.GetProposal(proposal.proposal_id, entry));
+    BOOST_CHECK_EQUAL(entry.tally.yes_votes, 1);
+    BOOST_CHECK_EQUAL(entry.tally.no_votes, 0);
+    BOOST_CHECK_EQUAL(entry.tally.GetTotalPower(), 10 * COIN);
+    BOOST_CHECK(governancedb.EraseBlock(&indexes[0]));
+    BOOST_CHECK(governancedb.GetBestBlock().IsNull());
+    BOOST_CHECK(!governancedb.GetProposal(proposal.proposal_id, entry));
+    vVotes.clear();
+    BOOST_CHECK(governancedb.GetVotes(proposal.proposal_id, vVotes));
+    BOOST_CHECK(vVotes.empty());
+}
+
+BOOST_AUTO_TEST_CASE(governance_proposal_status)
+{
+    CGovernanceProposalEntry entry;
+    entry.proposal.voting_end_time = 100;
+    entry.proposal.quorum_percentage = 10;
+    entry.proposal.approval_percentage = 50;
+    const CAmount nNetworkStake = 100 * COIN;
+
+    // Only approved proposals are decided, once voting has ended
+    BOOST_CHECK_EQUAL(entry.GetStatus(200, nNetworkStake), PROPOSAL_PENDING);
+    entry.proposal.status = PROPOSAL_APPROVED;
+    BOOST_CHECK_EQUAL(entry.GetStatus(99, nNetworkStake), PROPOSAL_APPROVED);
+    BOOST_CHECK_EQUAL(entry.GetStatus(100, nNetworkStake), PROPOSAL_EXPIRED);
+
+    // The outcome follows the tally, so removing a vote changes it back
+    CKey key;
+    key.MakeNewKey(true);
+    CGovernanceVote yes = MakeStubVote(key, uint256(), VOTE_YES, 6 * COIN);
+    CGovernanceVote no = MakeStubVote(key, uint256(), VOTE_NO, 5 * COIN);
+    entry.tally.AddVote(yes);
+    BOOST_CHECK_EQUAL(entry.GetStatus(100, nNetworkStake), PROPOSAL_EXPIRED);
+    entry.tally.AddVote(no);
+    BOOST_CHECK_EQUAL(entry.GetStatus(100, nNetworkStake), PROPOSAL_EXECUTED);
+    entry.tally.AddVote(no);
+    BOOST_CHECK_EQUAL(entry.GetStatus(100, nNetworkStake), PROPOSAL_REJECTED);
+    entry.tally.RemoveVote(no);
+    BOOST_CHECK_EQUAL(entry.GetStatus(100, nNetworkStake), PROPOSAL_EXECUTED);
+
+    // Execution waits for the execution time
+    entry.proposal.execution_time = 150;
+    BOOST_CHECK_EQUAL(entry.GetStatus(120, nNetworkStake), PROPOSAL_APPROVED);
+    BOOST_CHECK_EQUAL(entry.GetStatus(150, nNetworkStake), PROPOSAL_EXECUTED);
+}
+
+BOOST_FIXTURE_TEST_CASE(governance_db_sync, TestChain240Setup)
+{
+    CGovernanceDB governancedb(1 << 20, true);
+    BOOST_CHECK(!governancedb.IsSynced());
+
+    // Sync catches up with the chain without cs_main held and then follows its notifications
+    RegisterValidationInterface(&governancedb);
+    BOOST_CHECK(governancedb.Sync(Params()));
+    BOOST_CHECK(governancedb.IsSynced());
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(governancedb.GetBestBlock() == chainActive.Tip()->GetBlockHash());
+    }
+
+    CScript scriptPubKey = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    CBlock block = CreateAndProcessBlock(std::vector<CMutableTransaction>(), scriptPubKey);
+    BOOST_CHECK(governancedb.GetBestBlock() == block.GetHash());
+    UnregisterValidationInterface(&governancedb);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -128,6 +128,16 @@ BOOST_AUTO_TEST_CASE(siphash)
     tx.nVersion = 1;
     ss << tx;
     BOOST_CHECK_EQUAL(SipHashUint256(1, 2, ss.GetHash()), 0x79751e980c2a0a35ULL);
+
+    // The outpoint variant hashes the 32 bytes of the txid followed by the
+    // 4 little endian bytes of the output index
+    const uint256 txid = ss.GetHash();
+    for (uint32_t n : {0u, 1u, 0x12345678u, 0xffffffffu}) {
+        const unsigned char vn[4] = {(unsigned char)n, (unsigned char)(n >> 8), (unsigned char)(n >> 16), (unsigned char)(n >> 24)};
+        CSipHasher hasher4(1, 2);
+        hasher4.Write(txid.begin(), 32).Write(vn, 4);
+        BOOST_CHECK_EQUAL(SipHashUint256Extra(1, 2, txid, n), hasher4.Finalize());
+    }
 }
 
 BOOST_AUTO_TEST_SUITE_END()
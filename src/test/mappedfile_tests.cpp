@@ -0,0 +1,74 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "mappedfile.h"
+#include "chainparams.h"
+#include "validation.h"
+#include "test/test_fleetcredits.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <boost/test/unit_test.hpp>
+
+struct RegtestingSetup : public TestingSetup {
+    RegtestingSetup() : TestingSetup(CBaseChainParams::REGTEST) {}
+};
+
+BOOST_FIXTURE_TEST_SUITE(mappedfile_tests, RegtestingSetup)
+
+BOOST_AUTO_TEST_CASE(mappedfile_open)
+{
+    fs::path path = pathTemp / "mappedfile_test.dat";
+    BOOST_CHECK(!CMappedFile::Open(path));
+
+    FILE* file = fsbridge::fopen(path, "wb");
+    BOOST_REQUIRE(file);
+    fclose(file);
+    if (!CMappedFile::IsSupported()) {
+        BOOST_CHECK(!CMappedFile::Open(path));
+        return;
+    }
+
+    // Empty files cannot be mapped
+    BOOST_CHECK(!CMappedFile::Open(path));
+
+    const char data[] = "Fleet Credits mapped file";
+    file = fsbridge::fopen(path, "wb");
+    BOOST_REQUIRE(file);
+    BOOST_REQUIRE_EQUAL(fwrite(data, 1, sizeof(data), file), sizeof(data));
+    fclose(file);
+
+    std::shared_ptr<const CMappedFile> map = CMappedFile::Open(path);
+    BOOST_REQUIRE(map);
+    BOOST_CHECK(map->GetPath() == path);
+    BOOST_CHECK_EQUAL(map->size(), sizeof(data));
+    BOOST_CHECK(memcmp(map->data(), data, sizeof(data)) == 0);
+
+    // The mapping stays readable after the file has been removed
+    fs::remove(path);
+    BOOST_CHECK(memcmp(map->data(), data, sizeof(data)) == 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(mappedfile_read_blocks, TestChain240Setup)
+{
+    LOCK(cs_main);
+    for (CBlockIndex* pindex = chainActive.Tip(); pindex; pindex = pindex->pprev) {
+        // Each read serves the file from the same cached mapping
+        const Consensus::Params& consensusParams = Params().GetConsensus(pindex->nHeight);
+        CBlock block;
+        BOOST_CHECK(ReadBlockFromDisk(block, pindex, consensusParams));
+        BOOST_CHECK(block.GetHash() == pindex->GetBlockHash());
+        CBlockHeader header;
+        BOOST_CHECK(ReadBlockHeaderFromDisk(header, pindex, consensusParams));
+        BOOST_CHECK(header.GetHash() == pindex->GetBlockHash());
+    }
+
+    // Unknown files are not mapped and fall back to the regular read
+    CDiskBlockPos pos(chainActive.Tip()->GetBlockPos().nFile + 1, 8);
+    CBlock block;
+    BOOST_CHECK(!ReadBlockFromDisk(block, pos, Params().GetConsensus(0)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -10,8 +10,11 @@
 #include "consensus/validation.h"
 #include "validation.h"
 #include "miner.h"
+#include "pow.h"
 #include "policy/policy.h"
+#include "key.h"
 #include "pubkey.h"
+#include "script/interpreter.h"
 #include "script/standard.h"
 #include "txmempool.h"
 #include "uint256.h"
@@ -19,6 +22,7 @@
 #include "utilstrencodings.h"
 
 #include "test/test_fleetcredits.h"
+#include "test/test_markers.h"
 
 #include <memory>
 #include <algorithm>
@@ -357,6 +361,8 @@ BOOST_AUTO_TEST_CASE(CreateNewBlock_validity)
         CBlockIndex* next = new CBlockIndex();
         next->phashBlock = new uint256(InsecureRand256());
         pcoinsTip->SetBestBlock(next->GetBlockHash());
+        pmwebcoinsTip->SetBestBlock(next->GetBlockHash());
+        poraclesTip->SetBestBlock(next->GetBlockHash());
         next->pprev = prev;
         next->nHeight = prev->nHeight + 1;
         next->BuildSkip();
@@ -369,6 +375,8 @@ BOOST_AUTO_TEST_CASE(CreateNewBlock_validity)
         CBlockIndex* next = new CBlockIndex();
         next->phashBlock = new uint256(InsecureRand256());
         pcoinsTip->SetBestBlock(next->GetBlockHash());
+        pmwebcoinsTip->SetBestBlock(next->GetBlockHash());
+        poraclesTip->SetBestBlock(next->GetBlockHash());
         next->pprev = prev;
         next->nHeight = prev->nHeight + 1;
         next->BuildSkip();
@@ -380,6 +388,8 @@ BOOST_AUTO_TEST_CASE(CreateNewBlock_validity)
         CBlockIndex* del = chainActive.Tip();
         chainActive.SetTip(del->pprev);
         pcoinsTip->SetBestBlock(del->pprev->GetBlockHash());
+        pmwebcoinsTip->SetBestBlock(del->pprev->GetBlockHash());
+        poraclesTip->SetBestBlock(del->pprev->GetBlockHash());
         delete del->phashBlock;
         delete del;
     }
@@ -489,4 +499,106 @@ BOOST_AUTO_TEST_CASE(CreateNewBlock_validity)
     fCheckpointsEnabled = true;
 }
 
+BOOST_AUTO_TEST_CASE(SearchNonce_matches_serial_search)
+{
+    // An easy regtest target, met by about one nonce in 256
+    const Consensus::Params& params = Params(CBaseChainParams::REGTEST).GetConsensus(0);
+    const unsigned int nBits = 0x2000ffff;
+    const uint32_t nNonceEnd = 0x10000;
+
+    CPureBlockHeader header;
+    header.nVersion = 4;
+    header.hashPrevBlock = uint256S("0x1c4a");
+    header.hashMerkleRoot = uint256S("0x3d0e");
+    header.nTime = 1700000000;
+    header.nBits = nBits;
+
+    // The first two valid nonces, found one at a time
+    std::vector<uint32_t> vExpected;
+    CPureBlockHeader serial = header;
+    serial.nNonce = 0;
+    while (vExpected.size() < 2) {
+        if (CheckProofOfWork(serial.GetPoWHash(), nBits, params))
+            vExpected.push_back(serial.nNonce);
+        serial.nNonce++;
+    }
+
+    for (int nThreads : {1, 4}) {
+        CPureBlockHeader candidate = header;
+        candidate.nNonce = 0;
+        uint64_t nMaxTries = nNonceEnd;
+        BOOST_CHECK(SearchNonce(candidate, nBits, params, nNonceEnd, nMaxTries, nThreads));
+        BOOST_CHECK_EQUAL(candidate.nNonce, vExpected[0]);
+        BOOST_CHECK_EQUAL(nMaxTries, nNonceEnd - vExpected[0]);
+
+        // Carrying on from the next nonce finds the second
+        candidate.nNonce++;
+        nMaxTries--;
+        BOOST_CHECK(SearchNonce(candidate, nBits, params, nNonceEnd, nMaxTries, nThreads));
+        BOOST_CHECK_EQUAL(candidate.nNonce, vExpected[1]);
+        BOOST_CHECK_EQUAL(nMaxTries, nNonceEnd - vExpected[1]);
+
+        // Running out of tries just before a valid nonce
+        candidate.nNonce = 0;
+        nMaxTries = vExpected[0];
+        BOOST_CHECK(!SearchNonce(candidate, nBits, params, nNonceEnd, nMaxTries, nThreads));
+        BOOST_CHECK_EQUAL(candidate.nNonce, vExpected[0]);
+        BOOST_CHECK_EQUAL(nMaxTries, 0);
+
+        // Running out of nonces just before a valid one
+        candidate.nNonce = 0;
+        nMaxTries = nNonceEnd;
+        BOOST_CHECK(!SearchNonce(candidate, nBits, params, vExpected[0], nMaxTries, nThreads));
+        BOOST_CHECK_EQUAL(candidate.nNonce, vExpected[0]);
+        BOOST_CHECK_EQUAL(nMaxTries, nNonceEnd - vExpected[0]);
+        BOOST_CHECK(!SearchNonce(candidate, nBits, params, vExpected[0], nMaxTries, nThreads));
+        BOOST_CHECK_EQUAL(nMaxTries, nNonceEnd - vExpected[0]);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(CreateNewBlock_contribution_bonus, TestChain240Setup)
+{
+    // The miner earns half of the subsidy bonus a contribution adds, so a
+    // transaction carrying one is selected before one paying a higher fee
+    const CChainParams& chainparams = Params();
+    CScript scriptPubKey = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    TestMemPoolEntryHelper entry;
+
+    // Both fees clear the block minimum fee rate on their own
+    const CAmount nFees[2] = {RECOMMENDED_MIN_TX_FEE, 2 * RECOMMENDED_MIN_TX_FEE};
+    std::vector<CMutableTransaction> spends(2);
+    for (int i = 0; i < 2; i++) {
+        spends[i].nVersion = 1;
+        spends[i].vin.resize(1);
+        spends[i].vin[0].prevout = COutPoint(coinbaseTxns[i].GetHash(), 0);
+        spends[i].vout.resize(1);
+        spends[i].vout[0].nValue = coinbaseTxns[i].vout[0].nValue - nFees[i];
+        spends[i].vout[0].scriptPubKey = scriptPubKey;
+        if (i == 0) {
+            CContributionTransaction contrib = MakeStubContribution(coinbaseKey, CREATIVE_WORK, BONUS_LOW);
+            spends[i].vout.push_back(CTxOut(0, MakeRawMarkerScript(FC_MARKER_CONTRIBUTION, contrib)));
+        }
+
+        std::vector<unsigned char> vchSig;
+        uint256 hash = SignatureHash(scriptPubKey, spends[i], 0, SIGHASH_ALL, 0, SIGVERSION_BASE);
+        BOOST_CHECK(coinbaseKey.Sign(hash, vchSig));
+        vchSig.push_back((unsigned char)SIGHASH_ALL);
+        spends[i].vin[0].scriptSig << vchSig;
+        mempool.addUnchecked(spends[i].GetHash(), entry.Fee(nFees[i]).Time(GetTime()).SpendsCoinbase(true).FromTx(spends[i]));
+    }
+    BOOST_CHECK_EQUAL(mempool.GetContributionTxs().size(), 1);
+
+    // Leave out the priority area, which takes a transaction regardless of its fee
+    ForceSetArg("-blockprioritysize", "0");
+    std::unique_ptr<CBlockTemplate> pblocktemplate = BlockAssembler(chainparams).CreateNewBlock(scriptPubKey, true);
+    ForceSetArg("-blockprioritysize", std::to_string(DEFAULT_BLOCK_PRIORITY_SIZE));
+    BOOST_REQUIRE(pblocktemplate);
+    BOOST_REQUIRE_EQUAL(pblocktemplate->block.vtx.size(), 3);
+    BOOST_CHECK(pblocktemplate->block.vtx[1]->GetHash() == spends[0].GetHash());
+    BOOST_CHECK(pblocktemplate->block.vtx[2]->GetHash() == spends[1].GetHash());
+
+    mempool.clear();
+    BOOST_CHECK(mempool.GetContributionTxs().empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
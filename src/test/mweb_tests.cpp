@@ -3,16 +3,29 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "test/mweb_test.h"
+#include "chain.h"
+#include "chainparamsbase.h"
+#include "clientversion.h"
+#include "mweb_coins.h"
+#include "mweb_mempool.h"
+#include "mweb_verifycache.h"
 #include "primitives/mweb.h"
 #include "primitives/contribution.h"
 #include "primitives/block.h"
 #include "primitives/verification.h"
+#include "protocol.h"
 #include "random.h"
 #include "hash.h"
+#include "streams.h"
+#include "txdb.h"
 
 #include <boost/test/unit_test.hpp>
 #include <vector>
 
+struct RegtestingSetup : public TestingSetup {
+    RegtestingSetup() : TestingSetup(CBaseChainParams::REGTEST) {}
+};
+
 BOOST_FIXTURE_TEST_SUITE(mweb_tests, BasicTestingSetup)
 
 BOOST_AUTO_TEST_CASE(mweb_transaction_structure)
@@ -159,6 +172,422 @@ BOOST_AUTO_TEST_CASE(mweb_cut_through)
     BOOST_CHECK(MWEBTest::VerifyMWEBExtensionBlockStructure(cut_block));
 }
 
+static CPubKey RandomCommitment()
+{
+    std::vector<unsigned char> vch(CPubKey::COMPRESSED_SIZE);
+    GetRandBytes(vch.data(), vch.size());
+    vch[0] = 0x02;
+    return CPubKey(vch);
+}
+
+BOOST_AUTO_TEST_CASE(mweb_cut_through_large)
+{
+    // Outputs beyond index 10000 of a transaction are cut through correctly,
+    // and an output cancels a single input even if spent twice
+    CMWEBExtensionBlock block;
+    block.mweb_txs.resize(2);
+    CMWEBTransaction& funding = block.mweb_txs[0];
+    funding.outputs.resize(10002);
+    for (auto& output : funding.outputs) {
+        output.commitment.commitment = RandomCommitment();
+    }
+
+    CMWEBTransaction& spending = block.mweb_txs[1];
+    spending.inputs.resize(4);
+    spending.inputs[0].output_commitment = funding.outputs[10001].commitment;
+    spending.inputs[1].output_commitment.commitment = RandomCommitment();
+    spending.inputs[2].output_commitment = funding.outputs[3].commitment;
+    spending.inputs[3].output_commitment = funding.outputs[3].commitment;
+    spending.outputs.resize(1);
+    spending.outputs[0].commitment.commitment = RandomCommitment();
+
+    const CPubKey unknown = spending.inputs[1].output_commitment.commitment;
+    const CPubKey kept = funding.outputs[10000].commitment.commitment;
+    CMWEBExtensionBlock cut_block = MWEB::CutThrough(block);
+
+    BOOST_CHECK_EQUAL(cut_block.mweb_txs[0].outputs.size(), 10000);
+    BOOST_CHECK(cut_block.mweb_txs[0].outputs[3].commitment.commitment == block.mweb_txs[0].outputs[4].commitment.commitment);
+    BOOST_CHECK(cut_block.mweb_txs[0].outputs.back().commitment.commitment == kept);
+    BOOST_CHECK_EQUAL(cut_block.mweb_txs[1].inputs.size(), 2);
+    BOOST_CHECK(cut_block.mweb_txs[1].inputs[0].output_commitment.commitment == unknown);
+    BOOST_CHECK(cut_block.mweb_txs[1].inputs[1].output_commitment.commitment == block.mweb_txs[0].outputs[3].commitment.commitment);
+    BOOST_CHECK_EQUAL(cut_block.mweb_txs[1].outputs.size(), 1);
+
+    // The in-place variant gives the same result
+    MWEB::ApplyCutThrough(block);
+    BOOST_CHECK(block.GetHash() == cut_block.GetHash());
+}
+
+/** A blinding factor small enough for sums of them not to wrap */
+static uint256 SmallBlindingFactor(unsigned char n)
+{
+    uint256 r;
+    *(r.end() - 1) = n;
+    return r;
+}
+
+/** A transaction whose input less its output equals its kernel excess */
+static CMWEBTransaction MakeBalancedTransaction(unsigned char value, unsigned char blind)
+{
+    CMWEBTransaction tx = MWEBTest::CreateTestMWEBTransaction(value, SmallBlindingFactor(blind));
+    tx.kernels[0].excess_value = MWEB::CreateCommitment(1, SmallBlindingFactor(1)).commitment;
+    CMWEBInput input;
+    input.output_commitment = MWEB::CreateCommitment(value + 1, SmallBlindingFactor(blind + 1));
+    tx.inputs.push_back(input);
+    tx.tx_hash = tx.GetHash();
+    return tx;
+}
+
+BOOST_AUTO_TEST_CASE(mweb_verify_all_balance)
+{
+    // Test that VerifyAll decides on the balance of each transaction
+    std::vector<CMWEBTransaction> txs;
+    for (int i = 0; i < 4; i++) {
+        txs.push_back(MakeBalancedTransaction(10 * (i + 1), 20 * (i + 1)));
+        BOOST_CHECK(txs.back().VerifyBalance());
+    }
+    
+    CMWEBExtensionBlock block = MWEBTest::CreateTestMWEBExtensionBlock(txs);
+    BOOST_CHECK(block.VerifyAll());
+    
+    // A transaction whose input and output cancel fails VerifyBalance
+    std::vector<CMWEBTransaction> cancelling_txs = txs;
+    cancelling_txs[2].inputs[0].output_commitment = cancelling_txs[2].outputs[0].commitment;
+    BOOST_CHECK(!cancelling_txs[2].VerifyBalance());
+    BOOST_CHECK(!MWEBTest::CreateTestMWEBExtensionBlock(cancelling_txs).VerifyAll());
+    
+    // Output-only transactions (as created by RouteToMWEB) pass VerifyBalance
+    std::vector<CMWEBTransaction> routed_txs = txs;
+    routed_txs.push_back(MWEBTest::CreateTestMWEBTransaction(500 * COIN, GetRandHash()));
+    BOOST_CHECK(routed_txs.back().VerifyBalance());
+    BOOST_CHECK(MWEBTest::CreateTestMWEBExtensionBlock(routed_txs).VerifyAll());
+    
+    // A transaction without a valid kernel fails VerifyAll
+    std::vector<CMWEBTransaction> bad_kernel_txs = txs;
+    bad_kernel_txs[2].kernels[0].signature.clear();
+    BOOST_CHECK(!MWEBTest::CreateTestMWEBExtensionBlock(bad_kernel_txs).VerifyAll());
+    
+    // An unparseable commitment fails VerifyAll
+    std::vector<CMWEBTransaction> bad_commitment_txs = txs;
+    std::vector<unsigned char> bad_point(33, 0xff);
+    bad_point[0] = 0x02;
+    bad_commitment_txs[1].outputs[0].commitment.commitment.Set(bad_point.begin(), bad_point.end());
+    BOOST_CHECK(!MWEBTest::CreateTestMWEBExtensionBlock(bad_commitment_txs).VerifyAll());
+}
+
+BOOST_AUTO_TEST_CASE(mweb_verify_all_checks)
+{
+    // Test that VerifyAll hands out checks covering every transaction
+    std::vector<CMWEBTransaction> txs;
+    for (size_t i = 0; i < 2 * MWEB_CHECK_TXS + 3; i++) {
+        txs.push_back(MWEBTest::CreateTestMWEBTransaction((i + 1) * COIN, GetRandHash()));
+    }
+    CMWEBExtensionBlock block = MWEBTest::CreateTestMWEBExtensionBlock(txs);
+    
+    std::vector<CMWEBCheck> vChecks;
+    BOOST_CHECK(block.VerifyAll(&vChecks));
+    BOOST_CHECK_EQUAL(vChecks.size(), 3);
+    for (auto& check : vChecks) {
+        BOOST_CHECK(check());
+    }
+    
+    // A bad range proof in the last range is only caught by its check
+    block.mweb_txs.back().outputs[0].range_proof.proof_data[0] ^= 0x01;
+    vChecks.clear();
+    BOOST_CHECK(block.VerifyAll(&vChecks));
+    BOOST_CHECK(vChecks[0]());
+    BOOST_CHECK(vChecks[1]());
+    BOOST_CHECK(!vChecks[2]());
+    BOOST_CHECK(!block.VerifyAll());
+}
+
+BOOST_AUTO_TEST_CASE(mweb_verify_all_inline_matches_queue)
+{
+    // A transaction whose input and output cancel out is offset by another
+    // one, so that the block balances as a whole
+    std::vector<CMWEBTransaction> txs;
+    for (size_t i = 0; i < 2 * MWEB_CHECK_TXS; i++) {
+        txs.push_back(MakeBalancedTransaction(i + 1, 2 * (i + 1)));
+    }
+    txs[1].inputs[0].output_commitment = txs[1].outputs[0].commitment;
+    txs[1].tx_hash = txs[1].GetHash();
+    CMWEBInput offset;
+    offset.output_commitment.commitment = txs[1].kernels[0].excess_value;
+    txs.back().inputs.push_back(offset);
+    txs.back().tx_hash = txs.back().GetHash();
+    BOOST_CHECK(!txs[1].VerifyBalance());
+    BOOST_CHECK(txs.back().VerifyBalance());
+
+    // The block is rejected inline, in a single range ...
+    CMWEBExtensionBlock block = MWEBTest::CreateTestMWEBExtensionBlock(txs);
+    BOOST_CHECK(!block.VerifyAll());
+
+    // ... and through the check queue, by the range holding the transaction
+    std::vector<CMWEBCheck> vChecks;
+    BOOST_CHECK(block.VerifyAll(&vChecks));
+    BOOST_REQUIRE_EQUAL(vChecks.size(), 2);
+    BOOST_CHECK(!vChecks[0]());
+    BOOST_CHECK(vChecks[1]());
+
+    // Without it both accept the block
+    block.mweb_txs.erase(block.mweb_txs.begin() + 1);
+    BOOST_CHECK(block.VerifyAll());
+    vChecks.clear();
+    BOOST_CHECK(block.VerifyAll(&vChecks));
+    BOOST_REQUIRE_EQUAL(vChecks.size(), 2);
+    BOOST_CHECK(vChecks[0]());
+    BOOST_CHECK(vChecks[1]());
+}
+
+BOOST_AUTO_TEST_CASE(mweb_verify_cache)
+{
+    std::vector<CMWEBTransaction> txs;
+    for (size_t i = 0; i < 4; i++) {
+        txs.push_back(MWEBTest::CreateTestMWEBTransaction((i + 1) * COIN, GetRandHash()));
+    }
+    CMWEBExtensionBlock block = MWEBTest::CreateTestMWEBExtensionBlock(txs);
+    BOOST_CHECK(!IsMWEBTransactionVerified(txs[1], false));
+
+    // Entering the mempool records the transaction as verified
+    CMWEBMempool pool;
+    BOOST_CHECK(pool.AddMWEBTransaction(txs[1]));
+    BOOST_CHECK(IsMWEBTransactionVerified(txs[1], false));
+
+    // ... so block validation only checks the others
+    std::vector<CMWEBCheck> vChecks;
+    BOOST_CHECK(block.VerifyAll(&vChecks, true));
+    BOOST_CHECK_EQUAL(vChecks.size(), 2);
+    for (auto& check : vChecks) {
+        BOOST_CHECK(check());
+    }
+
+    // Checking a block neither remembers the others nor forgets txs[1]
+    vChecks.clear();
+    BOOST_CHECK(block.VerifyAll(&vChecks, true));
+    BOOST_CHECK_EQUAL(vChecks.size(), 2);
+    BOOST_CHECK(IsMWEBTransactionVerified(txs[1], false));
+    BOOST_CHECK(!IsMWEBTransactionVerified(txs[2], false));
+
+    // The cache is keyed on the contents, not on the claimed tx_hash
+    CMWEBTransaction tampered = txs[2];
+    tampered.outputs[0].range_proof.proof_data[0] ^= 0x01;
+    BOOST_CHECK(!IsMWEBTransactionVerified(tampered, false));
+}
+
+BOOST_AUTO_TEST_CASE(mweb_coins_connect_disconnect)
+{
+    // Outputs created by an extension block become spendable, spending them
+    // is recorded in undo data and disconnecting restores the previous set
+    CMWEBCoinsView dummy;
+    CMWEBCoinsViewCache base(&dummy);
+    CMWEBCoinsViewCache view(&base);
+
+    CMWEBTransaction tx_create = MWEBTest::CreateTestMWEBTransaction(5 * COIN, GetRandHash());
+    CMWEBExtensionBlock block1 = MWEBTest::CreateTestMWEBExtensionBlock(std::vector<CMWEBTransaction>(1, tx_create));
+    CMWEBBlockUndo undo1;
+    BOOST_CHECK(UpdateMWEBCoins(block1, view, undo1, 1));
+    BOOST_CHECK(undo1.vspent.empty());
+    const CPubKey& created = tx_create.outputs[0].commitment.commitment;
+    BOOST_CHECK(view.HaveCoin(created));
+    BOOST_CHECK_EQUAL(view.AccessCoin(created)->nHeight, 1);
+
+    // Creating the same output twice is rejected
+    CMWEBBlockUndo undo_dup;
+    BOOST_CHECK(!ApplyMWEBTransaction(tx_create, view, undo_dup, 2));
+
+    view.SetBestBlock(GetRandHash());
+    BOOST_CHECK(view.Flush());
+    BOOST_CHECK(base.HaveCoin(created));
+    BOOST_CHECK_EQUAL(view.GetCacheSize(), 0);
+
+    CMWEBTransaction tx_spend = MWEBTest::CreateTestMWEBTransaction(4 * COIN, GetRandHash());
+    CMWEBInput input;
+    input.output_commitment = tx_create.outputs[0].commitment;
+    tx_spend.inputs.push_back(input);
+    CMWEBExtensionBlock block2 = MWEBTest::CreateTestMWEBExtensionBlock(std::vector<CMWEBTransaction>(1, tx_spend));
+    CMWEBBlockUndo undo2;
+    BOOST_CHECK(UpdateMWEBCoins(block2, view, undo2, 2));
+    BOOST_CHECK_EQUAL(undo2.vspent.size(), 1);
+    BOOST_CHECK(undo2.vspent[0].output.commitment.commitment == created);
+    BOOST_CHECK(!view.HaveCoin(created));
+    BOOST_CHECK(view.HaveCoin(tx_spend.outputs[0].commitment.commitment));
+
+    // A second spend of the same output fails
+    CMWEBBlockUndo undo_double;
+    BOOST_CHECK(!UpdateMWEBCoins(block2, view, undo_double, 3));
+
+    BOOST_CHECK(DisconnectMWEBCoins(block2, view, undo2));
+    BOOST_CHECK(view.HaveCoin(created));
+    BOOST_CHECK(!view.HaveCoin(tx_spend.outputs[0].commitment.commitment));
+
+    // Undo data that does not match the block is refused
+    BOOST_CHECK(!DisconnectMWEBCoins(block2, view, undo1));
+
+    // An input spending an unknown output is rejected
+    CMWEBBlockUndo undo_missing;
+    CMWEBTransaction tx_missing = tx_spend;
+    tx_missing.inputs[0].output_commitment = MWEB::CreateCommitment(COIN, GetRandHash());
+    BOOST_CHECK(!ApplyMWEBTransaction(tx_missing, view, undo_missing, 2));
+}
+
+BOOST_FIXTURE_TEST_CASE(mweb_coins_flush_with_chainstate, RegtestingSetup)
+{
+    CCoinsViewDB coinsdb(1 << 20, true);
+    CMWEBCoinsViewDB mwebdb(coinsdb);
+    CMWEBCoinsViewCache view(&mwebdb);
+    CCoinsViewCache coins(&coinsdb);
+
+    CMWEBTransaction tx = MWEBTest::CreateTestMWEBTransaction(5 * COIN, GetRandHash());
+    CMWEBBlockUndo undo;
+    BOOST_CHECK(UpdateMWEBCoins(MWEBTest::CreateTestMWEBExtensionBlock(std::vector<CMWEBTransaction>(1, tx)), view, undo, 1));
+    const uint256 hashBlock = GetRandHash();
+    view.SetBestBlock(hashBlock);
+    coins.SetBestBlock(hashBlock);
+
+    // The MWEB flush alone does not reach the database
+    BOOST_CHECK(view.Flush());
+    BOOST_CHECK(!mwebdb.HaveCoin(tx.outputs[0].commitment.commitment));
+    BOOST_CHECK(mwebdb.GetBestBlock().IsNull());
+
+    // The coins flush commits both in one batch
+    BOOST_CHECK(coins.Flush());
+    BOOST_CHECK(mwebdb.HaveCoin(tx.outputs[0].commitment.commitment));
+    BOOST_CHECK(mwebdb.GetBestBlock() == hashBlock);
+    BOOST_CHECK(coinsdb.GetBestBlock() == hashBlock);
+}
+
+BOOST_FIXTURE_TEST_CASE(mweb_block_undo_erase_and_prune, RegtestingSetup)
+{
+    CCoinsViewDB coinsdb(1 << 20, true);
+    CMWEBCoinsViewDB mwebdb(coinsdb);
+    CCoinsViewCache coins(&coinsdb);
+
+    CMWEBBlockUndo undo;
+    std::vector<uint256> hashes;
+    for (int nHeight = 0; nHeight < 4; nHeight++) {
+        hashes.push_back(GetRandHash());
+        BOOST_CHECK(mwebdb.WriteBlockUndo(nHeight, hashes.back(), undo));
+    }
+    BOOST_CHECK(mwebdb.ReadBlockUndo(3, hashes[3], undo));
+    BOOST_CHECK(!mwebdb.ReadBlockUndo(2, hashes[3], undo));
+
+    // A disconnected block keeps its undo data until the chainstate is flushed
+    mwebdb.EraseBlockUndo(3, hashes[3]);
+    BOOST_CHECK(mwebdb.ReadBlockUndo(3, hashes[3], undo));
+    coins.SetBestBlock(hashes[2]);
+    BOOST_CHECK(coins.Flush());
+    BOOST_CHECK(!mwebdb.ReadBlockUndo(3, hashes[3], undo));
+
+    // Reconnecting after a staged erasure keeps the undo data
+    mwebdb.EraseBlockUndo(2, hashes[2]);
+    BOOST_CHECK(mwebdb.WriteBlockUndo(2, hashes[2], undo));
+    mwebdb.PruneBlockUndo(2);
+    coins.SetBestBlock(hashes[2]);
+    BOOST_CHECK(coins.Flush());
+    BOOST_CHECK(!mwebdb.ReadBlockUndo(0, hashes[0], undo));
+    BOOST_CHECK(!mwebdb.ReadBlockUndo(1, hashes[1], undo));
+    BOOST_CHECK(mwebdb.ReadBlockUndo(2, hashes[2], undo));
+}
+
+BOOST_AUTO_TEST_CASE(mweb_block_index_summary)
+{
+    // The extension summary survives a block index round trip, and entries
+    // without BLOCK_OPT_MWEB keep their old serialization
+    CBlockIndex index;
+    index.nStatus = BLOCK_VALID_TRANSACTIONS | BLOCK_OPT_MWEB;
+    index.hashMWEBExtension = GetRandHash();
+    index.nMWEBTx = 3;
+    index.nPegIn = 1;
+    index.nPegOut = 2;
+
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << CDiskBlockIndex(&index);
+    const size_t nSummarySize = ss.size();
+    CDiskBlockIndex diskindex;
+    ss >> diskindex;
+    BOOST_CHECK(diskindex.hashMWEBExtension == index.hashMWEBExtension);
+    BOOST_CHECK_EQUAL(diskindex.nMWEBTx, 3);
+    BOOST_CHECK_EQUAL(diskindex.nPegIn, 1);
+    BOOST_CHECK_EQUAL(diskindex.nPegOut, 2);
+
+    index.nStatus &= ~BLOCK_OPT_MWEB;
+    CDataStream ssLegacy(SER_DISK, CLIENT_VERSION);
+    ssLegacy << CDiskBlockIndex(&index);
+    BOOST_CHECK(ssLegacy.size() < nSummarySize);
+    CDiskBlockIndex legacyindex;
+    ssLegacy >> legacyindex;
+    BOOST_CHECK(ssLegacy.empty());
+    BOOST_CHECK(legacyindex.hashMWEBExtension.IsNull());
+    BOOST_CHECK_EQUAL(legacyindex.nMWEBTx, 0);
+}
+
+static CMWEBTransaction CreateFeeMWEBTransaction(uint64_t fee)
+{
+    CMWEBTransaction tx = MWEBTest::CreateTestMWEBTransaction(COIN, GetRandHash());
+    tx.kernels[0].fee = fee;
+    tx.tx_hash = tx.GetHash();
+    return tx;
+}
+
+BOOST_AUTO_TEST_CASE(mweb_mempool_fee_order_and_limit)
+{
+    CMWEBMempool pool;
+    CMWEBTransaction tx_low = CreateFeeMWEBTransaction(1000);
+    CMWEBTransaction tx_high = CreateFeeMWEBTransaction(3000);
+    CMWEBTransaction tx_mid = CreateFeeMWEBTransaction(2000);
+    BOOST_CHECK(pool.AddMWEBTransaction(tx_low));
+    BOOST_CHECK(pool.AddMWEBTransaction(tx_high));
+    BOOST_CHECK(pool.AddMWEBTransaction(tx_mid));
+    BOOST_CHECK_EQUAL(pool.Size(), 3);
+
+    // Highest fee rate first, shared rather than copied
+    std::vector<CMWEBTransactionRef> txs = pool.GetMWEBTransactions();
+    BOOST_CHECK_EQUAL(txs.size(), 3);
+    BOOST_CHECK(txs[0]->tx_hash == tx_high.tx_hash);
+    BOOST_CHECK(txs[1]->tx_hash == tx_mid.tx_hash);
+    BOOST_CHECK(txs[2]->tx_hash == tx_low.tx_hash);
+    BOOST_CHECK(pool.GetMWEBTransactions()[0] == txs[0]);
+
+    // Lookup by hash, as used to answer getdata for MSG_MWEB_TX
+    BOOST_CHECK(pool.Get(tx_mid.tx_hash) == txs[1]);
+    BOOST_CHECK(!pool.Get(GetRandHash()));
+    BOOST_CHECK_EQUAL(CInv(MSG_MWEB_TX, tx_mid.tx_hash).GetCommand(), NetMsgType::MWEBTX);
+
+    // Relay order of announcements, pending ones before those that left the pool
+    uint256 hashGone = GetRandHash();
+    BOOST_CHECK(pool.CompareFeeRate(tx_high.tx_hash, tx_mid.tx_hash));
+    BOOST_CHECK(!pool.CompareFeeRate(tx_low.tx_hash, tx_mid.tx_hash));
+    BOOST_CHECK(pool.CompareFeeRate(tx_low.tx_hash, hashGone));
+    BOOST_CHECK(!pool.CompareFeeRate(hashGone, tx_low.tx_hash));
+
+    // Size-bounded selection
+    std::vector<CMWEBTransactionRef> selected;
+    size_t nTxSize = ::GetSerializeSize(tx_high, SER_NETWORK, PROTOCOL_VERSION);
+    pool.SelectMWEBTransactions(nTxSize, selected);
+    BOOST_CHECK_EQUAL(selected.size(), 1);
+    BOOST_CHECK(selected[0]->tx_hash == tx_high.tx_hash);
+    selected.clear();
+    pool.SelectMWEBTransactions(0, selected);
+    BOOST_CHECK(selected.empty());
+
+    // Once full, the lowest fee rate transaction is evicted first and a
+    // transaction paying less than everything in the pool is refused
+    pool.SetLimits(pool.DynamicMemoryUsage(), 0);
+    CMWEBTransaction tx_top = CreateFeeMWEBTransaction(4000);
+    BOOST_CHECK(pool.AddMWEBTransaction(tx_top));
+    BOOST_CHECK(pool.Exists(tx_top.tx_hash));
+    BOOST_CHECK(!pool.Exists(tx_low.tx_hash));
+    BOOST_CHECK_EQUAL(pool.Size(), 3);
+    BOOST_CHECK(!pool.AddMWEBTransaction(CreateFeeMWEBTransaction(500)));
+    BOOST_CHECK_EQUAL(pool.Size(), 3);
+
+    BOOST_CHECK(pool.RemoveMWEBTransaction(tx_mid.tx_hash));
+    BOOST_CHECK(!pool.RemoveMWEBTransaction(tx_mid.tx_hash));
+    pool.Clear();
+    BOOST_CHECK_EQUAL(pool.Size(), 0);
+    BOOST_CHECK_EQUAL(pool.DynamicMemoryUsage(), 0);
+}
+
 BOOST_AUTO_TEST_CASE(mweb_view_key)
 {
     // Test view key generation
@@ -0,0 +1,291 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "oracles.h"
+#include "arith_uint256.h"
+#include "blockmarkers.h"
+#include "chainparams.h"
+#include "fleetcredits.h"
+#include "key.h"
+#include "primitives/verification.h"
+#include "test/test_fleetcredits.h"
+#include "test/test_markers.h"
+
+#include <set>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(oracles_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(oracle_sampler)
+{
+    std::vector<COracleNode> oracles;
+    for (int i = 0; i < 40; i++)
+        oracles.push_back(MakeStubOracle((500000 + i) * COIN));
+    oracles[3].is_active = false;
+    oracles[4].stake_fc = 1000 * COIN;
+
+    COracleSampler sampler;
+    for (const auto& oracle : oracles)
+        sampler.Update(oracle);
+    BOOST_CHECK_EQUAL(sampler.size(), 38U);
+
+    // Deterministic, distinct and eligible
+    const uint256 hashBlock = uint256S("0x01");
+    std::vector<CPubKey> selected = sampler.Select(hashBlock, uint256S("0x02"), 5);
+    BOOST_CHECK_EQUAL(selected.size(), 5U);
+    BOOST_CHECK(sampler.Select(hashBlock, uint256S("0x02"), 5) == selected);
+    BOOST_CHECK(std::set<CPubKey>(selected.begin(), selected.end()).size() == 5U);
+    for (const CPubKey& pubkey : selected)
+        BOOST_CHECK(pubkey != oracles[3].pubkey && pubkey != oracles[4].pubkey);
+    BOOST_CHECK(sampler.Select(hashBlock, uint256S("0x02"), 39).empty());
+
+    // The order of the updates does not matter
+    COracleSampler reversed;
+    for (auto it = oracles.rbegin(); it != oracles.rend(); ++it)
+        reversed.Update(*it);
+    BOOST_CHECK(reversed.Select(hashBlock, uint256S("0x02"), 5) == selected);
+
+    // Removing oracles leaves the draws of a sampler built from the rest
+    for (int i = 0; i < 30; i++) {
+        oracles[i].is_active = false;
+        sampler.Update(oracles[i]);
+    }
+    BOOST_CHECK_EQUAL(sampler.size(), 10U);
+    COracleSampler rebuilt;
+    for (const auto& oracle : oracles)
+        rebuilt.Update(oracle);
+    BOOST_CHECK_EQUAL(rebuilt.GetTotalStake(), sampler.GetTotalStake());
+    for (int i = 0; i < 20; i++) {
+        uint256 txid = ArithToUint256(arith_uint256(i));
+        BOOST_CHECK(sampler.Select(hashBlock, txid, 3) == rebuilt.Select(hashBlock, txid, 3));
+    }
+
+    // Draws follow stake
+    sampler.SetStake(oracles[39].pubkey, 1000000000 * COIN);
+    int nFirst = 0;
+    for (int i = 0; i < 100; i++) {
+        if (sampler.Select(hashBlock, ArithToUint256(arith_uint256(i)), 1)[0] == oracles[39].pubkey)
+            nFirst++;
+    }
+    BOOST_CHECK(nFirst > 90);
+}
+
+BOOST_AUTO_TEST_CASE(oracle_view_sampler)
+{
+    std::vector<CKey> keys(8);
+    COracleView base;
+    COracleViewCache parent(&base);
+    for (size_t i = 0; i < keys.size(); i++) {
+        keys[i].MakeNewKey(true);
+        COracleNode oracle = MakeStubOracle(500000 * COIN);
+        oracle.pubkey = keys[i].GetPubKey();
+        parent.SetOracle(oracle.pubkey, oracle);
+    }
+
+    // Selected oracles are registered and distinct
+    const uint256 hashBlock = uint256S("0x01");
+    std::vector<COracleNode> selected = parent.SelectOracles(hashBlock, uint256S("0x02"), 5);
+    BOOST_CHECK_EQUAL(selected.size(), 5U);
+    std::set<CPubKey> setSelected;
+    for (const COracleNode& oracle : selected) {
+        BOOST_CHECK(parent.AccessOracle(oracle.pubkey) != NULL);
+        setSelected.insert(oracle.pubkey);
+    }
+    BOOST_CHECK_EQUAL(setSelected.size(), 5U);
+    BOOST_CHECK(parent.SelectOracles(hashBlock, uint256S("0x02"), 9).empty());
+
+    // A child cache starts from the sampler of its parent and follows
+    // deactivations, stake changes and removals
+    COracleViewCache child(&parent);
+    COracleNode inactive = selected[0];
+    inactive.is_active = false;
+    child.SetOracle(inactive.pubkey, inactive);
+    COracleNode unstaked = selected[1];
+    unstaked.stake_fc = 1000 * COIN;
+    child.SetOracle(unstaked.pubkey, unstaked);
+    child.SetOracle(selected[2].pubkey, COracleNode());
+    BOOST_CHECK(child.SelectOracles(hashBlock, uint256S("0x02"), 6).empty());
+    for (int i = 0; i < 20; i++) {
+        for (const COracleNode& oracle : child.SelectOracles(hashBlock, ArithToUint256(arith_uint256(i)), 5)) {
+            BOOST_CHECK(oracle.pubkey != selected[0].pubkey);
+            BOOST_CHECK(oracle.pubkey != selected[1].pubkey);
+            BOOST_CHECK(oracle.pubkey != selected[2].pubkey);
+        }
+    }
+    BOOST_CHECK_EQUAL(parent.SelectOracles(hashBlock, uint256S("0x02"), 8).size(), 8U);
+
+    // Flushing brings the parent to the same draws
+    BOOST_CHECK(child.Flush());
+    for (int i = 0; i < 20; i++) {
+        uint256 txid = ArithToUint256(arith_uint256(i));
+        std::vector<COracleNode> fromParent = parent.SelectOracles(hashBlock, txid, 5);
+        std::vector<COracleNode> fromChild = child.SelectOracles(hashBlock, txid, 5);
+        BOOST_REQUIRE_EQUAL(fromParent.size(), 5U);
+        BOOST_REQUIRE_EQUAL(fromChild.size(), 5U);
+        for (size_t j = 0; j < fromParent.size(); j++)
+            BOOST_CHECK(fromParent[j].pubkey == fromChild[j].pubkey);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(oracle_state)
+{
+    std::vector<CKey> keys(4);
+    for (auto& key : keys)
+        key.MakeNewKey(true);
+    CKey contributor;
+    contributor.MakeNewKey(true);
+    CContributionTransaction contrib = MakeStubContribution(contributor, CHARITABLE_ACT, BONUS_HIGH);
+    contrib.tx_id = uint256S("0x01");
+    const uint256& record_id = contrib.proof_data.hash;
+
+    // Only correctly signed oracle markers are parsed
+    COracleVote forged = MakeOracleVote(keys[0], record_id, VOTE_APPROVE);
+    forged.vote_choice = VOTE_REJECT;
+    CMutableTransaction mtx;
+    mtx.vin.resize(1);
+    mtx.vin[0].prevout.hash = GetRandHash();
+    mtx.vout.resize(3);
+    mtx.vout[0].scriptPubKey = MakeRawMarkerScript(FC_MARKER_ORACLE_REGISTRATION, MakeOracleRegistration(keys[0], 500000 * COIN));
+    mtx.vout[1].scriptPubKey = MakeRawMarkerScript(FC_MARKER_ORACLE_VOTE, MakeOracleVote(keys[0], record_id, VOTE_APPROVE));
+    mtx.vout[2].scriptPubKey = MakeRawMarkerScript(FC_MARKER_ORACLE_VOTE, forged);
+    std::shared_ptr<const CBlockMarkers> parsed = GetTransactionMarkers(CTransaction(mtx));
+    BOOST_CHECK_EQUAL(parsed->oracle_registrations.size(), 1U);
+    BOOST_CHECK_EQUAL(parsed->oracle_votes.size(), 1U);
+
+    COracleView base;
+    COracleViewCache view(&base);
+
+    // Three staked oracles and one below the stake requirement register
+    CBlockMarkers registrations;
+    for (int i = 0; i < 3; i++)
+        registrations.oracle_registrations.push_back(MakeOracleRegistration(keys[i], 500000 * COIN));
+    registrations.oracle_registrations.push_back(MakeOracleRegistration(keys[3], 1000 * COIN));
+    COracleBlockUndo undoRegistrations;
+    UpdateOracleState(registrations, view, undoRegistrations, 1);
+    BOOST_CHECK(view.AccessOracle(keys[0].GetPubKey()) != NULL);
+
+    // The contribution claims the proof; a later one with the same proof is rejected
+    CBlockMarkers claim;
+    claim.contributions.push_back(contrib);
+    CContributionTransaction copy = contrib;
+    copy.tx_id = uint256S("0x02");
+    claim.contributions.push_back(copy);
+    COracleBlockUndo undoClaim;
+    UpdateOracleState(claim, view, undoClaim, 2);
+    BOOST_REQUIRE(view.AccessVerification(record_id) != NULL);
+    BOOST_CHECK(view.AccessVerification(record_id)->record.contrib_tx_id == contrib.tx_id);
+    BOOST_CHECK_EQUAL(GetContributionVerificationStatus(&view, contrib), VERIFICATION_PENDING);
+    BOOST_CHECK_EQUAL(GetContributionVerificationStatus(&view, copy), VERIFICATION_REJECTED);
+    BOOST_CHECK_EQUAL(GetContributionVerificationStatus(NULL, copy), VERIFICATION_PENDING);
+
+    // Oracle stake is not bonded, so votes do not change the state
+    CBlockMarkers votes;
+    for (int i = 0; i < 3; i++)
+        votes.oracle_votes.push_back(MakeOracleVote(keys[i], record_id, VOTE_APPROVE));
+    BOOST_CHECK(!HasOracleUpdates(votes));
+    COracleBlockUndo undoVotes;
+    UpdateOracleState(votes, view, undoVotes, 3);
+    BOOST_CHECK(undoVotes.vOracles.empty() && undoVotes.vVerifications.empty());
+    BOOST_CHECK_EQUAL(view.AccessVerification(record_id)->record.verification_status, VERIFICATION_PENDING);
+    BOOST_CHECK_EQUAL(view.AccessOracle(keys[0].GetPubKey())->total_votes_cast, 0U);
+
+    // The state survives a flush into a parent cache
+    COracleViewCache parent(&base);
+    {
+        COracleViewCache child(&parent);
+        COracleBlockUndo undo;
+        UpdateOracleState(registrations, child, undo, 1);
+        UpdateOracleState(claim, child, undo, 2);
+        BOOST_CHECK(child.Flush());
+    }
+    BOOST_REQUIRE(parent.AccessVerification(record_id) != NULL);
+    BOOST_CHECK(parent.AccessVerification(record_id)->record.contrib_tx_id == contrib.tx_id);
+    BOOST_CHECK_EQUAL(parent.AccessOracle(keys[2].GetPubKey())->stake_fc, 500000 * COIN);
+
+    // Disconnecting restores the earlier states
+    DisconnectOracleState(view, undoClaim);
+    BOOST_CHECK(view.AccessVerification(record_id) == NULL);
+    DisconnectOracleState(view, undoRegistrations);
+    BOOST_CHECK(view.AccessOracle(keys[0].GetPubKey()) == NULL);
+}
+
+BOOST_AUTO_TEST_CASE(oracle_claim_height)
+{
+    // A proof claimed by one contribution earns no bonus for another one
+    // from ContributionClaimHeight on
+    CKey contributor;
+    contributor.MakeNewKey(true);
+    CContributionTransaction contrib = MakeStubContribution(contributor, CREATIVE_WORK, BONUS_LOW);
+    contrib.tx_id = uint256S("0x01");
+    COracleView base;
+    COracleViewCache view(&base);
+    CBlockMarkers claim;
+    claim.contributions.push_back(contrib);
+    COracleBlockUndo undo;
+    UpdateOracleState(claim, view, undo, 1);
+
+    CContributionTransaction copy = contrib;
+    copy.tx_id = uint256S("0x02");
+    std::vector<CContributionTransaction> contribs(1, copy);
+    const CChainParams& chainparams = Params(CBaseChainParams::MAIN);
+    const int nClaimHeight = chainparams.GetConsensus(0).ContributionClaimHeight;
+    const Consensus::Params& before = chainparams.GetConsensus(nClaimHeight - 1);
+    const Consensus::Params& after = chainparams.GetConsensus(nClaimHeight);
+    BOOST_CHECK_EQUAL(GetFleetCreditsBlockSubsidyWithContributions(nClaimHeight - 1, before, uint256(), contribs, &view), FC_FOUNDATIONAL_BLOCK_REWARD);
+    BOOST_CHECK_EQUAL(GetFleetCreditsBlockSubsidyWithContributions(nClaimHeight, after, uint256(), contribs, &view), FC_BASE_BLOCK_REWARD);
+    BOOST_CHECK_EQUAL(GetFleetCreditsBlockSubsidyWithContributions(nClaimHeight, after, uint256(), contribs), FC_FOUNDATIONAL_BLOCK_REWARD);
+
+    // The contribution claiming the proof earns its bonus
+    contribs.assign(1, contrib);
+    BOOST_CHECK_EQUAL(GetFleetCreditsBlockSubsidyWithContributions(nClaimHeight, after, uint256(), contribs, &view), FC_FOUNDATIONAL_BLOCK_REWARD);
+}
+
+BOOST_AUTO_TEST_CASE(oracle_registration_sequence)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    const COracleRegistration first = MakeOracleRegistration(key, 500000 * COIN, 1);
+    BOOST_CHECK(first.CheckSignature());
+    COracleRegistration forged = first;
+    forged.sequence = 5;
+    BOOST_CHECK(!forged.CheckSignature());
+
+    COracleView base;
+    COracleViewCache view(&base);
+    COracleBlockUndo undo;
+
+    // Sequences start at 1
+    CBlockMarkers markers;
+    markers.oracle_registrations.push_back(MakeOracleRegistration(key, 500000 * COIN, 0));
+    UpdateOracleState(markers, view, undo, 1);
+    BOOST_CHECK(view.AccessOracle(key.GetPubKey()) == NULL);
+
+    // Registered, then deactivated with a new stake
+    markers.oracle_registrations.assign(1, first);
+    markers.oracle_registrations.push_back(MakeOracleRegistration(key, 600000 * COIN, 2, false));
+    UpdateOracleState(markers, view, undo, 2);
+    const COracleNode* oracle = view.AccessOracle(key.GetPubKey());
+    BOOST_REQUIRE(oracle != NULL);
+    BOOST_CHECK(!oracle->is_active);
+    BOOST_CHECK_EQUAL(oracle->stake_fc, 600000 * COIN);
+    BOOST_CHECK_EQUAL(oracle->registration_sequence, 2U);
+
+    // Replaying the first registration neither reactivates it nor restores its stake
+    markers.oracle_registrations.assign(1, first);
+    UpdateOracleState(markers, view, undo, 3);
+    oracle = view.AccessOracle(key.GetPubKey());
+    BOOST_CHECK(!oracle->is_active);
+    BOOST_CHECK_EQUAL(oracle->stake_fc, 600000 * COIN);
+
+    // A newer registration does
+    markers.oracle_registrations.assign(1, MakeOracleRegistration(key, 500000 * COIN, 3));
+    UpdateOracleState(markers, view, undo, 4);
+    oracle = view.AccessOracle(key.GetPubKey());
+    BOOST_CHECK(oracle->is_active);
+    BOOST_CHECK_EQUAL(oracle->stake_fc, 500000 * COIN);
+    BOOST_CHECK_EQUAL(oracle->registration_sequence, 3U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,102 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "support/allocators/pool.h"
+#include "test/test_fleetcredits.h"
+
+#include <stdint.h>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/unordered_map.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(pool_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(basic_allocating)
+{
+    PoolResource<8, 8> resource(1024);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 0);
+    BOOST_CHECK_EQUAL(resource.ChunkSizeBytes(), 1024);
+
+    // The first allocation takes a chunk, further small ones are carved from it.
+    void* block = resource.Allocate(8, 8);
+    BOOST_CHECK(block != nullptr);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1);
+    void* zero = resource.Allocate(0, 1);
+    BOOST_CHECK(zero != nullptr && zero != block);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1);
+    BOOST_CHECK_EQUAL(resource.FreeBytes(), 1024 - 16);
+
+    // A freed block is handed out again for the next request of its size.
+    resource.Deallocate(block, 8, 8);
+    BOOST_CHECK(resource.Allocate(7, 4) == block);
+    resource.Deallocate(block, 7, 4);
+    resource.Deallocate(zero, 0, 1);
+    BOOST_CHECK_EQUAL(resource.FreeBytes(), 1024);
+
+    // Blocks that do not fit bypass the pool but are accounted for.
+    void* big = resource.Allocate(16, 8);
+    BOOST_CHECK_EQUAL(resource.OversizeBytes(), 16);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1);
+    resource.Deallocate(big, 16, 8);
+    BOOST_CHECK_EQUAL(resource.OversizeBytes(), 0);
+
+    // Filling the chunk makes the resource take another one.
+    std::vector<void*> blocks;
+    for (int i = 0; i < 1024 / 8 + 1; ++i) {
+        blocks.push_back(resource.Allocate(8, 8));
+    }
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 2);
+    for (void* p : blocks) {
+        resource.Deallocate(p, 8, 8);
+    }
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 2);
+    BOOST_CHECK_EQUAL(resource.FreeBytes(), 2 * 1024);
+}
+
+BOOST_AUTO_TEST_CASE(chunk_tail_reused)
+{
+    // 24 + 24 + 24 leaves 16 bytes at the end of the first chunk; they go to
+    // the free list for that size when the next 24 byte block needs a chunk.
+    PoolResource<24, 8> resource(88);
+    void* a = resource.Allocate(24, 8);
+    resource.Allocate(24, 8);
+    resource.Allocate(24, 8);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 1);
+    resource.Allocate(24, 8);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 2);
+    void* tail = resource.Allocate(16, 8);
+    BOOST_CHECK(tail == static_cast<char*>(a) + 72);
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(memusage_test)
+{
+    typedef boost::unordered_map<int, int64_t, boost::hash<int>, std::equal_to<int>,
+                                 PoolAllocator<std::pair<const int, int64_t>, sizeof(std::pair<const int, int64_t>) + sizeof(void*) * 4> >
+        Map;
+    Map::allocator_type::ResourceType resource(1024);
+    Map map(0, Map::hasher(), Map::key_equal(), &resource);
+    BOOST_CHECK_EQUAL(memusage::DynamicUsage(map), 0);
+
+    for (int i = 0; i < 1000; ++i) {
+        map[i] = i;
+    }
+    const size_t usage = memusage::DynamicUsage(map);
+    BOOST_CHECK(resource.NumAllocatedChunks() > 1);
+    BOOST_CHECK(usage >= resource.NumAllocatedChunks() * resource.ChunkSizeBytes() + resource.OversizeBytes());
+
+    // Erased nodes stay in the pool, so inserting as many again takes no new chunks.
+    const size_t chunks = resource.NumAllocatedChunks();
+    for (int i = 0; i < 1000; ++i) {
+        map.erase(i);
+    }
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), chunks);
+    for (int i = 1000; i < 2000; ++i) {
+        map[i] = i;
+    }
+    BOOST_CHECK_EQUAL(resource.NumAllocatedChunks(), chunks);
+    BOOST_CHECK_EQUAL(memusage::DynamicUsage(map), usage);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -5,12 +5,16 @@
 
 #include "chain.h"
 #include "chainparams.h"
+#include "consensus/validation.h"
 #include "pow.h"
 #include "random.h"
 #include "util.h"
+#include "validation.h"
+#include "versionbits.h"
 #include "test/test_fleetcredits.h"
 
 #include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
 
 BOOST_FIXTURE_TEST_SUITE(pow_tests, BasicTestingSetup)
 
@@ -95,4 +99,83 @@ BOOST_AUTO_TEST_CASE(GetBlockProofEquivalentTime_test)
     }
 }
 
+namespace {
+struct HeadersTestingSetup : public TestingSetup {
+    HeadersTestingSetup() : TestingSetup(CBaseChainParams::REGTEST) {}
+};
+} // namespace
+
+/** A chain of count headers on top of pindexPrev, each with valid proof of work */
+static std::vector<CBlockHeader> MineHeaders(const CBlockIndex* pindexPrev, size_t count)
+{
+    const Consensus::Params& params = Params().GetConsensus(0);
+    std::vector<CBlockHeader> headers(count);
+    uint256 hashPrev = pindexPrev->GetBlockHash();
+    for (size_t i = 0; i < count; i++) {
+        CBlockHeader& header = headers[i];
+        header.SetBaseVersion(VERSIONBITS_LAST_OLD_BLOCK_VERSION, params.nAuxpowChainId);
+        header.hashPrevBlock = hashPrev;
+        header.hashMerkleRoot = GetRandHash();
+        header.nTime = pindexPrev->GetBlockTime() + 1 + i;
+        header.nBits = pindexPrev->nBits;
+        while (!CheckProofOfWork(header.GetPoWHash(), header.nBits, params))
+            header.nNonce++;
+        hashPrev = header.GetHash();
+    }
+    return headers;
+}
+
+BOOST_FIXTURE_TEST_CASE(process_new_block_headers, HeadersTestingSetup)
+{
+    const CChainParams& chainparams = Params();
+    const CBlockIndex* pindexGenesis = chainActive.Tip();
+
+    // Proof of work checked inline, in more than one batch of lanes
+    std::vector<CBlockHeader> headers = MineHeaders(pindexGenesis, 40);
+    CValidationState state;
+    const CBlockIndex* pindexLast = NULL;
+    BOOST_CHECK(ProcessNewBlockHeaders(headers, state, chainparams, &pindexLast));
+    BOOST_CHECK(pindexLast != NULL && pindexLast->nHeight == 40);
+    BOOST_CHECK(pindexLast != NULL && pindexLast->GetBlockHash() == headers.back().GetHash());
+
+    // Known headers are accepted again
+    BOOST_CHECK(ProcessNewBlockHeaders(headers, state, chainparams, &pindexLast));
+    BOOST_CHECK(pindexLast != NULL && pindexLast->nHeight == 40);
+
+    // On the header check threads, a header with bad proof of work is
+    // rejected after those before it were accepted
+    boost::thread_group threadGroup;
+    nScriptCheckThreads = 3;
+    for (int i = 0; i < nScriptCheckThreads - 1; ++i)
+        threadGroup.create_thread(&ThreadHeaderCheck);
+
+    headers = MineHeaders(pindexGenesis, 40);
+    while (CheckProofOfWork(headers[25].GetPoWHash(), headers[25].nBits, chainparams.GetConsensus(0)))
+        headers[25].nNonce++;
+    CValidationState stateBad;
+    BOOST_CHECK(!ProcessNewBlockHeaders(headers, stateBad, chainparams, &pindexLast));
+    BOOST_CHECK_EQUAL(stateBad.GetRejectReason(), "high-hash");
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(mapBlockIndex.count(headers[24].GetHash()));
+        BOOST_CHECK(!mapBlockIndex.count(headers[25].GetHash()));
+    }
+
+    // A bad first header rejects the message before the rest is hashed
+    headers = MineHeaders(pindexGenesis, 40);
+    while (CheckProofOfWork(headers[0].GetPoWHash(), headers[0].nBits, chainparams.GetConsensus(0)))
+        headers[0].nNonce++;
+    CValidationState stateFirst;
+    BOOST_CHECK(!ProcessNewBlockHeaders(headers, stateFirst, chainparams, &pindexLast));
+    BOOST_CHECK_EQUAL(stateFirst.GetRejectReason(), "high-hash");
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(!mapBlockIndex.count(headers[0].GetHash()));
+    }
+
+    threadGroup.interrupt_all();
+    threadGroup.join_all();
+    nScriptCheckThreads = 0;
+}
+
 BOOST_AUTO_TEST_SUITE_END()
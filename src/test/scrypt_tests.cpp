@@ -9,6 +9,9 @@
 #include "util.h"
 #include "utilstrencodings.h"
 
+#include <algorithm>
+#include <vector>
+
 BOOST_AUTO_TEST_SUITE(scrypt_tests)
 
 BOOST_AUTO_TEST_CASE(scrypt_hashtest)
@@ -36,4 +39,31 @@ BOOST_AUTO_TEST_CASE(scrypt_hashtest)
     }
 }
 
+BOOST_AUTO_TEST_CASE(scrypt_multi)
+{
+    // Batches hash as one input at a time, with every kernel built in and
+    // supported, whole groups of lanes or not
+    const int count = 2 * SCRYPT_MAX_LANES + 5;
+    std::vector<char> input(80 * count);
+    for (size_t i = 0; i < input.size(); i++)
+        input[i] = (char)(i * 7 + i / 80);
+    std::vector<char> expected(32 * count);
+    char scratchpad[SCRYPT_SCRATCHPAD_SIZE];
+    for (int i = 0; i < count; i++)
+        scrypt_1024_1_1_256_sp_generic(&input[80 * i], &expected[32 * i], scratchpad);
+
+    for (int max_lanes = SCRYPT_MAX_LANES; max_lanes >= 1; max_lanes /= 2) {
+        int lanes = scrypt_detect_multi(max_lanes);
+        BOOST_CHECK(lanes <= max_lanes);
+        for (int n = 0; n <= count; n++) {
+            std::vector<char> output(32 * count, 0);
+            scrypt_1024_1_1_256_multi(input.data(), output.data(), n);
+            BOOST_CHECK_MESSAGE(std::equal(output.begin(), output.begin() + 32 * n, expected.begin()),
+                                "lanes " << lanes << ", " << n << " inputs");
+            BOOST_CHECK(std::all_of(output.begin() + 32 * n, output.end(), [](char c) { return c == 0; }));
+        }
+    }
+    scrypt_detect_multi();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
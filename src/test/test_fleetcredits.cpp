@@ -22,6 +22,7 @@
 #include "ui_interface.h"
 #include "rpc/server.h"
 #include "rpc/register.h"
+#include "mweb_verifycache.h"
 #include "script/sigcache.h"
 #include "utiltime.h"
 
@@ -63,6 +64,7 @@ BasicTestingSetup::BasicTestingSetup(const std::string& chainName)
         SetupEnvironment();
         SetupNetworking();
         InitSignatureCache();
+        InitMWEBVerifyCache();
         fPrintToDebugLog = false; // don't want to write to debug.log file
         fCheckBlockIndex = true;
         SelectParams(chainName);
@@ -102,6 +104,10 @@ TestingSetup::TestingSetup(const std::string& chainName) : BasicTestingSetup(cha
         pblocktree = new CBlockTreeDB(1 << 20, true);
         pcoinsdbview = new CCoinsViewDB(1 << 23, true);
         pcoinsTip = new CCoinsViewCache(pcoinsdbview);
+        pmwebcoinsdbview = new CMWEBCoinsViewDB(*pcoinsdbview);
+        pmwebcoinsTip = new CMWEBCoinsViewCache(pmwebcoinsdbview);
+        poraclesdbview = new COracleViewDB(*pcoinsdbview);
+        poraclesTip = new COracleViewCache(poraclesdbview);
         InitBlockIndex(chainparams);
         {
             CValidationState state;
@@ -125,6 +131,10 @@ TestingSetup::~TestingSetup()
         threadGroup.interrupt_all();
         threadGroup.join_all();
         UnloadBlockIndex();
+        delete poraclesTip;
+        delete poraclesdbview;
+        delete pmwebcoinsTip;
+        delete pmwebcoinsdbview;
         delete pcoinsTip;
         delete pcoinsdbview;
         delete pblocktree;
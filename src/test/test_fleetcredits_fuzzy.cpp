@@ -8,6 +8,9 @@
 
 #include "consensus/merkle.h"
 #include "primitives/block.h"
+#include "primitives/contribution.h"
+#include "primitives/mweb.h"
+#include "primitives/verification.h"
 #include "script/script.h"
 #include "addrman.h"
 #include "chain.h"
@@ -45,6 +48,9 @@ enum TEST_ID {
     CBLOOMFILTER_DESERIALIZE,
     CDISKBLOCKINDEX_DESERIALIZE,
     CTXOUTCOMPRESSOR_DESERIALIZE,
+    CCONTRIBUTION_DESERIALIZE,
+    CORACLEVOTE_DESERIALIZE,
+    CMWEBTRANSACTION_DESERIALIZE,
     TEST_ID_END
 };
 
@@ -169,8 +175,8 @@ int main(int argc, char **argv)
         {
             try
             {
-                CCoins block;
-                ds >> block;
+                Coin coin;
+                ds >> coin;
             } catch (const std::ios_base::failure& e) {return 0;}
             break;
         }
@@ -250,6 +256,33 @@ int main(int argc, char **argv)
 
             break;
         }
+        case CCONTRIBUTION_DESERIALIZE:
+        {
+            try
+            {
+                CContributionTransaction contrib;
+                ds >> contrib;
+            } catch (const std::ios_base::failure& e) {return 0;}
+            break;
+        }
+        case CORACLEVOTE_DESERIALIZE:
+        {
+            try
+            {
+                COracleVote vote;
+                ds >> vote;
+            } catch (const std::ios_base::failure& e) {return 0;}
+            break;
+        }
+        case CMWEBTRANSACTION_DESERIALIZE:
+        {
+            try
+            {
+                CMWEBTransaction tx;
+                ds >> tx;
+            } catch (const std::ios_base::failure& e) {return 0;}
+            break;
+        }
         default:
             return 0;
     }
@@ -0,0 +1,112 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "test/test_markers.h"
+
+#include "key.h"
+#include "random.h"
+
+#include <cassert>
+
+CContributionTransaction MakeStubContribution(const CKey& key, ContributionType type, uint32_t bonusLevel)
+{
+    CContributionTransaction contrib;
+    contrib.contrib_type = type;
+    contrib.bonus_level = bonusLevel;
+    contrib.contributor = key.GetPubKey();
+    contrib.timestamp = 1776643200; // deterministic test timestamp
+    contrib.signature = std::vector<unsigned char>(1, 0x01);
+
+    contrib.proof_data.contrib_type = type;
+    contrib.proof_data.timestamp = contrib.timestamp;
+    contrib.proof_data.evidence = {0x01};
+    contrib.proof_data.nonce = {0x02};
+    contrib.proof_data.metadata = {0x03};
+    contrib.proof_data.hash = CalculateProofDataHash(contrib.proof_data);
+
+    if (type == ETHICAL_REVIEW) {
+        contrib.requires_mweb = true;
+    }
+
+    return contrib;
+}
+
+CGovernanceVote MakeStubVote(const CKey& key, const uint256& proposal_id, VoteChoice choice, CAmount power)
+{
+    CGovernanceVote vote;
+    vote.proposal_id = proposal_id;
+    vote.voter = key.GetPubKey();
+    vote.choice = choice;
+    vote.voting_power = power;
+    vote.vote_time = 1776643200;
+    vote.signature = std::vector<unsigned char>(1, 0x01);
+    vote.vote_id = vote.CalculateVoteId();
+    return vote;
+}
+
+COracleNode MakeStubOracle(CAmount stake)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    COracleNode oracle;
+    oracle.pubkey = key.GetPubKey();
+    oracle.stake_fc = stake;
+    oracle.is_active = true;
+    return oracle;
+}
+
+COracleRegistration MakeOracleRegistration(const CKey& key, CAmount stake, uint32_t sequence, bool fActive)
+{
+    COracleRegistration registration;
+    registration.pubkey = key.GetPubKey();
+    registration.node_address = "127.0.0.1:22556";
+    registration.stake_fc = stake;
+    registration.is_active = fActive;
+    registration.sequence = sequence;
+    bool fSigned = key.Sign(registration.GetSignatureHash(), registration.signature);
+    assert(fSigned);
+    return registration;
+}
+
+COracleVote MakeOracleVote(const CKey& key, const uint256& record_id, OracleVoteChoice choice)
+{
+    COracleVote vote;
+    vote.oracle_pubkey = key.GetPubKey();
+    vote.verification_record_id = record_id;
+    vote.vote_choice = choice;
+    vote.vote_timestamp = 1776643200;
+    bool fSigned = key.Sign(vote.GetSignatureHash(), vote.vote_signature);
+    assert(fSigned);
+    return vote;
+}
+
+CTransactionRef MakeContributionTx(const CContributionTransaction& contrib)
+{
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << static_cast<uint8_t>(contrib.contrib_type);
+    ss << contrib.proof_data.hash;
+    ss << contrib.proof_data.evidence;
+    ss << contrib.timestamp;
+    ss << contrib.bonus_level;
+    ss << static_cast<uint8_t>(contrib.requires_mweb ? 1 : 0);
+
+    std::vector<unsigned char> data;
+    data.push_back(FC_MARKER);
+    data.push_back(FC_MARKER_CONTRIBUTION);
+    data.insert(data.end(), ss.begin(), ss.end());
+
+    return MakeMarkerTx(CScript() << OP_RETURN << data);
+}
+
+CTransactionRef MakeMarkerTx(const CScript& script)
+{
+    CMutableTransaction mtx;
+    mtx.vin.resize(1);
+    mtx.vin[0].prevout.hash = GetRandHash();
+    mtx.vin[0].prevout.n = 0;
+    mtx.vout.resize(1);
+    mtx.vout[0].scriptPubKey = script;
+    mtx.vout[0].nValue = 0;
+    return MakeTransactionRef(mtx);
+}
@@ -0,0 +1,58 @@
+// Copyright (c) 2025-2026 The Fleet Credits Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+/**
+ * Builders for Fleet Credits markers and the transactions carrying them,
+ * shared by unit tests
+ */
+#ifndef FLEETCREDITS_TEST_TEST_MARKERS_H
+#define FLEETCREDITS_TEST_TEST_MARKERS_H
+
+#include "blockmarkers.h"
+#include "primitives/contribution.h"
+#include "primitives/governance.h"
+#include "primitives/transaction.h"
+#include "primitives/verification.h"
+#include "script/script.h"
+#include "streams.h"
+#include "version.h"
+
+class CKey;
+
+/** A contribution of the given type with a deterministic proof */
+CContributionTransaction MakeStubContribution(const CKey& key, ContributionType type, uint32_t bonusLevel);
+
+/** A transaction carrying contrib in an OP_RETURN output, as submitcontribution builds it */
+CTransactionRef MakeContributionTx(const CContributionTransaction& contrib);
+
+/** A governance vote with a placeholder signature */
+CGovernanceVote MakeStubVote(const CKey& key, const uint256& proposal_id, VoteChoice choice, CAmount power);
+
+/** An active oracle with a new key and the given stake */
+COracleNode MakeStubOracle(CAmount stake);
+
+/** An oracle registration signed by key */
+COracleRegistration MakeOracleRegistration(const CKey& key, CAmount stake, uint32_t sequence = 1, bool fActive = true);
+
+/** An oracle vote on record_id signed by key */
+COracleVote MakeOracleVote(const CKey& key, const uint256& record_id, OracleVoteChoice choice);
+
+/** An output script with a marker directly after OP_RETURN, as consensus reads them */
+template <typename T>
+CScript MakeRawMarkerScript(unsigned char type, const T& payload)
+{
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << payload;
+    std::vector<unsigned char> script;
+    script.push_back(OP_RETURN);
+    script.push_back(FC_MARKER);
+    script.push_back(type);
+    script.insert(script.end(), ss.begin(), ss.end());
+    return CScript(script.begin(), script.end());
+}
+
+/** A transaction with a single zero value output paying to script */
+CTransactionRef MakeMarkerTx(const CScript& script);
+
+#endif // FLEETCREDITS_TEST_TEST_MARKERS_H
@@ -7,34 +7,108 @@
 
 #include "chainparams.h"
 #include "hash.h"
+#include "init.h"
 #include "pow.h"
 #include "uint256.h"
+#include "ui_interface.h"
+#include "util.h"
 
 #include <stdint.h>
 
 #include <boost/thread.hpp>
 
+static const char DB_COIN = 'C';
 static const char DB_COINS = 'c';
+static const char DB_MWEB_COIN = 'm';
+static const char DB_MWEB_UNDO = 'u';
+static const char DB_ORACLE = 'o';
+static const char DB_VERIFICATION = 'v';
+static const char DB_ORACLE_UNDO = 'U';
 static const char DB_BLOCK_FILES = 'f';
 static const char DB_TXINDEX = 't';
 static const char DB_BLOCK_INDEX = 'b';
 
 static const char DB_BEST_BLOCK = 'B';
+static const char DB_MWEB_BEST_BLOCK = 'M';
+static const char DB_ORACLE_BEST_BLOCK = 'O';
 static const char DB_FLAG = 'F';
 static const char DB_REINDEX_FLAG = 'R';
 static const char DB_LAST_BLOCK = 'l';
 
+namespace {
 
-CCoinsViewDB::CCoinsViewDB(size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / "chainstate", nCacheSize, fMemory, fWipe, true) 
+/** Key of MWEB and oracle undo records, ordered by height so they can be pruned by depth */
+struct BlockUndoEntry {
+    char key;
+    uint32_t nHeight;
+    uint256 hash;
+    BlockUndoEntry(char keyIn, int nHeightIn, const uint256& hashIn) : key(keyIn), nHeight(nHeightIn), hash(hashIn) {}
+
+    template<typename Stream>
+    void Serialize(Stream &s) const {
+        s << key;
+        ser_writedata32be(s, nHeight);
+        s << hash;
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        s >> key;
+        nHeight = ser_readdata32be(s);
+        s >> hash;
+    }
+};
+
+/** Stage the erasure of the undo records stored under key for blocks below nHeight */
+void PruneBlockUndoEntries(CDBWrapper& db, CDBBatch& batch, char key, int nHeight)
 {
+    std::unique_ptr<CDBIterator> pcursor(db.NewIterator());
+    pcursor->Seek(BlockUndoEntry(key, 0, uint256()));
+    size_t count = 0;
+    while (pcursor->Valid()) {
+        BlockUndoEntry entry(key, 0, uint256());
+        if (!pcursor->GetKey(entry) || entry.key != key || (int)entry.nHeight >= nHeight)
+            break;
+        batch.Erase(entry);
+        count++;
+        pcursor->Next();
+    }
+    if (count > 0)
+        LogPrint("coindb", "Pruning %u undo records of type '%c' below height %d\n", (unsigned int)count, key, nHeight);
 }
 
-bool CCoinsViewDB::GetCoins(const uint256 &txid, CCoins &coins) const {
-    return db.Read(std::make_pair(DB_COINS, txid), coins);
+struct CoinEntry {
+    COutPoint* outpoint;
+    char key;
+    CoinEntry(const COutPoint* ptr) : outpoint(const_cast<COutPoint*>(ptr)), key(DB_COIN)  {}
+
+    template<typename Stream>
+    void Serialize(Stream &s) const {
+        s << key;
+        s << outpoint->hash;
+        s << VARINT(outpoint->n);
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s) {
+        s >> key;
+        s >> outpoint->hash;
+        s >> VARINT(outpoint->n);
+    }
+};
+
 }
 
-bool CCoinsViewDB::HaveCoins(const uint256 &txid) const {
-    return db.Exists(std::make_pair(DB_COINS, txid));
+CCoinsViewDB::CCoinsViewDB(size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / "chainstate", nCacheSize, fMemory, fWipe, true), batchPending(db)
+{
+}
+
+bool CCoinsViewDB::GetCoin(const COutPoint &outpoint, Coin &coin) const {
+    return db.Read(CoinEntry(&outpoint), coin);
+}
+
+bool CCoinsViewDB::HaveCoin(const COutPoint &outpoint) const {
+    return db.Exists(CoinEntry(&outpoint));
 }
 
 uint256 CCoinsViewDB::GetBestBlock() const {
@@ -44,27 +118,174 @@ uint256 CCoinsViewDB::GetBestBlock() const {
     return hashBestChain;
 }
 
-bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
-    CDBBatch batch(db);
+bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, bool erase) {
+    // Staged MWEB and oracle writes go out in the same batch as the coins
+    CDBBatch& batch = batchPending;
     size_t count = 0;
     size_t changed = 0;
     for (CCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end();) {
         if (it->second.flags & CCoinsCacheEntry::DIRTY) {
-            if (it->second.coins.IsPruned())
-                batch.Erase(std::make_pair(DB_COINS, it->first));
+            CoinEntry entry(&it->first);
+            if (it->second.coin.IsSpent())
+                batch.Erase(entry);
             else
-                batch.Write(std::make_pair(DB_COINS, it->first), it->second.coins);
+                batch.Write(entry, it->second.coin);
             changed++;
         }
         count++;
-        CCoinsMap::iterator itOld = it++;
-        mapCoins.erase(itOld);
+        if (erase) {
+            CCoinsMap::iterator itOld = it++;
+            mapCoins.erase(itOld);
+        } else {
+            ++it;
+        }
     }
     if (!hashBlock.IsNull())
         batch.Write(DB_BEST_BLOCK, hashBlock);
 
-    LogPrint("coindb", "Committing %u changed transactions (out of %u) to coin database...\n", (unsigned int)changed, (unsigned int)count);
-    return db.WriteBatch(batch);
+    LogPrint("coindb", "Committing %u changed transaction outputs (out of %u) to coin database...\n", (unsigned int)changed, (unsigned int)count);
+    bool ret = db.WriteBatch(batch);
+    batch.Clear();
+    return ret;
+}
+
+bool CMWEBCoinsViewDB::GetCoin(const CPubKey& commitment, CMWEBCoin& coin) const {
+    return db.Read(std::make_pair(DB_MWEB_COIN, commitment), coin);
+}
+
+bool CMWEBCoinsViewDB::HaveCoin(const CPubKey& commitment) const {
+    return db.Exists(std::make_pair(DB_MWEB_COIN, commitment));
+}
+
+uint256 CMWEBCoinsViewDB::GetBestBlock() const {
+    uint256 hashBestChain;
+    if (!db.Read(DB_MWEB_BEST_BLOCK, hashBestChain))
+        return uint256();
+    return hashBestChain;
+}
+
+bool CMWEBCoinsViewDB::BatchWrite(CMWEBCoinsMap& mapCoins, const uint256& hashBlock) {
+    CDBBatch& batch = batchPending;
+    size_t count = 0;
+    size_t changed = 0;
+    for (CMWEBCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end();) {
+        if (it->second.flags & CMWEBCoinsCacheEntry::DIRTY) {
+            if (it->second.coin.IsSpent())
+                batch.Erase(std::make_pair(DB_MWEB_COIN, it->first));
+            else
+                batch.Write(std::make_pair(DB_MWEB_COIN, it->first), it->second.coin);
+            changed++;
+        }
+        count++;
+        CMWEBCoinsMap::iterator itOld = it++;
+        mapCoins.erase(itOld);
+    }
+    if (!hashBlock.IsNull())
+        batch.Write(DB_MWEB_BEST_BLOCK, hashBlock);
+
+    LogPrint("coindb", "Staging %u changed MWEB outputs (out of %u) for the coin database...\n", (unsigned int)changed, (unsigned int)count);
+    return true;
+}
+
+bool CMWEBCoinsViewDB::WriteBlockUndo(int nHeight, const uint256& hashBlock, const CMWEBBlockUndo& undo) {
+    // Also staged, so it outlives an erasure staged by an earlier disconnect
+    BlockUndoEntry entry(DB_MWEB_UNDO, nHeight, hashBlock);
+    batchPending.Write(entry, undo);
+    return db.Write(entry, undo);
+}
+
+bool CMWEBCoinsViewDB::ReadBlockUndo(int nHeight, const uint256& hashBlock, CMWEBBlockUndo& undo) const {
+    return db.Read(BlockUndoEntry(DB_MWEB_UNDO, nHeight, hashBlock), undo);
+}
+
+void CMWEBCoinsViewDB::EraseBlockUndo(int nHeight, const uint256& hashBlock) {
+    batchPending.Erase(BlockUndoEntry(DB_MWEB_UNDO, nHeight, hashBlock));
+}
+
+void CMWEBCoinsViewDB::PruneBlockUndo(int nHeight) {
+    PruneBlockUndoEntries(db, batchPending, DB_MWEB_UNDO, nHeight);
+}
+
+bool COracleViewDB::GetOracle(const CPubKey& pubkey, COracleNode& oracle) const {
+    return db.Read(std::make_pair(DB_ORACLE, pubkey), oracle);
+}
+
+bool COracleViewDB::GetVerification(const uint256& record_id, CVerificationEntry& entry) const {
+    return db.Read(std::make_pair(DB_VERIFICATION, record_id), entry);
+}
+
+uint256 COracleViewDB::GetBestBlock() const {
+    uint256 hashBestChain;
+    if (!db.Read(DB_ORACLE_BEST_BLOCK, hashBestChain))
+        return uint256();
+    return hashBestChain;
+}
+
+void COracleViewDB::LoadSampler(COracleSampler& sampler) const {
+    std::unique_ptr<CDBIterator> pcursor(db.NewIterator());
+    pcursor->Seek(std::make_pair(DB_ORACLE, CPubKey()));
+    while (pcursor->Valid()) {
+        std::pair<char, CPubKey> key;
+        COracleNode oracle;
+        if (!pcursor->GetKey(key) || key.first != DB_ORACLE)
+            break;
+        if (pcursor->GetValue(oracle))
+            sampler.Update(oracle);
+        pcursor->Next();
+    }
+}
+
+bool COracleViewDB::BatchWrite(COracleMap& mapOracles, CVerificationMap& mapVerifications, const uint256& hashBlock) {
+    CDBBatch& batch = batchPending;
+    size_t count = 0;
+    size_t changed = 0;
+    for (COracleMap::iterator it = mapOracles.begin(); it != mapOracles.end();) {
+        if (it->second.flags & COracleCacheEntry::DIRTY) {
+            if (!it->second.oracle.pubkey.IsValid())
+                batch.Erase(std::make_pair(DB_ORACLE, it->first));
+            else
+                batch.Write(std::make_pair(DB_ORACLE, it->first), it->second.oracle);
+            changed++;
+        }
+        count++;
+        COracleMap::iterator itOld = it++;
+        mapOracles.erase(itOld);
+    }
+    for (CVerificationMap::iterator it = mapVerifications.begin(); it != mapVerifications.end();) {
+        if (it->second.flags & CVerificationCacheEntry::DIRTY) {
+            if (it->second.entry.IsNull())
+                batch.Erase(std::make_pair(DB_VERIFICATION, it->first));
+            else
+                batch.Write(std::make_pair(DB_VERIFICATION, it->first), it->second.entry);
+            changed++;
+        }
+        count++;
+        CVerificationMap::iterator itOld = it++;
+        mapVerifications.erase(itOld);
+    }
+    if (!hashBlock.IsNull())
+        batch.Write(DB_ORACLE_BEST_BLOCK, hashBlock);
+
+    LogPrint("coindb", "Staging %u changed oracles and verification records (out of %u) for the coin database...\n", (unsigned int)changed, (unsigned int)count);
+    return true;
+}
+
+bool COracleViewDB::WriteBlockUndo(int nHeight, const uint256& hashBlock, const COracleBlockUndo& undo) {
+    BlockUndoEntry entry(DB_ORACLE_UNDO, nHeight, hashBlock);
+    batchPending.Write(entry, undo);
+    return db.Write(entry, undo);
+}
+
+bool COracleViewDB::ReadBlockUndo(int nHeight, const uint256& hashBlock, COracleBlockUndo& undo) const {
+    return db.Read(BlockUndoEntry(DB_ORACLE_UNDO, nHeight, hashBlock), undo);
+}
+
+void COracleViewDB::EraseBlockUndo(int nHeight, const uint256& hashBlock) {
+    batchPending.Erase(BlockUndoEntry(DB_ORACLE_UNDO, nHeight, hashBlock));
+}
+
+void COracleViewDB::PruneBlockUndo(int nHeight) {
+    PruneBlockUndoEntries(db, batchPending, DB_ORACLE_UNDO, nHeight);
 }
 
 CBlockTreeDB::CBlockTreeDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "blocks" / "index", nCacheSize, fMemory, fWipe) {
@@ -96,29 +317,31 @@ CCoinsViewCursor *CCoinsViewDB::Cursor() const
     /* It seems that there are no "const iterators" for LevelDB.  Since we
        only need read operations on it, use a const-cast to get around
        that restriction.  */
-    i->pcursor->Seek(DB_COINS);
+    i->pcursor->Seek(DB_COIN);
     // Cache key of first record
     if (i->pcursor->Valid()) {
-        i->pcursor->GetKey(i->keyTmp);
+        CoinEntry entry(&i->keyTmp.second);
+        i->pcursor->GetKey(entry);
+        i->keyTmp.first = entry.key;
     } else {
         i->keyTmp.first = 0; // Make sure Valid() and GetKey() return false
     }
     return i;
 }
 
-bool CCoinsViewDBCursor::GetKey(uint256 &key) const
+bool CCoinsViewDBCursor::GetKey(COutPoint &key) const
 {
     // Return cached key
-    if (keyTmp.first == DB_COINS) {
+    if (keyTmp.first == DB_COIN) {
         key = keyTmp.second;
         return true;
     }
     return false;
 }
 
-bool CCoinsViewDBCursor::GetValue(CCoins &coins) const
+bool CCoinsViewDBCursor::GetValue(Coin &coin) const
 {
-    return pcursor->GetValue(coins);
+    return pcursor->GetValue(coin);
 }
 
 unsigned int CCoinsViewDBCursor::GetValueSize() const
@@ -128,14 +351,18 @@ unsigned int CCoinsViewDBCursor::GetValueSize() const
 
 bool CCoinsViewDBCursor::Valid() const
 {
-    return keyTmp.first == DB_COINS;
+    return keyTmp.first == DB_COIN;
 }
 
 void CCoinsViewDBCursor::Next()
 {
     pcursor->Next();
-    if (!pcursor->Valid() || !pcursor->GetKey(keyTmp))
+    CoinEntry entry(&keyTmp.second);
+    if (!pcursor->Valid() || !pcursor->GetKey(entry)) {
         keyTmp.first = 0; // Invalidate cached key after last record so that Valid() and GetKey() return false
+    } else {
+        keyTmp.first = entry.key;
+    }
 }
 
 bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo) {
@@ -200,6 +427,10 @@ bool CBlockTreeDB::LoadBlockIndexGuts(std::function<CBlockIndex*(const uint256&)
                 pindexNew->nNonce         = diskindex.nNonce;
                 pindexNew->nStatus        = diskindex.nStatus;
                 pindexNew->nTx            = diskindex.nTx;
+                pindexNew->hashMWEBExtension = diskindex.hashMWEBExtension;
+                pindexNew->nMWEBTx        = diskindex.nMWEBTx;
+                pindexNew->nPegIn         = diskindex.nPegIn;
+                pindexNew->nPegOut        = diskindex.nPegOut;
 
                 /* Fleet Credits checks the PoW here.  We don't do this because
                    the CDiskBlockIndex does not contain the auxpow.
@@ -217,3 +448,122 @@ bool CBlockTreeDB::LoadBlockIndexGuts(std::function<CBlockIndex*(const uint256&)
 
     return true;
 }
+
+namespace {
+
+//! Legacy class to deserialize pre-pertxout database entries without reindex.
+class CCoins
+{
+public:
+    //! whether transaction is a coinbase
+    bool fCoinBase;
+
+    //! unspent transaction outputs; spent outputs are .IsNull(); spent outputs at the end of the array are dropped
+    std::vector<CTxOut> vout;
+
+    //! at which height this transaction was included in the active block chain
+    int nHeight;
+
+    //! empty constructor
+    CCoins() : fCoinBase(false), vout(0), nHeight(0) { }
+
+    template<typename Stream>
+    void Unserialize(Stream &s) {
+        unsigned int nCode = 0;
+        // version
+        int nVersionDummy;
+        ::Unserialize(s, VARINT(nVersionDummy));
+        // header code
+        ::Unserialize(s, VARINT(nCode));
+        fCoinBase = nCode & 1;
+        std::vector<bool> vAvail(2, false);
+        vAvail[0] = (nCode & 2) != 0;
+        vAvail[1] = (nCode & 4) != 0;
+        unsigned int nMaskCode = (nCode / 8) + ((nCode & 6) != 0 ? 0 : 1);
+        // spentness bitmask
+        while (nMaskCode > 0) {
+            unsigned char chAvail = 0;
+            ::Unserialize(s, chAvail);
+            for (unsigned int p = 0; p < 8; p++) {
+                bool f = (chAvail & (1 << p)) != 0;
+                vAvail.push_back(f);
+            }
+            if (chAvail != 0)
+                nMaskCode--;
+        }
+        // txouts themself
+        vout.assign(vAvail.size(), CTxOut());
+        for (unsigned int i = 0; i < vAvail.size(); i++) {
+            if (vAvail[i])
+                ::Unserialize(s, REF(CTxOutCompressor(vout[i])));
+        }
+        // coinbase height
+        ::Unserialize(s, VARINT(nHeight));
+    }
+};
+
+}
+
+/** Upgrade the database from older formats.
+ *
+ * Currently implemented: from the per-tx utxo model (0.8..0.14.x) to per-txout.
+ */
+bool CCoinsViewDB::Upgrade() {
+    std::unique_ptr<CDBIterator> pcursor(db.NewIterator());
+    pcursor->Seek(std::make_pair(DB_COINS, uint256()));
+    if (!pcursor->Valid()) {
+        return true;
+    }
+
+    int64_t count = 0;
+    LogPrintf("Upgrading utxo-set database...\n");
+    LogPrintf("[0%%]...");
+    uiInterface.SafeShowProgress(_("Upgrading UTXO database"), 0);
+    size_t batch_size = 1 << 24;
+    CDBBatch batch(db);
+    int reportDone = 0;
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        if (ShutdownRequested()) {
+            break;
+        }
+        std::pair<unsigned char, uint256> key;
+        if (pcursor->GetKey(key) && key.first == DB_COINS) {
+            if (count++ % 256 == 0) {
+                uint32_t high = 0x100 * *key.second.begin() + *(key.second.begin() + 1);
+                int percentageDone = (int)(high * 100.0 / 65536.0 + 0.5);
+                uiInterface.SafeShowProgress(_("Upgrading UTXO database"), percentageDone);
+                if (reportDone < percentageDone/10) {
+                    // report max. every 10% step
+                    LogPrintf("[%d%%]...", percentageDone);
+                    reportDone = percentageDone/10;
+                }
+            }
+            CCoins old_coins;
+            if (!pcursor->GetValue(old_coins)) {
+                return error("%s: cannot parse CCoins record", __func__);
+            }
+            COutPoint outpoint(key.second, 0);
+            for (size_t i = 0; i < old_coins.vout.size(); ++i) {
+                if (!old_coins.vout[i].IsNull() && !old_coins.vout[i].scriptPubKey.IsUnspendable()) {
+                    Coin newcoin(old_coins.vout[i], old_coins.nHeight, old_coins.fCoinBase);
+                    outpoint.n = i;
+                    CoinEntry entry(&outpoint);
+                    batch.Write(entry, newcoin);
+                }
+            }
+            batch.Erase(key);
+            if (batch.SizeEstimate() > batch_size) {
+                db.WriteBatch(batch);
+                batch.Clear();
+            }
+            pcursor->Next();
+        } else {
+            break;
+        }
+    }
+    db.WriteBatch(batch);
+    uiInterface.SafeShowProgress("", 100);
+    LogPrintf("[%s].\n", ShutdownRequested() ? "CANCELLED" : "DONE");
+    return !ShutdownRequested();
+}
@@ -9,6 +9,8 @@
 #include "coins.h"
 #include "dbwrapper.h"
 #include "chain.h"
+#include "mweb_coins.h"
+#include "oracles.h"
 
 #include <map>
 #include <string>
@@ -71,14 +73,74 @@ class CCoinsViewDB : public CCoinsView
 {
 protected:
     CDBWrapper db;
+    //! Writes of the MWEB output set and oracle state, committed with the coins
+    CDBBatch batchPending;
 public:
     CCoinsViewDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
 
-    bool GetCoins(const uint256 &txid, CCoins &coins) const;
-    bool HaveCoins(const uint256 &txid) const;
+    bool GetCoin(const COutPoint &outpoint, Coin &coin) const;
+    bool HaveCoin(const COutPoint &outpoint) const;
     uint256 GetBestBlock() const;
-    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock);
+    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock, bool erase = true);
     CCoinsViewCursor *Cursor() const;
+
+    //! Attempt to update from an older database format. Returns whether an error occurred.
+    bool Upgrade();
+
+    //! The chainstate database, shared with the MWEB output set and oracle state
+    CDBWrapper& GetDB() { return db; }
+    //! The batch the next BatchWrite() commits together with the coins
+    CDBBatch& GetPendingBatch() { return batchPending; }
+};
+
+/**
+ * CMWEBCoinsView backed by the chainstate database, alongside the coins.
+ * BatchWrite() only stages its writes; they reach the database with the next
+ * BatchWrite() of the coins view, so both always describe the same block.
+ */
+class CMWEBCoinsViewDB : public CMWEBCoinsView
+{
+protected:
+    CDBWrapper& db;
+    CDBBatch& batchPending;
+public:
+    CMWEBCoinsViewDB(CCoinsViewDB& coinsIn) : db(coinsIn.GetDB()), batchPending(coinsIn.GetPendingBatch()) {}
+
+    bool GetCoin(const CPubKey& commitment, CMWEBCoin& coin) const;
+    bool HaveCoin(const CPubKey& commitment) const;
+    uint256 GetBestBlock() const;
+    bool BatchWrite(CMWEBCoinsMap& mapCoins, const uint256& hashBlock);
+
+    bool WriteBlockUndo(int nHeight, const uint256& hashBlock, const CMWEBBlockUndo& undo);
+    bool ReadBlockUndo(int nHeight, const uint256& hashBlock, CMWEBBlockUndo& undo) const;
+    //! Stage the erasure of the undo data of a block that left the chain
+    void EraseBlockUndo(int nHeight, const uint256& hashBlock);
+    //! Stage the erasure of the undo data of all blocks below nHeight
+    void PruneBlockUndo(int nHeight);
+};
+
+/**
+ * COracleView backed by the chainstate database, alongside the coins.
+ * Like CMWEBCoinsViewDB, BatchWrite() stages its writes for the coins view.
+ */
+class COracleViewDB : public COracleView
+{
+protected:
+    CDBWrapper& db;
+    CDBBatch& batchPending;
+public:
+    COracleViewDB(CCoinsViewDB& coinsIn) : db(coinsIn.GetDB()), batchPending(coinsIn.GetPendingBatch()) {}
+
+    bool GetOracle(const CPubKey& pubkey, COracleNode& oracle) const;
+    bool GetVerification(const uint256& record_id, CVerificationEntry& entry) const;
+    uint256 GetBestBlock() const;
+    bool BatchWrite(COracleMap& mapOracles, CVerificationMap& mapVerifications, const uint256& hashBlock);
+    void LoadSampler(COracleSampler& sampler) const;
+
+    bool WriteBlockUndo(int nHeight, const uint256& hashBlock, const COracleBlockUndo& undo);
+    bool ReadBlockUndo(int nHeight, const uint256& hashBlock, COracleBlockUndo& undo) const;
+    void EraseBlockUndo(int nHeight, const uint256& hashBlock);
+    void PruneBlockUndo(int nHeight);
 };
 
 /** Specialization of CCoinsViewCursor to iterate over a CCoinsViewDB */
@@ -87,8 +149,8 @@ class CCoinsViewDBCursor: public CCoinsViewCursor
 public:
     ~CCoinsViewDBCursor() {}
 
-    bool GetKey(uint256 &key) const;
-    bool GetValue(CCoins &coins) const;
+    bool GetKey(COutPoint &key) const;
+    bool GetValue(Coin &coin) const;
     unsigned int GetValueSize() const;
 
     bool Valid() const;
@@ -98,7 +160,7 @@ private:
     CCoinsViewDBCursor(CDBIterator* pcursorIn, const uint256 &hashBlockIn):
         CCoinsViewCursor(hashBlockIn), pcursor(pcursorIn) {}
     std::unique_ptr<CDBIterator> pcursor;
-    std::pair<char, uint256> keyTmp;
+    std::pair<char, COutPoint> keyTmp;
 
     friend class CCoinsViewDB;
 };
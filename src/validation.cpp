@@ -7,17 +7,21 @@
 #include "validation.h"
 
 #include "arith_uint256.h"
+#include "blockmarkers.h"
 #include "chainparams.h"
 #include "checkpoints.h"
 #include "checkqueue.h"
 #include "consensus/consensus.h"
 #include "consensus/merkle.h"
 #include "consensus/validation.h"
+#include "crypto/common.h"
+#include "crypto/scrypt.h"
 #include "fleetcredits.h"
 #include "fleetcredits-fees.h"
 #include "fs.h"
 #include "hash.h"
 #include "init.h"
+#include "mappedfile.h"
 #include "policy/fees.h"
 #include "policy/policy.h"
 #include "pow.h"
@@ -25,7 +29,10 @@
 #include "primitives/pureheader.h"
 #include "primitives/transaction.h"
 #include "primitives/contribution.h"
+#include "primitives/mweb.h"
 #include "primitives/verification.h"
+#include "mweb_coins.h"
+#include "oracles.h"
 #include "mweb_mempool.h"
 #include "random.h"
 #include "script/script.h"
@@ -245,6 +252,10 @@ CBlockIndex* FindForkInGlobalIndex(const CChain& chain, const CBlockLocator& loc
 }
 
 CCoinsViewCache *pcoinsTip = NULL;
+CMWEBCoinsViewDB *pmwebcoinsdbview = NULL;
+CMWEBCoinsViewCache *pmwebcoinsTip = NULL;
+COracleViewDB *poraclesdbview = NULL;
+COracleViewCache *poraclesTip = NULL;
 CBlockTreeDB *pblocktree = NULL;
 
 enum FlushStateMode {
@@ -433,15 +444,15 @@ bool CheckSequenceLocks(const CTransaction &tx, int flags, LockPoints* lp, bool
         prevheights.resize(tx.vin.size());
         for (size_t txinIndex = 0; txinIndex < tx.vin.size(); txinIndex++) {
             const CTxIn& txin = tx.vin[txinIndex];
-            CCoins coins;
-            if (!viewMemPool.GetCoins(txin.prevout.hash, coins)) {
+            Coin coin;
+            if (!viewMemPool.GetCoin(txin.prevout, coin)) {
                 return error("%s: Missing input", __func__);
             }
-            if (coins.nHeight == MEMPOOL_HEIGHT) {
+            if (coin.nHeight == MEMPOOL_HEIGHT) {
                 // Assume all mempool transaction confirm in the next block
                 prevheights[txinIndex] = tip->nHeight + 1;
             } else {
-                prevheights[txinIndex] = coins.nHeight;
+                prevheights[txinIndex] = coin.nHeight;
             }
         }
         lockPair = CalculateSequenceLocks(tx, flags, &prevheights, index);
@@ -497,7 +508,9 @@ unsigned int GetP2SHSigOpCount(const CTransaction& tx, const CCoinsViewCache& in
     unsigned int nSigOps = 0;
     for (unsigned int i = 0; i < tx.vin.size(); i++)
     {
-        const CTxOut &prevout = inputs.GetOutputFor(tx.vin[i]);
+        const Coin& coin = inputs.AccessCoin(tx.vin[i].prevout);
+        assert(!coin.IsSpent());
+        const CTxOut &prevout = coin.out;
         if (prevout.scriptPubKey.IsPayToScriptHash())
             nSigOps += prevout.scriptPubKey.GetSigOpCount(tx.vin[i].scriptSig);
     }
@@ -517,7 +530,9 @@ int64_t GetTransactionSigOpCost(const CTransaction& tx, const CCoinsViewCache& i
 
     for (unsigned int i = 0; i < tx.vin.size(); i++)
     {
-        const CTxOut &prevout = inputs.GetOutputFor(tx.vin[i]);
+        const Coin& coin = inputs.AccessCoin(tx.vin[i].prevout);
+        assert(!coin.IsSpent());
+        const CTxOut &prevout = coin.out;
         nSigOps += CountWitnessSigOps(tx.vin[i].scriptSig, prevout.scriptPubKey, &tx.vin[i].scriptWitness, flags);
     }
     return nSigOps;
@@ -588,9 +603,9 @@ void LimitMempoolSize(CTxMemPool& pool, size_t limit, unsigned long age) {
     if (expired != 0)
         LogPrint("mempool", "Expired %i transactions from the memory pool\n", expired);
 
-    std::vector<uint256> vNoSpendsRemaining;
+    std::vector<COutPoint> vNoSpendsRemaining;
     pool.TrimToSize(limit, &vNoSpendsRemaining);
-    BOOST_FOREACH(const uint256& removed, vNoSpendsRemaining)
+    BOOST_FOREACH(const COutPoint& removed, vNoSpendsRemaining)
         pcoinsTip->Uncache(removed);
 }
 
@@ -617,7 +632,7 @@ static bool IsCurrentForFeeEstimation()
 
 bool AcceptToMemoryPoolWorker(CTxMemPool& pool, CValidationState& state, const CTransactionRef& ptx, bool fLimitFree,
                               bool* pfMissingInputs, int64_t nAcceptTime, std::list<CTransactionRef>* plTxnReplaced,
-                              bool fOverrideMempoolLimit, const CAmount& nAbsurdFee, std::vector<uint256>& vHashTxnToUncache)
+                              bool fOverrideMempoolLimit, const CAmount& nAbsurdFee, std::vector<COutPoint>& coins_to_uncache)
 {
     const CTransaction& tx = *ptx;
     const uint256 hash = tx.GetHash();
@@ -710,30 +725,34 @@ bool AcceptToMemoryPoolWorker(CTxMemPool& pool, CValidationState& state, const C
         view.SetBackend(viewMemPool);
 
         // do we already have it?
-        bool fHadTxInCache = pcoinsTip->HaveCoinsInCache(hash);
-        if (view.HaveCoins(hash)) {
-            if (!fHadTxInCache)
-                vHashTxnToUncache.push_back(hash);
-            return state.Invalid(false, REJECT_ALREADY_KNOWN, "txn-already-known");
+        for (size_t out = 0; out < tx.vout.size(); out++) {
+            COutPoint outpoint(hash, out);
+            bool fHadCoinInCache = pcoinsTip->HaveCoinInCache(outpoint);
+            if (view.HaveCoin(outpoint)) {
+                if (!fHadCoinInCache)
+                    coins_to_uncache.push_back(outpoint);
+                return state.Invalid(false, REJECT_ALREADY_KNOWN, "txn-already-known");
+            }
         }
 
         // do all inputs exist?
-        // Note that this does not check for the presence of actual outputs (see the next check for that),
-        // and only helps with filling in pfMissingInputs (to determine missing vs spent).
         BOOST_FOREACH(const CTxIn txin, tx.vin) {
-            if (!pcoinsTip->HaveCoinsInCache(txin.prevout.hash))
-                vHashTxnToUncache.push_back(txin.prevout.hash);
-            if (!view.HaveCoins(txin.prevout.hash)) {
+            if (!pcoinsTip->HaveCoinInCache(txin.prevout))
+                coins_to_uncache.push_back(txin.prevout);
+            if (!view.HaveCoin(txin.prevout)) {
+                // Are inputs missing because we already have the tx?
+                for (size_t out = 0; out < tx.vout.size(); out++) {
+                    // Optimistically just do efficient check of cache for outputs
+                    if (pcoinsTip->HaveCoinInCache(COutPoint(hash, out)))
+                        return state.Invalid(false, REJECT_ALREADY_KNOWN, "txn-already-known");
+                }
+                // Otherwise assume this might be an orphan tx for which we just haven't seen parents yet
                 if (pfMissingInputs)
                     *pfMissingInputs = true;
                 return false; // fMissingInputs and !state.IsInvalid() is used to detect this condition, don't set state.Invalid()
             }
         }
 
-        // are the actual inputs available?
-        if (!view.HaveInputs(tx))
-            return state.Invalid(false, REJECT_DUPLICATE, "bad-txns-inputs-spent");
-
         // Bring the best block into scope
         view.GetBestBlock();
 
@@ -775,8 +794,8 @@ bool AcceptToMemoryPoolWorker(CTxMemPool& pool, CValidationState& state, const C
         // during reorgs to ensure COINBASE_MATURITY is still met.
         bool fSpendsCoinbase = false;
         BOOST_FOREACH(const CTxIn &txin, tx.vin) {
-            const CCoins *coins = view.AccessCoins(txin.prevout.hash);
-            if (coins->IsCoinBase()) {
+            const Coin &coin = view.AccessCoin(txin.prevout);
+            if (coin.IsCoinBase()) {
                 fSpendsCoinbase = true;
                 break;
             }
@@ -1062,11 +1081,11 @@ bool AcceptToMemoryPoolWithTime(CTxMemPool& pool, CValidationState &state, const
                         bool* pfMissingInputs, int64_t nAcceptTime, std::list<CTransactionRef>* plTxnReplaced,
                         bool fOverrideMempoolLimit, const CAmount nAbsurdFee)
 {
-    std::vector<uint256> vHashTxToUncache;
-    bool res = AcceptToMemoryPoolWorker(pool, state, tx, fLimitFree, pfMissingInputs, nAcceptTime, plTxnReplaced, fOverrideMempoolLimit, nAbsurdFee, vHashTxToUncache);
+    std::vector<COutPoint> coins_to_uncache;
+    bool res = AcceptToMemoryPoolWorker(pool, state, tx, fLimitFree, pfMissingInputs, nAcceptTime, plTxnReplaced, fOverrideMempoolLimit, nAbsurdFee, coins_to_uncache);
     if (!res) {
-        BOOST_FOREACH(const uint256& hashTx, vHashTxToUncache)
-            pcoinsTip->Uncache(hashTx);
+        BOOST_FOREACH(const COutPoint& outpoint, coins_to_uncache)
+            pcoinsTip->Uncache(outpoint);
     }
     // After we've (potentially) uncached entries, ensure our coins cache is still within its size limits
     CValidationState stateDummy;
@@ -1117,15 +1136,8 @@ bool GetTransaction(const uint256 &hash, CTransactionRef &txOut, const Consensus
     }
 
     if (fAllowSlow) { // use coin database to locate block that contains transaction, and scan it
-        int nHeight = -1;
-        {
-            const CCoinsViewCache& view = *pcoinsTip;
-            const CCoins* coins = view.AccessCoins(hash);
-            if (coins)
-                nHeight = coins->nHeight;
-        }
-        if (nHeight > 0)
-            pindexSlow = chainActive[nHeight];
+        const Coin& coin = AccessByTxid(*pcoinsTip, hash);
+        if (!coin.IsSpent()) pindexSlow = chainActive[coin.nHeight];
     }
 
     if (pindexSlow) {
@@ -1175,6 +1187,86 @@ bool WriteBlockToDisk(const CBlock& block, CDiskBlockPos& pos, const CMessageHea
     return true;
 }
 
+/** Recently used block file mappings, most recently used first. */
+static CCriticalSection cs_BlockFileMaps;
+static std::list<std::shared_ptr<const CMappedFile> > listBlockFileMaps;
+
+/**
+ * Return a mapping of block file nFile covering at least its first nMinSize
+ * bytes, or nullptr if the file cannot be mapped. The file is mapped again
+ * when it has grown past a cached mapping.
+ */
+static std::shared_ptr<const CMappedFile> GetBlockFileMap(int nFile, size_t nMinSize)
+{
+    const fs::path path = GetBlockPosFilename(CDiskBlockPos(nFile, 0), "blk");
+
+    LOCK(cs_BlockFileMaps);
+    for (auto it = listBlockFileMaps.begin(); it != listBlockFileMaps.end(); ++it) {
+        if ((*it)->GetPath() == path) {
+            std::shared_ptr<const CMappedFile> map = *it;
+            listBlockFileMaps.erase(it);
+            if (map->size() >= nMinSize) {
+                listBlockFileMaps.push_front(map);
+                return map;
+            }
+            break;
+        }
+    }
+
+    std::shared_ptr<const CMappedFile> map = CMappedFile::Open(path);
+    if (!map || map->size() < nMinSize)
+        return nullptr;
+    listBlockFileMaps.push_front(map);
+    if (listBlockFileMaps.size() > MAX_MAPPED_BLOCK_FILES)
+        listBlockFileMaps.pop_back();
+    return map;
+}
+
+/** Drop the cached mapping of block file nFile, if any. */
+static void ForgetBlockFileMap(int nFile)
+{
+    const fs::path path = GetBlockPosFilename(CDiskBlockPos(nFile, 0), "blk");
+
+    LOCK(cs_BlockFileMaps);
+    for (auto it = listBlockFileMaps.begin(); it != listBlockFileMaps.end(); ++it) {
+        if ((*it)->GetPath() == path) {
+            listBlockFileMaps.erase(it);
+            return;
+        }
+    }
+}
+
+/**
+ * Find the bytes of the block stored at pos in a mapping of its file. Only
+ * blocks within the part of the file recorded as written are read this way,
+ * so pages past the end of a finalized (truncated) file are never touched.
+ * The returned mapping keeps [pbegin, pend) valid.
+ */
+static std::shared_ptr<const CMappedFile> GetMappedBlock(const CDiskBlockPos& pos, const unsigned char*& pbegin, const unsigned char*& pend)
+{
+    unsigned int nFileSize;
+    {
+        LOCK(cs_LastBlockFile);
+        if (pos.nFile < 0 || (unsigned int)pos.nFile >= vinfoBlockFile.size())
+            return nullptr;
+        nFileSize = vinfoBlockFile[pos.nFile].nSize;
+    }
+    // The block is preceded by the message start and its size
+    if (pos.nPos < 8 || pos.nPos > nFileSize)
+        return nullptr;
+
+    std::shared_ptr<const CMappedFile> map = GetBlockFileMap(pos.nFile, nFileSize);
+    if (!map)
+        return nullptr;
+    unsigned int nBlockSize = ReadLE32(map->data() + pos.nPos - 4);
+    if (nBlockSize > nFileSize - pos.nPos)
+        return nullptr;
+
+    pbegin = map->data() + pos.nPos;
+    pend = pbegin + nBlockSize;
+    return map;
+}
+
 /* Generic implementation of block reading that can handle
    both a block and its header.  */
 
@@ -1183,17 +1275,29 @@ static bool ReadBlockOrHeader(T& block, const CDiskBlockPos& pos, const Consensu
 {
     block.SetNull();
 
-    // Open history file to read
-    CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
-    if (filein.IsNull())
-        return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
+    // Read block, straight from a mapping of the history file if possible
+    const unsigned char* pbegin;
+    const unsigned char* pend;
+    std::shared_ptr<const CMappedFile> map = GetMappedBlock(pos, pbegin, pend);
+    if (map) {
+        try {
+            CSpanReader(SER_DISK, CLIENT_VERSION, pbegin, pend) >> block;
+        }
+        catch (const std::exception& e) {
+            return error("%s: Deserialize error - %s at %s", __func__, e.what(), pos.ToString());
+        }
+    } else {
+        // Open history file to read
+        CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
+        if (filein.IsNull())
+            return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
 
-    // Read block
-    try {
-        filein >> block;
-    }
-    catch (const std::exception& e) {
-        return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
+        try {
+            filein >> block;
+        }
+        catch (const std::exception& e) {
+            return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
+        }
     }
 
     // Check the header - always validate PoW for all blocks
@@ -1392,24 +1496,13 @@ void UpdateCoins(const CTransaction& tx, CCoinsViewCache& inputs, CTxUndo &txund
     if (!tx.IsCoinBase()) {
         txundo.vprevout.reserve(tx.vin.size());
         BOOST_FOREACH(const CTxIn &txin, tx.vin) {
-            CCoinsModifier coins = inputs.ModifyCoins(txin.prevout.hash);
-            unsigned nPos = txin.prevout.n;
-
-            if (nPos >= coins->vout.size() || coins->vout[nPos].IsNull())
-                assert(false);
-            // mark an outpoint spent, and construct undo information
-            txundo.vprevout.push_back(CTxInUndo(coins->vout[nPos]));
-            coins->Spend(nPos);
-            if (coins->vout.size() == 0) {
-                CTxInUndo& undo = txundo.vprevout.back();
-                undo.nHeight = coins->nHeight;
-                undo.fCoinBase = coins->fCoinBase;
-                undo.nVersion = coins->nVersion;
-            }
+            txundo.vprevout.emplace_back();
+            bool is_spent = inputs.SpendCoin(txin.prevout, &txundo.vprevout.back());
+            assert(is_spent);
         }
     }
     // add outputs
-    inputs.ModifyNewCoins(tx.GetHash(), tx.IsCoinBase())->FromTx(tx, nHeight);
+    AddCoins(inputs, tx, nHeight);
 }
 
 void UpdateCoins(const CTransaction& tx, CCoinsViewCache& inputs, int nHeight)
@@ -1449,22 +1542,22 @@ bool CheckTxInputs(const CChainParams& params, const CTransaction& tx, CValidati
         for (unsigned int i = 0; i < tx.vin.size(); i++)
         {
             const COutPoint &prevout = tx.vin[i].prevout;
-            const CCoins *coins = inputs.AccessCoins(prevout.hash);
-            assert(coins);
+            const Coin& coin = inputs.AccessCoin(prevout);
+            assert(!coin.IsSpent());
 
             // If prev is coinbase, check that it's matured
-            if (coins->IsCoinBase()) {
+            if (coin.IsCoinBase()) {
                 // Fleet Credits: Switch maturity at depth 145,000
-                int nCoinbaseMaturity = params.GetConsensus(coins->nHeight).nCoinbaseMaturity;
-                if (nSpendHeight - coins->nHeight < nCoinbaseMaturity)
+                int nCoinbaseMaturity = params.GetConsensus(coin.nHeight).nCoinbaseMaturity;
+                if (nSpendHeight - (int)coin.nHeight < nCoinbaseMaturity)
                     return state.Invalid(false,
                         REJECT_INVALID, "bad-txns-premature-spend-of-coinbase",
-                        strprintf("tried to spend coinbase at depth %d", nSpendHeight - coins->nHeight));
+                        strprintf("tried to spend coinbase at depth %d", nSpendHeight - (int)coin.nHeight));
             }
 
             // Check for negative or overflow input values
-            nValueIn += coins->vout[prevout.n].nValue;
-            if (!MoneyRange(coins->vout[prevout.n].nValue) || !MoneyRange(nValueIn))
+            nValueIn += coin.out.nValue;
+            if (!MoneyRange(coin.out.nValue) || !MoneyRange(nValueIn))
                 return state.DoS(100, false, REJECT_INVALID, "bad-txns-inputvalues-outofrange");
 
         }
@@ -1506,11 +1599,11 @@ bool CheckInputs(const CTransaction& tx, CValidationState &state, const CCoinsVi
         if (fScriptChecks) {
             for (unsigned int i = 0; i < tx.vin.size(); i++) {
                 const COutPoint &prevout = tx.vin[i].prevout;
-                const CCoins* coins = inputs.AccessCoins(prevout.hash);
-                assert(coins);
+                const Coin& coin = inputs.AccessCoin(prevout);
+                assert(!coin.IsSpent());
 
                 // Verify signature
-                CScriptCheck check(*coins, tx, i, flags, cacheStore, &txdata);
+                CScriptCheck check(coin.out, tx, i, flags, cacheStore, &txdata);
                 if (pvChecks) {
                     pvChecks->push_back(CScriptCheck());
                     check.swap(pvChecks->back());
@@ -1522,7 +1615,7 @@ bool CheckInputs(const CTransaction& tx, CValidationState &state, const CCoinsVi
                         // arguments; if so, don't trigger DoS protection to
                         // avoid splitting the network between upgraded and
                         // non-upgraded nodes.
-                        CScriptCheck check2(*coins, tx, i,
+                        CScriptCheck check2(coin.out, tx, i,
                                 flags & ~STANDARD_NOT_MANDATORY_VERIFY_FLAGS, cacheStore, &txdata);
                         if (check2())
                             return state.Invalid(false, REJECT_NONSTANDARD, strprintf("non-mandatory-script-verify-flag (%s)", ScriptErrorString(check.GetScriptError())));
@@ -1619,42 +1712,48 @@ bool AbortNode(CValidationState& state, const std::string& strMessage, const std
 
 } // anon namespace
 
+enum DisconnectResult
+{
+    DISCONNECT_OK,      // All good.
+    DISCONNECT_UNCLEAN, // Rolled back, but UTXO set was inconsistent with block.
+    DISCONNECT_FAILED   // Something else went wrong.
+};
+
 /**
- * Apply the undo operation of a CTxInUndo to the given chain state.
- * @param undo The undo object.
+ * Restore the UTXO in a Coin at a given COutPoint
+ * @param undo The Coin to be restored.
  * @param view The coins view to which to apply the changes.
  * @param out The out point that corresponds to the tx input.
- * @return True on success.
+ * @return A DisconnectResult as an int
  */
-bool ApplyTxInUndo(const CTxInUndo& undo, CCoinsViewCache& view, const COutPoint& out)
+int ApplyTxInUndo(Coin&& undo, CCoinsViewCache& view, const COutPoint& out)
 {
     bool fClean = true;
 
-    CCoinsModifier coins = view.ModifyCoins(out.hash);
-    if (undo.nHeight != 0) {
-        // undo data contains height: this is the last output of the prevout tx being spent
-        if (!coins->IsPruned())
-            fClean = fClean && error("%s: undo data overwriting existing transaction", __func__);
-        coins->Clear();
-        coins->fCoinBase = undo.fCoinBase;
-        coins->nHeight = undo.nHeight;
-        coins->nVersion = undo.nVersion;
-    } else {
-        if (coins->IsPruned())
-            fClean = fClean && error("%s: undo data adding output to missing transaction", __func__);
+    if (view.HaveCoin(out)) fClean = false; // overwriting transaction output
+
+    if (undo.nHeight == 0) {
+        // Missing undo metadata (height and coinbase). Older versions included this
+        // information only in undo records for the last spend of a transactions'
+        // outputs. This implies that it must be present for some other output of the same tx.
+        const Coin& alternate = AccessByTxid(view, out.hash);
+        if (!alternate.IsSpent()) {
+            undo.nHeight = alternate.nHeight;
+            undo.fCoinBase = alternate.fCoinBase;
+        } else {
+            return DISCONNECT_FAILED; // adding output for transaction without known metadata
+        }
     }
-    if (coins->IsAvailable(out.n))
-        fClean = fClean && error("%s: undo data overwriting existing output", __func__);
-    if (coins->vout.size() < out.n+1)
-        coins->vout.resize(out.n+1);
-    coins->vout[out.n] = undo.txout;
+    view.AddCoin(out, std::move(undo), !fClean);
 
-    return fClean;
+    return fClean ? DISCONNECT_OK : DISCONNECT_UNCLEAN;
 }
 
-bool DisconnectBlock(const CBlock& block, CValidationState& state, const CBlockIndex* pindex, CCoinsViewCache& view, bool* pfClean)
+bool DisconnectBlock(const CBlock& block, CValidationState& state, const CBlockIndex* pindex, CCoinsViewCache& view, CMWEBCoinsViewCache& mwebview, COracleViewCache& oracleview, bool* pfClean)
 {
     assert(pindex->GetBlockHash() == view.GetBestBlock());
+    assert(pindex->GetBlockHash() == mwebview.GetBestBlock());
+    assert(pindex->GetBlockHash() == oracleview.GetBestBlock());
 
     if (pfClean)
         *pfClean = false;
@@ -1676,41 +1775,56 @@ bool DisconnectBlock(const CBlock& block, CValidationState& state, const CBlockI
         const CTransaction &tx = *(block.vtx[i]);
         uint256 hash = tx.GetHash();
 
+        bool is_coinbase = tx.IsCoinBase();
+
         // Check that all outputs are available and match the outputs in the block itself
         // exactly.
-        {
-        CCoinsModifier outs = view.ModifyCoins(hash);
-        outs->ClearUnspendable();
-
-        CCoins outsBlock(tx, pindex->nHeight);
-        // The CCoins serialization does not serialize negative numbers.
-        // No network rules currently depend on the version here, so an inconsistency is harmless
-        // but it must be corrected before txout nversion ever influences a network rule.
-        if (outsBlock.nVersion < 0)
-            outs->nVersion = outsBlock.nVersion;
-        if (*outs != outsBlock)
-            fClean = fClean && error("DisconnectBlock(): added transaction mismatch? database corrupted");
-
-        // remove outputs
-        outs->Clear();
+        for (size_t o = 0; o < tx.vout.size(); o++) {
+            if (!tx.vout[o].scriptPubKey.IsUnspendable()) {
+                COutPoint out(hash, o);
+                Coin coin;
+                bool is_spent = view.SpendCoin(out, &coin);
+                if (!is_spent || tx.vout[o] != coin.out || (uint32_t)pindex->nHeight != coin.nHeight || is_coinbase != coin.fCoinBase)
+                    fClean = fClean && error("DisconnectBlock(): added transaction mismatch? database corrupted");
+            }
         }
 
         // restore inputs
         if (i > 0) { // not coinbases
-            const CTxUndo &txundo = blockUndo.vtxundo[i-1];
+            CTxUndo &txundo = blockUndo.vtxundo[i-1];
             if (txundo.vprevout.size() != tx.vin.size())
                 return error("DisconnectBlock(): transaction and undo data inconsistent");
             for (unsigned int j = tx.vin.size(); j-- > 0;) {
                 const COutPoint &out = tx.vin[j].prevout;
-                const CTxInUndo &undo = txundo.vprevout[j];
-                if (!ApplyTxInUndo(undo, view, out))
-                    fClean = false;
+                int res = ApplyTxInUndo(std::move(txundo.vprevout[j]), view, out);
+                if (res == DISCONNECT_FAILED)
+                    return error("DisconnectBlock(): undo data lacks the height of %s", out.ToString());
+                fClean = fClean && res != DISCONNECT_UNCLEAN;
             }
         }
     }
 
+    // undo the MWEB output set changes
+    if (block.mweb_extension) {
+        CMWEBBlockUndo mwebUndo;
+        if (!pmwebcoinsdbview->ReadBlockUndo(pindex->nHeight, pindex->GetBlockHash(), mwebUndo))
+            return error("DisconnectBlock(): failure reading MWEB undo data");
+        if (!DisconnectMWEBCoins(*block.mweb_extension, mwebview, mwebUndo))
+            fClean = false;
+    }
+
+    // undo the oracle state changes
+    if (HasOracleUpdates(*GetBlockMarkers(block))) {
+        COracleBlockUndo oracleUndo;
+        if (!poraclesdbview->ReadBlockUndo(pindex->nHeight, pindex->GetBlockHash(), oracleUndo))
+            return error("DisconnectBlock(): failure reading oracle undo data");
+        DisconnectOracleState(oracleview, oracleUndo);
+    }
+
     // move best block pointer to prevout block
     view.SetBestBlock(pindex->pprev->GetBlockHash());
+    mwebview.SetBestBlock(pindex->pprev->GetBlockHash());
+    oracleview.SetBestBlock(pindex->pprev->GetBlockHash());
 
     if (pfClean) {
         *pfClean = fClean;
@@ -1752,6 +1866,83 @@ void ThreadScriptCheck() {
     scriptcheckqueue.Thread();
 }
 
+static CCheckQueue<CMWEBCheck> mwebcheckqueue(128);
+
+void ThreadMWEBCheck() {
+    RenameThread("fleetcredits-mwebch");
+    mwebcheckqueue.Thread();
+}
+
+/** Number of headers covered by a single CHeaderPoWCheck: a batch for the widest scrypt kernel */
+static const size_t HEADER_POW_CHECK_HEADERS = SCRYPT_MAX_LANES;
+
+static CCheckQueue<CHeaderPoWCheck> headercheckqueue(128);
+
+void ThreadHeaderCheck() {
+    RenameThread("fleetcredits-headerch");
+    headercheckqueue.Thread();
+}
+
+bool CHeaderPoWCheck::operator()() {
+    const Consensus::Params& params = Params().GetConsensus(0);
+    char input[HEADER_POW_CHECK_HEADERS * 80];
+    uint256 hashes[HEADER_POW_CHECK_HEADERS];
+    for (size_t i = nBegin; i < nEnd; i += HEADER_POW_CHECK_HEADERS) {
+        size_t n = std::min(nEnd - i, HEADER_POW_CHECK_HEADERS);
+        for (size_t j = 0; j < n; j++) {
+            // The hashed header, as in CPureBlockHeader::GetPoWHash
+            const CBlockHeader& header = (*headers)[i + j];
+            const CPureBlockHeader& powHeader = header.auxpow ? header.auxpow->parentBlock : static_cast<const CPureBlockHeader&>(header);
+            memcpy(&input[80 * j], BEGIN(powHeader.nVersion), 80);
+        }
+        scrypt_1024_1_1_256_multi(input, (char*)hashes, n);
+        for (size_t j = 0; j < n; j++) {
+            if (!CheckAuxPowProofOfWork((*headers)[i + j], hashes[j], params))
+                return false;
+            (*pvValid)[i + j] = true;
+        }
+    }
+    return true;
+}
+
+static CCheckQueue<CCoinsPrefetch> coinsprefetchqueue(128);
+
+void ThreadCoinsPrefetch() {
+    RenameThread("fleetcredits-prefetch");
+    coinsprefetchqueue.Thread();
+}
+
+bool CCoinsPrefetch::operator()() {
+    view->GetCoinFromBase(*poutpoint, *pcoin);
+    return true;
+}
+
+/**
+ * Check the proof of work of headers[nBegin..], spread over the header
+ * check threads if there are any. vValid[i] is set for the headers that pass;
+ * checking stops at the first failure.
+ */
+static void CheckHeadersProofOfWork(const std::vector<CBlockHeader>& headers, size_t nBegin, std::vector<char>& vValid)
+{
+    // A message with a bad first header is rejected without hashing the rest
+    if (nBegin >= headers.size() || !CHeaderPoWCheck(headers, vValid, nBegin, nBegin + 1)())
+        return;
+
+    CCheckQueueControl<CHeaderPoWCheck> control(nScriptCheckThreads ? &headercheckqueue : NULL);
+    std::vector<CHeaderPoWCheck> vChecks;
+    for (size_t i = nBegin + 1; i < headers.size(); i += HEADER_POW_CHECK_HEADERS) {
+        CHeaderPoWCheck check(headers, vValid, i, std::min(i + HEADER_POW_CHECK_HEADERS, headers.size()));
+        if (nScriptCheckThreads) {
+            vChecks.push_back(CHeaderPoWCheck());
+            check.swap(vChecks.back());
+        } else if (!check()) {
+            return;
+        }
+    }
+    control.Add(vChecks);
+    control.Wait();
+}
+
 // Protected by cs_main
 VersionBitsCache versionbitscache;
 
@@ -1806,7 +1997,7 @@ static int64_t nTimeCallbacks = 0;
 static int64_t nTimeTotal = 0;
 
 bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pindex,
-                  CCoinsViewCache& view, const CChainParams& chainparams, bool fJustCheck)
+                  CCoinsViewCache& view, CMWEBCoinsViewCache& mwebview, COracleViewCache& oracleview, const CChainParams& chainparams, bool fJustCheck)
 {
     AssertLockHeld(cs_main);
 
@@ -1840,12 +2031,17 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
     // verify that the view's current state corresponds to the previous block
     uint256 hashPrevBlock = pindex->pprev == NULL ? uint256() : pindex->pprev->GetBlockHash();
     assert(hashPrevBlock == view.GetBestBlock());
+    assert(hashPrevBlock == mwebview.GetBestBlock());
+    assert(hashPrevBlock == oracleview.GetBestBlock());
 
     // Special case for the genesis block, skipping connection of its transactions
     // (its coinbase is unspendable)
     if (block.GetHash() == Params().GetConsensus(0).hashGenesisBlock) {
-        if (!fJustCheck)
+        if (!fJustCheck) {
             view.SetBestBlock(pindex->GetBlockHash());
+            mwebview.SetBestBlock(pindex->GetBlockHash());
+            oracleview.SetBestBlock(pindex->GetBlockHash());
+        }
         return true;
     }
 
@@ -1905,10 +2101,12 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
 
     if (fEnforceBIP30) {
         for (const auto& tx : block.vtx) {
-            const CCoins* coins = view.AccessCoins(tx->GetHash());
-            if (coins && !coins->IsPruned())
-                return state.DoS(100, error("ConnectBlock(): tried to overwrite transaction"),
-                                 REJECT_INVALID, "bad-txns-BIP30");
+            for (size_t o = 0; o < tx->vout.size(); o++) {
+                if (view.HaveCoin(COutPoint(tx->GetHash(), o))) {
+                    return state.DoS(100, error("ConnectBlock(): tried to overwrite transaction"),
+                                     REJECT_INVALID, "bad-txns-BIP30");
+                }
+            }
         }
     }
 
@@ -1947,6 +2145,9 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
     CBlockUndo blockundo;
 
     CCheckQueueControl<CScriptCheck> control(fScriptChecks && nScriptCheckThreads ? &scriptcheckqueue : NULL);
+    // MWEB range proofs and balances are always verified (not subject to
+    // -assumevalid), so they use the queue whenever worker threads exist
+    CCheckQueueControl<CMWEBCheck> mwebcontrol(nScriptCheckThreads ? &mwebcheckqueue : NULL);
 
     std::vector<int> prevheights;
     CAmount nFees = 0;
@@ -1975,7 +2176,7 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
             // be in ConnectBlock because they require the UTXO set
             prevheights.resize(tx.vin.size());
             for (size_t j = 0; j < tx.vin.size(); j++) {
-                prevheights[j] = view.AccessCoins(tx.vin[j].prevout.hash)->nHeight;
+                prevheights[j] = view.AccessCoin(tx.vin[j].prevout).nHeight;
             }
 
             if (!SequenceLocks(tx, nLockTimeFlags, &prevheights, *pindex)) {
@@ -2024,58 +2225,44 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
 
     CAmount blockReward = nFees + GetFleetCreditsBlockSubsidy(pindex->nHeight, chainparams.GetConsensus(pindex->nHeight), hashPrevBlock);
     
-    // Extract contributions from block and calculate bonus rewards
-    std::vector<CContributionTransaction> contributions = ExtractContributionsFromBlock(block);
+    // Extract contributions from block and calculate bonus rewards, reusing
+    // what was parsed when its transactions entered our mempool
+    std::shared_ptr<const CBlockMarkers> markers = GetBlockMarkers(block, [](const CTransaction& tx) { return mempool.GetMarkers(tx); });
+    std::vector<CContributionTransaction> contributions = markers->contributions;
     if (!contributions.empty()) {
-        // Calculate block reward with contribution bonuses
+        // Calculate block reward with contribution bonuses, as verified by
+        // the oracles up to the previous block
         blockReward = nFees + GetFleetCreditsBlockSubsidyWithContributions(
             pindex->nHeight, 
             chainparams.GetConsensus(pindex->nHeight), 
             hashPrevBlock, 
-            contributions
+            contributions,
+            &oracleview
         );
     }
+
+    COracleBlockUndo oracleundo;
+    UpdateOracleState(*markers, oracleview, oracleundo, block.GetBlockTime());
     
     // Validate MWEB extension block if present
+    CMWEBBlockUndo mwebundo;
     if (block.mweb_extension) {
-        if (!block.mweb_extension->VerifyAll()) {
+        std::vector<CMWEBCheck> vMWEBChecks;
+        if (!block.mweb_extension->VerifyAll(nScriptCheckThreads ? &vMWEBChecks : NULL, fJustCheck)) {
             return state.DoS(100, false, REJECT_INVALID, "bad-mweb-extension");
         }
+        mwebcontrol.Add(vMWEBChecks);
+
+        // MWEB inputs must spend unspent outputs, and outputs must be new
+        if (!UpdateMWEBCoins(*block.mweb_extension, mwebview, mwebundo, pindex->nHeight))
+            return state.DoS(100, error("ConnectBlock(): MWEB inputs missing/spent or duplicate outputs"),
+                             REJECT_INVALID, "bad-mweb-txns-inputs-missingorspent");
         
         // Verify peg-in transactions match main chain transactions
         for (const auto& peg_in : block.mweb_extension->peg_ins) {
             // Verify the main chain transaction exists in this block or previous blocks
-            bool found_peg_tx = false;
-            
             // Check current block first
-            for (const auto& tx : block.vtx) {
-                if (tx->GetHash() == peg_in.main_chain_tx_id) {
-                    // Verify transaction has correct peg-in marker and amount
-                    for (const auto& txout : tx->vout) {
-                        const CScript& script = txout.scriptPubKey;
-                        if (script.size() > 2 && script[0] == OP_RETURN && 
-                            script[1] == 0xFC && script[2] == 0x02) {
-                            // Found peg-in marker
-                            // Verify amount matches
-                            try {
-                                std::vector<unsigned char> peg_data(script.begin() + 3, script.end());
-                                CDataStream ss(peg_data, SER_NETWORK, PROTOCOL_VERSION);
-                                uint256 peg_tx_id;
-                                CAmount peg_amount;
-                                ss >> peg_tx_id;
-                                ss >> peg_amount;
-                                if (peg_tx_id == peg_in.peg_tx_id && static_cast<uint64_t>(peg_amount) == peg_in.amount) {
-                                    found_peg_tx = true;
-                                    break;
-                                }
-                            } catch (...) {
-                                // Invalid peg-in data
-                            }
-                        }
-                    }
-                    if (found_peg_tx) break;
-                }
-            }
+            bool found_peg_tx = markers->HasPegIn(peg_in.main_chain_tx_id, peg_in.peg_tx_id, peg_in.amount);
             
             // If not in current block, verify it exists in previous blocks or mempool
             if (!found_peg_tx) {
@@ -2173,6 +2360,9 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
         }
         return state.DoS(100, false);
     }
+    if (!mwebcontrol.Wait())
+        return state.DoS(100, error("ConnectBlock(): MWEB extension verification failed"),
+                         REJECT_INVALID, "bad-mweb-extension");
     int64_t nTime4 = GetTimeMicros(); nTimeVerify += nTime4 - nTime2;
     LogPrint("bench", "    - Verify %u txins: %.2fms (%.3fms/txin) [%.2fs]\n", nInputs - 1, 0.001 * (nTime4 - nTime2), nInputs <= 1 ? 0 : 0.001 * (nTime4 - nTime2) / (nInputs-1), nTimeVerify * 0.000001);
 
@@ -2198,12 +2388,20 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
         setDirtyBlockIndex.insert(pindex);
     }
 
+    if (block.mweb_extension && !pmwebcoinsdbview->WriteBlockUndo(pindex->nHeight, pindex->GetBlockHash(), mwebundo))
+        return AbortNode(state, "Failed to write MWEB undo data");
+
+    if (HasOracleUpdates(*markers) && !poraclesdbview->WriteBlockUndo(pindex->nHeight, pindex->GetBlockHash(), oracleundo))
+        return AbortNode(state, "Failed to write oracle undo data");
+
     if (fTxIndex)
         if (!pblocktree->WriteTxIndex(vPos))
             return AbortNode(state, "Failed to write transaction index");
 
     // add this block to the view's block chain
     view.SetBestBlock(pindex->GetBlockHash());
+    mwebview.SetBestBlock(pindex->GetBlockHash());
+    oracleview.SetBestBlock(pindex->GetBlockHash());
 
     int64_t nTime5 = GetTimeMicros(); nTimeIndex += nTime5 - nTime4;
     LogPrint("bench", "    - Index writing: %.2fms [%.2fs]\n", 0.001 * (nTime5 - nTime4), nTimeIndex * 0.000001);
@@ -2225,6 +2423,8 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
  * The caches and indexes are flushed depending on the mode we're called with
  * if they're too large, if it's been a while since the last write,
  * or always and in all cases if we're in prune mode and are deleting files.
+ * Unless the flush is forced, the coins cache keeps its contents: only its
+ * modified entries are written, and unmodified ones are evicted to make room.
  */
 bool static FlushStateToDisk(CValidationState &state, FlushStateMode mode, int nManualPruneHeight) {
     int64_t nMempoolUsage = mempool.DynamicMemoryUsage();
@@ -2263,21 +2463,31 @@ bool static FlushStateToDisk(CValidationState &state, FlushStateMode mode, int n
         nLastSetChain = nNow;
     }
     int64_t nMempoolSizeMax = GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000;
-    int64_t cacheSize = pcoinsTip->DynamicMemoryUsage() * DB_PEAK_USAGE_FACTOR;
+    int64_t nOtherCacheSize = pmwebcoinsTip->DynamicMemoryUsage() + poraclesTip->DynamicMemoryUsage();
+    // Memory the coins cache keeps for reuse after evictions counts as free.
+    int64_t cacheSize = (pcoinsTip->DynamicMemoryInUse() + nOtherCacheSize) * DB_PEAK_USAGE_FACTOR;
     int64_t nTotalSpace = nCoinCacheUsage + std::max<int64_t>(nMempoolSizeMax - nMempoolUsage, 0);
+    int64_t nCacheLargeSize = std::min(std::max(nTotalSpace / 2, nTotalSpace - MIN_BLOCK_COINSDB_USAGE * 1024 * 1024),
+                                       std::max((9 * nTotalSpace) / 10, nTotalSpace - MAX_BLOCK_COINSDB_USAGE * 1024 * 1024));
     // The cache is large and we're within 10% and 200 MiB or 50% and 50MiB of the limit, but we have time now (not in the middle of a block processing).
-    bool fCacheLarge = mode == FLUSH_STATE_PERIODIC && cacheSize > std::min(std::max(nTotalSpace / 2, nTotalSpace - MIN_BLOCK_COINSDB_USAGE * 1024 * 1024),
-                                                                            std::max((9 * nTotalSpace) / 10, nTotalSpace - MAX_BLOCK_COINSDB_USAGE * 1024 * 1024));
+    bool fCacheLarge = mode == FLUSH_STATE_PERIODIC && cacheSize > nCacheLargeSize;
     // The cache is over the limit, we have to write now.
     bool fCacheCritical = mode == FLUSH_STATE_IF_NEEDED && cacheSize > nTotalSpace;
+    // The coins cache holds on to well over the limit, which evicting entries
+    // does not give back; only emptying it does.
+    int64_t cacheHeldSize = (pcoinsTip->DynamicMemoryUsage() + nOtherCacheSize) * DB_PEAK_USAGE_FACTOR;
+    bool fCacheOversized = (fCacheLarge || fCacheCritical) && cacheHeldSize > nTotalSpace + nTotalSpace / 10;
     // It's been a while since we wrote the block index to disk. Do this frequently, so we don't need to redownload after a crash.
     bool fPeriodicWrite = mode == FLUSH_STATE_PERIODIC && nNow > nLastWrite + (int64_t)DATABASE_WRITE_INTERVAL * 1000000;
     // It's been very long since we flushed the cache. Do this infrequently, to optimize cache usage.
     bool fPeriodicFlush = mode == FLUSH_STATE_PERIODIC && nNow > nLastFlush + (int64_t)DATABASE_FLUSH_INTERVAL * 1000000;
     // Combine all conditions that result in a full cache flush.
-    bool fDoFullFlush = (mode == FLUSH_STATE_ALWAYS) || fCacheLarge || fCacheCritical || fPeriodicFlush || fFlushForPrune;
+    bool fDoFullFlush = (mode == FLUSH_STATE_ALWAYS) || fCacheOversized || fFlushForPrune;
+    // Otherwise write the chainstate but keep the coins cache warm, evicting
+    // only as many unmodified coins as needed to get back under the limit.
+    bool fDoPartialFlush = !fDoFullFlush && (fCacheLarge || fCacheCritical || fPeriodicFlush);
     // Write blocks and block index to disk.
-    if (fDoFullFlush || fPeriodicWrite) {
+    if (fDoFullFlush || fDoPartialFlush || fPeriodicWrite) {
         // Depend on nMinDiskSpace to ensure we can write block index
         if (!CheckDiskSpace(0))
             return state.Error("out of disk space");
@@ -2307,20 +2517,42 @@ bool static FlushStateToDisk(CValidationState &state, FlushStateMode mode, int n
         nLastWrite = nNow;
     }
     // Flush best chain related state. This can only be done if the blocks / block index write was also done.
-    if (fDoFullFlush) {
-        // Typical CCoins structures on disk are around 128 bytes in size.
+    if (fDoFullFlush || fDoPartialFlush) {
+        // Typical Coin structures on disk are around 48 bytes in size.
         // Pushing a new one to the database can cause it to be written
         // twice (once in the log, and once in the tables). This is already
         // an overestimation, as most will delete an existing entry or
         // overwrite one. Still, use a conservative safety factor of 2.
-        if (!CheckDiskSpace(128 * 2 * 2 * pcoinsTip->GetCacheSize()))
+        if (!CheckDiskSpace(48 * 2 * 2 * pcoinsTip->GetCacheSize()))
             return state.Error("out of disk space");
         // Flush the chainstate (which may refer to block index entries).
-        if (!pcoinsTip->Flush())
-            return AbortNode(state, "Failed to write to coin database");
+        // The MWEB output set and oracle state only stage their writes,
+        // which the coins flush commits in the same database batch.
+        if (chainActive.Height() > (int)MAX_REORG_DEPTH) {
+            pmwebcoinsdbview->PruneBlockUndo(chainActive.Height() - MAX_REORG_DEPTH);
+            poraclesdbview->PruneBlockUndo(chainActive.Height() - MAX_REORG_DEPTH);
+        }
+        if (!pmwebcoinsTip->Flush())
+            return AbortNode(state, "Failed to write to MWEB output database");
+        if (!poraclesTip->Flush())
+            return AbortNode(state, "Failed to write to oracle database");
+        if (fDoFullFlush) {
+            if (!pcoinsTip->Flush())
+                return AbortNode(state, "Failed to write to coin database");
+        } else {
+            if (!pcoinsTip->Sync())
+                return AbortNode(state, "Failed to write to coin database");
+            if (fCacheLarge || fCacheCritical) {
+                // Leave some room below the threshold, so the next flush is not due right away.
+                int64_t nTargetSize = nCacheLargeSize - nTotalSpace * DATABASE_EVICT_MARGIN_PERCENT / 100;
+                int64_t nTargetUsage = nTargetSize / DB_PEAK_USAGE_FACTOR - pmwebcoinsTip->DynamicMemoryUsage() - poraclesTip->DynamicMemoryUsage();
+                size_t nEvicted = pcoinsTip->Trim(std::max<int64_t>(nTargetUsage, 0));
+                LogPrint("coindb", "Evicted %u unmodified coins from the cache\n", (unsigned int)nEvicted);
+            }
+        }
         nLastFlush = nNow;
     }
-    if (fDoFullFlush || ((mode == FLUSH_STATE_ALWAYS || mode == FLUSH_STATE_PERIODIC) && nNow > nLastSetChain + (int64_t)DATABASE_WRITE_INTERVAL * 1000000)) {
+    if (fDoFullFlush || fDoPartialFlush || ((mode == FLUSH_STATE_ALWAYS || mode == FLUSH_STATE_PERIODIC) && nNow > nLastSetChain + (int64_t)DATABASE_WRITE_INTERVAL * 1000000)) {
         // Update best block in wallet (so we can detect restored wallets).
         GetMainSignals().SetBestChain(chainActive.GetLocator());
         nLastSetChain = nNow;
@@ -2418,10 +2650,15 @@ bool static DisconnectTip(CValidationState& state, const CChainParams& chainpara
     int64_t nStart = GetTimeMicros();
     {
         CCoinsViewCache view(pcoinsTip);
-        if (!DisconnectBlock(block, state, pindexDelete, view))
+        CMWEBCoinsViewCache mwebview(pmwebcoinsTip);
+        COracleViewCache oracleview(poraclesTip);
+        if (!DisconnectBlock(block, state, pindexDelete, view, mwebview, oracleview))
             return error("DisconnectTip(): DisconnectBlock %s failed", pindexDelete->GetBlockHash().ToString());
-        bool flushed = view.Flush();
+        bool flushed = view.Flush() && mwebview.Flush() && oracleview.Flush();
         assert(flushed);
+        // The MWEB and oracle undo data goes with the next chainstate flush
+        pmwebcoinsdbview->EraseBlockUndo(pindexDelete->nHeight, pindexDelete->GetBlockHash());
+        poraclesdbview->EraseBlockUndo(pindexDelete->nHeight, pindexDelete->GetBlockHash());
     }
     LogPrint("bench", "- Disconnect block: %.2fms\n", (GetTimeMicros() - nStart) * 0.001);
     // Write the chain state to disk, if necessary.
@@ -2456,6 +2693,7 @@ bool static DisconnectTip(CValidationState& state, const CChainParams& chainpara
     for (const auto& tx : block.vtx) {
         GetMainSignals().SyncTransaction(*tx, pindexDelete->pprev, CMainSignals::SYNC_TRANSACTION_NOT_IN_BLOCK);
     }
+    GetMainSignals().BlockDisconnected(block, pindexDelete);
     return true;
 }
 
@@ -2501,7 +2739,9 @@ bool static ConnectTip(CValidationState& state, const CChainParams& chainparams,
     LogPrint("bench", "  - Load block from disk: %.2fms [%.2fs]\n", (nTime2 - nTime1) * 0.001, nTimeReadFromDisk * 0.000001);
     {
         CCoinsViewCache view(pcoinsTip);
-        bool rv = ConnectBlock(blockConnecting, state, pindexNew, view, chainparams);
+        CMWEBCoinsViewCache mwebview(pmwebcoinsTip);
+        COracleViewCache oracleview(poraclesTip);
+        bool rv = ConnectBlock(blockConnecting, state, pindexNew, view, mwebview, oracleview, chainparams);
         GetMainSignals().BlockChecked(blockConnecting, state);
         if (!rv) {
             arith_uint256 bnTarget;
@@ -2517,7 +2757,7 @@ bool static ConnectTip(CValidationState& state, const CChainParams& chainparams,
         }
         nTime3 = GetTimeMicros(); nTimeConnectTotal += nTime3 - nTime2;
         LogPrint("bench", "  - Connect total: %.2fms [%.2fs]\n", (nTime3 - nTime2) * 0.001, nTimeConnectTotal * 0.000001);
-        bool flushed = view.Flush();
+        bool flushed = view.Flush() && mwebview.Flush() && oracleview.Flush();
         assert(flushed);
     }
     int64_t nTime4 = GetTimeMicros(); nTimeFlush += nTime4 - nTime3;
@@ -2767,6 +3007,7 @@ bool ActivateBestChain(CValidationState &state, const CChainParams& chainparams,
                 const CBlock& block = *(pair.second);
                 for (unsigned int i = 0; i < block.vtx.size(); i++)
                     GetMainSignals().SyncTransaction(*block.vtx[i], pair.first, i);
+                GetMainSignals().BlockConnected(block, pair.first);
             }
         }
         // When we reach this point, we switched to a new tip (stored in pindexNewTip).
@@ -2977,6 +3218,16 @@ bool ReceivedBlockTransactions(const CBlock &block, CValidationState& state, CBl
     if (IsWitnessEnabled(pindexNew->pprev, Params().GetConsensus(pindexNew->nHeight))) {
         pindexNew->nStatus |= BLOCK_OPT_WITNESS;
     }
+    if (block.mweb_extension) {
+        pindexNew->hashMWEBExtension = block.mweb_extension->GetHash();
+        pindexNew->nMWEBTx = block.mweb_extension->mweb_txs.size();
+        pindexNew->nPegIn = block.mweb_extension->peg_ins.size();
+        pindexNew->nPegOut = block.mweb_extension->peg_outs.size();
+    } else {
+        pindexNew->hashMWEBExtension.SetNull();
+        pindexNew->nMWEBTx = pindexNew->nPegIn = pindexNew->nPegOut = 0;
+    }
+    pindexNew->nStatus |= BLOCK_OPT_MWEB;
     pindexNew->RaiseValidity(BLOCK_VALID_TRANSACTIONS);
     setDirtyBlockIndex.insert(pindexNew);
 
@@ -3138,6 +3389,11 @@ bool CheckBlock(const CBlock& block, CValidationState& state, bool fCheckPOW, bo
         // while still invalidating it.
         if (mutated)
             return state.DoS(100, false, REJECT_INVALID, "bad-txns-duplicate", true, "duplicate transaction");
+
+        // The MWEB extension block is not covered by the merkle root, so
+        // check its contents against the hash it carries instead.
+        if (block.mweb_extension && block.mweb_extension->extension_block_hash != block.mweb_extension->GetHash())
+            return state.DoS(100, false, REJECT_INVALID, "bad-mweb-extension-hash", true, "extension_block_hash mismatch");
     }
 
     // All potential-corruption validation must be done before we do any
@@ -3388,7 +3644,7 @@ bool ContextualCheckBlock(const CBlock& block, CValidationState& state, const CB
     return true;
 }
 
-static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex)
+static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex, bool fCheckPOW = true)
 {
     AssertLockHeld(cs_main);
     // Check for duplicate
@@ -3407,7 +3663,7 @@ static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state
             return true;
         }
 
-        if (!CheckBlockHeader(block, state))
+        if (!CheckBlockHeader(block, state, fCheckPOW))
             return error("%s: Consensus::CheckBlockHeader: %s, %s", __func__, hash.ToString(), FormatStateMessage(state));
 
         // Get prev block index
@@ -3455,11 +3711,27 @@ static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state
 // Exposed wrapper for AcceptBlockHeader
 bool ProcessNewBlockHeaders(const std::vector<CBlockHeader>& headers, CValidationState& state, const CChainParams& chainparams, const CBlockIndex** ppindex)
 {
+    // Scrypt makes the proof of work the bulk of checking a headers message,
+    // so check it up front without holding cs_main. AcceptBlockHeader then
+    // only checks it again for the headers that failed, to reject them in
+    // order, as without this.
+    std::vector<char> vPoWValid(headers.size(), false);
+    if (headers.size() > 1) {
+        // Headers already known, usually a prefix of the batch, are not checked again
+        size_t nFirstNew = 0;
+        {
+            LOCK(cs_main);
+            while (nFirstNew < headers.size() && mapBlockIndex.count(headers[nFirstNew].GetHash()))
+                nFirstNew++;
+        }
+        CheckHeadersProofOfWork(headers, nFirstNew, vPoWValid);
+    }
+
     {
         LOCK(cs_main);
-        for (const CBlockHeader& header : headers) {
+        for (size_t i = 0; i < headers.size(); i++) {
             CBlockIndex *pindex = NULL; // Use a temp pindex instead of ppindex to avoid a const_cast
-            if (!AcceptBlockHeader(header, state, chainparams, &pindex)) {
+            if (!AcceptBlockHeader(headers[i], state, chainparams, &pindex, !vPoWValid[i])) {
                 return false;
             }
             if (ppindex) {
@@ -3563,6 +3835,50 @@ static bool __attribute__((unused)) IsSuperMajority(int minVersion, const CBlock
     return (nFound >= nRequired);
 }
 
+/**
+ * Load the coins spent by a block into pcoinsTip before it gets connected.
+ * ConnectBlock would otherwise read them one by one as it walks the
+ * transactions; here the reads of those not cached yet are spread over the
+ * prefetch threads, so that their database latencies overlap.
+ */
+static void PrefetchBlockInputs(const CBlock& block)
+{
+    AssertLockHeld(cs_main);
+
+    std::vector<COutPoint> vOutpoints;
+    std::set<uint256> setBlockTxids;
+    for (const auto& tx : block.vtx) {
+        if (!tx->IsCoinBase()) {
+            for (const CTxIn& txin : tx->vin) {
+                // Outputs created earlier in the block are not in the database yet
+                if (!setBlockTxids.count(txin.prevout.hash) && !pcoinsTip->HaveCoinInCache(txin.prevout))
+                    vOutpoints.push_back(txin.prevout);
+            }
+        }
+        setBlockTxids.insert(tx->GetHash());
+    }
+    if (vOutpoints.empty())
+        return;
+
+    int64_t nTimeStart = GetTimeMicros();
+    std::vector<Coin> vCoins(vOutpoints.size());
+    {
+        CCheckQueueControl<CCoinsPrefetch> control(&coinsprefetchqueue);
+        std::vector<CCoinsPrefetch> vChecks;
+        vChecks.reserve(vOutpoints.size());
+        for (size_t i = 0; i < vOutpoints.size(); i++) {
+            CCoinsPrefetch check(*pcoinsTip, vOutpoints[i], vCoins[i]);
+            vChecks.push_back(CCoinsPrefetch());
+            check.swap(vChecks.back());
+        }
+        control.Add(vChecks);
+        control.Wait();
+    }
+    for (size_t i = 0; i < vOutpoints.size(); i++)
+        pcoinsTip->CacheCoinFromBase(vOutpoints[i], std::move(vCoins[i]));
+    LogPrint("bench", "    - Prefetch %u inputs: %.2fms\n", (unsigned int)vOutpoints.size(), 0.001 * (GetTimeMicros() - nTimeStart));
+}
+
 bool ProcessNewBlock(const CChainParams& chainparams, const std::shared_ptr<const CBlock> pblock, bool fForceProcessing, bool *fNewBlock)
 {
     {
@@ -3584,6 +3900,9 @@ bool ProcessNewBlock(const CChainParams& chainparams, const std::shared_ptr<cons
             GetMainSignals().BlockChecked(*pblock, state);
             return error("%s: AcceptBlock FAILED", __func__);
         }
+        // A block extending the tip is what ActivateBestChain connects next.
+        if (nScriptCheckThreads && pindex && pindex->pprev == chainActive.Tip())
+            PrefetchBlockInputs(*pblock);
     }
 
     NotifyHeaderTip();
@@ -3602,6 +3921,8 @@ bool TestBlockValidity(CValidationState& state, const CChainParams& chainparams,
     AssertLockHeld(cs_main);
     assert(pindexPrev && pindexPrev == chainActive.Tip());
     CCoinsViewCache viewNew(pcoinsTip);
+    CMWEBCoinsViewCache mwebViewNew(pmwebcoinsTip);
+    COracleViewCache oracleViewNew(poraclesTip);
     CBlockIndex indexDummy(block);
     indexDummy.pprev = pindexPrev;
     indexDummy.nHeight = pindexPrev->nHeight + 1;
@@ -3613,7 +3934,7 @@ bool TestBlockValidity(CValidationState& state, const CChainParams& chainparams,
         return error("%s: Consensus::CheckBlock: %s", __func__, FormatStateMessage(state));
     if (!ContextualCheckBlock(block, state, pindexPrev))
         return error("%s: Consensus::ContextualCheckBlock: %s", __func__, FormatStateMessage(state));
-    if (!ConnectBlock(block, state, &indexDummy, viewNew, chainparams, true))
+    if (!ConnectBlock(block, state, &indexDummy, viewNew, mwebViewNew, oracleViewNew, chainparams, true))
         return false;
     assert(state.IsValid());
 
@@ -3675,6 +3996,7 @@ void UnlinkPrunedFiles(const std::set<int>& setFilesToPrune)
 {
     for (std::set<int>::iterator it = setFilesToPrune.begin(); it != setFilesToPrune.end(); ++it) {
         CDiskBlockPos pos(*it, 0);
+        ForgetBlockFileMap(*it);
         fs::remove(GetBlockPosFilename(pos, "blk"));
         fs::remove(GetBlockPosFilename(pos, "rev"));
         LogPrintf("Prune: %s deleted blk/rev (%05u)\n", __func__, *it);
@@ -3964,6 +4286,8 @@ bool CVerifyDB::VerifyDB(const CChainParams& chainparams, CCoinsView *coinsview,
     nCheckLevel = std::max(0, std::min(4, nCheckLevel));
     LogPrintf("Verifying last %i blocks at level %i\n", nCheckDepth, nCheckLevel);
     CCoinsViewCache coins(coinsview);
+    CMWEBCoinsViewCache mwebcoins(pmwebcoinsTip);
+    COracleViewCache oracles(poraclesTip);
     CBlockIndex* pindexState = chainActive.Tip();
     CBlockIndex* pindexFailure = NULL;
     int nGoodTransactions = 0;
@@ -4005,9 +4329,9 @@ bool CVerifyDB::VerifyDB(const CChainParams& chainparams, CCoinsView *coinsview,
             }
         }
         // check level 3: check for inconsistencies during memory-only disconnect of tip blocks
-        if (nCheckLevel >= 3 && pindex == pindexState && (coins.DynamicMemoryUsage() + pcoinsTip->DynamicMemoryUsage()) <= nCoinCacheUsage) {
+        if (nCheckLevel >= 3 && pindex == pindexState && (coins.DynamicMemoryUsage() + pcoinsTip->DynamicMemoryUsage() + mwebcoins.DynamicMemoryUsage() + oracles.DynamicMemoryUsage()) <= nCoinCacheUsage) {
             bool fClean = true;
-            if (!DisconnectBlock(block, state, pindex, coins, &fClean))
+            if (!DisconnectBlock(block, state, pindex, coins, mwebcoins, oracles, &fClean))
                 return error("VerifyDB(): *** irrecoverable inconsistency in block data at %d, hash=%s", pindex->nHeight, pindex->GetBlockHash().ToString());
             pindexState = pindex->pprev;
             if (!fClean) {
@@ -4032,7 +4356,7 @@ bool CVerifyDB::VerifyDB(const CChainParams& chainparams, CCoinsView *coinsview,
             CBlock block;
             if (!ReadBlockFromDisk(block, pindex, chainparams.GetConsensus(pindex->nHeight)))
                 return error("VerifyDB(): *** ReadBlockFromDisk failed at %d, hash=%s", pindex->nHeight, pindex->GetBlockHash().ToString());
-            if (!ConnectBlock(block, state, pindex, coins, chainparams))
+            if (!ConnectBlock(block, state, pindex, coins, mwebcoins, oracles, chainparams))
                 return error("VerifyDB(): *** found unconnectable block at %d, hash=%s", pindex->nHeight, pindex->GetBlockHash().ToString());
         }
     }
@@ -4096,6 +4420,7 @@ bool RewindBlockIndex(const CChainParams& params)
             pindexIter->nDataPos = 0;
             pindexIter->nUndoPos = 0;
             // Remove various other things
+            pindexIter->nStatus &= ~BLOCK_OPT_MWEB;
             pindexIter->nTx = 0;
             pindexIter->nChainTx = 0;
             pindexIter->nSequenceId = 0;
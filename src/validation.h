@@ -41,6 +41,10 @@ class CBloomFilter;
 class CBlockUndo;
 class CChainParams;
 class CInv;
+class CMWEBCoinsViewCache;
+class CMWEBCoinsViewDB;
+class COracleViewCache;
+class COracleViewDB;
 class CConnman;
 class CScriptCheck;
 class CTxMemPool;
@@ -86,6 +90,8 @@ static const unsigned int MAX_BLOCKFILE_SIZE = 0x8000000; // 128 MiB
 static const unsigned int BLOCKFILE_CHUNK_SIZE = 0x1000000; // 16 MiB
 /** The pre-allocation chunk size for rev?????.dat files (since 0.8) */
 static const unsigned int UNDOFILE_CHUNK_SIZE = 0x100000; // 1 MiB
+/** The number of blk?????.dat files kept memory mapped for reading blocks (64-bit builds only, see CMappedFile) */
+static const unsigned int MAX_MAPPED_BLOCK_FILES = 16;
 
 /** Maximum number of script-checking threads allowed */
 static const int MAX_SCRIPTCHECK_THREADS = 16;
@@ -112,6 +118,8 @@ static const unsigned int BLOCK_DOWNLOAD_WINDOW = 1024;
 static const unsigned int DATABASE_WRITE_INTERVAL = 60 * 60;
 /** Time to wait (in seconds) between flushing chainstate to disk. */
 static const unsigned int DATABASE_FLUSH_INTERVAL = 24 * 60 * 60;
+/** Share of the cache budget (in percent) to free up below the flush threshold when the chainstate is written without emptying the coins cache. */
+static const unsigned int DATABASE_EVICT_MARGIN_PERCENT = 10;
 /** Maximum length of reject messages. */
 static const unsigned int MAX_REJECT_MESSAGE_LENGTH = 111;
 /** Average delay between local address broadcasts in seconds. */
@@ -210,6 +218,8 @@ extern bool fPruneMode;
 extern uint64_t nPruneTarget;
 /** Block files containing a block-height within MIN_BLOCKS_TO_KEEP of chainActive.Tip() will not be pruned. */
 static const unsigned int MIN_BLOCKS_TO_KEEP = 1440;
+/** MWEB and oracle undo data is kept for this many blocks below the tip; deeper blocks cannot be disconnected. */
+static const unsigned int MAX_REORG_DEPTH = MIN_BLOCKS_TO_KEEP;
 
 static const signed int DEFAULT_CHECKBLOCKS = 6;
 static const unsigned int DEFAULT_CHECKLEVEL = 3;
@@ -248,7 +258,8 @@ bool ProcessNewBlock(const CChainParams& chainparams, const std::shared_ptr<cons
 /**
  * Process incoming block headers.
  *
- * Call without cs_main held.
+ * Call without cs_main held. The proof of work of the new headers is checked
+ * first, as a batch on the header check threads and before taking cs_main.
  *
  * @param[in]  block The block headers themselves
  * @param[out] state This may be set to an Error state if any error occurred processing them
@@ -275,6 +286,12 @@ bool LoadBlockIndex(const CChainParams& chainparams);
 void UnloadBlockIndex();
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck();
+/** Run an instance of the MWEB extension block checking thread */
+void ThreadMWEBCheck();
+/** Run an instance of the header proof of work checking thread */
+void ThreadHeaderCheck();
+/** Run an instance of the thread reading a new block's inputs ahead of connecting it */
+void ThreadCoinsPrefetch();
 /** Check whether we are doing an initial block download (synchronizing from disk or network) */
 bool IsInitialBlockDownload();
 /** Format a string that describes several potential problems detected by the core.
@@ -461,8 +478,8 @@ private:
 
 public:
     CScriptCheck(): amount(0), ptxTo(0), nIn(0), nFlags(0), cacheStore(false), error(SCRIPT_ERR_UNKNOWN_ERROR) {}
-    CScriptCheck(const CCoins& txFromIn, const CTransaction& txToIn, unsigned int nInIn, unsigned int nFlagsIn, bool cacheIn, PrecomputedTransactionData* txdataIn) :
-        scriptPubKey(txFromIn.vout[txToIn.vin[nInIn].prevout.n].scriptPubKey), amount(txFromIn.vout[txToIn.vin[nInIn].prevout.n].nValue),
+    CScriptCheck(const CTxOut& outIn, const CTransaction& txToIn, unsigned int nInIn, unsigned int nFlagsIn, bool cacheIn, PrecomputedTransactionData* txdataIn) :
+        scriptPubKey(outIn.scriptPubKey), amount(outIn.nValue),
         ptxTo(&txToIn), nIn(nInIn), nFlags(nFlagsIn), cacheStore(cacheIn), error(SCRIPT_ERR_UNKNOWN_ERROR), txdata(txdataIn) { }
 
     bool operator()();
@@ -481,6 +498,62 @@ public:
     ScriptError GetScriptError() const { return error; }
 };
 
+/**
+ * Closure checking the proof of work of a range of headers, with their scrypt
+ * hashes computed as a batch. Headers that pass are marked in (*pvValid)[i].
+ * Returns false at the first header that fails, which also stops the other
+ * checks of the queue: those headers are left for AcceptBlockHeader.
+ */
+class CHeaderPoWCheck
+{
+private:
+    const std::vector<CBlockHeader>* headers;
+    std::vector<char>* pvValid;
+    size_t nBegin;
+    size_t nEnd;
+
+public:
+    CHeaderPoWCheck(): headers(NULL), pvValid(NULL), nBegin(0), nEnd(0) {}
+    CHeaderPoWCheck(const std::vector<CBlockHeader>& headersIn, std::vector<char>& vValidIn, size_t nBeginIn, size_t nEndIn) :
+        headers(&headersIn), pvValid(&vValidIn), nBegin(nBeginIn), nEnd(nEndIn) {}
+
+    bool operator()();
+
+    void swap(CHeaderPoWCheck& check) {
+        std::swap(headers, check.headers);
+        std::swap(pvValid, check.pvValid);
+        std::swap(nBegin, check.nBegin);
+        std::swap(nEnd, check.nEnd);
+    }
+};
+
+/**
+ * Closure reading the coin for one outpoint from the view behind a coins
+ * cache, so that the inputs of a block can be read from the database by
+ * several threads at once. The coin is stored in *pcoin, which stays spent
+ * if there is none.
+ */
+class CCoinsPrefetch
+{
+private:
+    const CCoinsViewCache* view;
+    const COutPoint* poutpoint;
+    Coin* pcoin;
+
+public:
+    CCoinsPrefetch(): view(NULL), poutpoint(NULL), pcoin(NULL) {}
+    CCoinsPrefetch(const CCoinsViewCache& viewIn, const COutPoint& outpointIn, Coin& coinIn) :
+        view(&viewIn), poutpoint(&outpointIn), pcoin(&coinIn) {}
+
+    bool operator()();
+
+    void swap(CCoinsPrefetch& check) {
+        std::swap(view, check.view);
+        std::swap(poutpoint, check.poutpoint);
+        std::swap(pcoin, check.pcoin);
+    }
+};
+
 
 /** Functions for disk access for blocks */
 bool WriteBlockToDisk(const CBlock& block, CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart);
@@ -502,17 +575,20 @@ bool CheckBlock(const CBlock& block, CValidationState& state, bool fCheckPOW = t
 bool ContextualCheckBlockHeader(const CBlockHeader& block, CValidationState& state, const CBlockIndex* pindexPrev, int64_t nAdjustedTime);
 bool ContextualCheckBlock(const CBlock& block, CValidationState& state, const CBlockIndex* pindexPrev);
 
-/** Apply the effects of this block (with given index) on the UTXO set represented by coins.
+/** Apply the effects of this block (with given index) on the UTXO set represented by coins,
+ *  of its extension block on the MWEB output set represented by mwebcoins and of its
+ *  oracle markers and contributions on the oracle state represented by oracles.
  *  Validity checks that depend on the UTXO set are also done; ConnectBlock()
  *  can fail if those validity checks fail (among other reasons). */
 bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pindex, CCoinsViewCache& coins,
-                  const CChainParams& chainparams, bool fJustCheck = false);
+                  CMWEBCoinsViewCache& mwebcoins, COracleViewCache& oracles, const CChainParams& chainparams, bool fJustCheck = false);
 
 /** Undo the effects of this block (with given index) on the UTXO set represented by coins.
  *  In case pfClean is provided, operation will try to be tolerant about errors, and *pfClean
  *  will be true if no problems were found. Otherwise, the return value will be false in case
  *  of problems. Note that in any case, coins may be modified. */
-bool DisconnectBlock(const CBlock& block, CValidationState& state, const CBlockIndex* pindex, CCoinsViewCache& coins, bool* pfClean = NULL);
+bool DisconnectBlock(const CBlock& block, CValidationState& state, const CBlockIndex* pindex, CCoinsViewCache& coins,
+                     CMWEBCoinsViewCache& mwebcoins, COracleViewCache& oracles, bool* pfClean = NULL);
 
 /** Check a block is completely valid from start to finish (only works on top of our current best block, with cs_main held) */
 bool TestBlockValidity(CValidationState& state, const CChainParams& chainparams, const CBlock& block, CBlockIndex* pindexPrev, bool fCheckPOW = true, bool fCheckMerkleRoot = true);
@@ -555,6 +631,18 @@ extern CChain chainActive;
 /** Global variable that points to the active CCoinsView (protected by cs_main) */
 extern CCoinsViewCache *pcoinsTip;
 
+/** Global variable that points to the MWEB output set database (protected by cs_main) */
+extern CMWEBCoinsViewDB *pmwebcoinsdbview;
+
+/** Global variable that points to the active MWEB output set cache (protected by cs_main) */
+extern CMWEBCoinsViewCache *pmwebcoinsTip;
+
+/** Global variable that points to the oracle state database (protected by cs_main) */
+extern COracleViewDB *poraclesdbview;
+
+/** Global variable that points to the active oracle state cache (protected by cs_main) */
+extern COracleViewCache *poraclesTip;
+
 /** Global variable that points to the active block tree (protected by cs_main) */
 extern CBlockTreeDB *pblocktree;
 
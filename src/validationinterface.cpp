@@ -24,6 +24,12 @@ void RegisterValidationInterface(CValidationInterface* pwalletIn) {
                                                   pwalletIn, boost::placeholders::_1,
                                                   boost::placeholders::_2,
                                                   boost::placeholders::_3));
+    g_signals.BlockConnected.connect(boost::bind(&CValidationInterface::BlockConnected,
+                                                 pwalletIn, boost::placeholders::_1,
+                                                 boost::placeholders::_2));
+    g_signals.BlockDisconnected.connect(boost::bind(&CValidationInterface::BlockDisconnected,
+                                                    pwalletIn, boost::placeholders::_1,
+                                                    boost::placeholders::_2));
     g_signals.UpdatedTransaction.connect(boost::bind(&CValidationInterface::UpdatedTransaction,
                                                      pwalletIn, boost::placeholders::_1));
     g_signals.SetBestChain.connect(boost::bind(&CValidationInterface::SetBestChain,
@@ -57,6 +63,12 @@ void UnregisterValidationInterface(CValidationInterface* pwalletIn) {
                                                   pwalletIn, boost::placeholders::_1));
     g_signals.UpdatedTransaction.disconnect(boost::bind(&CValidationInterface::UpdatedTransaction,
                                                         pwalletIn, boost::placeholders::_1));
+    g_signals.BlockDisconnected.disconnect(boost::bind(&CValidationInterface::BlockDisconnected,
+                                                       pwalletIn, boost::placeholders::_1,
+                                                       boost::placeholders::_2));
+    g_signals.BlockConnected.disconnect(boost::bind(&CValidationInterface::BlockConnected,
+                                                    pwalletIn, boost::placeholders::_1,
+                                                    boost::placeholders::_2));
     g_signals.SyncTransaction.disconnect(boost::bind(&CValidationInterface::SyncTransaction,
                                                      pwalletIn, boost::placeholders::_1,
                                                      boost::placeholders::_2,
@@ -77,6 +89,8 @@ void UnregisterAllValidationInterfaces() {
     g_signals.Broadcast.disconnect_all_slots();
     g_signals.SetBestChain.disconnect_all_slots();
     g_signals.UpdatedTransaction.disconnect_all_slots();
+    g_signals.BlockDisconnected.disconnect_all_slots();
+    g_signals.BlockConnected.disconnect_all_slots();
     g_signals.SyncTransaction.disconnect_all_slots();
     g_signals.UpdatedBlockTip.disconnect_all_slots();
     g_signals.NewPoWValidBlock.disconnect_all_slots();
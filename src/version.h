@@ -11,7 +11,7 @@
 
 // XXX: Decide if this is appropriate - if we reintroduce alerts we may need
 //      to  reduce to 70012
-static const int PROTOCOL_VERSION = 70015;
+static const int PROTOCOL_VERSION = 70016;
 
 //! initial proto version, to be increased after version/verack negotiation
 static const int INIT_PROTO_VERSION = 209;
@@ -47,4 +47,10 @@ static const int SHORT_IDS_BLOCKS_VERSION = 70014;
 //! not banning for invalid compact blocks starts with this version
 static const int INVALID_CB_NO_BAN_VERSION = 70015;
 
+//! MWEB extension blocks in cmpctblock, getblocktxn and blocktxn start with this version
+static const int MWEB_CMPCT_VERSION = 70016;
+
+//! "mwebtx" and MSG_MWEB_TX inventory are relayed starting with this version
+static const int MWEB_TX_VERSION = 70016;
+
 #endif // FLEETCREDITS_VERSION_H